@@ -0,0 +1,628 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the graph and virtualizer benchmark
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ * Drives the real graph and virtualizer code through the phases of a studio
+ * lifetime against a mock JACK server (see mock.c) and reports, per phase,
+ * wall time, heap allocations, D-Bus messages (signals) and JACK requests.
+ *
+ * Phases:
+ *  appear   - apps start and their JACK clients and ports appear in the studio
+ *  connect  - JACK connections between the app ports are made
+ *  restart  - studio is stopped and started again: apps stop, JACK server
+ *             stops and starts, apps start and the connections are restored
+ *  rooms    - apps with connections appear in rooms, then the rooms are removed
+ *  copy     - studio graph is copied, as done when studio is saved and loaded
+ *  teardown - apps stop and the graphs are cleared
+ */
+
+#include <getopt.h>
+#include <dbus/dbus.h>
+
+#include "mock.h"
+#include "../daemon/virtualizer.h"
+#include "../daemon/studio_internal.h"
+#include "../common/time.h"
+
+#define STUDIO_OPATH "/org/ladish/Studio"
+#define ROOM_OPATH_PREFIX "/org/ladish/Room"
+
+/********************************************************************************/
+/* measurements */
+
+enum bench_phase
+{
+  BENCH_PHASE_APPEAR,
+  BENCH_PHASE_CONNECT,
+  BENCH_PHASE_RESTART,
+  BENCH_PHASE_ROOMS,
+  BENCH_PHASE_COPY,
+  BENCH_PHASE_TEARDOWN,
+  BENCH_PHASE_COUNT
+};
+
+static const char * g_phase_names[BENCH_PHASE_COUNT] =
+{
+  [BENCH_PHASE_APPEAR] = "appear",
+  [BENCH_PHASE_CONNECT] = "connect",
+  [BENCH_PHASE_RESTART] = "restart",
+  [BENCH_PHASE_ROOMS] = "rooms",
+  [BENCH_PHASE_COPY] = "copy",
+  [BENCH_PHASE_TEARDOWN] = "teardown",
+};
+
+struct bench_result
+{
+  unsigned int count;
+  uint64_t usecs;
+  uint64_t usecs_min;
+  uint64_t allocations;
+  uint64_t dbus_messages;
+  uint64_t jack_requests;
+};
+
+static struct
+{
+  enum bench_phase phase;
+  uint64_t start;
+  struct mock_counters counters;
+  struct bench_result results[BENCH_PHASE_COUNT];
+} g_measurement;
+
+static void bench_begin(enum bench_phase phase)
+{
+  g_measurement.phase = phase;
+  g_measurement.counters = g_mock_counters;
+  g_measurement.start = ladish_get_current_microseconds();
+}
+
+static void bench_end(void)
+{
+  uint64_t usecs;
+  struct bench_result * result_ptr;
+
+  usecs = ladish_get_current_microseconds() - g_measurement.start;
+
+  result_ptr = g_measurement.results + g_measurement.phase;
+  result_ptr->usecs += usecs;
+  if (result_ptr->count++ == 0 || usecs < result_ptr->usecs_min)
+  {
+    result_ptr->usecs_min = usecs;
+  }
+  result_ptr->allocations += g_mock_counters.allocations - g_measurement.counters.allocations;
+  result_ptr->dbus_messages += g_mock_counters.dbus_messages - g_measurement.counters.dbus_messages;
+  result_ptr->jack_requests += g_mock_counters.jack_requests - g_measurement.counters.jack_requests;
+}
+
+/********************************************************************************/
+/* scenario */
+
+struct bench_app
+{
+  ladish_graph_handle graph;
+  char name[64];
+  pid_t pid;
+  uint64_t client_id;
+  uint64_t * port_ids;          /* first half are inputs, second half are outputs */
+};
+
+static struct
+{
+  unsigned int app_count;
+  unsigned int port_count;      /* per app */
+  unsigned int connection_count;
+  unsigned int room_count;
+  unsigned int iterations;
+
+  ladish_virtualizer_handle virtualizer;
+  struct bench_app * apps;
+  pid_t next_pid;
+} g_bench =
+{
+  .app_count = 50,
+  .port_count = 8,
+  .connection_count = 200,
+  .room_count = 8,
+  .iterations = 1,
+};
+
+static
+bool
+set_graph_connection_handlers(
+  void * context,
+  ladish_graph_handle graph,
+  ladish_app_supervisor_handle UNUSED(app_supervisor))
+{
+  ladish_virtualizer_set_graph_connection_handlers(context, graph);
+  return true;                  /* iterate all vgraphs */
+}
+
+static bool jack_start(void)
+{
+  if (!ladish_virtualizer_create(mock_jack_get_graph_proxy(), g_studio.jack_graph, &g_bench.virtualizer))
+  {
+    log_error("ladish_virtualizer_create() failed.");
+    return false;
+  }
+
+  ladish_studio_iterate_virtual_graphs(g_bench.virtualizer, set_graph_connection_handlers);
+  return true;
+}
+
+static void jack_stop(void)
+{
+  ladish_graph_hide_non_virtual(g_studio.jack_graph);
+  ladish_graph_hide_non_virtual(g_studio.studio_graph);
+  ladish_virtualizer_destroy(g_bench.virtualizer);
+  g_bench.virtualizer = NULL;
+  mock_jack_clear();
+}
+
+static bool app_appear(struct bench_app * app_ptr)
+{
+  unsigned int i;
+  bool is_input;
+  char port_name[64];
+
+  app_ptr->client_id = mock_jack_client_appear(app_ptr->name, app_ptr->pid);
+  if (app_ptr->client_id == 0)
+  {
+    log_error("mock_jack_client_appear() failed for '%s'", app_ptr->name);
+    return false;
+  }
+
+  for (i = 0; i < g_bench.port_count; i++)
+  {
+    is_input = i < g_bench.port_count / 2;
+    snprintf(port_name, sizeof(port_name), "%s_%u", is_input ? "in" : "out", i);
+    app_ptr->port_ids[i] = mock_jack_port_appear(app_ptr->client_id, port_name, is_input, false);
+    if (app_ptr->port_ids[i] == 0)
+    {
+      log_error("mock_jack_port_appear() failed for '%s:%s'", app_ptr->name, port_name);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool app_create(struct bench_app * app_ptr, ladish_graph_handle graph, const char * prefix, unsigned int index)
+{
+  app_ptr->graph = graph;
+  app_ptr->pid = g_bench.next_pid++;
+  app_ptr->client_id = 0;
+  snprintf(app_ptr->name, sizeof(app_ptr->name), "%s%u", prefix, index);
+
+  app_ptr->port_ids = calloc(g_bench.port_count, sizeof(uint64_t));
+  if (app_ptr->port_ids == NULL)
+  {
+    log_error("calloc() failed for port ids of '%s'", app_ptr->name);
+    return false;
+  }
+
+  if (mock_app_add(graph, app_ptr->name, app_ptr->pid) == NULL)
+  {
+    log_error("mock_app_add() failed for '%s'", app_ptr->name);
+    free(app_ptr->port_ids);
+    return false;
+  }
+
+  return true;
+}
+
+/* connect outputs of each app to inputs of the next one, round robin */
+static unsigned int apps_connect(struct bench_app * apps, unsigned int app_count, unsigned int connection_count)
+{
+  unsigned int i;
+  unsigned int half;
+  struct bench_app * src_ptr;
+  struct bench_app * dst_ptr;
+  unsigned int connected;
+
+  half = g_bench.port_count / 2;
+  if (half == 0 || app_count < 2)
+  {
+    return 0;
+  }
+
+  connected = 0;
+  for (i = 0; i < connection_count; i++)
+  {
+    src_ptr = apps + i % app_count;
+    dst_ptr = apps + (i % app_count + 1 + i / (app_count * half)) % app_count;
+    if (src_ptr == dst_ptr)
+    {
+      continue;
+    }
+
+    if (mock_jack_connect(src_ptr->port_ids[half + (i / app_count) % half], dst_ptr->port_ids[(i / app_count) % half]))
+    {
+      connected++;
+    }
+  }
+
+  return connected;
+}
+
+static void apps_disappear(struct bench_app * apps, unsigned int app_count)
+{
+  unsigned int i;
+
+  for (i = 0; i < app_count; i++)
+  {
+    if (apps[i].client_id != 0)
+    {
+      mock_jack_client_disappear(apps[i].client_id);
+      apps[i].client_id = 0;
+    }
+  }
+}
+
+static void remove_room_port(ladish_port_handle port)
+{
+  ladish_client_handle jack_client;
+
+  jack_client = ladish_graph_remove_port(g_studio.jack_graph, port);
+  if (jack_client != NULL && ladish_graph_client_is_empty(g_studio.jack_graph, jack_client))
+  {
+    ladish_graph_remove_client(g_studio.jack_graph, jack_client);
+  }
+}
+
+static bool run_rooms(void)
+{
+  unsigned int apps_per_room;
+  unsigned int room;
+  unsigned int i;
+  char opath[64];
+  ladish_graph_handle * graphs;
+  struct bench_app * apps;
+  bool ret;
+
+  ret = false;
+
+  apps_per_room = g_bench.app_count / g_bench.room_count;
+  if (apps_per_room < 2)
+  {
+    apps_per_room = 2;
+  }
+
+  graphs = calloc(g_bench.room_count, sizeof(ladish_graph_handle));
+  apps = calloc(g_bench.room_count * apps_per_room, sizeof(struct bench_app));
+  if (graphs == NULL || apps == NULL)
+  {
+    log_error("calloc() failed for rooms");
+    goto free;
+  }
+
+  for (room = 0; room < g_bench.room_count; room++)
+  {
+    snprintf(opath, sizeof(opath), ROOM_OPATH_PREFIX "%u", room + 1);
+    if (!ladish_graph_create(graphs + room, opath))
+    {
+      log_error("ladish_graph_create() failed for room %u", room + 1);
+      goto destroy;
+    }
+
+    mock_vgraph_add(graphs[room]);
+    ladish_virtualizer_set_graph_connection_handlers(g_bench.virtualizer, graphs[room]);
+
+    for (i = 0; i < apps_per_room; i++)
+    {
+      if (!app_create(apps + room * apps_per_room + i, graphs[room], "roomapp", room * apps_per_room + i))
+      {
+        goto destroy;
+      }
+    }
+  }
+
+  for (i = 0; i < g_bench.room_count * apps_per_room; i++)
+  {
+    if (!app_appear(apps + i))
+    {
+      goto destroy;
+    }
+  }
+
+  for (room = 0; room < g_bench.room_count; room++)
+  {
+    apps_connect(apps + room * apps_per_room, apps_per_room, g_bench.connection_count / g_bench.room_count);
+  }
+
+  ret = true;
+
+destroy:
+  apps_disappear(apps, g_bench.room_count * apps_per_room);
+
+  for (room = 0; room < g_bench.room_count; room++)
+  {
+    if (graphs[room] != NULL)
+    {
+      ladish_graph_clear(graphs[room], remove_room_port);
+      mock_vgraph_remove(graphs[room]);
+      ladish_graph_destroy(graphs[room]);
+    }
+  }
+
+  for (i = 0; i < g_bench.room_count * apps_per_room; i++)
+  {
+    free(apps[i].port_ids);
+  }
+free:
+  free(apps);
+  free(graphs);
+  return ret;
+}
+
+static bool run_copy(void)
+{
+  ladish_graph_handle graph;
+  bool ret;
+
+  if (!ladish_graph_create(&graph, NULL))
+  {
+    log_error("ladish_graph_create() failed for the copy");
+    return false;
+  }
+
+  ret = ladish_graph_copy(g_studio.studio_graph, graph);
+  if (!ret)
+  {
+    log_error("ladish_graph_copy() failed");
+  }
+
+  ladish_graph_destroy(graph);
+  return ret;
+}
+
+static bool run_iteration(void)
+{
+  unsigned int i;
+  unsigned int connected;
+  bool ret;
+
+  ret = false;
+  g_bench.next_pid = 1000;
+
+  if (!ladish_graph_create(&g_studio.jack_graph, NULL))
+  {
+    log_error("ladish_graph_create() failed to create jack graph object.");
+    goto exit;
+  }
+
+  if (!ladish_graph_create(&g_studio.studio_graph, STUDIO_OPATH))
+  {
+    log_error("ladish_graph_create() failed to create studio graph object.");
+    goto destroy_jack_graph;
+  }
+
+  mock_vgraph_add(g_studio.studio_graph);
+
+  g_bench.apps = calloc(g_bench.app_count, sizeof(struct bench_app));
+  if (g_bench.apps == NULL)
+  {
+    log_error("calloc() failed for apps");
+    goto destroy_studio_graph;
+  }
+
+  for (i = 0; i < g_bench.app_count; i++)
+  {
+    if (!app_create(g_bench.apps + i, g_studio.studio_graph, "app", i))
+    {
+      goto free_apps;
+    }
+  }
+
+  if (!jack_start())
+  {
+    goto free_apps;
+  }
+
+  bench_begin(BENCH_PHASE_APPEAR);
+  for (i = 0; i < g_bench.app_count; i++)
+  {
+    if (!app_appear(g_bench.apps + i))
+    {
+      goto stop;
+    }
+  }
+  bench_end();
+
+  bench_begin(BENCH_PHASE_CONNECT);
+  connected = apps_connect(g_bench.apps, g_bench.app_count, g_bench.connection_count);
+  bench_end();
+
+  bench_begin(BENCH_PHASE_RESTART);
+  apps_disappear(g_bench.apps, g_bench.app_count);
+  jack_stop();
+  if (!jack_start())
+  {
+    goto free_apps;
+  }
+  for (i = 0; i < g_bench.app_count; i++)
+  {
+    if (!app_appear(g_bench.apps + i))
+    {
+      goto stop;
+    }
+  }
+  bench_end();
+
+  if (mock_jack_get_connection_count() != connected)
+  {
+    log_error("%u of %u connections restored after JACK restart", mock_jack_get_connection_count(), connected);
+    goto stop;
+  }
+
+  if (g_bench.room_count != 0)
+  {
+    bench_begin(BENCH_PHASE_ROOMS);
+    if (!run_rooms())
+    {
+      goto stop;
+    }
+    bench_end();
+  }
+
+  bench_begin(BENCH_PHASE_COPY);
+  if (!run_copy())
+  {
+    goto stop;
+  }
+  bench_end();
+
+  bench_begin(BENCH_PHASE_TEARDOWN);
+  apps_disappear(g_bench.apps, g_bench.app_count);
+  jack_stop();
+  ladish_graph_clear(g_studio.studio_graph, NULL);
+  ladish_graph_clear(g_studio.jack_graph, NULL);
+  bench_end();
+
+  ret = true;
+
+stop:
+  if (g_bench.virtualizer != NULL)
+  {
+    jack_stop();
+  }
+free_apps:
+  for (i = 0; i < g_bench.app_count; i++)
+  {
+    free(g_bench.apps[i].port_ids);
+  }
+  free(g_bench.apps);
+  g_bench.apps = NULL;
+destroy_studio_graph:
+  mock_uninit();
+  ladish_graph_destroy(g_studio.studio_graph);
+  g_studio.studio_graph = NULL;
+destroy_jack_graph:
+  ladish_graph_destroy(g_studio.jack_graph);
+  g_studio.jack_graph = NULL;
+exit:
+  return ret;
+}
+
+static void print_results(void)
+{
+  unsigned int i;
+  struct bench_result * result_ptr;
+
+  printf("%-10s %12s %12s %12s %12s %12s\n", "phase", "avg usecs", "min usecs", "allocations", "dbus msgs", "jack reqs");
+
+  for (i = 0; i < BENCH_PHASE_COUNT; i++)
+  {
+    result_ptr = g_measurement.results + i;
+    if (result_ptr->count == 0)
+    {
+      continue;
+    }
+
+    printf(
+      "%-10s %12"PRIu64" %12"PRIu64" %12"PRIu64" %12"PRIu64" %12"PRIu64"\n",
+      g_phase_names[i],
+      result_ptr->usecs / result_ptr->count,
+      result_ptr->usecs_min,
+      result_ptr->allocations / result_ptr->count,
+      result_ptr->dbus_messages / result_ptr->count,
+      result_ptr->jack_requests / result_ptr->count);
+  }
+}
+
+static void usage(const char * program)
+{
+  printf("Usage: %s [options]\n", program);
+  printf("  -a <count>  apps in the studio (default %u)\n", g_bench.app_count);
+  printf("  -p <count>  ports per app, half of them inputs (default %u)\n", g_bench.port_count);
+  printf("  -c <count>  connections between studio apps (default %u)\n", g_bench.connection_count);
+  printf("  -r <count>  rooms, 0 to skip the rooms phase (default %u)\n", g_bench.room_count);
+  printf("  -i <count>  iterations (default %u)\n", g_bench.iterations);
+  printf("  -v          print errors logged by the daemon code\n");
+  printf("  -h          this help\n");
+}
+
+int main(int argc, char ** argv)
+{
+  int opt;
+  unsigned int i;
+
+  while ((opt = getopt(argc, argv, "a:p:c:r:i:vh")) != -1)
+  {
+    switch (opt)
+    {
+    case 'a':
+      g_bench.app_count = strtoul(optarg, NULL, 10);
+      break;
+    case 'p':
+      g_bench.port_count = strtoul(optarg, NULL, 10);
+      break;
+    case 'c':
+      g_bench.connection_count = strtoul(optarg, NULL, 10);
+      break;
+    case 'r':
+      g_bench.room_count = strtoul(optarg, NULL, 10);
+      break;
+    case 'i':
+      g_bench.iterations = strtoul(optarg, NULL, 10);
+      break;
+    case 'v':
+      g_mock_verbose = true;
+      break;
+    case 'h':
+      usage(argv[0]);
+      return 0;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (g_bench.app_count == 0 || g_bench.iterations == 0)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  printf("%u apps, %u ports per app, %u connections, %u rooms, %u iterations\n", g_bench.app_count, g_bench.port_count, g_bench.connection_count, g_bench.room_count, g_bench.iterations);
+
+  for (i = 0; i < g_bench.iterations; i++)
+  {
+    if (!run_iteration())
+    {
+      fprintf(stderr, "iteration %u failed\n", i + 1);
+      return 1;
+    }
+  }
+
+  print_results();
+
+  if (g_mock_counters.errors != 0)
+  {
+    fprintf(stderr, "%"PRIu64" errors were logged, use -v to see them\n", g_mock_counters.errors);
+    return 1;                   /* the results are not trustworthy */
+  }
+
+  return 0;
+}
@@ -0,0 +1,708 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the replay tool for recorded JACK graph sessions
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ * Replays a file written by ladishd when LADISH_CONF_KEY_DAEMON_GRAPH_RECORD_FILE
+ * is set (see daemon/graph_record.h) into the real graph and virtualizer code,
+ * through the mock JACK server of mock.c.
+ *
+ * Connection changes are driven by the recording. The (dis)connect requests
+ * of the virtualizer are counted and acknowledged but do not change the mock graph.
+ * Apps are represented by mock apps in mock app supervisors, the vgraphs of rooms
+ * are created when their first app appears. Room link ports are not replayed.
+ *
+ * The commands that were recorded are reported with their recorded duration
+ * and the time it took to replay the graph events received while they were running.
+ */
+
+#include <getopt.h>
+#include <unistd.h>
+#include <dbus/dbus.h>
+
+#include "mock.h"
+#include "../daemon/virtualizer.h"
+#include "../daemon/studio_internal.h"
+#include "../daemon/graph_record.h"
+#include "../common/time.h"
+
+#define STUDIO_OPATH "/org/ladish/Studio"
+#define RECORD_TYPE_MAX LADISH_GRAPH_RECORD_COMMAND
+
+static const char * g_record_type_names[RECORD_TYPE_MAX + 1] =
+{
+  [LADISH_GRAPH_RECORD_SESSION_BEGIN] = "session begin",
+  [LADISH_GRAPH_RECORD_SESSION_END] = "session end",
+  [LADISH_GRAPH_RECORD_CLEAR] = "clear",
+  [LADISH_GRAPH_RECORD_APP] = "app",
+  [LADISH_GRAPH_RECORD_CLIENT_APPEARED] = "client appeared",
+  [LADISH_GRAPH_RECORD_CLIENT_RENAMED] = "client renamed",
+  [LADISH_GRAPH_RECORD_CLIENT_DISAPPEARED] = "client disappeared",
+  [LADISH_GRAPH_RECORD_PORT_APPEARED] = "port appeared",
+  [LADISH_GRAPH_RECORD_PORT_RENAMED] = "port renamed",
+  [LADISH_GRAPH_RECORD_PORT_DISAPPEARED] = "port disappeared",
+  [LADISH_GRAPH_RECORD_PORTS_CONNECTED] = "ports connected",
+  [LADISH_GRAPH_RECORD_PORTS_DISCONNECTED] = "ports disconnected",
+  [LADISH_GRAPH_RECORD_COMMAND] = "command",
+};
+
+/* decoded record, strings point into the record file buffer */
+struct replay_record
+{
+  unsigned int type;
+  uint64_t time;                /* microseconds since start of the recording */
+  uint64_t values[4];
+  char * strings[3];
+};
+
+struct replay_command
+{
+  char * name;
+  uint64_t time;                /* recorded start time */
+  uint64_t events;              /* graph event counter at start */
+  uint64_t usecs;               /* replay time counter at start */
+};
+
+static struct
+{
+  bool realtime;
+
+  /* record file */
+  unsigned char * buffer;
+  size_t size;
+  size_t offset;
+
+  struct replay_record * records;
+  size_t record_count;
+
+  ladish_virtualizer_handle virtualizer;
+  ladish_graph_handle * rooms;
+  unsigned int room_count;
+
+  struct replay_command * commands; /* commands that are running */
+  unsigned int command_count;
+
+  /* statistics */
+  uint64_t type_counts[RECORD_TYPE_MAX + 1];
+  uint64_t type_usecs[RECORD_TYPE_MAX + 1];
+  uint64_t events;              /* graph events */
+  uint64_t usecs;               /* time spent replaying graph events */
+  unsigned int sessions;
+} g_replay;
+
+/********************************************************************************/
+/* record file parsing */
+
+static bool read_uint(uint64_t * value_ptr)
+{
+  uint64_t value;
+  unsigned int shift;
+  unsigned char byte;
+
+  value = 0;
+  shift = 0;
+
+  do
+  {
+    if (g_replay.offset >= g_replay.size || shift > 63)
+    {
+      log_error("truncated or corrupt integer at offset %zu", g_replay.offset);
+      return false;
+    }
+
+    byte = g_replay.buffer[g_replay.offset++];
+    value |= (uint64_t)(byte & 0x7F) << shift;
+    shift += 7;
+  }
+  while ((byte & 0x80) != 0);
+
+  *value_ptr = value;
+  return true;
+}
+
+/* strings are made zero terminated in place by moving them one byte back, over their length */
+static bool read_string(char ** str_ptr)
+{
+  uint64_t len;
+  char * str;
+
+  if (!read_uint(&len))
+  {
+    return false;
+  }
+
+  if (len > g_replay.size - g_replay.offset)
+  {
+    log_error("truncated string at offset %zu", g_replay.offset);
+    return false;
+  }
+
+  str = (char *)g_replay.buffer + g_replay.offset - 1;
+  memmove(str, str + 1, len);
+  str[len] = 0;
+  g_replay.offset += len;
+
+  *str_ptr = str;
+  return true;
+}
+
+static bool read_uints(struct replay_record * record_ptr, unsigned int count)
+{
+  unsigned int i;
+
+  for (i = 0; i < count; i++)
+  {
+    if (!read_uint(record_ptr->values + i))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool read_strings(struct replay_record * record_ptr, unsigned int count)
+{
+  unsigned int i;
+
+  for (i = 0; i < count; i++)
+  {
+    if (!read_string(record_ptr->strings + i))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool read_record(struct replay_record * record_ptr, uint64_t * time_ptr)
+{
+  uint64_t delta;
+
+  memset(record_ptr, 0, sizeof(struct replay_record));
+
+  record_ptr->type = g_replay.buffer[g_replay.offset++];
+
+  if (!read_uint(&delta))
+  {
+    return false;
+  }
+
+  *time_ptr += delta;
+  record_ptr->time = *time_ptr;
+
+  switch (record_ptr->type)
+  {
+  case LADISH_GRAPH_RECORD_SESSION_BEGIN:
+  case LADISH_GRAPH_RECORD_SESSION_END:
+  case LADISH_GRAPH_RECORD_CLEAR:
+    return true;
+  case LADISH_GRAPH_RECORD_APP:
+    return read_uints(record_ptr, 1) && read_strings(record_ptr, 2);
+  case LADISH_GRAPH_RECORD_CLIENT_APPEARED:
+    return read_uints(record_ptr, 2) && read_strings(record_ptr, 1);
+  case LADISH_GRAPH_RECORD_CLIENT_RENAMED:
+    return read_uints(record_ptr, 1) && read_strings(record_ptr, 2);
+  case LADISH_GRAPH_RECORD_CLIENT_DISAPPEARED:
+    return read_uints(record_ptr, 1);
+  case LADISH_GRAPH_RECORD_PORT_APPEARED:
+    return read_uints(record_ptr, 3) && read_strings(record_ptr, 1);
+  case LADISH_GRAPH_RECORD_PORT_RENAMED:
+    return read_uints(record_ptr, 2) && read_strings(record_ptr, 2);
+  case LADISH_GRAPH_RECORD_PORT_DISAPPEARED:
+    return read_uints(record_ptr, 2);
+  case LADISH_GRAPH_RECORD_PORTS_CONNECTED:
+  case LADISH_GRAPH_RECORD_PORTS_DISCONNECTED:
+    return read_uints(record_ptr, 4);
+  case LADISH_GRAPH_RECORD_COMMAND:
+    return read_uints(record_ptr, 1) && read_strings(record_ptr, 1);
+  }
+
+  log_error("unknown record type %u at offset %zu", record_ptr->type, g_replay.offset - 1);
+  return false;
+}
+
+static bool load(const char * path)
+{
+  FILE * file;
+  long size;
+  uint64_t version;
+  uint64_t time;
+  size_t allocated;
+  struct replay_record * records;
+  bool ret;
+
+  ret = false;
+
+  file = fopen(path, "r");
+  if (file == NULL)
+  {
+    log_error("fopen(%s) failed: %d (%s)", path, errno, strerror(errno));
+    goto exit;
+  }
+
+  if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0)
+  {
+    log_error("cannot get size of '%s': %d (%s)", path, errno, strerror(errno));
+    goto close;
+  }
+
+  g_replay.size = size;
+  g_replay.buffer = malloc(g_replay.size + 1);
+  if (g_replay.buffer == NULL)
+  {
+    log_error("malloc() failed for %zu bytes", g_replay.size);
+    goto close;
+  }
+
+  if (fread(g_replay.buffer, 1, g_replay.size, file) != g_replay.size)
+  {
+    log_error("fread(%s) failed", path);
+    goto close;
+  }
+
+  if (g_replay.size < LADISH_GRAPH_RECORD_MAGIC_SIZE ||
+      memcmp(g_replay.buffer, LADISH_GRAPH_RECORD_MAGIC, LADISH_GRAPH_RECORD_MAGIC_SIZE) != 0)
+  {
+    log_error("'%s' is not a graph record file", path);
+    goto close;
+  }
+
+  g_replay.offset = LADISH_GRAPH_RECORD_MAGIC_SIZE;
+
+  if (!read_uint(&version) || !read_uint(&time))
+  {
+    goto close;
+  }
+
+  if (version != LADISH_GRAPH_RECORD_VERSION)
+  {
+    log_error("unsupported graph record version %"PRIu64, version);
+    goto close;
+  }
+
+  time = 0;
+  allocated = 0;
+
+  while (g_replay.offset < g_replay.size)
+  {
+    if (g_replay.record_count == allocated)
+    {
+      allocated = allocated == 0 ? 1024 : allocated * 2;
+      records = realloc(g_replay.records, allocated * sizeof(struct replay_record));
+      if (records == NULL)
+      {
+        log_error("realloc() failed for %zu records", allocated);
+        goto close;
+      }
+
+      g_replay.records = records;
+    }
+
+    if (!read_record(g_replay.records + g_replay.record_count, &time))
+    {
+      /* the daemon may have been killed while writing, replay what was read */
+      log_error("record %zu is truncated or corrupt, ignoring the rest of the file", g_replay.record_count);
+      break;
+    }
+
+    g_replay.record_count++;
+  }
+
+  ret = true;
+
+close:
+  fclose(file);
+exit:
+  return ret;
+}
+
+/********************************************************************************/
+/* replay */
+
+static
+bool
+set_graph_connection_handlers(
+  void * context,
+  ladish_graph_handle graph,
+  ladish_app_supervisor_handle UNUSED(app_supervisor))
+{
+  ladish_virtualizer_set_graph_connection_handlers(context, graph);
+  return true;                  /* iterate all vgraphs */
+}
+
+static void session_begin(void)
+{
+  if (g_replay.virtualizer != NULL)
+  {
+    log_error("session begins while previous one did not end");
+    return;
+  }
+
+  if (!ladish_virtualizer_create(mock_jack_get_graph_proxy(), g_studio.jack_graph, &g_replay.virtualizer))
+  {
+    log_error("ladish_virtualizer_create() failed.");
+    g_replay.virtualizer = NULL;
+    return;
+  }
+
+  ladish_studio_iterate_virtual_graphs(g_replay.virtualizer, set_graph_connection_handlers);
+  g_replay.sessions++;
+}
+
+static void session_end(void)
+{
+  if (g_replay.virtualizer == NULL)
+  {
+    return;
+  }
+
+  ladish_graph_hide_non_virtual(g_studio.jack_graph);
+  ladish_graph_hide_non_virtual(g_studio.studio_graph);
+  ladish_virtualizer_destroy(g_replay.virtualizer);
+  g_replay.virtualizer = NULL;
+  mock_jack_clear();
+}
+
+static ladish_graph_handle find_vgraph(const char * opath)
+{
+  unsigned int i;
+  ladish_graph_handle * rooms;
+
+  if (strcmp(opath, STUDIO_OPATH) == 0)
+  {
+    return g_studio.studio_graph;
+  }
+
+  for (i = 0; i < g_replay.room_count; i++)
+  {
+    if (strcmp(ladish_graph_get_opath(g_replay.rooms[i]), opath) == 0)
+    {
+      return g_replay.rooms[i];
+    }
+  }
+
+  rooms = realloc(g_replay.rooms, (g_replay.room_count + 1) * sizeof(ladish_graph_handle));
+  if (rooms == NULL)
+  {
+    log_error("realloc() failed for rooms");
+    return NULL;
+  }
+
+  g_replay.rooms = rooms;
+
+  if (!ladish_graph_create(rooms + g_replay.room_count, opath))
+  {
+    log_error("ladish_graph_create() failed for '%s'", opath);
+    return NULL;
+  }
+
+  mock_vgraph_add(rooms[g_replay.room_count]);
+  if (g_replay.virtualizer != NULL)
+  {
+    ladish_virtualizer_set_graph_connection_handlers(g_replay.virtualizer, rooms[g_replay.room_count]);
+  }
+
+  return rooms[g_replay.room_count++];
+}
+
+static void command_event(struct replay_record * record_ptr)
+{
+  unsigned int i;
+  struct replay_command * command_ptr;
+
+  if (record_ptr->values[0] == LADISH_GRAPH_RECORD_COMMAND_STARTED)
+  {
+    command_ptr = realloc(g_replay.commands, (g_replay.command_count + 1) * sizeof(struct replay_command));
+    if (command_ptr == NULL)
+    {
+      log_error("realloc() failed for commands");
+      return;
+    }
+
+    g_replay.commands = command_ptr;
+    command_ptr += g_replay.command_count++;
+    command_ptr->name = record_ptr->strings[0];
+    command_ptr->time = record_ptr->time;
+    command_ptr->events = g_replay.events;
+    command_ptr->usecs = g_replay.usecs;
+    return;
+  }
+
+  /* commands of different rooms can run in parallel, the last started one with this name completed */
+  for (i = g_replay.command_count; i > 0; i--)
+  {
+    command_ptr = g_replay.commands + i - 1;
+    if (strcmp(command_ptr->name, record_ptr->strings[0]) != 0)
+    {
+      continue;
+    }
+
+    printf(
+      "%10.3f  %-24s %-6s %10.3f ms recorded %8"PRIu64" events %10.3f ms replayed\n",
+      command_ptr->time / 1000000.0,
+      command_ptr->name,
+      record_ptr->values[0] == LADISH_GRAPH_RECORD_COMMAND_DONE ? "done" : "failed",
+      (record_ptr->time - command_ptr->time) / 1000.0,
+      g_replay.events - command_ptr->events,
+      (g_replay.usecs - command_ptr->usecs) / 1000.0);
+
+    memmove(command_ptr, command_ptr + 1, (g_replay.command_count - i) * sizeof(struct replay_command));
+    g_replay.command_count--;
+    return;
+  }
+
+  log_error("completion of command '%s' that did not start", record_ptr->strings[0]);
+}
+
+static void replay_record(struct replay_record * record_ptr)
+{
+  ladish_graph_handle vgraph;
+
+  switch (record_ptr->type)
+  {
+  case LADISH_GRAPH_RECORD_SESSION_BEGIN:
+    session_begin();
+    return;
+  case LADISH_GRAPH_RECORD_SESSION_END:
+    session_end();
+    return;
+  case LADISH_GRAPH_RECORD_CLEAR:
+    mock_jack_reset();
+    return;
+  case LADISH_GRAPH_RECORD_APP:
+    vgraph = find_vgraph(record_ptr->strings[1]);
+    if (vgraph != NULL)
+    {
+      mock_app_add(vgraph, record_ptr->strings[0], (pid_t)record_ptr->values[0]);
+    }
+    return;
+  case LADISH_GRAPH_RECORD_CLIENT_APPEARED:
+    mock_jack_client_appear_with_id(record_ptr->values[0], record_ptr->strings[0], (pid_t)record_ptr->values[1]);
+    return;
+  case LADISH_GRAPH_RECORD_CLIENT_RENAMED:
+    mock_jack_client_rename(record_ptr->values[0], record_ptr->strings[1]);
+    return;
+  case LADISH_GRAPH_RECORD_CLIENT_DISAPPEARED:
+    mock_jack_client_disappear(record_ptr->values[0]);
+    return;
+  case LADISH_GRAPH_RECORD_PORT_APPEARED:
+    mock_jack_port_appear_with_id(
+      record_ptr->values[0],
+      record_ptr->values[1],
+      record_ptr->strings[0],
+      (record_ptr->values[2] & LADISH_GRAPH_RECORD_PORT_INPUT) != 0,
+      (record_ptr->values[2] & LADISH_GRAPH_RECORD_PORT_TERMINAL) != 0,
+      (record_ptr->values[2] & LADISH_GRAPH_RECORD_PORT_MIDI) != 0);
+    return;
+  case LADISH_GRAPH_RECORD_PORT_RENAMED:
+    mock_jack_port_rename(record_ptr->values[1], record_ptr->strings[1]);
+    return;
+  case LADISH_GRAPH_RECORD_PORT_DISAPPEARED:
+    mock_jack_port_disappear(record_ptr->values[1]);
+    return;
+  case LADISH_GRAPH_RECORD_PORTS_CONNECTED:
+    mock_jack_connect(record_ptr->values[1], record_ptr->values[3]);
+    return;
+  case LADISH_GRAPH_RECORD_PORTS_DISCONNECTED:
+    mock_jack_disconnect(record_ptr->values[1], record_ptr->values[3]);
+    return;
+  case LADISH_GRAPH_RECORD_COMMAND:
+    command_event(record_ptr);
+    return;
+  }
+
+  ASSERT_NO_PASS;
+}
+
+static void replay(void)
+{
+  size_t i;
+  struct replay_record * record_ptr;
+  uint64_t start;
+  uint64_t begin;
+  uint64_t usecs;
+  uint64_t now;
+
+  start = ladish_get_current_microseconds();
+
+  for (i = 0; i < g_replay.record_count; i++)
+  {
+    record_ptr = g_replay.records + i;
+
+    if (g_replay.realtime)
+    {
+      now = ladish_get_current_microseconds();
+      if (start + record_ptr->time > now)
+      {
+        usleep(start + record_ptr->time - now);
+      }
+    }
+
+    begin = ladish_get_current_microseconds();
+    replay_record(record_ptr);
+    usecs = ladish_get_current_microseconds() - begin;
+
+    g_replay.type_counts[record_ptr->type]++;
+    g_replay.type_usecs[record_ptr->type] += usecs;
+
+    if (record_ptr->type != LADISH_GRAPH_RECORD_COMMAND)
+    {
+      g_replay.events++;
+      g_replay.usecs += usecs;
+    }
+  }
+
+  /* the daemon exited or was killed while JACK server was running */
+  session_end();
+}
+
+static void print_statistics(void)
+{
+  unsigned int type;
+
+  printf("\n%-20s %10s %12s\n", "event", "count", "usecs");
+
+  for (type = 1; type <= RECORD_TYPE_MAX; type++)
+  {
+    if (g_replay.type_counts[type] != 0)
+    {
+      printf("%-20s %10"PRIu64" %12"PRIu64"\n", g_record_type_names[type], g_replay.type_counts[type], g_replay.type_usecs[type]);
+    }
+  }
+
+  printf(
+    "\n%u sessions, %"PRIu64" graph events replayed in %.3f ms, %"PRIu64" allocations, %"PRIu64" D-Bus messages, %"PRIu64" JACK requests\n",
+    g_replay.sessions,
+    g_replay.events,
+    g_replay.usecs / 1000.0,
+    g_mock_counters.allocations,
+    g_mock_counters.dbus_messages,
+    g_mock_counters.jack_requests);
+
+  if (g_replay.records != NULL && g_replay.record_count != 0)
+  {
+    printf("recording spans %.3f s\n", g_replay.records[g_replay.record_count - 1].time / 1000000.0);
+  }
+}
+
+static void usage(const char * program)
+{
+  printf("Usage: %s [options] <record file>\n", program);
+  printf("  -r  replay with the recorded timing instead of as fast as possible\n");
+  printf("  -v  print errors logged by the daemon code\n");
+  printf("  -h  this help\n");
+}
+
+int main(int argc, char ** argv)
+{
+  int opt;
+  unsigned int i;
+  int ret;
+
+  while ((opt = getopt(argc, argv, "rvh")) != -1)
+  {
+    switch (opt)
+    {
+    case 'r':
+      g_replay.realtime = true;
+      break;
+    case 'v':
+      g_mock_verbose = true;
+      break;
+    case 'h':
+      usage(argv[0]);
+      return 0;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (optind + 1 != argc)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  ret = 1;
+
+  if (!load(argv[optind]))
+  {
+    fprintf(stderr, "loading of '%s' failed\n", argv[optind]);
+    goto free;
+  }
+
+  if (!ladish_graph_create(&g_studio.jack_graph, NULL))
+  {
+    fprintf(stderr, "ladish_graph_create() failed to create jack graph object.\n");
+    goto free;
+  }
+
+  if (!ladish_graph_create(&g_studio.studio_graph, STUDIO_OPATH))
+  {
+    fprintf(stderr, "ladish_graph_create() failed to create studio graph object.\n");
+    goto destroy_jack_graph;
+  }
+
+  mock_vgraph_add(g_studio.studio_graph);
+  mock_jack_set_passive(true);
+
+  printf("%zu records\n\n", g_replay.record_count);
+
+  replay();
+  print_statistics();
+
+  if (g_mock_counters.errors != 0)
+  {
+    fprintf(stderr, "%"PRIu64" errors were logged, use -v to see them\n", g_mock_counters.errors);
+  }
+
+  ret = g_mock_counters.errors != 0 ? 1 : 0;
+
+  for (i = 0; i < g_replay.room_count; i++)
+  {
+    ladish_graph_clear(g_replay.rooms[i], NULL);
+  }
+
+  ladish_graph_clear(g_studio.studio_graph, NULL);
+  ladish_graph_clear(g_studio.jack_graph, NULL);
+  mock_uninit();
+
+  for (i = 0; i < g_replay.room_count; i++)
+  {
+    ladish_graph_destroy(g_replay.rooms[i]);
+  }
+
+  ladish_graph_destroy(g_studio.studio_graph);
+destroy_jack_graph:
+  ladish_graph_destroy(g_studio.jack_graph);
+free:
+  free(g_replay.commands);
+  free(g_replay.rooms);
+  free(g_replay.records);
+  free(g_replay.buffer);
+  return ret;
+}
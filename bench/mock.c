@@ -0,0 +1,1109 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the mock JACK graph and of the stubs
+ * that replace the D-Bus services, used by the graph benchmark
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ * The daemon graph code is linked unmodified. Everything it calls outside of the
+ * graph, dict, client, port and virtualizer modules is stubbed here:
+ *
+ *  - graph_proxy is backed by an in-memory JACK graph, (dis)connect requests
+ *    complete immediately and are reported back like jackdbus signals do
+ *  - app supervisors only map pids to apps, one supervisor per virtual graph
+ *  - a2j, jmcore and alsapid are absent
+ *  - D-Bus messages are built by the real cdbus code but dbus_connection_send()
+ *    is wrapped at link time (-Wl,--wrap) so they are counted instead of sent
+ *  - log messages are dropped, formatting them would dominate the measurements
+ *  - heap allocations are counted by interposing malloc() and friends
+ */
+
+#include <stdarg.h>
+#include <dbus/dbus.h>
+
+#include "mock.h"
+#include "../daemon/studio_internal.h"
+#include "../daemon/procfs.h"
+#include "../proxies/a2j_proxy.h"
+#include "../proxies/jmcore_proxy.h"
+#include "../alsapid/alsapid.h"
+#include "../cdbus/helpers.h"
+
+struct mock_counters g_mock_counters;
+bool g_mock_verbose;
+
+/* globals that are defined in the daemon modules that are not linked */
+struct studio g_studio;
+uint64_t g_generation;
+DBusConnection * cdbus_g_dbus_connection;
+DBusError cdbus_g_dbus_error;
+
+/********************************************************************************/
+/* mock JACK server */
+
+struct mock_jack_port
+{
+  struct list_head siblings;
+  uint64_t id;
+  uint64_t client_id;
+  char * name;
+  bool is_input;
+  bool is_terminal;
+  bool is_midi;
+};
+
+struct mock_jack_client
+{
+  struct list_head siblings;
+  uint64_t id;
+  pid_t pid;
+  char * name;
+};
+
+struct mock_jack_connection
+{
+  struct list_head siblings;
+  struct mock_jack_port * port1_ptr; /* output */
+  struct mock_jack_port * port2_ptr; /* input */
+};
+
+struct mock_jack_request
+{
+  struct list_head siblings;
+  bool connect;
+  uint64_t port1_id;
+  uint64_t port2_id;
+  void * context;
+  void (* callback)(void * context, uint64_t port1_id, uint64_t port2_id, bool success);
+};
+
+static struct
+{
+  uint64_t next_id;
+  struct list_head clients;
+  struct list_head ports;
+  struct list_head connections;
+  struct list_head requests;    /* async requests that wait for graph_proxy_commit_requests() */
+  unsigned int connection_count;
+  bool passive;
+
+  void * context;
+  void (* clear)(void * context);
+  void (* client_appeared)(void * context, uint64_t id, const char * name);
+  void (* client_renamed)(void * context, uint64_t client_id, const char * old_client_name, const char * new_client_name);
+  void (* client_disappeared)(void * context, uint64_t id);
+  void (* port_appeared)(void * context, uint64_t client_id, uint64_t port_id, const char * port_name, bool is_input, bool is_terminal, bool is_midi);
+  void (* port_renamed)(void * context, uint64_t client_id, uint64_t port_id, const char * old_port_name, const char * new_port_name);
+  void (* port_disappeared)(void * context, uint64_t client_id, uint64_t port_id);
+  void (* ports_connected)(void * context, uint64_t client1_id, uint64_t port1_id, uint64_t client2_id, uint64_t port2_id);
+  void (* ports_disconnected)(void * context, uint64_t client1_id, uint64_t port1_id, uint64_t client2_id, uint64_t port2_id);
+} g_jack =
+{
+  .next_id = 1,
+  .clients = LIST_HEAD_INIT(g_jack.clients),
+  .ports = LIST_HEAD_INIT(g_jack.ports),
+  .connections = LIST_HEAD_INIT(g_jack.connections),
+  .requests = LIST_HEAD_INIT(g_jack.requests),
+};
+
+static struct mock_jack_client * mock_jack_find_client(uint64_t id)
+{
+  struct list_head * node_ptr;
+  struct mock_jack_client * client_ptr;
+
+  list_for_each(node_ptr, &g_jack.clients)
+  {
+    client_ptr = list_entry(node_ptr, struct mock_jack_client, siblings);
+    if (client_ptr->id == id)
+    {
+      return client_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+static struct mock_jack_port * mock_jack_find_port(uint64_t id)
+{
+  struct list_head * node_ptr;
+  struct mock_jack_port * port_ptr;
+
+  list_for_each(node_ptr, &g_jack.ports)
+  {
+    port_ptr = list_entry(node_ptr, struct mock_jack_port, siblings);
+    if (port_ptr->id == id)
+    {
+      return port_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+static struct mock_jack_connection * mock_jack_find_connection(struct mock_jack_port * port1_ptr, struct mock_jack_port * port2_ptr)
+{
+  struct list_head * node_ptr;
+  struct mock_jack_connection * connection_ptr;
+
+  list_for_each(node_ptr, &g_jack.connections)
+  {
+    connection_ptr = list_entry(node_ptr, struct mock_jack_connection, siblings);
+    if ((connection_ptr->port1_ptr == port1_ptr && connection_ptr->port2_ptr == port2_ptr) ||
+        (connection_ptr->port1_ptr == port2_ptr && connection_ptr->port2_ptr == port1_ptr))
+    {
+      return connection_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+static void mock_jack_remove_connection(struct mock_jack_connection * connection_ptr, bool notify)
+{
+  list_del(&connection_ptr->siblings);
+  g_jack.connection_count--;
+
+  if (notify && g_jack.ports_disconnected != NULL)
+  {
+    g_jack.ports_disconnected(
+      g_jack.context,
+      connection_ptr->port1_ptr->client_id,
+      connection_ptr->port1_ptr->id,
+      connection_ptr->port2_ptr->client_id,
+      connection_ptr->port2_ptr->id);
+  }
+
+  free(connection_ptr);
+}
+
+static void mock_jack_remove_port(struct mock_jack_port * port_ptr, bool notify)
+{
+  struct list_head * node_ptr;
+  struct list_head * next_ptr;
+  struct mock_jack_connection * connection_ptr;
+
+  list_for_each_safe(node_ptr, next_ptr, &g_jack.connections)
+  {
+    connection_ptr = list_entry(node_ptr, struct mock_jack_connection, siblings);
+    if (connection_ptr->port1_ptr == port_ptr || connection_ptr->port2_ptr == port_ptr)
+    {
+      mock_jack_remove_connection(connection_ptr, notify);
+    }
+  }
+
+  list_del(&port_ptr->siblings);
+
+  if (notify && g_jack.port_disappeared != NULL)
+  {
+    g_jack.port_disappeared(g_jack.context, port_ptr->client_id, port_ptr->id);
+  }
+
+  free(port_ptr->name);
+  free(port_ptr);
+}
+
+static bool mock_jack_connect_internal(uint64_t port1_id, uint64_t port2_id, bool connect)
+{
+  struct mock_jack_port * port1_ptr;
+  struct mock_jack_port * port2_ptr;
+  struct mock_jack_port * tmp_ptr;
+  struct mock_jack_connection * connection_ptr;
+
+  port1_ptr = mock_jack_find_port(port1_id);
+  port2_ptr = mock_jack_find_port(port2_id);
+  if (port1_ptr == NULL || port2_ptr == NULL || port1_ptr->is_input == port2_ptr->is_input || port1_ptr->is_midi != port2_ptr->is_midi)
+  {
+    return false;
+  }
+
+  if (port1_ptr->is_input)
+  {
+    tmp_ptr = port1_ptr;
+    port1_ptr = port2_ptr;
+    port2_ptr = tmp_ptr;
+  }
+
+  connection_ptr = mock_jack_find_connection(port1_ptr, port2_ptr);
+
+  if (!connect)
+  {
+    if (connection_ptr == NULL)
+    {
+      return false;
+    }
+
+    mock_jack_remove_connection(connection_ptr, true);
+    return true;
+  }
+
+  if (connection_ptr != NULL)
+  {
+    return false;
+  }
+
+  connection_ptr = malloc(sizeof(struct mock_jack_connection));
+  if (connection_ptr == NULL)
+  {
+    return false;
+  }
+
+  connection_ptr->port1_ptr = port1_ptr;
+  connection_ptr->port2_ptr = port2_ptr;
+  list_add_tail(&connection_ptr->siblings, &g_jack.connections);
+  g_jack.connection_count++;
+
+  if (g_jack.ports_connected != NULL)
+  {
+    g_jack.ports_connected(g_jack.context, port1_ptr->client_id, port1_ptr->id, port2_ptr->client_id, port2_ptr->id);
+  }
+
+  return true;
+}
+
+graph_proxy_handle mock_jack_get_graph_proxy(void)
+{
+  return (graph_proxy_handle)&g_jack;
+}
+
+bool mock_jack_client_appear_with_id(uint64_t client_id, const char * name, pid_t pid)
+{
+  struct mock_jack_client * client_ptr;
+
+  if (mock_jack_find_client(client_id) != NULL)
+  {
+    log_error("mock JACK client %"PRIu64" already exists", client_id);
+    return false;
+  }
+
+  client_ptr = malloc(sizeof(struct mock_jack_client));
+  if (client_ptr == NULL)
+  {
+    return false;
+  }
+
+  client_ptr->name = strdup(name);
+  if (client_ptr->name == NULL)
+  {
+    free(client_ptr);
+    return false;
+  }
+
+  client_ptr->id = client_id;
+  client_ptr->pid = pid;
+  list_add_tail(&client_ptr->siblings, &g_jack.clients);
+
+  if (client_id >= g_jack.next_id)
+  {
+    g_jack.next_id = client_id + 1;
+  }
+
+  if (g_jack.client_appeared != NULL)
+  {
+    g_jack.client_appeared(g_jack.context, client_ptr->id, client_ptr->name);
+  }
+
+  return true;
+}
+
+uint64_t mock_jack_client_appear(const char * name, pid_t pid)
+{
+  uint64_t client_id;
+
+  client_id = g_jack.next_id;
+  return mock_jack_client_appear_with_id(client_id, name, pid) ? client_id : 0;
+}
+
+bool
+mock_jack_port_appear_with_id(
+  uint64_t client_id,
+  uint64_t port_id,
+  const char * name,
+  bool is_input,
+  bool is_terminal,
+  bool is_midi)
+{
+  struct mock_jack_port * port_ptr;
+
+  if (mock_jack_find_client(client_id) == NULL)
+  {
+    log_error("mock JACK client %"PRIu64" of port %"PRIu64" does not exist", client_id, port_id);
+    return false;
+  }
+
+  if (mock_jack_find_port(port_id) != NULL)
+  {
+    log_error("mock JACK port %"PRIu64" already exists", port_id);
+    return false;
+  }
+
+  port_ptr = malloc(sizeof(struct mock_jack_port));
+  if (port_ptr == NULL)
+  {
+    return false;
+  }
+
+  port_ptr->name = strdup(name);
+  if (port_ptr->name == NULL)
+  {
+    free(port_ptr);
+    return false;
+  }
+
+  port_ptr->id = port_id;
+  port_ptr->client_id = client_id;
+  port_ptr->is_input = is_input;
+  port_ptr->is_terminal = is_terminal;
+  port_ptr->is_midi = is_midi;
+  list_add_tail(&port_ptr->siblings, &g_jack.ports);
+
+  if (port_id >= g_jack.next_id)
+  {
+    g_jack.next_id = port_id + 1;
+  }
+
+  if (g_jack.port_appeared != NULL)
+  {
+    g_jack.port_appeared(g_jack.context, client_id, port_ptr->id, port_ptr->name, is_input, is_terminal, is_midi);
+  }
+
+  return true;
+}
+
+uint64_t mock_jack_port_appear(uint64_t client_id, const char * name, bool is_input, bool is_midi)
+{
+  uint64_t port_id;
+
+  port_id = g_jack.next_id;
+  return mock_jack_port_appear_with_id(client_id, port_id, name, is_input, false, is_midi) ? port_id : 0;
+}
+
+void mock_jack_client_rename(uint64_t client_id, const char * name)
+{
+  struct mock_jack_client * client_ptr;
+  char * old_name;
+
+  client_ptr = mock_jack_find_client(client_id);
+  if (client_ptr == NULL)
+  {
+    log_error("cannot rename unknown mock JACK client %"PRIu64, client_id);
+    return;
+  }
+
+  old_name = client_ptr->name;
+  client_ptr->name = strdup(name);
+  if (client_ptr->name == NULL)
+  {
+    client_ptr->name = old_name;
+    return;
+  }
+
+  if (g_jack.client_renamed != NULL)
+  {
+    g_jack.client_renamed(g_jack.context, client_id, old_name, client_ptr->name);
+  }
+
+  free(old_name);
+}
+
+void mock_jack_port_rename(uint64_t port_id, const char * name)
+{
+  struct mock_jack_port * port_ptr;
+  char * old_name;
+
+  port_ptr = mock_jack_find_port(port_id);
+  if (port_ptr == NULL)
+  {
+    log_error("cannot rename unknown mock JACK port %"PRIu64, port_id);
+    return;
+  }
+
+  old_name = port_ptr->name;
+  port_ptr->name = strdup(name);
+  if (port_ptr->name == NULL)
+  {
+    port_ptr->name = old_name;
+    return;
+  }
+
+  if (g_jack.port_renamed != NULL)
+  {
+    g_jack.port_renamed(g_jack.context, port_ptr->client_id, port_id, old_name, port_ptr->name);
+  }
+
+  free(old_name);
+}
+
+void mock_jack_port_disappear(uint64_t port_id)
+{
+  struct mock_jack_port * port_ptr;
+
+  port_ptr = mock_jack_find_port(port_id);
+  if (port_ptr == NULL)
+  {
+    log_error("cannot remove unknown mock JACK port %"PRIu64, port_id);
+    return;
+  }
+
+  mock_jack_remove_port(port_ptr, true);
+}
+
+void mock_jack_client_disappear(uint64_t client_id)
+{
+  struct mock_jack_client * client_ptr;
+  struct list_head * node_ptr;
+  struct list_head * next_ptr;
+  struct mock_jack_port * port_ptr;
+
+  client_ptr = mock_jack_find_client(client_id);
+  if (client_ptr == NULL)
+  {
+    ASSERT_NO_PASS;
+    return;
+  }
+
+  list_for_each_safe(node_ptr, next_ptr, &g_jack.ports)
+  {
+    port_ptr = list_entry(node_ptr, struct mock_jack_port, siblings);
+    if (port_ptr->client_id == client_id)
+    {
+      mock_jack_remove_port(port_ptr, true);
+    }
+  }
+
+  list_del(&client_ptr->siblings);
+
+  if (g_jack.client_disappeared != NULL)
+  {
+    g_jack.client_disappeared(g_jack.context, client_id);
+  }
+
+  free(client_ptr->name);
+  free(client_ptr);
+}
+
+bool mock_jack_connect(uint64_t port1_id, uint64_t port2_id)
+{
+  return mock_jack_connect_internal(port1_id, port2_id, true);
+}
+
+bool mock_jack_disconnect(uint64_t port1_id, uint64_t port2_id)
+{
+  return mock_jack_connect_internal(port1_id, port2_id, false);
+}
+
+void mock_jack_set_passive(bool passive)
+{
+  g_jack.passive = passive;
+}
+
+unsigned int mock_jack_get_connection_count(void)
+{
+  return g_jack.connection_count;
+}
+
+void mock_jack_clear(void)
+{
+  struct mock_jack_client * client_ptr;
+
+  while (!list_empty(&g_jack.ports))
+  {
+    mock_jack_remove_port(list_entry(g_jack.ports.next, struct mock_jack_port, siblings), false);
+  }
+
+  while (!list_empty(&g_jack.clients))
+  {
+    client_ptr = list_entry(g_jack.clients.next, struct mock_jack_client, siblings);
+    list_del(&client_ptr->siblings);
+    free(client_ptr->name);
+    free(client_ptr);
+  }
+
+  ASSERT(list_empty(&g_jack.requests));
+  ASSERT(g_jack.connection_count == 0);
+}
+
+void mock_jack_reset(void)
+{
+  mock_jack_clear();
+
+  if (g_jack.clear != NULL)
+  {
+    g_jack.clear(g_jack.context);
+  }
+}
+
+/********************************************************************************/
+/* graph_proxy stubs */
+
+bool
+graph_proxy_attach(
+  graph_proxy_handle UNUSED(graph),
+  void * context,
+  void (* clear)(void * context),
+  void (* client_appeared)(void * context, uint64_t id, const char * name),
+  void (* client_renamed)(void * context, uint64_t client_id, const char * old_client_name, const char * new_client_name),
+  void (* client_disappeared)(void * context, uint64_t id),
+  void (* port_appeared)(void * context, uint64_t client_id, uint64_t port_id, const char * port_name, bool is_input, bool is_terminal, bool is_midi),
+  void (* port_renamed)(void * context, uint64_t client_id, uint64_t port_id, const char * old_port_name, const char * new_port_name),
+  void (* port_disappeared)(void * context, uint64_t client_id, uint64_t port_id),
+  void (* ports_connected)(void * context, uint64_t client1_id, uint64_t port1_id, uint64_t client2_id, uint64_t port2_id),
+  void (* ports_disconnected)(void * context, uint64_t client1_id, uint64_t port1_id, uint64_t client2_id, uint64_t port2_id))
+{
+  ASSERT(g_jack.context == NULL);
+
+  g_jack.context = context;
+  g_jack.clear = clear;
+  g_jack.client_appeared = client_appeared;
+  g_jack.client_renamed = client_renamed;
+  g_jack.client_disappeared = client_disappeared;
+  g_jack.port_appeared = port_appeared;
+  g_jack.port_renamed = port_renamed;
+  g_jack.port_disappeared = port_disappeared;
+  g_jack.ports_connected = ports_connected;
+  g_jack.ports_disconnected = ports_disconnected;
+
+  return true;
+}
+
+void graph_proxy_detach(graph_proxy_handle UNUSED(graph), void * context)
+{
+  ASSERT(g_jack.context == context);
+
+  g_jack.context = NULL;
+  g_jack.clear = NULL;
+  g_jack.client_appeared = NULL;
+  g_jack.client_renamed = NULL;
+  g_jack.client_disappeared = NULL;
+  g_jack.port_appeared = NULL;
+  g_jack.port_renamed = NULL;
+  g_jack.port_disappeared = NULL;
+  g_jack.ports_connected = NULL;
+  g_jack.ports_disconnected = NULL;
+}
+
+bool
+graph_proxy_replay_clients(
+  graph_proxy_handle UNUSED(graph),
+  void * context,
+  bool (* filter)(void * context, uint64_t client_id))
+{
+  struct list_head * node_ptr;
+  struct mock_jack_client * client_ptr;
+  struct mock_jack_port * port_ptr;
+  struct mock_jack_connection * connection_ptr;
+
+  ASSERT(g_jack.context == context);
+
+  list_for_each(node_ptr, &g_jack.clients)
+  {
+    client_ptr = list_entry(node_ptr, struct mock_jack_client, siblings);
+    if (filter(context, client_ptr->id))
+    {
+      g_jack.client_appeared(context, client_ptr->id, client_ptr->name);
+    }
+  }
+
+  list_for_each(node_ptr, &g_jack.ports)
+  {
+    port_ptr = list_entry(node_ptr, struct mock_jack_port, siblings);
+    if (filter(context, port_ptr->client_id))
+    {
+      g_jack.port_appeared(context, port_ptr->client_id, port_ptr->id, port_ptr->name, port_ptr->is_input, port_ptr->is_terminal, port_ptr->is_midi);
+    }
+  }
+
+  list_for_each(node_ptr, &g_jack.connections)
+  {
+    connection_ptr = list_entry(node_ptr, struct mock_jack_connection, siblings);
+    if (filter(context, connection_ptr->port1_ptr->client_id) || filter(context, connection_ptr->port2_ptr->client_id))
+    {
+      g_jack.ports_connected(
+        context,
+        connection_ptr->port1_ptr->client_id,
+        connection_ptr->port1_ptr->id,
+        connection_ptr->port2_ptr->client_id,
+        connection_ptr->port2_ptr->id);
+    }
+  }
+
+  return true;
+}
+
+bool graph_proxy_get_client_pid(graph_proxy_handle UNUSED(graph), uint64_t client_id, pid_t * pid_ptr)
+{
+  struct mock_jack_client * client_ptr;
+
+  client_ptr = mock_jack_find_client(client_id);
+  if (client_ptr == NULL)
+  {
+    return false;
+  }
+
+  *pid_ptr = client_ptr->pid;
+  return true;
+}
+
+bool graph_proxy_connect_ports(graph_proxy_handle UNUSED(graph), uint64_t port1_id, uint64_t port2_id)
+{
+  g_mock_counters.jack_requests++;
+  return g_jack.passive || mock_jack_connect_internal(port1_id, port2_id, true);
+}
+
+bool graph_proxy_disconnect_ports(graph_proxy_handle UNUSED(graph), uint64_t port1_id, uint64_t port2_id)
+{
+  g_mock_counters.jack_requests++;
+  return g_jack.passive || mock_jack_connect_internal(port1_id, port2_id, false);
+}
+
+static
+bool
+mock_jack_queue_request(
+  bool connect,
+  uint64_t port1_id,
+  uint64_t port2_id,
+  void * context,
+  void (* callback)(void * context, uint64_t port1_id, uint64_t port2_id, bool success))
+{
+  struct mock_jack_request * request_ptr;
+
+  request_ptr = malloc(sizeof(struct mock_jack_request));
+  if (request_ptr == NULL)
+  {
+    return false;
+  }
+
+  request_ptr->connect = connect;
+  request_ptr->port1_id = port1_id;
+  request_ptr->port2_id = port2_id;
+  request_ptr->context = context;
+  request_ptr->callback = callback;
+  list_add_tail(&request_ptr->siblings, &g_jack.requests);
+
+  g_mock_counters.jack_requests++;
+  return true;
+}
+
+bool
+graph_proxy_connect_ports_async(
+  graph_proxy_handle UNUSED(graph),
+  uint64_t port1_id,
+  uint64_t port2_id,
+  void * context,
+  void (* callback)(void * context, uint64_t port1_id, uint64_t port2_id, bool success))
+{
+  return mock_jack_queue_request(true, port1_id, port2_id, context, callback);
+}
+
+bool
+graph_proxy_disconnect_ports_async(
+  graph_proxy_handle UNUSED(graph),
+  uint64_t port1_id,
+  uint64_t port2_id,
+  void * context,
+  void (* callback)(void * context, uint64_t port1_id, uint64_t port2_id, bool success))
+{
+  return mock_jack_queue_request(false, port1_id, port2_id, context, callback);
+}
+
+void graph_proxy_commit_requests(graph_proxy_handle UNUSED(graph))
+{
+  struct mock_jack_request * request_ptr;
+  bool success;
+
+  while (!list_empty(&g_jack.requests))
+  {
+    request_ptr = list_entry(g_jack.requests.next, struct mock_jack_request, siblings);
+    list_del(&request_ptr->siblings);
+
+    success = g_jack.passive || mock_jack_connect_internal(request_ptr->port1_id, request_ptr->port2_id, request_ptr->connect);
+    if (request_ptr->callback != NULL)
+    {
+      request_ptr->callback(request_ptr->context, request_ptr->port1_id, request_ptr->port2_id, success);
+    }
+
+    free(request_ptr);
+  }
+}
+
+/********************************************************************************/
+/* mock app supervisors */
+
+struct mock_app
+{
+  struct list_head siblings;
+  char * name;
+  uuid_t uuid;
+  pid_t pid;
+};
+
+struct mock_vgraph
+{
+  struct list_head siblings;
+  ladish_graph_handle graph;
+  struct list_head apps;
+};
+
+static LIST_HEAD(g_vgraphs);
+
+#define supervisor_ptr ((struct mock_vgraph *)supervisor_handle)
+#define app_ptr ((struct mock_app *)app_handle)
+
+static struct mock_vgraph * mock_vgraph_find(ladish_graph_handle graph)
+{
+  struct list_head * node_ptr;
+  struct mock_vgraph * vgraph_ptr;
+
+  list_for_each(node_ptr, &g_vgraphs)
+  {
+    vgraph_ptr = list_entry(node_ptr, struct mock_vgraph, siblings);
+    if (vgraph_ptr->graph == graph)
+    {
+      return vgraph_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+void mock_vgraph_add(ladish_graph_handle graph)
+{
+  struct mock_vgraph * vgraph_ptr;
+
+  vgraph_ptr = malloc(sizeof(struct mock_vgraph));
+  if (vgraph_ptr == NULL)
+  {
+    log_error("malloc() failed for struct mock_vgraph");
+    return;
+  }
+
+  vgraph_ptr->graph = graph;
+  INIT_LIST_HEAD(&vgraph_ptr->apps);
+  list_add_tail(&vgraph_ptr->siblings, &g_vgraphs);
+}
+
+void mock_vgraph_remove(ladish_graph_handle graph)
+{
+  struct mock_vgraph * vgraph_ptr;
+  struct mock_app * mock_app_ptr;
+
+  vgraph_ptr = mock_vgraph_find(graph);
+  if (vgraph_ptr == NULL)
+  {
+    ASSERT_NO_PASS;
+    return;
+  }
+
+  while (!list_empty(&vgraph_ptr->apps))
+  {
+    mock_app_ptr = list_entry(vgraph_ptr->apps.next, struct mock_app, siblings);
+    list_del(&mock_app_ptr->siblings);
+    free(mock_app_ptr->name);
+    free(mock_app_ptr);
+  }
+
+  list_del(&vgraph_ptr->siblings);
+  free(vgraph_ptr);
+}
+
+ladish_app_handle mock_app_add(ladish_graph_handle graph, const char * name, pid_t pid)
+{
+  struct mock_vgraph * vgraph_ptr;
+  struct list_head * node_ptr;
+  struct mock_app * mock_app_ptr;
+
+  vgraph_ptr = mock_vgraph_find(graph);
+  if (vgraph_ptr == NULL)
+  {
+    ASSERT_NO_PASS;
+    return NULL;
+  }
+
+  list_for_each(node_ptr, &vgraph_ptr->apps)
+  {
+    mock_app_ptr = list_entry(node_ptr, struct mock_app, siblings);
+    if (strcmp(mock_app_ptr->name, name) == 0)
+    {
+      mock_app_ptr->pid = pid;
+      return (ladish_app_handle)mock_app_ptr;
+    }
+  }
+
+  mock_app_ptr = malloc(sizeof(struct mock_app));
+  if (mock_app_ptr == NULL)
+  {
+    return NULL;
+  }
+
+  mock_app_ptr->name = strdup(name);
+  if (mock_app_ptr->name == NULL)
+  {
+    free(mock_app_ptr);
+    return NULL;
+  }
+
+  uuid_generate(mock_app_ptr->uuid);
+  mock_app_ptr->pid = pid;
+  list_add_tail(&mock_app_ptr->siblings, &vgraph_ptr->apps);
+
+  return (ladish_app_handle)mock_app_ptr;
+}
+
+void mock_uninit(void)
+{
+  mock_jack_clear();
+
+  while (!list_empty(&g_vgraphs))
+  {
+    mock_vgraph_remove(list_entry(g_vgraphs.next, struct mock_vgraph, siblings)->graph);
+  }
+}
+
+bool
+ladish_studio_iterate_virtual_graphs(
+  void * context,
+  bool (* callback)(
+    void * context,
+    ladish_graph_handle graph,
+    ladish_app_supervisor_handle app_supervisor))
+{
+  struct list_head * node_ptr;
+  struct mock_vgraph * vgraph_ptr;
+
+  list_for_each(node_ptr, &g_vgraphs)
+  {
+    vgraph_ptr = list_entry(node_ptr, struct mock_vgraph, siblings);
+    if (!callback(context, vgraph_ptr->graph, (ladish_app_supervisor_handle)vgraph_ptr))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+ladish_app_supervisor_handle ladish_studio_find_app_supervisor(const char * opath)
+{
+  struct list_head * node_ptr;
+  struct mock_vgraph * vgraph_ptr;
+
+  list_for_each(node_ptr, &g_vgraphs)
+  {
+    vgraph_ptr = list_entry(node_ptr, struct mock_vgraph, siblings);
+    if (strcmp(ladish_graph_get_opath(vgraph_ptr->graph), opath) == 0)
+    {
+      return (ladish_app_supervisor_handle)vgraph_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+ladish_app_handle ladish_app_supervisor_find_app_by_pid(ladish_app_supervisor_handle supervisor_handle, pid_t pid)
+{
+  struct list_head * node_ptr;
+  struct mock_app * mock_app_ptr;
+
+  list_for_each(node_ptr, &supervisor_ptr->apps)
+  {
+    mock_app_ptr = list_entry(node_ptr, struct mock_app, siblings);
+    if (mock_app_ptr->pid == pid)
+    {
+      return (ladish_app_handle)mock_app_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+ladish_app_handle ladish_app_supervisor_find_app_by_uuid(ladish_app_supervisor_handle supervisor_handle, const uuid_t uuid)
+{
+  struct list_head * node_ptr;
+  struct mock_app * mock_app_ptr;
+
+  list_for_each(node_ptr, &supervisor_ptr->apps)
+  {
+    mock_app_ptr = list_entry(node_ptr, struct mock_app, siblings);
+    if (uuid_compare(mock_app_ptr->uuid, uuid) == 0)
+    {
+      return (ladish_app_handle)mock_app_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+ladish_app_handle ladish_studio_find_app_by_uuid(const uuid_t app_uuid)
+{
+  struct list_head * node_ptr;
+  ladish_app_handle app;
+
+  list_for_each(node_ptr, &g_vgraphs)
+  {
+    app = ladish_app_supervisor_find_app_by_uuid((ladish_app_supervisor_handle)list_entry(node_ptr, struct mock_vgraph, siblings), app_uuid);
+    if (app != NULL)
+    {
+      return app;
+    }
+  }
+
+  return NULL;
+}
+
+const char * ladish_app_get_name(ladish_app_handle app_handle)
+{
+  return app_ptr->name;
+}
+
+void ladish_app_get_uuid(ladish_app_handle app_handle, uuid_t uuid)
+{
+  uuid_copy(uuid, app_ptr->uuid);
+}
+
+void ladish_app_add_pid(ladish_app_handle UNUSED(app_handle), pid_t UNUSED(pid))
+{
+}
+
+void ladish_app_del_pid(ladish_app_handle UNUSED(app_handle), pid_t UNUSED(pid))
+{
+}
+
+#undef app_ptr
+#undef supervisor_ptr
+
+/********************************************************************************/
+/* absent services */
+
+unsigned long long procfs_get_process_parent(unsigned long long UNUSED(pid))
+{
+  return 0;
+}
+
+const char * a2j_proxy_get_jack_client_name_cached(void)
+{
+  return NULL;
+}
+
+bool
+a2j_proxy_map_jack_port(
+    const char * UNUSED(jack_port_name),
+    char ** UNUSED(alsa_client_name_ptr_ptr),
+    char ** UNUSED(alsa_port_name_ptr_ptr),
+    uint32_t * UNUSED(alsa_client_id_ptr))
+{
+  return false;
+}
+
+int64_t jmcore_proxy_get_pid_cached(void)
+{
+  return 0;
+}
+
+bool alsapid_get_pid(int UNUSED(alsa_client_id), pid_t * UNUSED(pid_ptr))
+{
+  return false;
+}
+
+/********************************************************************************/
+/* allocation counting */
+
+extern void * __libc_malloc(size_t size);
+extern void * __libc_calloc(size_t nmemb, size_t size);
+extern void * __libc_realloc(void * ptr, size_t size);
+extern void __libc_free(void * ptr);
+
+LADISH_PUBLIC void * malloc(size_t size)
+{
+  g_mock_counters.allocations++;
+  return __libc_malloc(size);
+}
+
+LADISH_PUBLIC void * calloc(size_t nmemb, size_t size)
+{
+  g_mock_counters.allocations++;
+  return __libc_calloc(nmemb, size);
+}
+
+LADISH_PUBLIC void * realloc(void * ptr, size_t size)
+{
+  if (ptr == NULL)
+  {
+    g_mock_counters.allocations++;
+  }
+
+  return __libc_realloc(ptr, size);
+}
+
+LADISH_PUBLIC void free(void * ptr)
+{
+  __libc_free(ptr);
+}
+
+/********************************************************************************/
+/* D-Bus and log */
+
+dbus_bool_t __wrap_dbus_connection_send(DBusConnection * connection, DBusMessage * message, dbus_uint32_t * serial);
+void __wrap_dbus_connection_flush(DBusConnection * connection);
+
+dbus_bool_t
+__wrap_dbus_connection_send(
+  DBusConnection * UNUSED(connection),
+  DBusMessage * UNUSED(message),
+  dbus_uint32_t * UNUSED(serial))
+{
+  g_mock_counters.dbus_messages++;
+  return TRUE;
+}
+
+void __wrap_dbus_connection_flush(DBusConnection * UNUSED(connection))
+{
+}
+
+void
+ladish_log(
+  unsigned int level,
+  const char * file,
+  unsigned int line,
+  const char * func,
+  const char * format,
+  ...)
+{
+  va_list ap;
+
+  if (level < LADISH_LOG_LEVEL_ERROR)
+  {
+    return;
+  }
+
+  g_mock_counters.errors++;
+
+  if (!g_mock_verbose)
+  {
+    return;
+  }
+
+  fprintf(stderr, "%s:%u %s: ", file, line, func);
+  va_start(ap, format);
+  vfprintf(stderr, format, ap);
+  va_end(ap);
+  fputc('\n', stderr);
+}
@@ -0,0 +1,80 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains interface to the mock JACK graph and app supervisors
+ * used by the graph benchmark
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MOCK_H__9E1F4C2B_6A3D_4B8E_A0C5_7D2E91F3B864__INCLUDED
+#define MOCK_H__9E1F4C2B_6A3D_4B8E_A0C5_7D2E91F3B864__INCLUDED
+
+#include "../common.h"
+#include "../proxies/graph_proxy.h"
+#include "../daemon/graph.h"
+#include "../daemon/app_supervisor.h"
+
+/* Counters of the stubbed D-Bus and log layers */
+struct mock_counters
+{
+  uint64_t dbus_messages;       /* messages that would be sent on the bus */
+  uint64_t jack_requests;       /* (dis)connect requests sent to the mock JACK server */
+  uint64_t errors;              /* log_error() calls */
+  uint64_t allocations;         /* malloc(), calloc() and realloc(NULL) calls */
+};
+
+extern struct mock_counters g_mock_counters;
+extern bool g_mock_verbose;     /* print errors logged by the daemon code */
+
+/* The mock JACK server. There is only one, graph_proxy_create() is not stubbed,
+ * mock_jack_get_graph_proxy() returns the handle the virtualizer should be created with.
+ * Changes are reported synchronously to the attached virtualizer, like jackdbus signals. */
+graph_proxy_handle mock_jack_get_graph_proxy(void);
+uint64_t mock_jack_client_appear(const char * name, pid_t pid);
+uint64_t mock_jack_port_appear(uint64_t client_id, const char * name, bool is_input, bool is_midi);
+void mock_jack_client_disappear(uint64_t client_id);
+bool mock_jack_connect(uint64_t port1_id, uint64_t port2_id);
+unsigned int mock_jack_get_connection_count(void);
+/* forget all objects without notifying, as when JACK server is stopped */
+void mock_jack_clear(void);
+
+/* Variants used for replaying recorded sessions, object ids are the recorded ones */
+bool mock_jack_client_appear_with_id(uint64_t client_id, const char * name, pid_t pid);
+bool mock_jack_port_appear_with_id(uint64_t client_id, uint64_t port_id, const char * name, bool is_input, bool is_terminal, bool is_midi);
+void mock_jack_client_rename(uint64_t client_id, const char * name);
+void mock_jack_port_rename(uint64_t port_id, const char * name);
+void mock_jack_port_disappear(uint64_t port_id);
+bool mock_jack_disconnect(uint64_t port1_id, uint64_t port2_id);
+/* mock_jack_clear() and notify the virtualizer that the graph was cleared */
+void mock_jack_reset(void);
+/* When passive, (dis)connect requests succeed without changing the mock graph,
+ * the connection changes are expected to come from the replayed session */
+void mock_jack_set_passive(bool passive);
+
+/* Mock app supervisors, one per virtual graph */
+void mock_vgraph_add(ladish_graph_handle graph);
+void mock_vgraph_remove(ladish_graph_handle graph);
+/* An app with same name in the graph is reused, its pid is updated */
+ladish_app_handle mock_app_add(ladish_graph_handle graph, const char * name, pid_t pid);
+void mock_uninit(void);
+
+#endif /* #ifndef MOCK_H__9E1F4C2B_6A3D_4B8E_A0C5_7D2E91F3B864__INCLUDED */
@@ -0,0 +1,118 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the name hash used for D-Bus dispatch
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "../common.h"
+#include "hash.h"
+
+uint32_t cdbus_hash_string(uint32_t hash, const char * str)
+{
+  while (*str != 0)
+  {
+    hash ^= (unsigned char)*str++;
+    hash *= 16777619u;          /* FNV prime */
+  }
+
+  return hash;
+}
+
+bool cdbus_hash_init(struct cdbus_hash * hash_ptr, size_t count)
+{
+  uint32_t size;
+
+  /* keep the load factor at most 1/2 so lookup of missing keys stops early */
+  size = 4;
+  while (size < count * 2)
+  {
+    size *= 2;
+  }
+
+  hash_ptr->entries = calloc(size, sizeof(struct cdbus_hash_entry));
+  if (hash_ptr->entries == NULL)
+  {
+    log_error("calloc() failed to allocate hash of %u entries", (unsigned int)size);
+    return false;
+  }
+
+  hash_ptr->mask = size - 1;
+  return true;
+}
+
+void cdbus_hash_uninit(struct cdbus_hash * hash_ptr)
+{
+  free(hash_ptr->entries);
+  hash_ptr->entries = NULL;
+}
+
+void cdbus_hash_insert(struct cdbus_hash * hash_ptr, const char * key, const void * value)
+{
+  uint32_t hash;
+  uint32_t index;
+  struct cdbus_hash_entry * entry_ptr;
+
+  hash = cdbus_hash_string(CDBUS_HASH_INIT, key);
+
+  for (index = hash & hash_ptr->mask; ; index = (index + 1) & hash_ptr->mask)
+  {
+    entry_ptr = hash_ptr->entries + index;
+
+    if (entry_ptr->key == NULL)
+    {
+      entry_ptr->hash = hash;
+      entry_ptr->key = key;
+      entry_ptr->value = value;
+      return;
+    }
+
+    if (entry_ptr->hash == hash && strcmp(entry_ptr->key, key) == 0)
+    {
+      return;
+    }
+  }
+}
+
+const void * cdbus_hash_lookup(const struct cdbus_hash * hash_ptr, const char * key)
+{
+  uint32_t hash;
+  uint32_t index;
+  const struct cdbus_hash_entry * entry_ptr;
+
+  hash = cdbus_hash_string(CDBUS_HASH_INIT, key);
+
+  for (index = hash & hash_ptr->mask; ; index = (index + 1) & hash_ptr->mask)
+  {
+    entry_ptr = hash_ptr->entries + index;
+
+    if (entry_ptr->key == NULL)
+    {
+      return NULL;
+    }
+
+    if (entry_ptr->hash == hash && strcmp(entry_ptr->key, key) == 0)
+    {
+      return entry_ptr->value;
+    }
+  }
+}
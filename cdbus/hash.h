@@ -0,0 +1,58 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains interface of the name hash used for D-Bus dispatch
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __CDBUS_HASH_H__
+#define __CDBUS_HASH_H__
+
+#define CDBUS_HASH_INIT ((uint32_t)2166136261u) /* FNV-1a offset basis */
+
+struct cdbus_hash_entry
+{
+  uint32_t hash;
+  const char * key;
+  const void * value;
+};
+
+/* Open addressing hash of names. Keys are not copied, they must outlive the hash.
+ * The table does not grow, at most count keys, as supplied to cdbus_hash_init(), can be inserted. */
+struct cdbus_hash
+{
+  struct cdbus_hash_entry * entries;
+  uint32_t mask;
+};
+
+/* Continue FNV-1a hash of the string, start with CDBUS_HASH_INIT */
+uint32_t cdbus_hash_string(uint32_t hash, const char * str);
+
+bool cdbus_hash_init(struct cdbus_hash * hash_ptr, size_t count);
+void cdbus_hash_uninit(struct cdbus_hash * hash_ptr);
+
+/* When same key is inserted twice, lookup returns the value of the first insert */
+void cdbus_hash_insert(struct cdbus_hash * hash_ptr, const char * key, const void * value);
+
+const void * cdbus_hash_lookup(const struct cdbus_hash * hash_ptr, const char * key);
+
+#endif /* __CDBUS_HASH_H__ */
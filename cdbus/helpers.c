@@ -36,6 +36,8 @@
 #include "method.h"
 #include "../common.h"
 #include "../common/klist.h"
+#include "hash.h"
+#include "stats.h"
 
 /* D-Bus versions earlier than 1.4.12 dont define DBUS_TIMEOUT_INFINITE */
 #if !defined(DBUS_TIMEOUT_INFINITE)
@@ -54,8 +56,10 @@ struct cdbus_signal_hook_descriptor
   struct list_head siblings;
   char * object;
   char * interface;
+  uint32_t hash;                /* hash of object and interface */
   void * hook_context;
   const struct cdbus_signal_hook * signal_hooks;
+  struct cdbus_hash signals;    /* signal hooks by signal name */
 };
 
 struct cdbus_service_descriptor
@@ -381,17 +385,26 @@ cdbus_call_raw(
   DBusMessage * request_ptr)
 {
   DBusMessage * reply_ptr;
+  uint64_t start;
 
   if (timeout == 0)
   {
     timeout = DBUS_CALL_DEFAULT_TIMEOUT;
   }
 
+  start = cdbus_stats_now();
+
   reply_ptr = dbus_connection_send_with_reply_and_block(
     cdbus_g_dbus_connection,
     request_ptr,
     timeout,
     &cdbus_g_dbus_error);
+
+  cdbus_stats_call_completed(
+    dbus_message_get_destination(request_ptr),
+    dbus_message_get_interface(request_ptr),
+    dbus_message_get_member(request_ptr),
+    cdbus_stats_now() - start);
   if (reply_ptr == NULL)
   {
     cdbus_call_last_error_set();
@@ -608,6 +621,7 @@ static void cdbus_async_call_reply_context_free(void * user_data)
 
 bool
 cdbus_call_async(
+  unsigned int timeout,
   DBusMessage * request_ptr,
   void * context,
   void * cookie,
@@ -620,7 +634,7 @@ cdbus_call_async(
 
   ret = false;
 
-  if (!dbus_connection_send_with_reply(cdbus_g_dbus_connection, request_ptr, &pending_call_ptr, DBUS_TIMEOUT_INFINITE))
+  if (!dbus_connection_send_with_reply(cdbus_g_dbus_connection, request_ptr, &pending_call_ptr, timeout != 0 ? (int)timeout : DBUS_TIMEOUT_INFINITE))
   {
     log_error("dbus_connection_send_with_reply() failed.");
     goto exit;
@@ -660,6 +674,260 @@ exit:
   return ret;
 }
 
+/*
+ * Call groups. Requests are sent as soon as they are added to a group,
+ * without waiting for replies of the already sent ones. The replies are
+ * then either waited for at once (cdbus_call_group_wait) or delivered
+ * from the main loop (cdbus_call_group_complete_async).
+ */
+
+struct cdbus_call_group_entry
+{
+  struct list_head siblings;
+  struct cdbus_call_group * owner_ptr;
+  DBusPendingCall * pending_call_ptr;
+  const char * output_signature;
+  void * context;
+  void (* callback)(void * context, void * cookie, DBusMessage * reply_ptr);
+  dbus_uint64_t cookie[0];
+};
+
+struct cdbus_call_group
+{
+  struct list_head entries;     /* in order of sending */
+  int timeout;
+  unsigned int pending;         /* number of calls that are not complete yet */
+  unsigned int failed;          /* number of calls that failed */
+  void * context;
+  void (* completion_callback)(void * context, unsigned int failed);
+};
+
+static void cdbus_call_group_free(struct cdbus_call_group * group_ptr)
+{
+  struct cdbus_call_group_entry * entry_ptr;
+
+  while (!list_empty(&group_ptr->entries))
+  {
+    entry_ptr = list_entry(group_ptr->entries.next, struct cdbus_call_group_entry, siblings);
+    list_del(&entry_ptr->siblings);
+
+    if (entry_ptr->pending_call_ptr != NULL)
+    {
+      dbus_pending_call_cancel(entry_ptr->pending_call_ptr);
+      dbus_pending_call_unref(entry_ptr->pending_call_ptr);
+    }
+
+    free(entry_ptr);
+  }
+
+  free(group_ptr);
+}
+
+#define entry_ptr ((struct cdbus_call_group_entry *)user_data)
+
+static void cdbus_call_group_reply_handler(DBusPendingCall * pending_call_ptr, void * user_data)
+{
+  struct cdbus_call_group * group_ptr;
+  DBusMessage * reply_ptr;
+  const char * reply_signature;
+  bool success;
+
+  group_ptr = entry_ptr->owner_ptr;
+
+  ASSERT(entry_ptr->pending_call_ptr == pending_call_ptr);
+  reply_ptr = dbus_pending_call_steal_reply(pending_call_ptr);
+  dbus_pending_call_unref(pending_call_ptr);
+  entry_ptr->pending_call_ptr = NULL;
+
+  ASSERT(group_ptr->pending > 0);
+  group_ptr->pending--;
+
+  success = false;
+
+  if (reply_ptr == NULL)
+  {
+    log_error("pending call notify called but reply is NULL");
+  }
+  else if (dbus_set_error_from_message(&cdbus_g_dbus_error, reply_ptr))
+  {
+    /* error aggregation, the first error of the group is kept as the last call error */
+    if (group_ptr->failed == 0)
+    {
+      cdbus_call_last_error_set();
+    }
+
+    dbus_error_free(&cdbus_g_dbus_error);
+  }
+  else if (entry_ptr->output_signature != NULL &&
+           strcmp((reply_signature = dbus_message_get_signature(reply_ptr)), entry_ptr->output_signature) != 0)
+  {
+    log_error("reply signature is '%s' but expected signature is '%s'", reply_signature, entry_ptr->output_signature);
+  }
+  else
+  {
+    success = true;
+  }
+
+  if (!success)
+  {
+    group_ptr->failed++;
+  }
+
+  if (entry_ptr->callback != NULL)
+  {
+    entry_ptr->callback(entry_ptr->context, entry_ptr->cookie, success ? reply_ptr : NULL);
+  }
+
+  if (reply_ptr != NULL)
+  {
+    dbus_message_unref(reply_ptr);
+  }
+
+  if (group_ptr->pending == 0 && group_ptr->completion_callback != NULL)
+  {
+    group_ptr->completion_callback(group_ptr->context, group_ptr->failed);
+    cdbus_call_group_free(group_ptr);
+  }
+}
+
+#undef entry_ptr
+
+#define group_ptr ((struct cdbus_call_group *)group)
+
+bool cdbus_call_group_create(unsigned int timeout, cdbus_call_group_handle * group_handle_ptr)
+{
+  struct cdbus_call_group * group;
+
+  group = malloc(sizeof(struct cdbus_call_group));
+  if (group == NULL)
+  {
+    log_error("malloc() failed to allocate struct cdbus_call_group");
+    return false;
+  }
+
+  INIT_LIST_HEAD(&group->entries);
+  group->timeout = timeout != 0 ? (int)timeout : DBUS_CALL_DEFAULT_TIMEOUT;
+  group->pending = 0;
+  group->failed = 0;
+  group->context = NULL;
+  group->completion_callback = NULL;
+
+  *group_handle_ptr = (cdbus_call_group_handle)group;
+  return true;
+}
+
+bool
+cdbus_call_group_add(
+  cdbus_call_group_handle group,
+  DBusMessage * request_ptr,
+  const char * output_signature,
+  void * context,
+  void * cookie,
+  size_t cookie_size,
+  void (* callback)(void * context, void * cookie, DBusMessage * reply_ptr))
+{
+  struct cdbus_call_group_entry * entry_ptr;
+
+  ASSERT(group_ptr->completion_callback == NULL); /* cannot add calls after the group is sealed */
+
+  entry_ptr = malloc(sizeof(struct cdbus_call_group_entry) + cookie_size);
+  if (entry_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate cdbus_call_group_entry struct with cookie size of %zu", cookie_size);
+    return false;
+  }
+
+  entry_ptr->owner_ptr = group_ptr;
+  entry_ptr->output_signature = output_signature;
+  entry_ptr->context = context;
+  entry_ptr->callback = callback;
+  if (cookie_size > 0)
+  {
+    memcpy(entry_ptr->cookie, cookie, cookie_size);
+  }
+
+  if (!dbus_connection_send_with_reply(cdbus_g_dbus_connection, request_ptr, &entry_ptr->pending_call_ptr, group_ptr->timeout) ||
+      entry_ptr->pending_call_ptr == NULL)
+  {
+    log_error("dbus_connection_send_with_reply() failed.");
+    free(entry_ptr);
+    return false;
+  }
+
+  /* the notify function may get called from within dbus_pending_call_set_notify() */
+  list_add_tail(&entry_ptr->siblings, &group_ptr->entries);
+  group_ptr->pending++;
+
+  if (!dbus_pending_call_set_notify(entry_ptr->pending_call_ptr, cdbus_call_group_reply_handler, entry_ptr, NULL))
+  {
+    log_error("dbus_pending_call_set_notify() failed.");
+    list_del(&entry_ptr->siblings);
+    group_ptr->pending--;
+    dbus_pending_call_cancel(entry_ptr->pending_call_ptr);
+    dbus_pending_call_unref(entry_ptr->pending_call_ptr);
+    free(entry_ptr);
+    return false;
+  }
+
+  return true;
+}
+
+bool cdbus_call_group_wait(cdbus_call_group_handle group)
+{
+  struct list_head * node_ptr;
+  struct cdbus_call_group_entry * entry_ptr;
+
+  ASSERT(group_ptr->completion_callback == NULL);
+
+  /* Wait in the order of sending. Blocking on pending call does not dispatch
+     other messages but completes the pending call, thus calling the reply handler */
+  list_for_each(node_ptr, &group_ptr->entries)
+  {
+    entry_ptr = list_entry(node_ptr, struct cdbus_call_group_entry, siblings);
+    if (entry_ptr->pending_call_ptr != NULL)
+    {
+      dbus_pending_call_block(entry_ptr->pending_call_ptr);
+    }
+  }
+
+  ASSERT(group_ptr->pending == 0);
+
+  return group_ptr->failed == 0;
+}
+
+unsigned int cdbus_call_group_get_failed_count(cdbus_call_group_handle group)
+{
+  return group_ptr->failed;
+}
+
+void
+cdbus_call_group_complete_async(
+  cdbus_call_group_handle group,
+  void * context,
+  void (* completion_callback)(void * context, unsigned int failed))
+{
+  ASSERT(completion_callback != NULL);
+  ASSERT(group_ptr->completion_callback == NULL);
+
+  if (group_ptr->pending == 0)
+  {
+    completion_callback(context, group_ptr->failed);
+    cdbus_call_group_free(group_ptr);
+    return;
+  }
+
+  group_ptr->context = context;
+  group_ptr->completion_callback = completion_callback;
+}
+
+void cdbus_call_group_destroy(cdbus_call_group_handle group)
+{
+  ASSERT(group_ptr->completion_callback == NULL); /* async groups are destroyed automatically */
+  cdbus_call_group_free(group_ptr);
+}
+
+#undef group_ptr
+
 static
 const char *
 cdbus_compose_signal_match(
@@ -745,11 +1013,15 @@ find_signal_hook_descriptor(
 {
   struct list_head * node_ptr;
   struct cdbus_signal_hook_descriptor * hook_ptr;
+  uint32_t hash;
+
+  hash = cdbus_hash_string(cdbus_hash_string(CDBUS_HASH_INIT, object), interface);
 
   list_for_each(node_ptr, &service_ptr->hooks)
   {
     hook_ptr = list_entry(node_ptr, struct cdbus_signal_hook_descriptor, siblings);
-    if (strcmp(hook_ptr->object, object) == 0 &&
+    if (hook_ptr->hash == hash &&
+        strcmp(hook_ptr->object, object) == 0 &&
         strcmp(hook_ptr->interface, interface) == 0)
     {
       return hook_ptr;
@@ -853,13 +1125,11 @@ cdbus_signal_handler(
     hook_ptr = find_signal_hook_descriptor(service_ptr, object_path, interface);
     if (hook_ptr != NULL)
     {
-      for (signal_ptr = hook_ptr->signal_hooks; signal_ptr->signal_name != NULL; signal_ptr++)
+      signal_ptr = cdbus_hash_lookup(&hook_ptr->signals, signal_name);
+      if (signal_ptr != NULL)
       {
-        if (strcmp(signal_name, signal_ptr->signal_name) == 0)
-        {
-          signal_ptr->hook_function(hook_ptr->hook_context, message_ptr);
-          return DBUS_HANDLER_RESULT_HANDLED;
-        }
+        signal_ptr->hook_function(hook_ptr->hook_context, message_ptr);
+        return DBUS_HANDLER_RESULT_HANDLED;
       }
     }
   }
@@ -953,6 +1223,7 @@ cdbus_register_object_signal_hooks(
   struct cdbus_service_descriptor * service_ptr;
   struct cdbus_signal_hook_descriptor * hook_ptr;
   const struct cdbus_signal_hook * signal_ptr;
+  size_t count;
 
   if (connection != cdbus_g_dbus_connection)
   {
@@ -997,9 +1268,26 @@ cdbus_register_object_signal_hooks(
     goto free_object_name;
   }
 
+  hook_ptr->hash = cdbus_hash_string(cdbus_hash_string(CDBUS_HASH_INIT, object), iface);
   hook_ptr->hook_context = hook_context;
   hook_ptr->signal_hooks = signal_hooks;
 
+  count = 0;
+  for (signal_ptr = signal_hooks; signal_ptr->signal_name != NULL; signal_ptr++)
+  {
+    count++;
+  }
+
+  if (!cdbus_hash_init(&hook_ptr->signals, count))
+  {
+    goto free_interface_name;
+  }
+
+  for (signal_ptr = signal_hooks; signal_ptr->signal_name != NULL; signal_ptr++)
+  {
+    cdbus_hash_insert(&hook_ptr->signals, signal_ptr->signal_name, signal_ptr);
+  }
+
   list_add_tail(&hook_ptr->siblings, &service_ptr->hooks);
 
   for (signal_ptr = signal_hooks; signal_ptr->signal_name != NULL; signal_ptr++)
@@ -1031,6 +1319,8 @@ cdbus_register_object_signal_hooks(
 
 remove_hook:
   list_del(&hook_ptr->siblings);
+  cdbus_hash_uninit(&hook_ptr->signals);
+free_interface_name:
   free(hook_ptr->interface);
 free_object_name:
   free(hook_ptr->object);
@@ -1091,6 +1381,7 @@ cdbus_unregister_object_signal_hooks(
 
   list_del(&hook_ptr->siblings);
 
+  cdbus_hash_uninit(&hook_ptr->signals);
   free(hook_ptr->interface);
   free(hook_ptr->object);
   free(hook_ptr);
@@ -60,12 +60,91 @@ cdbus_call(
 
 bool
 cdbus_call_async(
+  unsigned int timeout,         /* in milliseconds, zero for no timeout */
   DBusMessage * request_ptr,
   void * context,
   void * cookie,
   size_t cookie_size,
   void (* callback)(void * context, void * cookie, DBusMessage * reply_ptr));
 
+typedef struct cdbus_call_group_tag { int unused; } * cdbus_call_group_handle;
+
+/**
+ * Create group of pipelined calls
+ *
+ * @param[in] timeout Timeout for each of the calls, in milliseconds. Zero for default timeout.
+ * @param[out] group_handle_ptr Pointer to variable that will receive the group handle
+ *
+ * @return success status
+ */
+bool cdbus_call_group_create(unsigned int timeout, cdbus_call_group_handle * group_handle_ptr);
+
+/**
+ * Send a call as part of group. The call is sent immediately, without waiting for replies of other calls.
+ *
+ * @param[in] group Group handle
+ * @param[in] request_ptr The request message, still owned by caller
+ * @param[in] output_signature Expected reply signature or NULL to skip the check. The string must outlive the call.
+ * @param[in] context User defined context to be supplied to the callback
+ * @param[in] cookie Pointer to data that is copied and supplied to the callback
+ * @param[in] cookie_size Size of the cookie data
+ * @param[in] callback Function to call when the call is complete, can be NULL.
+ *                     Reply is NULL when call failed (error reply, timeout or signature mismatch).
+ *
+ * @return success status
+ */
+bool
+cdbus_call_group_add(
+  cdbus_call_group_handle group,
+  DBusMessage * request_ptr,
+  const char * output_signature,
+  void * context,
+  void * cookie,
+  size_t cookie_size,
+  void (* callback)(void * context, void * cookie, DBusMessage * reply_ptr));
+
+/**
+ * Block until all calls of the group complete. Other messages are not dispatched meanwhile.
+ * The per-call callbacks are called in order of sending.
+ * When some of calls failed, the error of the first failed one can be obtained through cdbus_call_last_error_*()
+ *
+ * @param[in] group Group handle
+ *
+ * @return whether all calls succeeded
+ */
+bool cdbus_call_group_wait(cdbus_call_group_handle group);
+
+/**
+ * Get number of failed calls in group
+ *
+ * @param[in] group Group handle
+ *
+ * @return number of failed calls
+ */
+unsigned int cdbus_call_group_get_failed_count(cdbus_call_group_handle group);
+
+/**
+ * Seal the group and let the calls complete from the main loop.
+ * The completion callback is called once all calls are complete, and then the group is destroyed.
+ * It may be called before this function returns, if all calls are already complete.
+ *
+ * @param[in] group Group handle
+ * @param[in] context User defined context to be supplied to the completion callback
+ * @param[in] completion_callback Function to call when all calls are complete
+ */
+void
+cdbus_call_group_complete_async(
+  cdbus_call_group_handle group,
+  void * context,
+  void (* completion_callback)(void * context, unsigned int failed));
+
+/**
+ * Destroy group, cancelling calls that are not complete yet.
+ *
+ * @param[in] group Group handle
+ */
+void cdbus_call_group_destroy(cdbus_call_group_handle group);
+
 DBusMessage *
 cdbus_new_method_call_message(
   const char * service,
@@ -31,10 +31,36 @@
 #include "helpers.h"
 #include <string.h>
 
+/*
+ * Execute a method's function. The method must be one of the interface methods.
+ */
+void
+cdbus_interface_call_method(
+  const struct cdbus_interface_descriptor * iface_ptr,
+  const struct cdbus_method_descriptor * method_ptr,
+  struct cdbus_method_call * call_ptr)
+{
+  call_ptr->iface = iface_ptr;
+  method_ptr->handler(call_ptr);
+  /* If the method handler didn't construct a return message create a void one here */
+  // TODO: Also handle cases where the sender doesn't need a reply
+  if (call_ptr->reply == NULL)
+  {
+    call_ptr->reply = dbus_message_new_method_return(call_ptr->message);
+    if (call_ptr->reply == NULL)
+    {
+      log_error("Failed to construct void method return");
+    }
+  }
+}
+
 /*
  * Execute a method's function if the method specified in the method call
  * object exists in the method array. Return true if the method was found,
  * false otherwise.
+ *
+ * Object paths don't call this for interfaces that use it as handler,
+ * they look the methods up in hashes that are built when the object path is created.
  */
 bool cdbus_interface_default_handler(const struct cdbus_interface_descriptor * iface_ptr, struct cdbus_method_call * call_ptr)
 {
@@ -44,18 +70,7 @@ bool cdbus_interface_default_handler(const struct cdbus_interface_descriptor * i
   {
     if (strcmp(call_ptr->method_name, method_ptr->name) == 0)
     {
-      call_ptr->iface = iface_ptr;
-      method_ptr->handler(call_ptr);
-      /* If the method handler didn't construct a return message create a void one here */
-      // TODO: Also handle cases where the sender doesn't need a reply
-      if (call_ptr->reply == NULL)
-      {
-        call_ptr->reply = dbus_message_new_method_return(call_ptr->message);
-        if (call_ptr->reply == NULL)
-        {
-          log_error("Failed to construct void method return");
-        }
-      }
+      cdbus_interface_call_method(iface_ptr, method_ptr, call_ptr);
 
       /* Known method */
       return true;
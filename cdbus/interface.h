@@ -42,6 +42,12 @@ struct cdbus_interface_descriptor
 
 bool cdbus_interface_default_handler(const struct cdbus_interface_descriptor * interface, struct cdbus_method_call * call_ptr);
 
+void
+cdbus_interface_call_method(
+  const struct cdbus_interface_descriptor * interface,
+  const struct cdbus_method_descriptor * method,
+  struct cdbus_method_call * call_ptr);
+
 #define CDBUS_INTERFACE_BEGIN(iface_var, iface_name) \
 const struct cdbus_interface_descriptor iface_var =  \
 {                                                    \
@@ -29,11 +29,21 @@
 
 #include "../common.h"
 #include "helpers.h"
+#include "hash.h"
+#include "stats.h"
+
+struct cdbus_object_path_method
+{
+  const struct cdbus_method_descriptor * descriptor;
+  struct cdbus_stats_entry * stats;
+};
 
 struct cdbus_object_path_interface
 {
   const struct cdbus_interface_descriptor * iface;
   void * iface_context;
+  struct cdbus_object_path_method * methods_array;
+  struct cdbus_hash methods;    /* methods_array items by name, entries are NULL if interface has custom handler */
 };
 
 struct cdbus_object_path
@@ -41,6 +51,7 @@ struct cdbus_object_path
   char * name;
   DBusMessage * introspection;
   struct cdbus_object_path_interface * ifaces;
+  struct cdbus_hash ifaces_hash; /* struct cdbus_object_path_interface pointers by interface name */
   bool registered;
 };
 
@@ -219,6 +230,115 @@ CDBUS_INTERFACE_BEGIN(g_dbus_interface_dtor_introspectable, "org.freedesktop.DBu
   CDBUS_INTERFACE_EXPOSE_METHODS
 CDBUS_INTERFACE_END
 
+static void cdbus_object_path_uninit_hashes(struct cdbus_object_path * opath_ptr)
+{
+  struct cdbus_object_path_interface * iface_ptr;
+
+  for (iface_ptr = opath_ptr->ifaces; iface_ptr->iface != NULL; iface_ptr++)
+  {
+    cdbus_hash_uninit(&iface_ptr->methods);
+    free(iface_ptr->methods_array);
+  }
+
+  cdbus_hash_uninit(&opath_ptr->ifaces_hash);
+}
+
+/* Build the interface and method hashes, so dispatch cost does not depend on the number of interfaces and methods */
+static bool cdbus_object_path_init_hashes(struct cdbus_object_path * opath_ptr, size_t ifaces_count)
+{
+  struct cdbus_object_path_interface * iface_ptr;
+  const struct cdbus_method_descriptor * method_ptr;
+  struct cdbus_object_path_method * item_ptr;
+  size_t count;
+
+  for (iface_ptr = opath_ptr->ifaces; iface_ptr->iface != NULL; iface_ptr++)
+  {
+    iface_ptr->methods_array = NULL;
+    iface_ptr->methods.entries = NULL;
+  }
+
+  if (!cdbus_hash_init(&opath_ptr->ifaces_hash, ifaces_count))
+  {
+    return false;
+  }
+
+  for (iface_ptr = opath_ptr->ifaces; iface_ptr->iface != NULL; iface_ptr++)
+  {
+    cdbus_hash_insert(&opath_ptr->ifaces_hash, iface_ptr->iface->name, iface_ptr);
+
+    if (iface_ptr->iface->handler != cdbus_interface_default_handler || iface_ptr->iface->methods == NULL)
+    {
+      continue;
+    }
+
+    count = 0;
+    for (method_ptr = iface_ptr->iface->methods; method_ptr->name != NULL; method_ptr++)
+    {
+      count++;
+    }
+
+    iface_ptr->methods_array = malloc(count * sizeof(struct cdbus_object_path_method));
+    if (iface_ptr->methods_array == NULL)
+    {
+      log_error("malloc() failed to allocate methods array");
+      cdbus_object_path_uninit_hashes(opath_ptr);
+      return false;
+    }
+
+    if (!cdbus_hash_init(&iface_ptr->methods, count))
+    {
+      cdbus_object_path_uninit_hashes(opath_ptr);
+      return false;
+    }
+
+    item_ptr = iface_ptr->methods_array;
+    for (method_ptr = iface_ptr->iface->methods; method_ptr->name != NULL; method_ptr++)
+    {
+      item_ptr->descriptor = method_ptr;
+      item_ptr->stats = cdbus_stats_get_method(iface_ptr->iface->name, method_ptr->name);
+      cdbus_hash_insert(&iface_ptr->methods, method_ptr->name, item_ptr);
+      item_ptr++;
+    }
+  }
+
+  return true;
+}
+
+/* Return true if the method is known to the interface */
+static bool cdbus_object_path_dispatch(const struct cdbus_object_path_interface * iface_ptr, struct cdbus_method_call * call_ptr)
+{
+  const struct cdbus_object_path_method * method_ptr;
+  uint64_t start;
+
+  call_ptr->iface_context = iface_ptr->iface_context;
+
+  if (iface_ptr->methods.entries == NULL)
+  {
+    if (iface_ptr->iface->methods == NULL && iface_ptr->iface->handler == cdbus_interface_default_handler)
+    {
+      /* signals only interface */
+      return false;
+    }
+
+    return iface_ptr->iface->handler(iface_ptr->iface, call_ptr);
+  }
+
+  method_ptr = cdbus_hash_lookup(&iface_ptr->methods, call_ptr->method_name);
+  if (method_ptr == NULL)
+  {
+    return false;
+  }
+
+  start = cdbus_stats_now();
+  cdbus_interface_call_method(iface_ptr->iface, method_ptr->descriptor, call_ptr);
+  if (method_ptr->stats != NULL)
+  {
+    cdbus_stats_method_handled(method_ptr->stats, cdbus_stats_now() - start);
+  }
+
+  return true;
+}
+
 cdbus_object_path cdbus_object_path_new(const char *name, const struct cdbus_interface_descriptor * iface1_ptr, ...)
 {
   struct cdbus_object_path * opath_ptr;
@@ -289,10 +409,17 @@ cdbus_object_path cdbus_object_path_new(const char *name, const struct cdbus_int
   iface_dst_ptr++;
   iface_dst_ptr->iface = NULL;
 
+  if (!cdbus_object_path_init_hashes(opath_ptr, iface_dst_ptr - opath_ptr->ifaces))
+  {
+    goto destroy_introspection;
+  }
+
   opath_ptr->registered = false;
 
   return (cdbus_object_path)opath_ptr;
 
+destroy_introspection:
+  cdbus_introspection_destroy(opath_ptr);
 free_ifaces:
   free(opath_ptr->ifaces);
 free_name:
@@ -324,6 +451,7 @@ void cdbus_object_path_destroy(DBusConnection * connection_ptr, cdbus_object_pat
     log_error("dbus_connection_unregister_object_path() failed.");
   }
 
+  cdbus_object_path_uninit_hashes(opath_ptr);
   cdbus_introspection_destroy(opath_ptr);
   free(opath_ptr->ifaces);
   free(opath_ptr->name);
@@ -360,19 +488,10 @@ static DBusHandlerResult cdbus_object_path_handler(DBusConnection * connection,
   iface_name = dbus_message_get_interface(message);
   if (iface_name != NULL)
   {
-    for (iface_ptr = opath_ptr->ifaces; iface_ptr->iface != NULL; iface_ptr++)
+    iface_ptr = cdbus_hash_lookup(&opath_ptr->ifaces_hash, iface_name);
+    if (iface_ptr != NULL && cdbus_object_path_dispatch(iface_ptr, &call))
     {
-      if (strcmp(iface_name, iface_ptr->iface->name) == 0)
-      {
-        call.iface_context = iface_ptr->iface_context;
-        if (!iface_ptr->iface->handler(iface_ptr->iface, &call))
-        {
-          /* unknown method */
-          break;
-        }
-
-        goto send_return;
-      }
+      goto send_return;
     }
   }
   else
@@ -387,8 +506,7 @@ static DBusHandlerResult cdbus_object_path_handler(DBusConnection * connection,
      */
     for (iface_ptr = opath_ptr->ifaces; iface_ptr->iface != NULL; iface_ptr++)
     {
-      call.iface_context = iface_ptr->iface_context;
-      if (!iface_ptr->iface->handler(iface_ptr->iface, &call))
+      if (cdbus_object_path_dispatch(iface_ptr, &call))
       {
         /* known method */
         goto send_return;
@@ -30,6 +30,7 @@
 #include "../common.h"
 #include <stdarg.h>
 #include "helpers.h"
+#include "stats.h"
 
 void cdbus_signal_send(DBusConnection * connection_ptr, DBusMessage * message_ptr)
 {
@@ -59,6 +60,8 @@ cdbus_signal_emit(
 
   log_debug("Sending signal %s.%s from %s", interface, name, path);
 
+  cdbus_stats_signal_emitted(interface, name);
+
   va_start(ap, signature);
 
   ASSERT(signature != NULL);
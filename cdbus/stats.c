@@ -0,0 +1,360 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the D-Bus call statistics
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Three sets of statistics are kept:
+ *  - handled methods: count, total and max handler time, per interface and method
+ *  - outgoing blocking calls: count, total and max time and a latency histogram,
+ *    per destination and method; calls to unique names (":1.42") are keyed by
+ *    interface instead, so short lived peers do not add an entry each
+ *  - emitted signals: count, per interface and signal
+ *
+ * They are exposed through the IFACE_STATS interface (stats_iface.c) and cdbus_stats_dump().
+ * Entries are never freed before cdbus_stats_uninit() because object paths cache method entries.
+ * Each set keeps its entries in creation order for iteration and in hash buckets for lookup.
+ */
+
+#include <time.h>
+
+#include "../common.h"
+#include "helpers.h"
+#include "hash.h"
+#include "stats.h"
+
+#define CDBUS_STATS_HASH_SIZE 64
+
+struct cdbus_stats_entry
+{
+  struct list_head siblings;
+  struct list_head hash_siblings;
+  uint32_t hash;
+  char * name1;                 /* interface or destination */
+  char * name2;                 /* method or signal */
+  uint64_t count;
+  uint64_t total_usecs;
+  uint64_t max_usecs;
+  uint64_t histogram[CDBUS_STATS_HISTOGRAM_BUCKETS];
+};
+
+struct cdbus_stats_set
+{
+  struct list_head entries;
+  struct list_head hash[CDBUS_STATS_HASH_SIZE];
+  bool hash_initialized;        /* buckets are initialized on first use */
+};
+
+static struct cdbus_stats_set g_methods = {.entries = LIST_HEAD_INIT(g_methods.entries)};
+static struct cdbus_stats_set g_calls = {.entries = LIST_HEAD_INIT(g_calls.entries)};
+static struct cdbus_stats_set g_signals = {.entries = LIST_HEAD_INIT(g_signals.entries)};
+
+uint64_t cdbus_stats_now(void)
+{
+  struct timespec time;
+
+  /* monotonic, so durations are not skewed when the wall clock is adjusted */
+  if (clock_gettime(CLOCK_MONOTONIC, &time) != 0)
+  {
+    return 0;
+  }
+
+  return (uint64_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+static struct cdbus_stats_entry * cdbus_stats_find_or_create(struct cdbus_stats_set * set_ptr, const char * name1, const char * name2)
+{
+  struct list_head * bucket_ptr;
+  struct list_head * node_ptr;
+  struct cdbus_stats_entry * entry_ptr;
+  uint32_t hash;
+  unsigned int i;
+
+  if (!set_ptr->hash_initialized)
+  {
+    for (i = 0; i < CDBUS_STATS_HASH_SIZE; i++)
+    {
+      INIT_LIST_HEAD(set_ptr->hash + i);
+    }
+
+    set_ptr->hash_initialized = true;
+  }
+
+  hash = cdbus_hash_string(cdbus_hash_string(CDBUS_HASH_INIT, name1), name2);
+  bucket_ptr = set_ptr->hash + hash % CDBUS_STATS_HASH_SIZE;
+
+  list_for_each(node_ptr, bucket_ptr)
+  {
+    entry_ptr = list_entry(node_ptr, struct cdbus_stats_entry, hash_siblings);
+    if (entry_ptr->hash == hash &&
+        strcmp(entry_ptr->name1, name1) == 0 &&
+        strcmp(entry_ptr->name2, name2) == 0)
+    {
+      return entry_ptr;
+    }
+  }
+
+  entry_ptr = calloc(1, sizeof(struct cdbus_stats_entry));
+  if (entry_ptr == NULL)
+  {
+    log_error("calloc() failed to allocate struct cdbus_stats_entry");
+    goto fail;
+  }
+
+  entry_ptr->name1 = strdup(name1);
+  if (entry_ptr->name1 == NULL)
+  {
+    log_error("strdup() failed for stats entry name");
+    goto free;
+  }
+
+  entry_ptr->name2 = strdup(name2);
+  if (entry_ptr->name2 == NULL)
+  {
+    log_error("strdup() failed for stats entry name");
+    goto free_name1;
+  }
+
+  entry_ptr->hash = hash;
+  list_add_tail(&entry_ptr->siblings, &set_ptr->entries);
+  list_add_tail(&entry_ptr->hash_siblings, bucket_ptr);
+  return entry_ptr;
+
+free_name1:
+  free(entry_ptr->name1);
+free:
+  free(entry_ptr);
+fail:
+  return NULL;
+}
+
+static void cdbus_stats_add(struct cdbus_stats_entry * entry_ptr, uint64_t usecs)
+{
+  unsigned int bucket;
+  uint64_t limit;
+
+  entry_ptr->count++;
+  entry_ptr->total_usecs += usecs;
+  if (usecs > entry_ptr->max_usecs)
+  {
+    entry_ptr->max_usecs = usecs;
+  }
+
+  for (bucket = 0, limit = 100; bucket < CDBUS_STATS_HISTOGRAM_BUCKETS - 1 && usecs >= limit; bucket++, limit *= 10);
+  entry_ptr->histogram[bucket]++;
+}
+
+struct cdbus_stats_entry * cdbus_stats_get_method(const char * iface, const char * method)
+{
+  return cdbus_stats_find_or_create(&g_methods, iface, method);
+}
+
+void cdbus_stats_method_handled(struct cdbus_stats_entry * entry_ptr, uint64_t usecs)
+{
+  cdbus_stats_add(entry_ptr, usecs);
+}
+
+void cdbus_stats_call_completed(const char * destination, const char * iface, const char * method, uint64_t usecs)
+{
+  struct cdbus_stats_entry * entry_ptr;
+
+  if (destination == NULL || destination[0] == ':')
+  {
+    destination = iface;
+  }
+
+  entry_ptr = cdbus_stats_find_or_create(&g_calls, destination != NULL ? destination : "", method != NULL ? method : "");
+  if (entry_ptr != NULL)
+  {
+    cdbus_stats_add(entry_ptr, usecs);
+  }
+}
+
+void cdbus_stats_signal_emitted(const char * iface, const char * signal)
+{
+  struct cdbus_stats_entry * entry_ptr;
+
+  entry_ptr = cdbus_stats_find_or_create(&g_signals, iface, signal);
+  if (entry_ptr != NULL)
+  {
+    entry_ptr->count++;
+  }
+}
+
+bool
+cdbus_stats_iterate(
+  unsigned int set,
+  void * context,
+  bool (* callback)(void * context, const struct cdbus_stats_values * values_ptr))
+{
+  struct list_head * list_ptr;
+  struct list_head * node_ptr;
+  struct cdbus_stats_entry * entry_ptr;
+  struct cdbus_stats_values values;
+  unsigned int i;
+
+  switch (set)
+  {
+  case CDBUS_STATS_SET_METHODS:
+    list_ptr = &g_methods.entries;
+    break;
+  case CDBUS_STATS_SET_CALLS:
+    list_ptr = &g_calls.entries;
+    break;
+  case CDBUS_STATS_SET_SIGNALS:
+    list_ptr = &g_signals.entries;
+    break;
+  default:
+    ASSERT_NO_PASS;
+    return false;
+  }
+
+  list_for_each(node_ptr, list_ptr)
+  {
+    entry_ptr = list_entry(node_ptr, struct cdbus_stats_entry, siblings);
+
+    values.name1 = entry_ptr->name1;
+    values.name2 = entry_ptr->name2;
+    values.count = entry_ptr->count;
+    values.total_usecs = entry_ptr->total_usecs;
+    values.max_usecs = entry_ptr->max_usecs;
+    for (i = 0; i < CDBUS_STATS_HISTOGRAM_BUCKETS; i++)
+    {
+      values.histogram[i] = entry_ptr->histogram[i];
+    }
+
+    if (!callback(context, &values))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void cdbus_stats_dump(void)
+{
+  struct list_head * node_ptr;
+  struct cdbus_stats_entry * entry_ptr;
+
+  log_info("D-Bus handled methods (count, total ms, max ms):");
+  list_for_each(node_ptr, &g_methods.entries)
+  {
+    entry_ptr = list_entry(node_ptr, struct cdbus_stats_entry, siblings);
+    if (entry_ptr->count == 0)
+    {
+      continue;
+    }
+
+    log_info(
+      "  %s.%s %"PRIu64" %.3f %.3f",
+      entry_ptr->name1,
+      entry_ptr->name2,
+      entry_ptr->count,
+      entry_ptr->total_usecs / 1000.0,
+      entry_ptr->max_usecs / 1000.0);
+  }
+
+  log_info("D-Bus outgoing calls (count, total ms, max ms, <100us <1ms <10ms <100ms <1s >=1s):");
+  list_for_each(node_ptr, &g_calls.entries)
+  {
+    entry_ptr = list_entry(node_ptr, struct cdbus_stats_entry, siblings);
+    if (entry_ptr->count == 0)
+    {
+      continue;
+    }
+
+    log_info(
+      "  %s %s %"PRIu64" %.3f %.3f %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64" %"PRIu64,
+      entry_ptr->name1,
+      entry_ptr->name2,
+      entry_ptr->count,
+      entry_ptr->total_usecs / 1000.0,
+      entry_ptr->max_usecs / 1000.0,
+      entry_ptr->histogram[0],
+      entry_ptr->histogram[1],
+      entry_ptr->histogram[2],
+      entry_ptr->histogram[3],
+      entry_ptr->histogram[4],
+      entry_ptr->histogram[5]);
+  }
+
+  log_info("D-Bus emitted signals (count):");
+  list_for_each(node_ptr, &g_signals.entries)
+  {
+    entry_ptr = list_entry(node_ptr, struct cdbus_stats_entry, siblings);
+    if (entry_ptr->count == 0)
+    {
+      continue;
+    }
+
+    log_info("  %s.%s %"PRIu64, entry_ptr->name1, entry_ptr->name2, entry_ptr->count);
+  }
+}
+
+static void cdbus_stats_reset_list(struct list_head * list_ptr)
+{
+  struct list_head * node_ptr;
+  struct cdbus_stats_entry * entry_ptr;
+
+  list_for_each(node_ptr, list_ptr)
+  {
+    entry_ptr = list_entry(node_ptr, struct cdbus_stats_entry, siblings);
+    entry_ptr->count = 0;
+    entry_ptr->total_usecs = 0;
+    entry_ptr->max_usecs = 0;
+    memset(entry_ptr->histogram, 0, sizeof(entry_ptr->histogram));
+  }
+}
+
+void cdbus_stats_reset(void)
+{
+  cdbus_stats_reset_list(&g_methods.entries);
+  cdbus_stats_reset_list(&g_calls.entries);
+  cdbus_stats_reset_list(&g_signals.entries);
+}
+
+static void cdbus_stats_free_set(struct cdbus_stats_set * set_ptr)
+{
+  struct cdbus_stats_entry * entry_ptr;
+
+  while (!list_empty(&set_ptr->entries))
+  {
+    entry_ptr = list_entry(set_ptr->entries.next, struct cdbus_stats_entry, siblings);
+    list_del(&entry_ptr->siblings);
+    list_del(&entry_ptr->hash_siblings);
+    free(entry_ptr->name1);
+    free(entry_ptr->name2);
+    free(entry_ptr);
+  }
+
+  set_ptr->hash_initialized = false;
+}
+
+void cdbus_stats_uninit(void)
+{
+  cdbus_stats_free_set(&g_methods);
+  cdbus_stats_free_set(&g_calls);
+  cdbus_stats_free_set(&g_signals);
+}
@@ -0,0 +1,70 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains interface of the D-Bus call statistics
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __CDBUS_STATS_H__
+#define __CDBUS_STATS_H__
+
+#define CDBUS_STATS_HISTOGRAM_BUCKETS 6 /* <100us, <1ms, <10ms, <100ms, <1s, >=1s */
+
+#define CDBUS_STATS_SET_METHODS 0 /* handled methods, name1 is interface, name2 is method */
+#define CDBUS_STATS_SET_CALLS   1 /* outgoing blocking calls, name1 is destination (interface for unique names), name2 is method */
+#define CDBUS_STATS_SET_SIGNALS 2 /* emitted signals, name1 is interface, name2 is signal, only count is used */
+
+struct cdbus_stats_entry;
+
+struct cdbus_stats_values
+{
+  const char * name1;
+  const char * name2;
+  uint64_t count;
+  uint64_t total_usecs;
+  uint64_t max_usecs;
+  uint64_t histogram[CDBUS_STATS_HISTOGRAM_BUCKETS];
+};
+
+/* org.ladish.Stats interface, implemented in stats_iface.c */
+extern const struct cdbus_interface_descriptor g_cdbus_interface_stats;
+
+uint64_t cdbus_stats_now(void);
+
+/* Find or create the entry of a method, to be cached by the object path */
+struct cdbus_stats_entry * cdbus_stats_get_method(const char * iface, const char * method);
+void cdbus_stats_method_handled(struct cdbus_stats_entry * entry_ptr, uint64_t usecs);
+
+void cdbus_stats_call_completed(const char * destination, const char * iface, const char * method, uint64_t usecs);
+void cdbus_stats_signal_emitted(const char * iface, const char * signal);
+
+bool
+cdbus_stats_iterate(
+  unsigned int set,
+  void * context,
+  bool (* callback)(void * context, const struct cdbus_stats_values * values_ptr));
+
+void cdbus_stats_dump(void);
+void cdbus_stats_reset(void);
+void cdbus_stats_uninit(void);
+
+#endif /* __CDBUS_STATS_H__ */
@@ -0,0 +1,188 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the D-Bus interface of the D-Bus call statistics
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "../common.h"
+#include "../dbus_constants.h"
+#include "helpers.h"
+#include "stats.h"
+
+struct cdbus_stats_reply_context
+{
+  DBusMessageIter * array_iter_ptr;
+  bool times;
+  bool histogram;
+};
+
+#define ctx_ptr ((struct cdbus_stats_reply_context *)context)
+
+static bool cdbus_stats_append_entry(void * context, const struct cdbus_stats_values * values_ptr)
+{
+  DBusMessageIter struct_iter;
+  DBusMessageIter histogram_iter;
+  dbus_uint64_t value;
+  unsigned int i;
+
+  if (!dbus_message_iter_open_container(ctx_ptr->array_iter_ptr, DBUS_TYPE_STRUCT, NULL, &struct_iter))
+    return false;
+
+  if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &values_ptr->name1))
+    return false;
+
+  if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &values_ptr->name2))
+    return false;
+
+  value = values_ptr->count;
+  if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT64, &value))
+    return false;
+
+  if (ctx_ptr->times)
+  {
+    value = values_ptr->total_usecs;
+    if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT64, &value))
+      return false;
+
+    value = values_ptr->max_usecs;
+    if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT64, &value))
+      return false;
+  }
+
+  if (ctx_ptr->histogram)
+  {
+    if (!dbus_message_iter_open_container(&struct_iter, DBUS_TYPE_ARRAY, DBUS_TYPE_UINT64_AS_STRING, &histogram_iter))
+      return false;
+
+    for (i = 0; i < CDBUS_STATS_HISTOGRAM_BUCKETS; i++)
+    {
+      value = values_ptr->histogram[i];
+      if (!dbus_message_iter_append_basic(&histogram_iter, DBUS_TYPE_UINT64, &value))
+        return false;
+    }
+
+    if (!dbus_message_iter_close_container(&struct_iter, &histogram_iter))
+      return false;
+  }
+
+  if (!dbus_message_iter_close_container(ctx_ptr->array_iter_ptr, &struct_iter))
+    return false;
+
+  return true;
+}
+
+#undef ctx_ptr
+
+static
+void
+cdbus_stats_reply_list(
+  struct cdbus_method_call * call_ptr,
+  unsigned int set,
+  const char * signature,
+  bool times,
+  bool histogram)
+{
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+  struct cdbus_stats_reply_context context;
+
+  call_ptr->reply = dbus_message_new_method_return(call_ptr->message);
+  if (call_ptr->reply == NULL)
+  {
+    goto fail;
+  }
+
+  dbus_message_iter_init_append(call_ptr->reply, &iter);
+
+  if (!dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, signature, &array_iter))
+  {
+    goto fail_unref;
+  }
+
+  context.array_iter_ptr = &array_iter;
+  context.times = times;
+  context.histogram = histogram;
+
+  if (!cdbus_stats_iterate(set, &context, cdbus_stats_append_entry))
+  {
+    goto fail_unref;
+  }
+
+  if (!dbus_message_iter_close_container(&iter, &array_iter))
+  {
+    goto fail_unref;
+  }
+
+  return;
+
+fail_unref:
+  dbus_message_unref(call_ptr->reply);
+  call_ptr->reply = NULL;
+fail:
+  log_error("Ran out of memory trying to construct method return");
+}
+
+static void cdbus_stats_get_method_stats(struct cdbus_method_call * call_ptr)
+{
+  cdbus_stats_reply_list(call_ptr, CDBUS_STATS_SET_METHODS, "(ssttt)", true, false);
+}
+
+static void cdbus_stats_get_call_stats(struct cdbus_method_call * call_ptr)
+{
+  cdbus_stats_reply_list(call_ptr, CDBUS_STATS_SET_CALLS, "(sstttat)", true, true);
+}
+
+static void cdbus_stats_get_signal_stats(struct cdbus_method_call * call_ptr)
+{
+  cdbus_stats_reply_list(call_ptr, CDBUS_STATS_SET_SIGNALS, "(sst)", false, false);
+}
+
+static void cdbus_stats_reset_method(struct cdbus_method_call * call_ptr)
+{
+  cdbus_stats_reset();
+  cdbus_method_return_new_void(call_ptr);
+}
+
+CDBUS_METHOD_ARGS_BEGIN(GetMethodStats, "Get statistics of the handled methods")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("methods", "a(ssttt)", "interface, method, count, total and max handler time in microseconds")
+CDBUS_METHOD_ARGS_END
+
+CDBUS_METHOD_ARGS_BEGIN(GetCallStats, "Get statistics of the outgoing blocking calls")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("calls", "a(sstttat)", "destination (interface for unique names), method, count, total and max time in microseconds, histogram: <100us, <1ms, <10ms, <100ms, <1s, >=1s")
+CDBUS_METHOD_ARGS_END
+
+CDBUS_METHOD_ARGS_BEGIN(GetSignalStats, "Get statistics of the emitted signals")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("signals", "a(sst)", "interface, signal, count")
+CDBUS_METHOD_ARGS_END
+
+CDBUS_METHOD_ARGS_BEGIN(Reset, "Reset all statistics")
+CDBUS_METHOD_ARGS_END
+
+CDBUS_METHODS_BEGIN
+  CDBUS_METHOD_DESCRIBE(GetMethodStats, cdbus_stats_get_method_stats)
+  CDBUS_METHOD_DESCRIBE(GetCallStats, cdbus_stats_get_call_stats)
+  CDBUS_METHOD_DESCRIBE(GetSignalStats, cdbus_stats_get_signal_stats)
+  CDBUS_METHOD_DESCRIBE(Reset, cdbus_stats_reset_method)
+CDBUS_METHODS_END
+
+CDBUS_INTERFACE_DEFAULT_HANDLER_METHODS_ONLY(g_cdbus_interface_stats, IFACE_STATS)
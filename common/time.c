@@ -27,6 +27,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <sys/time.h>
+#include <time.h>
 
 #include "time.h"
 
@@ -40,3 +41,13 @@ uint64_t ladish_get_current_microseconds(void)
 
   return (uint64_t)time.tv_sec * 1000000 + (uint64_t)time.tv_usec;
 }
+
+uint64_t ladish_get_monotonic_microseconds(void)
+{
+  struct timespec time;
+
+  if (clock_gettime(CLOCK_MONOTONIC, &time) != 0)
+    return 0;
+
+  return (uint64_t)time.tv_sec * 1000000 + (uint64_t)time.tv_nsec / 1000;
+}
@@ -29,4 +29,7 @@
 
 uint64_t ladish_get_current_microseconds(void);
 
+/* for measuring durations, not affected by wall clock adjustments */
+uint64_t ladish_get_monotonic_microseconds(void);
+
 #endif /* #ifndef TIME_H__2E078D92_D0D7_4287_B27E_3B0F732F5989__INCLUDED */
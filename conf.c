@@ -32,13 +32,26 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <time.h>
 
 #include "cdbus/helpers.h"
 #include "dbus_constants.h"
 #include "common/catdup.h"
 #include "common/dirhelpers.h"
 
-#define STORAGE_BASE_DIR "/.ladish/conf/"
+#define STORAGE_BASE_DIR "/.ladish/conf/" /* legacy storage, one dir per key */
+#define STORAGE_JOURNAL "/.ladish/conf.journal"
+
+#define PAIR_HASH_SIZE 64
+
+/* the journal is fsync()ed this long after first not synced write */
+#define JOURNAL_SYNC_DELAY_MS 1000
+
+/* compact the journal when it is this many times bigger than its live records */
+#define JOURNAL_COMPACT_RATIO 2
+#define JOURNAL_COMPACT_MIN_SIZE 16384
+
+#define JOURNAL_RECORD_MAGIC 0x4C434A52 /* "LCJR" */
 
 extern const struct cdbus_interface_descriptor g_interface;
 
@@ -49,6 +62,7 @@ static bool g_quit;
 struct pair
 {
   struct list_head siblings;
+  struct list_head hash_siblings;
   uint64_t version;
   char * key;
   char * value;
@@ -56,6 +70,34 @@ struct pair
 };
 
 struct list_head g_pairs;
+struct list_head g_pairs_hash[PAIR_HASH_SIZE];
+
+/* The journal is a sequence of records, each one storing new value of a key.
+ * The last record for a key wins. Records are in host byte order.
+ * Incomplete or corrupted tail, as left by crash during write, is discarded on load. */
+struct journal_record_header
+{
+  uint32_t magic;
+  uint32_t checksum;            /* of key and value */
+  uint32_t key_len;
+  uint32_t value_len;
+  uint64_t version;
+};
+
+static struct
+{
+  char * path;
+  int fd;
+  size_t size;                  /* bytes in the journal file */
+  size_t live_size;             /* bytes of records that are not superseded */
+  bool compact;                 /* rewrite the journal on next sync */
+  bool dirty;                   /* there are writes that are not fsync()ed yet */
+  struct timespec dirty_since;
+} g_journal;
+
+static bool journal_init(void);
+static void journal_uninit(void);
+static void journal_sync(bool force);
 
 static bool connect_dbus(void)
 {
@@ -155,7 +197,11 @@ int main(int UNUSED(argc), char ** UNUSED(argv))
     return 1;
   }
 
-  INIT_LIST_HEAD(&g_pairs);
+  if (!journal_init())
+  {
+    log_error("Failed to load the settings journal");
+    return 1;
+  }
 
   install_term_signal_handler(SIGTERM, false);
   install_term_signal_handler(SIGINT, true);
@@ -163,18 +209,34 @@ int main(int UNUSED(argc), char ** UNUSED(argv))
   if (!connect_dbus())
   {
     log_error("Failed to connect to D-Bus");
+    journal_uninit();
     return 1;
   }
 
   while (!g_quit)
   {
     dbus_connection_read_write_dispatch(cdbus_g_dbus_connection, 50);
+    journal_sync(false);
   }
 
   disconnect_dbus();
+  journal_uninit();
   return 0;
 }
 
+static unsigned int pair_hash(const char * key)
+{
+  unsigned int hash;
+
+  hash = 5381;
+  while (*key != 0)
+  {
+    hash = hash * 33 + (unsigned char)*key++;
+  }
+
+  return hash % PAIR_HASH_SIZE;
+}
+
 static struct pair * create_pair(const char * key, const char * value)
 {
   struct pair * pair_ptr;
@@ -215,71 +277,440 @@ static struct pair * create_pair(const char * key, const char * value)
   pair_ptr->stored = false;
 
   list_add_tail(&pair_ptr->siblings, &g_pairs);
+  list_add_tail(&pair_ptr->hash_siblings, g_pairs_hash + pair_hash(key));
 
   return pair_ptr;
 }
 
-static bool store_pair(struct pair * pair_ptr)
+static void destroy_pair(struct pair * pair_ptr)
 {
-  char * dirpath;
-  char * filepath;
-  int fd;
+  list_del(&pair_ptr->siblings);
+  list_del(&pair_ptr->hash_siblings);
+  free(pair_ptr->key);
+  free(pair_ptr->value);
+  free(pair_ptr);
+}
+
+static struct pair * find_pair(const char * key)
+{
+  struct list_head * node_ptr;
+  struct pair * pair_ptr;
+
+  list_for_each(node_ptr, g_pairs_hash + pair_hash(key))
+  {
+    pair_ptr = list_entry(node_ptr, struct pair, hash_siblings);
+    if (strcmp(pair_ptr->key, key) == 0)
+    {
+      return pair_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+static uint32_t journal_checksum(const char * key, size_t key_len, const char * value, size_t value_len)
+{
+  uint32_t hash;
+  size_t i;
+
+  /* FNV-1a */
+  hash = 2166136261u;
+
+  for (i = 0; i < key_len; i++)
+  {
+    hash = (hash ^ (unsigned char)key[i]) * 16777619u;
+  }
+
+  for (i = 0; i < value_len; i++)
+  {
+    hash = (hash ^ (unsigned char)value[i]) * 16777619u;
+  }
+
+  return hash;
+}
+
+static size_t journal_record_size(struct pair * pair_ptr)
+{
+  return sizeof(struct journal_record_header) + strlen(pair_ptr->key) + strlen(pair_ptr->value);
+}
+
+static bool journal_write_record(int fd, struct pair * pair_ptr)
+{
+  struct journal_record_header * header_ptr;
+  size_t key_len;
+  size_t value_len;
   size_t len;
+  char * buffer;
   ssize_t written;
 
-  dirpath = catdupv(getenv("HOME"), STORAGE_BASE_DIR, pair_ptr->key, NULL);
-  if (dirpath == NULL)
+  key_len = strlen(pair_ptr->key);
+  value_len = strlen(pair_ptr->value);
+  len = sizeof(struct journal_record_header) + key_len + value_len;
+
+  /* whole record is written at once, so records of concurrent writes cannot interleave */
+  buffer = malloc(len);
+  if (buffer == NULL)
+  {
+    log_error("malloc() failed to allocate %zu bytes for journal record", len);
+    return false;
+  }
+
+  header_ptr = (struct journal_record_header *)buffer;
+  header_ptr->magic = JOURNAL_RECORD_MAGIC;
+  header_ptr->checksum = journal_checksum(pair_ptr->key, key_len, pair_ptr->value, value_len);
+  header_ptr->key_len = key_len;
+  header_ptr->value_len = value_len;
+  header_ptr->version = pair_ptr->version;
+  memcpy(buffer + sizeof(struct journal_record_header), pair_ptr->key, key_len);
+  memcpy(buffer + sizeof(struct journal_record_header) + key_len, pair_ptr->value, value_len);
+
+  written = write(fd, buffer, len);
+  free(buffer);
+
+  if (written < 0)
   {
+    log_error("Failed to write() to \"%s\": %d (%s)", g_journal.path, errno, strerror(errno));
     return false;
   }
 
-  if (!ensure_dir_exist(dirpath, 0700))
+  if ((size_t)written != len)
   {
-    free(dirpath);
+    log_error("write() to \"%s\" returned %zd instead of %zu", g_journal.path, written, len);
     return false;
   }
 
-  filepath = catdup(dirpath, "/value");
-  free(dirpath);
-  if (filepath == NULL)
+  return true;
+}
+
+/* rewrite the journal with only the live records */
+static bool journal_compact(void)
+{
+  char * tmp_path;
+  int fd;
+  struct list_head * node_ptr;
+  struct pair * pair_ptr;
+  size_t size;
+
+  tmp_path = catdup(g_journal.path, ".tmp");
+  if (tmp_path == NULL)
   {
     return false;
   }
 
-  fd = creat(filepath, 0700);
+  fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
   if (fd == -1)
   {
-    log_error("Failed to create \"%s\": %d (%s)", filepath, errno, strerror(errno));
-    free(filepath);
+    log_error("Failed to create \"%s\": %d (%s)", tmp_path, errno, strerror(errno));
+    goto free_path;
+  }
+
+  size = 0;
+
+  list_for_each(node_ptr, &g_pairs)
+  {
+    pair_ptr = list_entry(node_ptr, struct pair, siblings);
+    if (!journal_write_record(fd, pair_ptr))
+    {
+      goto close;
+    }
+
+    size += journal_record_size(pair_ptr);
+  }
+
+  if (fsync(fd) != 0)
+  {
+    log_error("fsync(\"%s\") failed: %d (%s)", tmp_path, errno, strerror(errno));
+    goto close;
+  }
+
+  if (rename(tmp_path, g_journal.path) != 0)
+  {
+    log_error("rename(\"%s\", \"%s\") failed: %d (%s)", tmp_path, g_journal.path, errno, strerror(errno));
+    goto close;
+  }
+
+  log_info("conf journal compacted, %zu -> %zu bytes", g_journal.size, size);
+
+  if (g_journal.fd != -1)
+  {
+    close(g_journal.fd);
+  }
+
+  /* the compacted file is opened for appending */
+  g_journal.fd = open(g_journal.path, O_WRONLY | O_APPEND);
+  if (g_journal.fd == -1)
+  {
+    log_error("Failed to open \"%s\": %d (%s)", g_journal.path, errno, strerror(errno));
+  }
+
+  g_journal.size = size;
+  g_journal.live_size = size;
+  g_journal.compact = false;
+
+  list_for_each(node_ptr, &g_pairs)
+  {
+    list_entry(node_ptr, struct pair, siblings)->stored = g_journal.fd != -1;
+  }
+
+  close(fd);
+  free(tmp_path);
+  return g_journal.fd != -1;
+
+close:
+  close(fd);
+  unlink(tmp_path);
+free_path:
+  free(tmp_path);
+  return false;
+}
+
+static bool journal_append(struct pair * pair_ptr, size_t old_record_size)
+{
+  if (g_journal.fd == -1 || g_journal.compact)
+  {
+    /* previous write failed, the tail of the journal cannot be trusted */
+    g_journal.compact = true;
+    return journal_compact();
+  }
+
+  if (!journal_write_record(g_journal.fd, pair_ptr))
+  {
+    g_journal.compact = true;
     return false;
   }
 
-  len = strlen(pair_ptr->value);
+  g_journal.size += journal_record_size(pair_ptr);
+  g_journal.live_size += journal_record_size(pair_ptr) - old_record_size;
+  pair_ptr->stored = true;
 
-  written = write(fd, pair_ptr->value, len);
-  if (written < 0)
+  if (!g_journal.dirty)
+  {
+    g_journal.dirty = true;
+    clock_gettime(CLOCK_MONOTONIC, &g_journal.dirty_since);
+  }
+
+  return true;
+}
+
+static void journal_sync(bool force)
+{
+  struct timespec now;
+
+  if (g_journal.dirty && g_journal.fd != -1)
   {
-    log_error("Failed to write() to \"%s\": %d (%s)", filepath, errno, strerror(errno));
-    free(filepath);
+    if (!force)
+    {
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      if ((now.tv_sec - g_journal.dirty_since.tv_sec) * 1000 + (now.tv_nsec - g_journal.dirty_since.tv_nsec) / 1000000 < JOURNAL_SYNC_DELAY_MS)
+      {
+        return;
+      }
+    }
+
+    if (fdatasync(g_journal.fd) != 0)
+    {
+      log_error("fdatasync(\"%s\") failed: %d (%s)", g_journal.path, errno, strerror(errno));
+    }
+
+    g_journal.dirty = false;
+  }
+
+  if (g_journal.compact ||
+      (g_journal.size > JOURNAL_COMPACT_MIN_SIZE && g_journal.size > g_journal.live_size * JOURNAL_COMPACT_RATIO))
+  {
+    journal_compact();
+  }
+}
+
+static bool journal_load(void)
+{
+  struct stat st;
+  char * buffer;
+  ssize_t bytes_read;
+  size_t offset;
+  struct journal_record_header header;
+  const char * record_key;
+  char * key;
+  char * value;
+  struct pair * pair_ptr;
+
+  g_journal.fd = open(g_journal.path, O_RDWR | O_CREAT | O_APPEND, 0600);
+  if (g_journal.fd == -1)
+  {
+    log_error("Failed to open \"%s\": %d (%s)", g_journal.path, errno, strerror(errno));
     return false;
   }
 
-  if ((size_t)written != len)
+  if (fstat(g_journal.fd, &st) != 0)
   {
-    log_error("write() to \"%s\" returned %zd instead of %zu", filepath, written, len);
-    free(filepath);
+    log_error("Failed to stat \"%s\": %d (%s)", g_journal.path, errno, strerror(errno));
     return false;
   }
 
-  close(fd);
-  free(filepath);
+  buffer = malloc((size_t)st.st_size + 1);
+  if (buffer == NULL)
+  {
+    log_error("malloc() failed to allocate %zu bytes of memory for journal", (size_t)st.st_size + 1);
+    return false;
+  }
+
+  bytes_read = pread(g_journal.fd, buffer, st.st_size, 0);
+  if (bytes_read < 0)
+  {
+    log_error("Failed to read() from \"%s\": %d (%s)", g_journal.path, errno, strerror(errno));
+    free(buffer);
+    return false;
+  }
+
+  offset = 0;
+  while (offset + sizeof(struct journal_record_header) <= (size_t)bytes_read)
+  {
+    memcpy(&header, buffer + offset, sizeof(struct journal_record_header));
+    if (header.magic != JOURNAL_RECORD_MAGIC ||
+        header.key_len == 0 ||
+        (size_t)bytes_read - offset - sizeof(struct journal_record_header) < (size_t)header.key_len + header.value_len)
+    {
+      break;
+    }
+
+    record_key = buffer + offset + sizeof(struct journal_record_header);
+    if (journal_checksum(record_key, header.key_len, record_key + header.key_len, header.value_len) != header.checksum)
+    {
+      break;
+    }
+
+    /* key and value are not nul terminated in the buffer */
+    key = malloc(header.key_len + 1);
+    if (key == NULL)
+    {
+      log_error("malloc() failed to allocate memory for key");
+      free(buffer);
+      return false;
+    }
+
+    memcpy(key, record_key, header.key_len);
+    key[header.key_len] = 0;
+
+    value = malloc(header.value_len + 1);
+    if (value == NULL)
+    {
+      log_error("malloc() failed to allocate memory for value");
+      free(key);
+      free(buffer);
+      return false;
+    }
+
+    memcpy(value, record_key + header.key_len, header.value_len);
+    value[header.value_len] = 0;
+
+    pair_ptr = find_pair(key);
+    if (pair_ptr != NULL)
+    {
+      g_journal.live_size -= journal_record_size(pair_ptr);
+      free(pair_ptr->value);
+    }
+    else
+    {
+      pair_ptr = create_pair(key, NULL);
+      if (pair_ptr == NULL)
+      {
+        free(value);
+        free(key);
+        free(buffer);
+        return false;
+      }
+    }
+
+    free(key);
+
+    pair_ptr->value = value;
+    pair_ptr->version = header.version;
+    pair_ptr->stored = true;
+
+    offset += sizeof(struct journal_record_header) + header.key_len + header.value_len;
+    g_journal.live_size += journal_record_size(pair_ptr);
+  }
+
+  free(buffer);
+
+  g_journal.size = offset;
+
+  if (offset != (size_t)st.st_size)
+  {
+    log_error("Discarding %zu bytes of incomplete or corrupted records at end of \"%s\"", (size_t)st.st_size - offset, g_journal.path);
+    if (ftruncate(g_journal.fd, offset) != 0)
+    {
+      log_error("ftruncate(\"%s\") failed: %d (%s)", g_journal.path, errno, strerror(errno));
+      g_journal.compact = true;
+    }
+  }
+
+  log_info("conf journal loaded, %zu bytes", g_journal.size);
+
+  journal_sync(true);
+
+  return true;
+}
+
+static bool journal_init(void)
+{
+  unsigned int i;
+
+  INIT_LIST_HEAD(&g_pairs);
+  for (i = 0; i < PAIR_HASH_SIZE; i++)
+  {
+    INIT_LIST_HEAD(g_pairs_hash + i);
+  }
+
+  g_journal.fd = -1;
+  g_journal.size = 0;
+  g_journal.live_size = 0;
+  g_journal.compact = false;
+  g_journal.dirty = false;
+
+  if (!ensure_dir_exist_varg(0700, getenv("HOME"), "/.ladish", NULL))
+  {
+    return false;
+  }
+
+  g_journal.path = catdup(getenv("HOME"), STORAGE_JOURNAL);
+  if (g_journal.path == NULL)
+  {
+    return false;
+  }
+
+  if (!journal_load())
+  {
+    if (g_journal.fd != -1)
+    {
+      close(g_journal.fd);
+    }
+    free(g_journal.path);
+    return false;
+  }
 
-  pair_ptr->stored = true;
-  
   return true;
 }
 
-static struct pair * load_pair(const char * key)
+static void journal_uninit(void)
+{
+  journal_sync(true);
+
+  if (g_journal.fd != -1)
+  {
+    close(g_journal.fd);
+  }
+
+  free(g_journal.path);
+
+  while (!list_empty(&g_pairs))
+  {
+    destroy_pair(list_entry(g_pairs.next, struct pair, siblings));
+  }
+}
+
+/* read value stored by older ladiconfd versions, in a file per key */
+static struct pair * load_legacy_pair(const char * key)
 {
   struct pair * pair_ptr;
   char * path;
@@ -296,11 +727,13 @@ static struct pair * load_pair(const char * key)
 
   if (stat(path, &st) != 0)
   {
-    log_error("Failed to stat \"%s\": %d (%s)", path, errno, strerror(errno));
+    if (errno != ENOENT)
+    {
+      log_error("Failed to stat \"%s\": %d (%s)", path, errno, strerror(errno));
+    }
     free(path);
     return false;
   }
-
   if (!S_ISREG(st.st_mode))
   {
     log_error("\"%s\" is not a regular file.", path);
@@ -363,23 +796,6 @@ static struct pair * load_pair(const char * key)
   return pair_ptr;
 }
 
-static struct pair * find_pair(const char * key)
-{
-  struct list_head * node_ptr;
-  struct pair * pair_ptr;
-
-  list_for_each(node_ptr, &g_pairs)
-  {
-    pair_ptr = list_entry(node_ptr, struct pair, siblings);
-    if (strcmp(pair_ptr->key, key) == 0)
-    {
-      return pair_ptr;
-    }
-  }
-
-  return NULL;
-}
-
 static void emit_changed(struct pair * pair_ptr)
 {
   cdbus_signal_emit(
@@ -403,6 +819,7 @@ static void conf_set(struct cdbus_method_call * call_ptr)
   struct pair * pair_ptr;
   char * buffer;
   bool store;
+  size_t old_record_size;
 
   if (!dbus_message_get_args(
         call_ptr->message,
@@ -418,6 +835,8 @@ static void conf_set(struct cdbus_method_call * call_ptr)
 
   log_info("set '%s' <- '%s'", key, value);
 
+  old_record_size = 0;
+
   pair_ptr = find_pair(key);
   if (pair_ptr == NULL)
   {
@@ -435,6 +854,11 @@ static void conf_set(struct cdbus_method_call * call_ptr)
   else
   {
     store = strcmp(pair_ptr->value, value) != 0;
+    if (pair_ptr->stored)
+    {
+      old_record_size = journal_record_size(pair_ptr);
+    }
+
     if (store)
     {
       buffer = strdup(value);
@@ -446,7 +870,7 @@ static void conf_set(struct cdbus_method_call * call_ptr)
       free(pair_ptr->value);
       pair_ptr->value = buffer;
       pair_ptr->version++;
-      pair_ptr->stored = false; /* mark that new value was not stored on disk yet */
+      pair_ptr->stored = false; /* mark that new value was not stored in the journal yet */
 
       emit_changed(pair_ptr);
     }
@@ -458,7 +882,7 @@ static void conf_set(struct cdbus_method_call * call_ptr)
 
   if (store)
   {
-    if (!store_pair(pair_ptr))
+    if (!journal_append(pair_ptr, old_record_size))
     {
       cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Storing the value of key '%s' to disk failed", pair_ptr->key);
       return;
@@ -487,12 +911,15 @@ static void conf_get(struct cdbus_method_call * call_ptr)
   pair_ptr = find_pair(key);
   if (pair_ptr == NULL)
   {
-    pair_ptr = load_pair(key);
+    pair_ptr = load_legacy_pair(key);
     if (pair_ptr == NULL)
     {
       cdbus_error(call_ptr, LADISH_DBUS_ERROR_KEY_NOT_FOUND, "Key '%s' not found", key);
       return;
     }
+
+    /* migrate to the journal; on failure the value is still served from memory */
+    journal_append(pair_ptr, 0);
   }
 
   log_info("get '%s' -> '%s'", key, pair_ptr->value);
@@ -39,7 +39,12 @@
 #include "../proxies/lash_client_proxy.h"
 #include "../common/catdup.h"
 #include "../common/dirhelpers.h"
+#include "../common/time.h"
+#include "../proxies/conf_proxy.h"
 #include "jack_session.h"
+#include "control.h"
+#include "conf.h"
+#include "perf_history.h"
 
 struct ladish_app
 {
@@ -61,6 +66,9 @@ struct ladish_app
   unsigned int state;
   char * dbus_name;
   struct ladish_app_supervisor * supervisor;
+  struct ladish_app_supervisor * detached_owner; /* supervisor the app was detached from, NULL if not detached or orphaned */
+  ladish_js_save_handle js_save; /* not NULL while JS save is in progress */
+  uint64_t js_save_deadline;
 };
 
 struct ladish_app_supervisor
@@ -72,17 +80,34 @@ struct ladish_app_supervisor
   char * js_dir;
   char * js_temp_dir;
   unsigned int pending_js_saves;
+  struct list_head js_saving_siblings; /* in g_js_saving_supervisors when pending_js_saves > 0 */
   void * save_callback_context;
   ladish_save_complete_callback save_callback;
 
   char * project_name;
   uint64_t version;
+  uint64_t generation;          /* stamp of the last modification of the persisted app properties */
   uint64_t next_id;
   struct list_head applist;
   void * on_app_renamed_context;
   ladish_app_supervisor_on_app_renamed_callback on_app_renamed;
 };
 
+/* JS saves of the studio and of all rooms are tracked together,
+ * so deadlines can be checked and progress reported from one place */
+static LIST_HEAD(g_js_saving_supervisors);
+
+/* Running apps of a studio that is being switched out. They are
+ * not owned by any supervisor and are kept running until
+ * they are adopted by matching apps of the studio that is switched in. */
+static LIST_HEAD(g_detached_apps);
+static struct
+{
+  unsigned int pending;
+  unsigned int completed;
+  unsigned int timed_out;
+} g_js_save_progress;
+
 bool ladish_check_app_level_validity(const char * level, size_t * len_ptr)
 {
   size_t len;
@@ -167,12 +192,14 @@ ladish_app_supervisor_create(
   supervisor_ptr->js_temp_dir = NULL;
   supervisor_ptr->js_dir = NULL;
   supervisor_ptr->pending_js_saves = 0;
+  INIT_LIST_HEAD(&supervisor_ptr->js_saving_siblings);
   supervisor_ptr->save_callback_context = NULL;
   supervisor_ptr->save_callback = NULL;
 
   supervisor_ptr->project_name = NULL;
 
   supervisor_ptr->version = 0;
+  supervisor_ptr->generation = ladish_generation_next();
   supervisor_ptr->next_id = 1;
 
   INIT_LIST_HEAD(&supervisor_ptr->applist);
@@ -202,13 +229,21 @@ struct ladish_app * ladish_app_supervisor_find_app_by_id_internal(struct ladish_
   return NULL;
 }
 
-void remove_app_internal(struct ladish_app_supervisor * supervisor_ptr, struct ladish_app * app_ptr)
-{
-  ASSERT(app_ptr->pid == 0);    /* Removing not-stoped app? Zombies will make a rebellion! */
+static void ladish_js_app_save_done(struct ladish_app * app_ptr, const char * commandline);
 
-  list_del(&app_ptr->siblings);
+static void ladish_app_free(struct ladish_app * app_ptr)
+{
+  free(app_ptr->dbus_name);
+  free(app_ptr->name);
+  free(app_ptr->commandline);
+  free(app_ptr->js_commandline);
+  free(app_ptr);
+}
 
+static void emit_app_removed(struct ladish_app_supervisor * supervisor_ptr, struct ladish_app * app_ptr)
+{
   supervisor_ptr->version++;
+  supervisor_ptr->generation = ladish_generation_next();
 
   cdbus_signal_emit(
     cdbus_g_dbus_connection,
@@ -218,12 +253,26 @@ void remove_app_internal(struct ladish_app_supervisor * supervisor_ptr, struct l
     "tt",
     &supervisor_ptr->version,
     &app_ptr->id);
+}
 
-  free(app_ptr->dbus_name);
-  free(app_ptr->name);
-  free(app_ptr->commandline);
-  free(app_ptr->js_commandline);
-  free(app_ptr);
+void remove_app_internal(struct ladish_app_supervisor * supervisor_ptr, struct ladish_app * app_ptr)
+{
+  ASSERT(app_ptr->pid == 0);    /* Removing not-stoped app? Zombies will make a rebellion! */
+
+  if (app_ptr->js_save != NULL)
+  {
+    log_error("App '%s' removed while its JACK session save is pending", app_ptr->name);
+    ladish_js_save_app_abandon(app_ptr->js_save);
+    app_ptr->js_save = NULL;
+    g_js_save_progress.completed++;
+    ladish_js_app_save_done(app_ptr, NULL);
+  }
+
+  list_del(&app_ptr->siblings);
+
+  emit_app_removed(supervisor_ptr, app_ptr);
+
+  ladish_app_free(app_ptr);
 }
 
 void emit_app_state_changed(struct ladish_app_supervisor * supervisor_ptr, struct ladish_app * app_ptr)
@@ -239,6 +288,7 @@ void emit_app_state_changed(struct ladish_app_supervisor * supervisor_ptr, struc
   level_byte = ladish_level_string_to_integer(app_ptr->level);
 
   supervisor_ptr->version++;
+  supervisor_ptr->generation = ladish_generation_next();
 
   cdbus_signal_emit(
     cdbus_g_dbus_connection,
@@ -277,6 +327,8 @@ static void ladish_js_save_complete(struct ladish_app_supervisor * supervisor_pt
   ASSERT(supervisor_ptr->js_dir != NULL);
   ASSERT(supervisor_ptr->pending_js_saves == 0);
 
+  list_del_init(&supervisor_ptr->js_saving_siblings);
+
   /* find whether all strdup() calls for new commandlines succeeded */
   list_for_each(node_ptr, &supervisor_ptr->applist)
   {
@@ -312,6 +364,11 @@ static void ladish_js_save_complete(struct ladish_app_supervisor * supervisor_pt
     {
       ASSERT(app_ptr->commandline != NULL);
       ASSERT(app_ptr->js_commandline != NULL);
+      if (strcmp(app_ptr->commandline, app_ptr->js_commandline) != 0)
+      {
+        supervisor_ptr->generation = ladish_generation_next();
+      }
+
       free(app_ptr->commandline);
       app_ptr->commandline = app_ptr->js_commandline;
       app_ptr->js_commandline = NULL;
@@ -450,6 +507,7 @@ ladish_app_supervisor_add(
   }
 
   app_ptr->js_commandline = NULL;
+  app_ptr->js_save = NULL;
 
   app_ptr->dbus_name = NULL;
 
@@ -475,9 +533,11 @@ ladish_app_supervisor_add(
   app_ptr->state = LADISH_APP_STATE_STOPPED;
   app_ptr->autorun = autorun;
   app_ptr->supervisor = supervisor_ptr;
+  app_ptr->detached_owner = NULL;
   list_add_tail(&app_ptr->siblings, &supervisor_ptr->applist);
 
   supervisor_ptr->version++;
+  supervisor_ptr->generation = ladish_generation_next();
 
   running = false;
   dbus_terminal = terminal;
@@ -720,10 +780,12 @@ exit:
   return;
 }
 
-#define app_ptr ((struct ladish_app *)context)
-
-static void ladish_js_app_save_complete(void * context, const char * commandline)
+static void ladish_js_app_save_done(struct ladish_app * app_ptr, const char * commandline)
 {
+  ASSERT(g_js_save_progress.pending > 0);
+  g_js_save_progress.pending--;
+  emit_js_save_progress(g_js_save_progress.pending, g_js_save_progress.completed, g_js_save_progress.timed_out);
+
   if (commandline != NULL)
   {
     log_info("JS app saved, commandline '%s'", commandline);
@@ -756,9 +818,18 @@ static void ladish_js_app_save_complete(void * context, const char * commandline
   ladish_js_save_complete(app_ptr->supervisor);
 }
 
+#define app_ptr ((struct ladish_app *)context)
+
+static void ladish_js_app_save_complete(void * context, const char * commandline)
+{
+  app_ptr->js_save = NULL;
+  g_js_save_progress.completed++;
+  ladish_js_app_save_done(app_ptr, commandline);
+}
+
 #undef app_ptr
 
-static inline void ladish_app_initiate_save(struct ladish_app * app_ptr)
+static inline void ladish_app_initiate_save(struct ladish_app * app_ptr, unsigned int timeout)
 {
   if (strcmp(app_ptr->level, LADISH_APP_LEVEL_LASH) == 0 &&
       app_ptr->dbus_name != NULL)
@@ -768,7 +839,8 @@ static inline void ladish_app_initiate_save(struct ladish_app * app_ptr)
   else if (strcmp(app_ptr->level, LADISH_APP_LEVEL_JACKSESSION) == 0)
   {
     log_info("Initiating JACK session save for '%s'", app_ptr->name);
-    if (!ladish_js_save_app(app_ptr->uuid, app_ptr->supervisor->js_temp_dir, app_ptr, ladish_js_app_save_complete))
+    app_ptr->js_save_deadline = ladish_get_current_microseconds() + (uint64_t)timeout * 1000000;
+    if (!ladish_js_save_app(app_ptr->uuid, app_ptr->supervisor->js_temp_dir, app_ptr, ladish_js_app_save_complete, &app_ptr->js_save))
     {
       ladish_js_app_save_complete(app_ptr, NULL);
     }
@@ -795,6 +867,30 @@ static inline void ladish_app_initiate_stop(struct ladish_app * app_ptr)
   app_ptr->state = LADISH_APP_STATE_STOPPING;
 }
 
+/* Fail the pending JS app saves, this completes the supervisor save */
+static void ladish_app_supervisor_abandon_js_saves(ladish_app_supervisor_handle supervisor_handle)
+{
+  struct list_head * node_ptr;
+  struct ladish_app * app_ptr;
+
+  list_for_each(node_ptr, &supervisor_ptr->applist)
+  {
+    app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+    if (app_ptr->js_save == NULL)
+    {
+      continue;
+    }
+
+    log_error("JACK session save of app '%s' abandoned", app_ptr->name);
+    ladish_js_save_app_abandon(app_ptr->js_save);
+    app_ptr->js_save = NULL;
+    g_js_save_progress.completed++;
+    ladish_js_app_save_done(app_ptr, NULL);
+  }
+
+  ASSERT(supervisor_ptr->pending_js_saves == 0);
+}
+
 bool ladish_app_supervisor_clear(ladish_app_supervisor_handle supervisor_handle)
 {
   struct list_head * node_ptr;
@@ -802,6 +898,9 @@ bool ladish_app_supervisor_clear(ladish_app_supervisor_handle supervisor_handle)
   struct ladish_app * app_ptr;
   bool lifeless;
 
+  /* the temp dir of a pending save is used until the save completes */
+  ladish_app_supervisor_abandon_js_saves(supervisor_handle);
+
   free(supervisor_ptr->js_temp_dir);
   supervisor_ptr->js_temp_dir = NULL;
   free(supervisor_ptr->js_dir);
@@ -836,7 +935,22 @@ bool ladish_app_supervisor_clear(ladish_app_supervisor_handle supervisor_handle)
 
 void ladish_app_supervisor_destroy(ladish_app_supervisor_handle supervisor_handle)
 {
+  struct list_head * node_ptr;
+  struct ladish_app * app_ptr;
+
+  /* nobody will adopt apps that were detached from this supervisor */
+  ladish_app_supervisor_stop_detached_apps(supervisor_handle);
+  list_for_each(node_ptr, &g_detached_apps)
+  {
+    app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+    if (app_ptr->detached_owner == supervisor_ptr)
+    {
+      app_ptr->detached_owner = NULL;
+    }
+  }
+
   ladish_app_supervisor_clear(supervisor_handle);
+  list_del_init(&supervisor_ptr->js_saving_siblings); /* the deadline check must not see a freed supervisor */
   free(supervisor_ptr->name);
   free(supervisor_ptr->opath);
   free(supervisor_ptr);
@@ -917,6 +1031,7 @@ bool ladish_app_supervisor_child_exit(ladish_app_supervisor_handle supervisor_ha
       clean = WIFEXITED(exit_status) && WEXITSTATUS(exit_status) == 0;
 
       log_info("%s exit of child '%s' detected.", clean ? "clean" : "dirty", app_ptr->name);
+      ladish_perf_history_add(LADISH_PERF_EVENT_APP_STOPPED, clean ? 0 : 1, "%s/%s", supervisor_ptr->name, app_ptr->name);
 
       app_ptr->pid = 0;
       app_ptr->pgrp = 0;
@@ -1014,6 +1129,7 @@ bool ladish_app_supervisor_start_app(ladish_app_supervisor_handle supervisor_han
 
   ASSERT(app_ptr->pid != 0);
   app_ptr->state = LADISH_APP_STATE_STARTED;
+  ladish_perf_history_add(LADISH_PERF_EVENT_APP_STARTED, 0, "%s/%s", supervisor_ptr->name, app_ptr->name);
 
   emit_app_state_changed(supervisor_ptr, app_ptr);
   return true;
@@ -1178,6 +1294,214 @@ void ladish_app_supervisor_stop(ladish_app_supervisor_handle supervisor_handle)
   }
 }
 
+unsigned int
+ladish_app_supervisor_detach_running_apps(
+  ladish_app_supervisor_handle supervisor_handle,
+  void * context,
+  void (* callback)(void * context, const uuid_t uuid, const char * name))
+{
+  struct list_head * node_ptr;
+  struct list_head * safe_node_ptr;
+  struct ladish_app * app_ptr;
+  unsigned int count;
+
+  count = 0;
+
+  list_for_each_safe(node_ptr, safe_node_ptr, &supervisor_ptr->applist)
+  {
+    app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+
+    /* JACK session apps are not detached because their state is stored by uuid in the studio dir */
+    if (app_ptr->pid == 0 ||
+        app_ptr->state != LADISH_APP_STATE_STARTED ||
+        app_ptr->js_save != NULL ||
+        strcmp(app_ptr->level, LADISH_APP_LEVEL_JACKSESSION) == 0)
+    {
+      continue;
+    }
+
+    log_info("detaching running '%s'", app_ptr->name);
+
+    if (callback != NULL)
+    {
+      callback(context, app_ptr->uuid, app_ptr->name);
+    }
+
+    list_del(&app_ptr->siblings);
+    emit_app_removed(supervisor_ptr, app_ptr);
+
+    app_ptr->supervisor = NULL;
+    app_ptr->detached_owner = supervisor_ptr;
+
+    /* the grandchild is associated again when its JACK client is seen by the virtualizer of the new studio */
+    app_ptr->firstborn_pid = 0;
+    app_ptr->firstborn_pgrp = 0;
+    app_ptr->firstborn_refcount = 0;
+
+    list_add_tail(&app_ptr->siblings, &g_detached_apps);
+    count++;
+  }
+
+  return count;
+}
+
+static
+struct ladish_app *
+ladish_app_find_detached_match(
+  struct ladish_app_supervisor * owner_ptr,
+  struct ladish_app * app_ptr)
+{
+  struct list_head * node_ptr;
+  struct ladish_app * detached_ptr;
+
+  list_for_each(node_ptr, &g_detached_apps)
+  {
+    detached_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+    if (detached_ptr->detached_owner == owner_ptr &&
+        detached_ptr->state == LADISH_APP_STATE_STARTED &&
+        detached_ptr->terminal == app_ptr->terminal &&
+        strcmp(detached_ptr->level, app_ptr->level) == 0 &&
+        strcmp(detached_ptr->name, app_ptr->name) == 0 &&
+        strcmp(detached_ptr->commandline, app_ptr->commandline) == 0)
+    {
+      return detached_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+unsigned int ladish_app_supervisor_adopt_detached_apps(ladish_app_supervisor_handle supervisor_handle)
+{
+  struct list_head * node_ptr;
+  struct ladish_app * app_ptr;
+  struct ladish_app * detached_ptr;
+  unsigned int count;
+
+  count = 0;
+
+  list_for_each(node_ptr, &supervisor_ptr->applist)
+  {
+    app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+
+    /* only apps that would be started by autorun */
+    if (app_ptr->pid != 0 || !app_ptr->autorun)
+    {
+      continue;
+    }
+
+    detached_ptr = ladish_app_find_detached_match(supervisor_ptr, app_ptr);
+    if (detached_ptr == NULL)
+    {
+      continue;
+    }
+
+    log_info("reusing running '%s' with pid %d", app_ptr->name, (int)detached_ptr->pid);
+
+    app_ptr->pid = detached_ptr->pid;
+    app_ptr->pgrp = detached_ptr->pgrp;
+    app_ptr->state = LADISH_APP_STATE_STARTED;
+    app_ptr->autorun = false;
+    app_ptr->zombie = false;
+
+    free(app_ptr->dbus_name);
+    app_ptr->dbus_name = detached_ptr->dbus_name;
+    detached_ptr->dbus_name = NULL;
+
+    list_del(&detached_ptr->siblings);
+    ladish_app_free(detached_ptr);
+
+    if (strcmp(app_ptr->level, LADISH_APP_LEVEL_LASH) == 0 && app_ptr->dbus_name != NULL)
+    {
+      /* load the state that is stored in the new studio */
+      ladish_app_initiate_lash_restore(app_ptr, supervisor_ptr->dir != NULL ? supervisor_ptr->dir : g_base_dir);
+    }
+
+    emit_app_state_changed(supervisor_ptr, app_ptr);
+    count++;
+  }
+
+  return count;
+}
+
+/* owner NULL matches all detached apps */
+static bool ladish_app_detached_owned(struct ladish_app * app_ptr, ladish_app_supervisor_handle owner)
+{
+  return owner == NULL || app_ptr->detached_owner == (struct ladish_app_supervisor *)owner;
+}
+
+void ladish_app_supervisor_stop_detached_apps(ladish_app_supervisor_handle owner)
+{
+  struct list_head * node_ptr;
+  struct ladish_app * app_ptr;
+
+  list_for_each(node_ptr, &g_detached_apps)
+  {
+    app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+    if (ladish_app_detached_owned(app_ptr, owner) && app_ptr->state == LADISH_APP_STATE_STARTED)
+    {
+      log_info("terminating detached '%s'...", app_ptr->name);
+      ladish_app_initiate_stop(app_ptr);
+    }
+  }
+}
+
+void ladish_app_supervisor_kill_detached_apps(ladish_app_supervisor_handle owner)
+{
+  struct list_head * node_ptr;
+  struct ladish_app * app_ptr;
+
+  list_for_each(node_ptr, &g_detached_apps)
+  {
+    app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+    if (!ladish_app_detached_owned(app_ptr, owner))
+    {
+      continue;
+    }
+
+    log_info("killing detached '%s'...", app_ptr->name);
+    ladish_app_send_signal(app_ptr, SIGKILL, false);
+    app_ptr->state = LADISH_APP_STATE_KILL;
+  }
+}
+
+unsigned int ladish_app_supervisor_get_detached_app_count(ladish_app_supervisor_handle owner)
+{
+  struct list_head * node_ptr;
+  unsigned int count;
+
+  count = 0;
+  list_for_each(node_ptr, &g_detached_apps)
+  {
+    if (ladish_app_detached_owned(list_entry(node_ptr, struct ladish_app, siblings), owner))
+    {
+      count++;
+    }
+  }
+
+  return count;
+}
+
+bool ladish_app_supervisor_detached_child_exit(pid_t pid)
+{
+  struct list_head * node_ptr;
+  struct ladish_app * app_ptr;
+
+  list_for_each(node_ptr, &g_detached_apps)
+  {
+    app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+    if (app_ptr->pid == pid)
+    {
+      log_info("exit of detached child '%s' detected.", app_ptr->name);
+      list_del(&app_ptr->siblings);
+      ladish_app_free(app_ptr);
+      return true;
+    }
+  }
+
+  return false;
+}
+
 void
 ladish_app_supervisor_save(
   ladish_app_supervisor_handle supervisor_handle,
@@ -1187,9 +1511,15 @@ ladish_app_supervisor_save(
   struct list_head * node_ptr;
   struct ladish_app * app_ptr;
   bool success;
+  unsigned int timeout;
 
   ASSERT(callback != NULL);
 
+  if (!conf_get_uint(LADISH_CONF_KEY_DAEMON_JS_SAVE_TIMEOUT, &timeout))
+  {
+    timeout = LADISH_CONF_KEY_DAEMON_JS_SAVE_TIMEOUT_DEFAULT;
+  }
+
   ASSERT(supervisor_ptr->js_temp_dir == NULL);
   ASSERT(supervisor_ptr->pending_js_saves == 0);
   list_for_each(node_ptr, &supervisor_ptr->applist)
@@ -1222,7 +1552,18 @@ ladish_app_supervisor_save(
       goto free_js_temp_dir;
     }
 
-    log_info("saving %u JACK session apps to '%s'", supervisor_ptr->pending_js_saves, supervisor_ptr->js_temp_dir);
+    log_info("saving %u JACK session apps to '%s', timeout %u seconds", supervisor_ptr->pending_js_saves, supervisor_ptr->js_temp_dir, timeout);
+
+    if (g_js_save_progress.pending == 0)
+    {
+      /* first supervisor to start saving, progress counting starts from zero */
+      g_js_save_progress.completed = 0;
+      g_js_save_progress.timed_out = 0;
+    }
+
+    g_js_save_progress.pending += supervisor_ptr->pending_js_saves;
+    list_add_tail(&supervisor_ptr->js_saving_siblings, &g_js_saving_supervisors);
+    emit_js_save_progress(g_js_save_progress.pending, g_js_save_progress.completed, g_js_save_progress.timed_out);
   }
 
   list_for_each(node_ptr, &supervisor_ptr->applist)
@@ -1239,7 +1580,7 @@ ladish_app_supervisor_save(
       continue;
     }
 
-    ladish_app_initiate_save(app_ptr);
+    ladish_app_initiate_save(app_ptr, timeout);
   }
 
   success = true;
@@ -1267,6 +1608,51 @@ exit:
   }
 }
 
+#undef supervisor_ptr
+
+void ladish_app_supervisor_check_js_save_deadlines(void)
+{
+  struct list_head * supervisor_node_ptr;
+  struct list_head * next_supervisor_node_ptr;
+  struct ladish_app_supervisor * supervisor_ptr;
+  struct list_head * node_ptr;
+  struct ladish_app * app_ptr;
+  uint64_t now;
+
+  if (list_empty(&g_js_saving_supervisors))
+  {
+    return;
+  }
+
+  now = ladish_get_current_microseconds();
+
+  list_for_each_safe(supervisor_node_ptr, next_supervisor_node_ptr, &g_js_saving_supervisors)
+  {
+    supervisor_ptr = list_entry(supervisor_node_ptr, struct ladish_app_supervisor, js_saving_siblings);
+
+    list_for_each(node_ptr, &supervisor_ptr->applist)
+    {
+      app_ptr = list_entry(node_ptr, struct ladish_app, siblings);
+      if (app_ptr->js_save == NULL || now < app_ptr->js_save_deadline)
+      {
+        continue;
+      }
+
+      log_error("JACK session save of app '%s' timed out", app_ptr->name);
+      ladish_notify_simple(LADISH_NOTIFY_URGENCY_HIGH, "JACK session app save timed out", app_ptr->name);
+
+      ladish_js_save_app_abandon(app_ptr->js_save);
+      app_ptr->js_save = NULL;
+      g_js_save_progress.timed_out++;
+
+      /* this can complete the supervisor save, the app list itself is not changed by that */
+      ladish_js_app_save_done(app_ptr, NULL);
+    }
+  }
+}
+
+#define supervisor_ptr ((struct ladish_app_supervisor *)supervisor_handle)
+
 const char * ladish_app_supervisor_get_name(ladish_app_supervisor_handle supervisor_handle)
 {
   return supervisor_ptr->name;
@@ -1291,6 +1677,25 @@ unsigned int ladish_app_supervisor_get_running_app_count(ladish_app_supervisor_h
   return counter;
 }
 
+unsigned int ladish_app_supervisor_get_app_count(ladish_app_supervisor_handle supervisor_handle)
+{
+  struct list_head * node_ptr;
+  unsigned int counter;
+
+  counter = 0;
+  list_for_each(node_ptr, &supervisor_ptr->applist)
+  {
+    counter++;
+  }
+
+  return counter;
+}
+
+uint64_t ladish_app_supervisor_get_generation(ladish_app_supervisor_handle supervisor_handle)
+{
+  return supervisor_ptr->generation;
+}
+
 bool ladish_app_supervisor_has_apps(ladish_app_supervisor_handle supervisor_handle)
 {
   return !list_empty(&supervisor_ptr->applist);
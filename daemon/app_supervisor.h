@@ -212,6 +212,11 @@ ladish_app_supervisor_clear(
 /**
  * Initiate save for apps running at level higher than 0
  *
+ * JS app saves of all supervisors that are saving at the same time are
+ * in flight together, deadlines and progress are tracked globally.
+ * The studio save command saves only the studio apps, room apps are saved
+ * by the room save project command, that runs in parallel in its room scope.
+ *
  * @param[in] supervisor_handle supervisor object handle
  * @param[in] context User defined context to be supplied when callback supplied throuth @c callback parameter is called
  * @param[in] callback Callback to call when save is complete
@@ -263,6 +268,74 @@ void
 ladish_app_supervisor_autorun(
   ladish_app_supervisor_handle supervisor_handle);
 
+/**
+ * Detach running apps from the supervisor, without stopping them.
+ * Detached apps are kept running until adopted by ladish_app_supervisor_adopt_detached_apps()
+ * or stopped by ladish_app_supervisor_stop_detached_apps(). JACK session apps are not detached.
+ * The supervisor stays the owner of the detached apps, only it can adopt them.
+ * When the supervisor is destroyed, its detached apps are stopped.
+ *
+ * @param[in] supervisor_handle supervisor object handle
+ * @param[in] context User defined context to be supplied when the callback is called
+ * @param[in] callback Function to call for each app, before it is detached. Can be NULL.
+ *
+ * @return Number of detached apps
+ */
+unsigned int
+ladish_app_supervisor_detach_running_apps(
+  ladish_app_supervisor_handle supervisor_handle,
+  void * context,
+  void (* callback)(void * context, const uuid_t uuid, const char * name));
+
+/**
+ * Make not started autorun apps of the supervisor use apps, detached from the same supervisor,
+ * with same name, commandline, level and terminal flag.
+ * LASH apps are asked to restore their state from the supervisor directory.
+ *
+ * @param[in] supervisor_handle supervisor object handle
+ *
+ * @return Number of adopted apps
+ */
+unsigned int ladish_app_supervisor_adopt_detached_apps(ladish_app_supervisor_handle supervisor_handle);
+
+/**
+ * Initiate stop of the detached apps
+ *
+ * @param[in] owner Handle of the supervisor the apps were detached from, NULL for all detached apps
+ */
+void ladish_app_supervisor_stop_detached_apps(ladish_app_supervisor_handle owner);
+
+/**
+ * Force kill the detached apps, used when they dont terminate after stop
+ *
+ * @param[in] owner Handle of the supervisor the apps were detached from, NULL for all detached apps
+ */
+void ladish_app_supervisor_kill_detached_apps(ladish_app_supervisor_handle owner);
+
+/**
+ * Get number of detached apps, these that are being stopped included
+ *
+ * @param[in] owner Handle of the supervisor the apps were detached from, NULL for all detached apps
+ *
+ * @return Number of detached apps
+ */
+unsigned int ladish_app_supervisor_get_detached_app_count(ladish_app_supervisor_handle owner);
+
+/**
+ * Handle exit of a child process that may be a detached app
+ *
+ * @param[in] pid PID of the exited child
+ *
+ * @return Whether the child was a detached app
+ */
+bool ladish_app_supervisor_detached_child_exit(pid_t pid);
+
+/**
+ * Fail JACK session app saves, of all supervisors, that did not complete before their deadline.
+ * To be called periodically.
+ */
+void ladish_app_supervisor_check_js_save_deadlines(void);
+
 /**
  * Get name of the supervisor
  *
@@ -283,6 +356,25 @@ const char * ladish_app_supervisor_get_name(ladish_app_supervisor_handle supervi
  */
 unsigned int ladish_app_supervisor_get_running_app_count(ladish_app_supervisor_handle supervisor_handle);
 
+/**
+ * Get number of apps (running or not)
+ *
+ * @param[in] supervisor_handle supervisor object handle
+ *
+ * @return Number of apps
+ */
+unsigned int ladish_app_supervisor_get_app_count(ladish_app_supervisor_handle supervisor_handle);
+
+/**
+ * Get modification stamp of the app list. The stamp grows whenever
+ * an app is added or removed, or app properties that are saved change.
+ *
+ * @param[in] supervisor_handle supervisor object handle
+ *
+ * @return Generation stamp
+ */
+uint64_t ladish_app_supervisor_get_generation(ladish_app_supervisor_handle supervisor_handle);
+
 /**
  * Check whether there are apps (running or not)
  *
@@ -27,8 +27,12 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/inotify.h>
 
 #include "appdb.h"
 #include "../log.h"
@@ -81,6 +85,11 @@ struct map g_appdb_entry_map[] =
     .type = MAP_TYPE_STRING,
     .offset = offsetof(struct lash_appdb_entry, path)
   },
+  {
+    .key = "Keywords",
+    .type = MAP_TYPE_STRING,
+    .offset = offsetof(struct lash_appdb_entry, keywords)
+  },
   {
     .key = "Terminal",
     .type = MAP_TYPE_BOOL,
@@ -160,7 +169,10 @@ load_file_data(
   file = fopen(file_path, "r");
   if (file == NULL)
   {
-    log_error("Failed to open '%s' for reading", file_path);
+    if (errno != ENOENT)
+    {
+      log_error("Failed to open '%s' for reading", file_path);
+    }
     goto exit;
   }
 
@@ -342,10 +354,13 @@ lash_appdb_find_key(
   return NULL;
 }
 
+/* returns false if file does not exist or is not a desktop entry;
+ * *entry_ptr_ptr is set to NULL for entries that are not to be shown */
+static
 bool
-lash_appdb_load_file(
-  struct list_head * appdb,
-  const char * file_path)
+lash_appdb_parse_file(
+  const char * file_path,
+  struct lash_appdb_entry ** entry_ptr_ptr)
 {
   char * data;
   bool ret;
@@ -353,8 +368,6 @@ lash_appdb_load_file(
   size_t entries_count;
   const char * value;
   const char * name;
-  const char * xlash;
-  struct list_head * node_ptr;
   struct lash_appdb_entry * entry_ptr;
   struct map * map_ptr;
   char ** str_ptr_ptr;
@@ -362,15 +375,10 @@ lash_appdb_load_file(
 
   //log_info("Desktop entry '%s'", file_path);
 
-  ret = true;
-
-  if (!load_file_data(file_path, &data))
-  {
-    ret = false;
-    goto exit;
-  }
+  ret = false;
+  *entry_ptr_ptr = NULL;
 
-  if (data == NULL)
+  if (!load_file_data(file_path, &data) || data == NULL)
   {
     goto exit;
   }
@@ -380,7 +388,7 @@ lash_appdb_load_file(
     goto exit_free_data;
   }
 
-  //log_info("%llu entries", (unsigned long long)entries_count);
+  ret = true;
 
   /* check whether entry is of "Application" type */
   value = lash_appdb_find_key(entries, entries_count, "Type");
@@ -396,22 +404,17 @@ lash_appdb_load_file(
     goto exit_free_data;
   }
 
-  /* check whether entry has LIBLASH or LASHCLASS key */
-  xlash = lash_appdb_find_key(entries, entries_count, "X-LASH");
-  if (xlash == NULL)
+  /* entries that hide applications of lower priority XDG dirs or that are not meant to be shown in menus */
+  value = lash_appdb_find_key(entries, entries_count, "Hidden");
+  if (value != NULL && strcmp(value, "true") == 0)
   {
     goto exit_free_data;
   }
 
-  /* check whether entry already exists (first found entries have priority according to XDG Base Directory Specification) */
-  list_for_each(node_ptr, appdb)
+  value = lash_appdb_find_key(entries, entries_count, "NoDisplay");
+  if (value != NULL && strcmp(value, "true") == 0)
   {
-    entry_ptr = list_entry(node_ptr, struct lash_appdb_entry, siblings);
-
-    if (strcmp(entry_ptr->name, name) == 0)
-    {
-      goto exit_free_data;
-    }
+    goto exit_free_data;
   }
 
   //log_info("Application '%s' found", name);
@@ -434,7 +437,7 @@ lash_appdb_load_file(
     if (value == NULL)
     {
       ASSERT(strcmp(map_ptr->key, "Name") != 0); /* name is required and we already checked this */
-      map_ptr++;  
+      map_ptr++;
       continue;
     }
 
@@ -475,8 +478,7 @@ lash_appdb_load_file(
     map_ptr++;
   }
 
-  /* add entry to appdb list */
-  list_add_tail(&entry_ptr->siblings, appdb);
+  *entry_ptr_ptr = entry_ptr;
 
   goto exit_free_data;
 
@@ -493,174 +495,807 @@ exit:
   return ret;
 }
 
-bool
-lash_appdb_load_dir(
-  struct list_head * appdb,
-  const char * base_directory)
+/* In-memory application database. The XDG dirs are scanned incrementally
+ * from the main loop and then kept current through inotify.
+ * Desktop files are identified by their filename (desktop file id),
+ * the one in the most important XDG dir wins. */
+
+#define APPDB_HASH_SIZE  256
+#define APPDB_SCAN_BATCH 32     /* max desktop files parsed per main loop iteration */
+
+struct appdb_dir
+{
+  struct list_head siblings;
+  char * path;                  /* the "applications" dir, with trailing slash */
+  unsigned int priority;        /* lower is more important */
+  int wd;                       /* inotify watch descriptor, -1 if not watched */
+  int parent_wd;                /* watch of the nearest existing parent while the dir does not exist, -1 otherwise */
+};
+
+struct appdb_file
+{
+  struct list_head siblings;    /* in hash bucket */
+  char * id;                    /* desktop file id */
+  unsigned int priority;        /* of the dir the file was loaded from */
+  struct lash_appdb_entry * entry_ptr; /* NULL for entries that are not to be shown */
+  unsigned int query_serial;
+};
+
+struct appdb_index_key
+{
+  char * key;                   /* lowercase name, name word or keyword */
+  struct appdb_file * file_ptr;
+};
+
+static struct
+{
+  struct list_head dirs;
+  unsigned int dir_count;
+  struct list_head files[APPDB_HASH_SIZE];
+  unsigned int app_count;
+  int inotify_fd;
+  struct appdb_dir * scan_dir_ptr; /* dir being scanned, NULL when scan is complete */
+  DIR * scan_dir;
+  struct appdb_index_key * index;
+  size_t index_count;
+  size_t index_size;
+  bool index_dirty;
+  unsigned int query_serial;
+} g_appdb;
+
+static unsigned int appdb_hash(const char * id)
+{
+  unsigned int hash;
+
+  hash = 5381;
+  while (*id != 0)
+  {
+    hash = hash * 33 + (unsigned char)*id++;
+  }
+
+  return hash % APPDB_HASH_SIZE;
+}
+
+static struct appdb_file * appdb_find_file(const char * id)
+{
+  struct list_head * node_ptr;
+  struct appdb_file * file_ptr;
+
+  list_for_each(node_ptr, g_appdb.files + appdb_hash(id))
+  {
+    file_ptr = list_entry(node_ptr, struct appdb_file, siblings);
+    if (strcmp(file_ptr->id, id) == 0)
+    {
+      return file_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+static void appdb_destroy_file(struct appdb_file * file_ptr)
+{
+  list_del(&file_ptr->siblings);
+
+  if (file_ptr->entry_ptr != NULL)
+  {
+    lash_appdb_free_entry(file_ptr->entry_ptr);
+    g_appdb.app_count--;
+  }
+
+  free(file_ptr->id);
+  free(file_ptr);
+
+  g_appdb.index_dirty = true;
+}
+
+/* returns false if the file does not exist or is not a desktop entry */
+static bool appdb_add_file(struct appdb_dir * dir_ptr, const char * id)
+{
+  char * path;
+  struct lash_appdb_entry * entry_ptr;
+  struct appdb_file * file_ptr;
+  bool parsed;
+
+  path = catdup(dir_ptr->path, id);
+  if (path == NULL)
+  {
+    log_error("catdup() failed to compose the appdb dir file");
+    return false;
+  }
+
+  parsed = lash_appdb_parse_file(path, &entry_ptr);
+  free(path);
+  if (!parsed)
+  {
+    return false;
+  }
+
+  file_ptr = malloc(sizeof(struct appdb_file));
+  if (file_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct appdb_file");
+    goto fail_free_entry;
+  }
+
+  file_ptr->id = strdup(id);
+  if (file_ptr->id == NULL)
+  {
+    log_error("strdup() failed for desktop file id");
+    free(file_ptr);
+    goto fail_free_entry;
+  }
+
+  file_ptr->priority = dir_ptr->priority;
+  file_ptr->entry_ptr = entry_ptr;
+  file_ptr->query_serial = 0;
+  list_add_tail(&file_ptr->siblings, g_appdb.files + appdb_hash(id));
+
+  if (entry_ptr != NULL)
+  {
+    g_appdb.app_count++;
+  }
+
+  g_appdb.index_dirty = true;
+  return true;
+
+fail_free_entry:
+  if (entry_ptr != NULL)
+  {
+    lash_appdb_free_entry(entry_ptr);
+  }
+
+  return false;
+}
+
+/* reparse desktop file after change in any of the dirs */
+static void appdb_refresh_file(const char * id)
+{
+  struct appdb_file * file_ptr;
+  struct list_head * node_ptr;
+
+  //log_info("refreshing desktop file '%s'", id);
+
+  file_ptr = appdb_find_file(id);
+  if (file_ptr != NULL)
+  {
+    appdb_destroy_file(file_ptr);
+  }
+
+  list_for_each(node_ptr, &g_appdb.dirs)
+  {
+    if (appdb_add_file(list_entry(node_ptr, struct appdb_dir, siblings), id))
+    {
+      return;
+    }
+  }
+}
+
+#define APPDB_DIR_WATCH_MASK    (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_ONLYDIR)
+#define APPDB_PARENT_WATCH_MASK (IN_CREATE | IN_MOVED_TO | IN_ONLYDIR | IN_MASK_ADD)
+
+static void appdb_unwatch_parent(struct appdb_dir * dir_ptr)
+{
+  struct list_head * node_ptr;
+  struct appdb_dir * other_ptr;
+  int wd;
+
+  wd = dir_ptr->parent_wd;
+  if (wd == -1)
+  {
+    return;
+  }
+
+  dir_ptr->parent_wd = -1;
+
+  /* the watch is shared by dirs with same nearest existing parent
+     and can be the watch of another appdb dir too */
+  list_for_each(node_ptr, &g_appdb.dirs)
+  {
+    other_ptr = list_entry(node_ptr, struct appdb_dir, siblings);
+    if (other_ptr->parent_wd == wd || other_ptr->wd == wd)
+    {
+      return;
+    }
+  }
+
+  inotify_rm_watch(g_appdb.inotify_fd, wd);
+}
+
+/* Watch the dir. If it does not exist, watch its nearest existing parent instead,
+ * so the dir can be watched when it gets created. */
+static void appdb_watch_dir(struct appdb_dir * dir_ptr)
+{
+  char * path;
+  size_t len;
+
+  dir_ptr->wd = inotify_add_watch(g_appdb.inotify_fd, dir_ptr->path, APPDB_DIR_WATCH_MASK);
+  if (dir_ptr->wd != -1)
+  {
+    appdb_unwatch_parent(dir_ptr);
+    return;
+  }
+
+  if (errno != ENOENT)
+  {
+    log_error("inotify_add_watch('%s') failed: %d (%s)", dir_ptr->path, errno, strerror(errno));
+    return;
+  }
+
+  path = strdup(dir_ptr->path);
+  if (path == NULL)
+  {
+    log_error("strdup() failed for appdb dir path '%s'", dir_ptr->path);
+    return;
+  }
+
+  appdb_unwatch_parent(dir_ptr);
+
+  len = strlen(path);
+  while (len > 1)
+  {
+    /* strip the trailing slashes and the last path component */
+    while (len > 1 && path[len - 1] == '/')
+    {
+      len--;
+    }
+
+    while (len > 1 && path[len - 1] != '/')
+    {
+      len--;
+    }
+
+    path[len] = 0;
+
+    dir_ptr->parent_wd = inotify_add_watch(g_appdb.inotify_fd, path, APPDB_PARENT_WATCH_MASK);
+    if (dir_ptr->parent_wd != -1)
+    {
+      log_info("'%s' does not exist, watching '%s' for its creation", dir_ptr->path, path);
+      break;
+    }
+
+    if (errno != ENOENT)
+    {
+      log_error("inotify_add_watch('%s') failed: %d (%s)", path, errno, strerror(errno));
+      break;
+    }
+  }
+
+  free(path);
+}
+
+/* the dir was created after the startup scan, load the files that are already in it */
+static void appdb_load_new_dir(struct appdb_dir * dir_ptr)
 {
-  char * directory_path;
-  bool ret;
   DIR * dir;
   struct dirent * dentry_ptr;
-  char * file_path;
 
-  //log_info("lash_appdb_load_dir() called for '%s'.", base_directory);
+  log_info("appdb dir '%s' created", dir_ptr->path);
 
-  ret = false;
+  dir = opendir(dir_ptr->path);
+  if (dir == NULL)
+  {
+    return;
+  }
+
+  while ((dentry_ptr = readdir(dir)) != NULL)
+  {
+    if (suffix_match(dentry_ptr->d_name, ".desktop"))
+    {
+      appdb_refresh_file(dentry_ptr->d_name);
+    }
+  }
+
+  closedir(dir);
+}
+
+static void appdb_add_dir(const char * base_directory, size_t len)
+{
+  struct appdb_dir * dir_ptr;
+
+  if (len == 0)
+  {
+    return;
+  }
+
+  dir_ptr = malloc(sizeof(struct appdb_dir));
+  if (dir_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct appdb_dir");
+    return;
+  }
+
+  dir_ptr->path = malloc(len + sizeof("/applications/"));
+  if (dir_ptr->path == NULL)
+  {
+    log_error("malloc() failed to compose the appdb dir path");
+    free(dir_ptr);
+    return;
+  }
+
+  memcpy(dir_ptr->path, base_directory, len);
+  strcpy(dir_ptr->path + len, "/applications/");
 
-  directory_path = catdup(base_directory, "/applications/");
-  if (directory_path == NULL)
+  dir_ptr->priority = g_appdb.dir_count++;
+  dir_ptr->wd = -1;
+  dir_ptr->parent_wd = -1;
+
+  list_add_tail(&dir_ptr->siblings, &g_appdb.dirs);
+
+  if (g_appdb.inotify_fd != -1)
+  {
+    appdb_watch_dir(dir_ptr);
+  }
+}
+
+static void appdb_scan_next_dir(void)
+{
+  if (g_appdb.scan_dir != NULL)
+  {
+    closedir(g_appdb.scan_dir);
+    g_appdb.scan_dir = NULL;
+  }
+
+  if (g_appdb.scan_dir_ptr->siblings.next == &g_appdb.dirs)
   {
-    log_error("catdup() failed to compose the appdb dir path");
-    goto fail;
+    g_appdb.scan_dir_ptr = NULL;
+    log_info("appdb scan complete, %u applications", g_appdb.app_count);
+    return;
   }
 
-  //log_info("Scanning directory '%s'", directory_path);
+  g_appdb.scan_dir_ptr = list_entry(g_appdb.scan_dir_ptr->siblings.next, struct appdb_dir, siblings);
+}
+
+static void appdb_scan(unsigned int max_files)
+{
+  struct dirent * dentry_ptr;
 
-  dir = opendir(directory_path);
-  if (dir != NULL)
+  while (g_appdb.scan_dir_ptr != NULL && max_files > 0)
   {
-    while ((dentry_ptr = readdir(dir)) != NULL)
+    if (g_appdb.scan_dir == NULL)
     {
-      if (dentry_ptr->d_type != DT_REG)
+      g_appdb.scan_dir = opendir(g_appdb.scan_dir_ptr->path);
+      if (g_appdb.scan_dir == NULL)
       {
+        //log_info("failed to open directory '%s'", g_appdb.scan_dir_ptr->path);
+        appdb_scan_next_dir();
         continue;
       }
+    }
+
+    dentry_ptr = readdir(g_appdb.scan_dir);
+    if (dentry_ptr == NULL)
+    {
+      appdb_scan_next_dir();
+      continue;
+    }
+
+    if (dentry_ptr->d_type != DT_REG && dentry_ptr->d_type != DT_LNK && dentry_ptr->d_type != DT_UNKNOWN)
+    {
+      continue;
+    }
+
+    if (!suffix_match(dentry_ptr->d_name, ".desktop"))
+    {
+      continue;
+    }
+
+    /* dirs are scanned in order of priority, already known files are from more important dirs
+       or were loaded through inotify events */
+    if (appdb_find_file(dentry_ptr->d_name) != NULL)
+    {
+      continue;
+    }
+
+    appdb_add_file(g_appdb.scan_dir_ptr, dentry_ptr->d_name);
+    max_files--;
+  }
+}
+
+static void appdb_rescan(void)
+{
+  unsigned int i;
+
+  for (i = 0; i < APPDB_HASH_SIZE; i++)
+  {
+    while (!list_empty(g_appdb.files + i))
+    {
+      appdb_destroy_file(list_entry(g_appdb.files[i].next, struct appdb_file, siblings));
+    }
+  }
+
+  if (g_appdb.scan_dir != NULL)
+  {
+    closedir(g_appdb.scan_dir);
+    g_appdb.scan_dir = NULL;
+  }
+
+  g_appdb.scan_dir_ptr = list_empty(&g_appdb.dirs) ? NULL : list_entry(g_appdb.dirs.next, struct appdb_dir, siblings);
+}
+
+static void appdb_process_events(void)
+{
+  char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  ssize_t len;
+  char * ptr;
+  struct inotify_event * event_ptr;
+  struct list_head * node_ptr;
+  struct appdb_dir * dir_ptr;
 
-      if (!suffix_match(dentry_ptr->d_name, ".desktop"))
+  if (g_appdb.inotify_fd == -1)
+  {
+    return;
+  }
+
+  while ((len = read(g_appdb.inotify_fd, buffer, sizeof(buffer))) > 0)
+  {
+    for (ptr = buffer; ptr < buffer + len; ptr += sizeof(struct inotify_event) + event_ptr->len)
+    {
+      event_ptr = (struct inotify_event *)ptr;
+
+      if ((event_ptr->mask & IN_Q_OVERFLOW) != 0)
       {
+        log_info("appdb inotify queue overflow, rescanning");
+        appdb_rescan();
         continue;
       }
 
-      file_path = catdup(directory_path, dentry_ptr->d_name);
-      if (file_path == NULL)
+      if ((event_ptr->mask & IN_IGNORED) != 0)
       {
-        log_error("catdup() failed to compose the appdb dir file");
+        list_for_each(node_ptr, &g_appdb.dirs)
+        {
+          dir_ptr = list_entry(node_ptr, struct appdb_dir, siblings);
+          if (dir_ptr->parent_wd == event_ptr->wd)
+          {
+            dir_ptr->parent_wd = -1;
+            appdb_watch_dir(dir_ptr);
+          }
+          else if (dir_ptr->wd == event_ptr->wd)
+          {
+            /* the dir was removed, wait for it to be created again */
+            dir_ptr->wd = -1;
+            appdb_watch_dir(dir_ptr);
+          }
+        }
+
+        continue;
       }
-      else
+
+      if ((event_ptr->mask & IN_ISDIR) != 0)
       {
-        if (!lash_appdb_load_file(appdb, file_path))
+        /* the dir or one of its missing parents was created */
+        list_for_each(node_ptr, &g_appdb.dirs)
         {
-          free(file_path);
-          goto fail_free_path;
+          dir_ptr = list_entry(node_ptr, struct appdb_dir, siblings);
+          if (dir_ptr->parent_wd == event_ptr->wd)
+          {
+            appdb_watch_dir(dir_ptr);
+            if (dir_ptr->wd != -1)
+            {
+              appdb_load_new_dir(dir_ptr);
+            }
+          }
         }
 
-        free(file_path);
+        continue;
+      }
+
+      if (event_ptr->len != 0 && suffix_match(event_ptr->name, ".desktop"))
+      {
+        appdb_refresh_file(event_ptr->name);
       }
     }
+  }
 
-    closedir(dir);
+  if (len == -1 && errno != EAGAIN)
+  {
+    log_error("read() from inotify fd failed: %d (%s)", errno, strerror(errno));
   }
-  else
+}
+
+static bool appdb_index_add(const char * key, size_t len, struct appdb_file * file_ptr)
+{
+  struct appdb_index_key * index;
+  char * lowercase;
+  size_t i;
+
+  if (len == 0)
   {
-    //log_info("failed to open directory '%s'", directory_path);
+    return true;
   }
 
-  ret = true;
+  if (g_appdb.index_count == g_appdb.index_size)
+  {
+    index = realloc(g_appdb.index, (g_appdb.index_size + 1024) * sizeof(struct appdb_index_key));
+    if (index == NULL)
+    {
+      log_error("realloc() failed for appdb index");
+      return false;
+    }
 
-fail_free_path:
-  free(directory_path);
+    g_appdb.index = index;
+    g_appdb.index_size += 1024;
+  }
 
-fail:
-  return ret;
+  lowercase = malloc(len + 1);
+  if (lowercase == NULL)
+  {
+    log_error("malloc() failed for appdb index key");
+    return false;
+  }
+
+  /* only ascii chars are lowercased, utf-8 sequences are kept intact */
+  for (i = 0; i < len; i++)
+  {
+    lowercase[i] = key[i] >= 'A' && key[i] <= 'Z' ? key[i] - 'A' + 'a' : key[i];
+  }
+  lowercase[len] = 0;
+
+  g_appdb.index[g_appdb.index_count].key = lowercase;
+  g_appdb.index[g_appdb.index_count].file_ptr = file_ptr;
+  g_appdb.index_count++;
+  return true;
 }
 
-bool
-lash_appdb_load_dirs(
-  struct list_head * appdb,
-  const char * base_directories)
+/* add whole string and each of its words */
+static bool appdb_index_add_words(const char * string, const char * separators, struct appdb_file * file_ptr)
 {
-  char * limiter;
-  char * directory;
-  char * directories;
+  size_t len;
 
-  directories = strdup(base_directories);
-  if (directories == NULL)
+  if (string == NULL)
   {
-    log_error("strdup() failed");
-    return false;
+    return true;
   }
 
-  directory = directories;
+  if (!appdb_index_add(string, strlen(string), file_ptr))
+  {
+    return false;
+  }
 
-  do
+  while (*string != 0)
   {
-    limiter = strchr(directory, ':');
-    if (limiter != NULL)
+    string += strspn(string, separators);
+    len = strcspn(string, separators);
+    if (!appdb_index_add(string, len, file_ptr))
     {
-      *limiter = 0;
+      return false;
     }
 
-    if (!lash_appdb_load_dir(appdb, directory))
+    string += len;
+  }
+
+  return true;
+}
+
+static int appdb_index_key_compare(const void * a, const void * b)
+{
+  return strcmp(((const struct appdb_index_key *)a)->key, ((const struct appdb_index_key *)b)->key);
+}
+
+static void appdb_index_clear(void)
+{
+  while (g_appdb.index_count > 0)
+  {
+    free(g_appdb.index[--g_appdb.index_count].key);
+  }
+}
+
+static bool appdb_index_build(void)
+{
+  unsigned int i;
+  struct list_head * node_ptr;
+  struct appdb_file * file_ptr;
+
+  appdb_index_clear();
+
+  for (i = 0; i < APPDB_HASH_SIZE; i++)
+  {
+    list_for_each(node_ptr, g_appdb.files + i)
     {
-      free(directories);
-      return false;
-    }
+      file_ptr = list_entry(node_ptr, struct appdb_file, siblings);
+      if (file_ptr->entry_ptr == NULL)
+      {
+        continue;
+      }
 
-    directory = limiter + 1;
+      if (!appdb_index_add_words(file_ptr->entry_ptr->name, " -", file_ptr) ||
+          !appdb_index_add_words(file_ptr->entry_ptr->keywords, ";", file_ptr))
+      {
+        appdb_index_clear();
+        return false;
+      }
+    }
   }
-  while (limiter != NULL);
 
-  free(directories);
+  qsort(g_appdb.index, g_appdb.index_count, sizeof(struct appdb_index_key), appdb_index_key_compare);
 
+  g_appdb.index_dirty = false;
   return true;
 }
 
-bool
-lash_appdb_load(
-  struct list_head * appdb)
+bool lash_appdb_init(void)
 {
-  const char * data_home;
+  const char * home_dir;
   char * data_home_default;
+  const char * data_home;
   const char * data_dirs;
-  const char * home_dir;
-  bool ret;
-
-  ret = false;
+  const char * limiter;
+  unsigned int i;
 
-  INIT_LIST_HEAD(appdb);
-
-  //log_info("lash_appdb_load() called.");
+  INIT_LIST_HEAD(&g_appdb.dirs);
+  g_appdb.dir_count = 0;
+  for (i = 0; i < APPDB_HASH_SIZE; i++)
+  {
+    INIT_LIST_HEAD(g_appdb.files + i);
+  }
+  g_appdb.app_count = 0;
+  g_appdb.scan_dir_ptr = NULL;
+  g_appdb.scan_dir = NULL;
+  g_appdb.index = NULL;
+  g_appdb.index_count = 0;
+  g_appdb.index_size = 0;
+  g_appdb.index_dirty = true;
+  g_appdb.query_serial = 0;
+
+  g_appdb.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (g_appdb.inotify_fd == -1)
+  {
+    log_error("inotify_init1() failed, appdb will not be refreshed: %d (%s)", errno, strerror(errno));
+  }
 
   home_dir = getenv("HOME");
   if (home_dir == NULL)
   {
     log_error("HOME environment variable is not set.");
-    goto fail;
+    return true;
   }
 
   data_home_default = catdup(home_dir, "/.local/share");
   if (data_home_default == NULL)
   {
     log_error("catdup failed to compose data_home_default");
-    goto fail;
+    return false;
   }
 
   data_home = get_xdg_var("XDG_DATA_HOME", data_home_default);
+  appdb_add_dir(data_home, strlen(data_home));
+  free(data_home_default);
 
-  if (!lash_appdb_load_dir(appdb, data_home))
+  data_dirs = get_xdg_var("XDG_DATA_DIRS", "/usr/local/share/:/usr/share/");
+  do
   {
-    goto fail_free_data_home_default;
+    limiter = strchr(data_dirs, ':');
+    appdb_add_dir(data_dirs, limiter != NULL ? (size_t)(limiter - data_dirs) : strlen(data_dirs));
+    data_dirs = limiter + 1;
   }
+  while (limiter != NULL);
 
-  data_dirs = get_xdg_var("XDG_DATA_DIRS", "/usr/local/share/:/usr/share/");
+  appdb_rescan();
+
+  return true;
+}
 
-  if (!lash_appdb_load_dirs(appdb, data_dirs))
+void lash_appdb_uninit(void)
+{
+  struct appdb_dir * dir_ptr;
+
+  appdb_rescan();
+  g_appdb.scan_dir_ptr = NULL;
+
+  appdb_index_clear();
+  free(g_appdb.index);
+
+  while (!list_empty(&g_appdb.dirs))
   {
-    goto fail_free_data_home_default;
+    dir_ptr = list_entry(g_appdb.dirs.next, struct appdb_dir, siblings);
+    list_del(&dir_ptr->siblings);
+    free(dir_ptr->path);
+    free(dir_ptr);
   }
 
-  ret = true;
+  if (g_appdb.inotify_fd != -1)
+  {
+    close(g_appdb.inotify_fd);
+  }
+}
 
-fail_free_data_home_default:
-  free(data_home_default);
+void lash_appdb_run(void)
+{
+  appdb_process_events();
+  appdb_scan(APPDB_SCAN_BATCH);
+}
+
+bool
+lash_appdb_iterate(
+  const char * filter,
+  void * context,
+  bool (* callback)(void * context, const struct lash_appdb_entry * entry_ptr))
+{
+  unsigned int i;
+  struct list_head * node_ptr;
+  struct appdb_file * file_ptr;
+  struct appdb_index_key key;
+  size_t len;
+  size_t low;
+  size_t high;
+  size_t middle;
+  bool ret;
+
+  /* pick up changes and complete the initial scan, if still in progress */
+  appdb_process_events();
+  appdb_scan(UINT_MAX);
 
-fail:
-  if (!ret)
+  if (filter == NULL || *filter == 0)
   {
-    lash_appdb_free(appdb);
+    for (i = 0; i < APPDB_HASH_SIZE; i++)
+    {
+      list_for_each(node_ptr, g_appdb.files + i)
+      {
+        file_ptr = list_entry(node_ptr, struct appdb_file, siblings);
+        if (file_ptr->entry_ptr != NULL && !callback(context, file_ptr->entry_ptr))
+        {
+          return false;
+        }
+      }
+    }
+
+    return true;
   }
 
+  if (g_appdb.index_dirty && !appdb_index_build())
+  {
+    return false;
+  }
+
+  ret = false;
+  len = strlen(filter);
+  if (!appdb_index_add(filter, len, NULL))
+  {
+    return false;
+  }
+
+  /* the filter was appended as last key, take it out */
+  key = g_appdb.index[--g_appdb.index_count];
+
+  /* lower bound of the filter in the sorted index */
+  low = 0;
+  high = g_appdb.index_count;
+  while (low < high)
+  {
+    middle = low + (high - low) / 2;
+    if (strcmp(g_appdb.index[middle].key, key.key) < 0)
+    {
+      low = middle + 1;
+    }
+    else
+    {
+      high = middle;
+    }
+  }
+
+  /* an app can match through more than one key */
+  g_appdb.query_serial++;
+
+  for (; low < g_appdb.index_count && strncmp(g_appdb.index[low].key, key.key, len) == 0; low++)
+  {
+    file_ptr = g_appdb.index[low].file_ptr;
+    if (file_ptr->query_serial == g_appdb.query_serial)
+    {
+      continue;
+    }
+
+    file_ptr->query_serial = g_appdb.query_serial;
+
+    if (!callback(context, file_ptr->entry_ptr))
+    {
+      goto exit;
+    }
+  }
+
+  ret = true;
+
+exit:
+  free(key.key);
   return ret;
 }
 
@@ -700,27 +1335,10 @@ lash_appdb_free_entry(
     free(entry_ptr->path);
   }
 
-  free(entry_ptr);
-}
-
-void
-lash_appdb_free(
-  struct list_head * appdb)
-{
-  struct list_head * node_ptr;
-  struct lash_appdb_entry * entry_ptr;
-
-  //log_info("lash_appdb_free() called.");
-
-  while (!list_empty(appdb))
+  if (entry_ptr->keywords != NULL)
   {
-    node_ptr = appdb->next;
-    entry_ptr = list_entry(node_ptr, struct lash_appdb_entry, siblings);
-
-    list_del(node_ptr);
-
-    //log_info("Destroying appdb entry '%s'", entry_ptr->name);
-
-    lash_appdb_free_entry(entry_ptr);
+    free(entry_ptr->keywords);
   }
+
+  free(entry_ptr);
 }
@@ -40,18 +40,26 @@ struct lash_appdb_entry
   char * icon;    /* Icon */
   char * exec;    /* Program to execute, possibly with arguments. */
   char * path;    /* The working directory to run the program in. */
+  char * keywords;  /* Semicolon separated list of keywords */
   bool terminal;    /* Wheter to run application in terminal */
 };
 
-/* parses .desktop entries in suitable XDG directories and returns list of lash_appdb_entry structs in appdb parameter */
+/* start incremental scan of .desktop entries in suitable XDG directories and setup inotify watches for them */
 /* returns success status */
-bool
-lash_appdb_load(
-  struct list_head * appdb);
+bool lash_appdb_init(void);
+
+void lash_appdb_uninit(void);
 
-/* free list of lash_appdb_entry structs, as returned by lash_appdb_load() */
-void
-lash_appdb_free(
-  struct list_head * appdb);
+/* continue the initial scan and process inotify events; to be called from the main loop */
+void lash_appdb_run(void);
+
+/* iterate applications, optionally only those that have name word or keyword starting with filter (case insensitive) */
+/* callback returns false to stop iteration */
+/* returns false if iteration was stopped or on failure */
+bool
+lash_appdb_iterate(
+  const char * filter,
+  void * context,
+  bool (* callback)(void * context, const struct lash_appdb_entry * entry_ptr));
 
 #endif /* #ifndef APPDB_H__4839D031_68EF_43F5_BDE2_2317C6B956A9__INCLUDED */
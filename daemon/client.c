@@ -38,6 +38,7 @@ struct ladish_client
   bool has_js_callback;                    /* Whether the client has set jack session callback */
   ladish_dict_handle dict;
   void * vgraph;                /* virtual graph */
+  uint64_t generation;          /* stamp of the last modification of the persisted properties */
 };
 
 bool
@@ -78,6 +79,7 @@ ladish_client_create(
   client_ptr->pid = 0;
   client_ptr->has_js_callback = false;
   client_ptr->vgraph = NULL;
+  client_ptr->generation = ladish_generation_next();
 
 #if 0
   {
@@ -118,6 +120,14 @@ ladish_dict_handle ladish_client_get_dict(ladish_client_handle client_handle)
   return client_ptr->dict;
 }
 
+uint64_t ladish_client_get_generation(ladish_client_handle client_handle)
+{
+  uint64_t dict_generation;
+
+  dict_generation = ladish_dict_get_generation(client_ptr->dict);
+  return dict_generation > client_ptr->generation ? dict_generation : client_ptr->generation;
+}
+
 void ladish_client_get_uuid(ladish_client_handle client_handle, uuid_t uuid)
 {
   uuid_copy(uuid, client_ptr->uuid);
@@ -167,6 +177,7 @@ pid_t ladish_client_get_pid(ladish_client_handle client_handle)
 void ladish_client_set_vgraph(ladish_client_handle client_handle, void * vgraph)
 {
   client_ptr->vgraph = vgraph;
+  client_ptr->generation = ladish_generation_next();
 }
 
 void * ladish_client_get_vgraph(ladish_client_handle client_handle)
@@ -180,16 +191,20 @@ void ladish_client_interlink(ladish_client_handle client_handle, ladish_client_h
 {
   uuid_copy(client_ptr->uuid_interlink, client2_ptr->uuid);
   uuid_copy(client2_ptr->uuid_interlink, client_ptr->uuid);
+  client_ptr->generation = ladish_generation_next();
+  client2_ptr->generation = ladish_generation_next();
 }
 
 void ladish_client_interlink_copy(ladish_client_handle client_handle, ladish_client_handle client2_handle)
 {
   uuid_copy(client_ptr->uuid_interlink, client2_ptr->uuid_interlink);
+  client_ptr->generation = ladish_generation_next();
 }
 
 void ladish_client_copy_app(ladish_client_handle client_handle, ladish_client_handle client2_handle)
 {
   uuid_copy(client_ptr->uuid_app, client2_ptr->uuid_app);
+  client_ptr->generation = ladish_generation_next();
 }
 
 #undef client2_ptr
@@ -219,11 +234,13 @@ bool ladish_client_set_interlink(ladish_client_handle client_handle, uuid_t uuid
 void ladish_client_clear_interlink(ladish_client_handle client_handle)
 {
   uuid_clear(client_ptr->uuid_interlink);
+  client_ptr->generation = ladish_generation_next();
 }
 
 void ladish_client_set_app(ladish_client_handle client_handle, const uuid_t uuid)
 {
   uuid_copy(client_ptr->uuid_app, uuid);
+  client_ptr->generation = ladish_generation_next();
 }
 
 bool ladish_client_get_app(ladish_client_handle client_handle, uuid_t uuid)
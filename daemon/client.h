@@ -46,6 +46,7 @@ ladish_client_destroy(
   ladish_client_handle client_handle);
 
 ladish_dict_handle ladish_client_get_dict(ladish_client_handle client_handle);
+uint64_t ladish_client_get_generation(ladish_client_handle client_handle);
 
 void ladish_client_get_uuid(ladish_client_handle client_handle, uuid_t uuid);
 
@@ -34,6 +34,8 @@
 #define LADISH_COMMAND_STATE_WAITING     2
 #define LADISH_COMMAND_STATE_DONE        3
 
+#define LADISH_COMMAND_WAIT_REASON_MAX 128
+
 struct ladish_command
 {
   struct list_head siblings;
@@ -44,6 +46,22 @@ struct ladish_command
   void * context;
   bool (* run)(void * context);
   void (* destructor)(void * context);
+
+  uuid_t scope;                 /* room the command operates on, null uuid for studio-wide commands */
+
+  const char * name;            /* static string, used for tracing */
+
+  /* what the command is waiting on, set by run() before returning in waiting state */
+  char wait_reason[LADISH_COMMAND_WAIT_REASON_MAX];
+
+  /* tracing, maintained by the queue, times are in microseconds */
+  uint64_t enqueue_time;
+  uint64_t start_time;          /* first run(), 0 if not started yet */
+  uint64_t run_usecs;           /* total time spent in run() */
+  unsigned int run_count;
+  uint64_t wait_start;          /* start of the current wait stage, 0 when not waiting */
+  char wait_stage_reason[LADISH_COMMAND_WAIT_REASON_MAX]; /* reason of the current wait stage */
+  uint64_t wait_usecs;          /* total time spent waiting */
 };
 
 struct ladish_cqueue
@@ -61,14 +79,28 @@ void ladish_cqueue_clear(struct ladish_cqueue * queue_ptr);
 
 void * ladish_command_new(size_t size);
 
+/* Describe what the command waits on, for the queue tracing. Call before returning from run() in waiting state */
+void
+ladish_command_set_wait_reason(
+  struct ladish_command * cmd_ptr,
+  const char * format,
+  ...)
+#if defined (__GNUC__)
+  __attribute__((format(printf, 2, 3)))
+#endif
+  ;
+
 bool ladish_command_new_studio(void * call_ptr, struct ladish_cqueue * queue_ptr, const char * studio_name);
 bool ladish_command_load_studio(void * call_ptr, struct ladish_cqueue * queue_ptr, const char * studio_name, bool autostart);
 bool ladish_command_rename_studio(void * call_ptr, struct ladish_cqueue * queue_ptr, const char * studio_name);
 bool ladish_command_save_studio(void * call_ptr, struct ladish_cqueue * queue_ptr, const char * new_studio_name);
 bool ladish_command_start_studio(void * call_ptr, struct ladish_cqueue * queue_ptr);
-bool ladish_command_stop_studio(void * call_ptr, struct ladish_cqueue * queue_ptr);
-bool ladish_command_unload_studio(void * call_ptr, struct ladish_cqueue * queue_ptr);
+bool ladish_command_stop_studio(void * call_ptr, struct ladish_cqueue * queue_ptr, bool keep_jack);
+bool ladish_command_unload_studio(void * call_ptr, struct ladish_cqueue * queue_ptr, bool keep_jack);
 bool ladish_command_exit(void * call_ptr, struct ladish_cqueue * queue_ptr);
+bool ladish_command_switch_studio(void * call_ptr, struct ladish_cqueue * queue_ptr, const char * studio_name);
+bool ladish_command_detach_studio_apps(void * call_ptr, struct ladish_cqueue * queue_ptr);
+bool ladish_command_adopt_studio_apps(void * call_ptr, struct ladish_cqueue * queue_ptr);
 
 bool
 ladish_command_new_app(
@@ -106,4 +138,11 @@ ladish_command_load_project(
   const uuid_t room_uuid_ptr,
   const char * project_dir);
 
+bool
+ladish_command_switch_project(
+  void * call_ptr,
+  struct ladish_cqueue * queue_ptr,
+  const uuid_t room_uuid_ptr,
+  const char * project_dir);
+
 #endif /* #ifndef CMD_H__28542C9B_7CB8_40F8_BBB6_DCE13CBB1E7F__INCLUDED */
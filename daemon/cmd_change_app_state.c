@@ -87,6 +87,8 @@ run_target_stop(
 
   if (ladish_app_is_running(app))
   {
+    ladish_command_set_wait_reason(&cmd_ptr->command, "'%s' process termination (%s)", app_name, cmd_ptr->target_state_description);
+
     if (cmd_ptr->command.state == LADISH_COMMAND_STATE_PENDING)
     {
       cmd_ptr->initiate_stop(app);
@@ -102,6 +104,7 @@ run_target_stop(
   if (!ladish_virtualizer_is_hidden_app(ladish_studio_get_jack_graph(), app_uuid, app_name))
   {
     log_info("Waiting '%s' client disappear (%s)...", app_name, cmd_ptr->target_state_description);
+    ladish_command_set_wait_reason(&cmd_ptr->command, "'%s' JACK clients disappear", app_name);
     return true;
   }
 
@@ -156,6 +159,7 @@ static void destructor(void * context)
 bool ladish_command_change_app_state(void * call_ptr, struct ladish_cqueue * queue_ptr, const char * opath, uint64_t id, unsigned int target_state)
 {
   struct ladish_command_change_app_state * cmd_ptr;
+  ladish_room_handle room;
   char * opath_dup;
 
   opath_dup = strdup(opath);
@@ -173,6 +177,7 @@ bool ladish_command_change_app_state(void * call_ptr, struct ladish_cqueue * que
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "change app state";
   cmd_ptr->command.destructor = destructor;
   cmd_ptr->opath = opath_dup;
   cmd_ptr->id = id;
@@ -201,6 +206,13 @@ bool ladish_command_change_app_state(void * call_ptr, struct ladish_cqueue * que
     goto fail_destroy_command;
   }
 
+  /* commands for apps of different rooms can run in parallel */
+  room = ladish_studio_find_room_by_opath(opath);
+  if (room != NULL)
+  {
+    ladish_room_get_uuid(room, cmd_ptr->command.scope);
+  }
+
   if (!ladish_cqueue_add_command(queue_ptr, &cmd_ptr->command))
   {
     cdbus_error(call_ptr, DBUS_ERROR_FAILED, "ladish_cqueue_add_command() failed.");
@@ -120,6 +120,7 @@ bool ladish_command_create_room(void * call_ptr, struct ladish_cqueue * queue_pt
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "create room";
   cmd_ptr->command.destructor = destructor;
   cmd_ptr->room_name = room_name_dup;
   cmd_ptr->template_name = template_name_dup;
@@ -61,6 +61,7 @@ found:
   if (cmd_ptr->command.state == LADISH_COMMAND_STATE_PENDING)
   {
     ladish_room_initiate_stop(room, true);
+    ladish_command_set_wait_reason(&cmd_ptr->command, "room '%s' stop", cmd_ptr->name);
     cmd_ptr->command.state = LADISH_COMMAND_STATE_WAITING;
     return true;
   }
@@ -112,6 +113,7 @@ bool ladish_command_delete_room(void * call_ptr, struct ladish_cqueue * queue_pt
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "delete room";
   cmd_ptr->command.destructor = destructor;
   cmd_ptr->name = room_name_dup;
 
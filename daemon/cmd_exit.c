@@ -44,7 +44,7 @@ bool ladish_command_exit(void * call_ptr, struct ladish_cqueue * queue_ptr)
 {
   struct ladish_command * cmd_ptr;
 
-  if (!ladish_command_unload_studio(call_ptr, queue_ptr))
+  if (!ladish_command_unload_studio(call_ptr, queue_ptr, false))
   {
     goto fail;
   }
@@ -57,6 +57,7 @@ bool ladish_command_exit(void * call_ptr, struct ladish_cqueue * queue_ptr)
   }
 
   cmd_ptr->run = run;
+  cmd_ptr->name = "exit";
 
   if (!ladish_cqueue_add_command(queue_ptr, cmd_ptr))
   {
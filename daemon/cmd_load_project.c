@@ -72,6 +72,38 @@ static void destructor(void * command_context)
 
 #undef cmd_ptr
 
+struct ladish_command_detach_room_apps
+{
+  struct ladish_command command;
+  uuid_t room_uuid;
+};
+
+#define cmd_ptr ((struct ladish_command_detach_room_apps *)command_context)
+
+static bool run_detach(void * command_context)
+{
+  ladish_room_handle room;
+  unsigned int count;
+
+  ASSERT(cmd_ptr->command.state == LADISH_COMMAND_STATE_PENDING);
+
+  room = ladish_studio_find_room_by_uuid(cmd_ptr->room_uuid);
+  if (room == NULL)
+  {
+    log_error("Cannot switch project in unknown room");
+    ladish_notify_simple(LADISH_NOTIFY_URGENCY_HIGH, "Cannot switch project in unknown room", NULL);
+    return false;
+  }
+
+  count = ladish_room_detach_running_apps(room);
+  log_info("%u running room apps detached", count);
+
+  cmd_ptr->command.state = LADISH_COMMAND_STATE_DONE;
+  return true;
+}
+
+#undef cmd_ptr
+
 bool
 ladish_command_load_project(
   void * call_ptr,
@@ -102,8 +134,10 @@ ladish_command_load_project(
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "load project";
   cmd_ptr->command.destructor = destructor;
   uuid_copy(cmd_ptr->room_uuid, room_uuid_ptr);
+  uuid_copy(cmd_ptr->command.scope, room_uuid_ptr);
   cmd_ptr->project_dir = project_dir_dup;
 
   if (!ladish_cqueue_add_command(queue_ptr, &cmd_ptr->command))
@@ -123,3 +157,48 @@ fail_drop_unload_command:
 fail:
   return false;
 }
+
+/* Same as project load but apps that are running in the room and have same
+ * name, commandline, level and terminal flag in the new project are not restarted */
+bool
+ladish_command_switch_project(
+  void * call_ptr,
+  struct ladish_cqueue * queue_ptr,
+  const uuid_t room_uuid_ptr,
+  const char * project_dir)
+{
+  struct ladish_command_detach_room_apps * cmd_ptr;
+
+  cmd_ptr = ladish_command_new(sizeof(struct ladish_command_detach_room_apps));
+  if (cmd_ptr == NULL)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "ladish_command_new() failed.");
+    goto fail;
+  }
+
+  cmd_ptr->command.run = run_detach;
+  cmd_ptr->command.name = "detach room apps";
+  uuid_copy(cmd_ptr->room_uuid, room_uuid_ptr);
+  uuid_copy(cmd_ptr->command.scope, room_uuid_ptr);
+
+  if (!ladish_cqueue_add_command(queue_ptr, &cmd_ptr->command))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "ladish_cqueue_add_command() failed.");
+    goto fail_destroy_command;
+  }
+
+  if (!ladish_command_load_project(call_ptr, queue_ptr, room_uuid_ptr, project_dir))
+  {
+    goto fail_drop_detach_command;
+  }
+
+  return true;
+
+fail_drop_detach_command:
+  ladish_cqueue_drop_command(queue_ptr);
+  return false;
+fail_destroy_command:
+  free(cmd_ptr);
+fail:
+  return false;
+}
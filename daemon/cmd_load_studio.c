@@ -796,9 +796,9 @@ static void callback_elend(void * data, const char * UNUSED(el))
       goto fail_free_address;
     }
 
-    if (!jack_proxy_set_parameter_value(address, &parameter))
+    if (!jack_proxy_conf_stage_set(address, &parameter))
     {
-      log_error("jack_proxy_set_parameter_value() failed");
+      log_error("jack_proxy_conf_stage_set() failed");
       goto fail_free_address;
     }
 
@@ -899,6 +899,7 @@ static bool run(void * command_context)
   int fd;
   enum XML_Status xmls;
   struct ladish_parse_context parse_context;
+  unsigned int jack_params_changed;
 
   ASSERT(cmd_ptr->command.state == LADISH_COMMAND_STATE_PENDING);
 
@@ -922,12 +923,6 @@ static bool run(void * command_context)
 
   g_studio.filename = path;
 
-  if (!jack_reset_all_params())
-  {
-    log_error("jack_reset_all_params() failed");
-    return false;
-  }
-
   fd = open(path, O_RDONLY);
   if (fd == -1)
   {
@@ -985,6 +980,16 @@ static bool run(void * command_context)
     return false;
   }
 
+  /* JACK parameters are staged during the parse and applied after it, only the ones that differ */
+  if (!jack_proxy_conf_stage_begin())
+  {
+    log_error("jack_proxy_conf_stage_begin() failed");
+    ladish_studio_clear();
+    XML_ParserFree(parser);
+    close(fd);
+    return false;
+  }
+
   xmls = XML_ParseBuffer(parser, bytes_read, XML_TRUE);
   if (xmls == XML_STATUS_ERROR)
   {
@@ -993,6 +998,7 @@ static bool run(void * command_context)
       log_error("XML_ParseBuffer() failed.");
     }
 
+    jack_proxy_conf_stage_abort();
     ladish_notify_simple(LADISH_NOTIFY_URGENCY_HIGH, "Studio load failed", LADISH_CHECK_LOG_TEXT);
     ladish_studio_clear();
     XML_ParserFree(parser);
@@ -1005,11 +1011,34 @@ static bool run(void * command_context)
 
   if (parse_context.error)
   {
+    jack_proxy_conf_stage_abort();
     ladish_studio_clear();
     ladish_notify_simple(LADISH_NOTIFY_URGENCY_HIGH, "Studio load failed", LADISH_CHECK_LOG_TEXT);
     return false;
   }
 
+  if (!jack_proxy_conf_stage_commit(&jack_params_changed))
+  {
+    log_error("jack_proxy_conf_stage_commit() failed");
+    ladish_studio_clear();
+    ladish_notify_simple(LADISH_NOTIFY_URGENCY_HIGH, "Studio load failed", LADISH_CHECK_LOG_TEXT);
+    return false;
+  }
+
+  if (g_studio.jack_kept && jack_params_changed != 0)
+  {
+    /* the running server has settings of the previous studio */
+    if (ladish_app_supervisor_get_detached_app_count(NULL) == 0)
+    {
+      ladish_studio_release_kept_jack();
+    }
+    else
+    {
+      /* detached apps of studio switch must be stopped first */
+      g_studio.jack_kept_outdated = true;
+    }
+  }
+
   ladish_interlink(ladish_studio_get_studio_graph(), ladish_studio_get_studio_app_supervisor());
 
   g_studio.persisted = true;
@@ -1055,7 +1084,8 @@ bool ladish_command_load_studio(void * call_ptr, struct ladish_cqueue * queue_pt
     goto fail;
   }
 
-  if (!ladish_command_unload_studio(call_ptr, queue_ptr))
+  /* JACK server is kept running, it is restarted only if the new studio has different JACK settings */
+  if (!ladish_command_unload_studio(call_ptr, queue_ptr, autostart))
   {
     goto fail_free_name;
   }
@@ -1068,6 +1098,7 @@ bool ladish_command_load_studio(void * call_ptr, struct ladish_cqueue * queue_pt
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "load studio";
   cmd_ptr->command.destructor = destructor;
   cmd_ptr->studio_name = studio_name_dup;
 
@@ -1102,3 +1133,73 @@ fail_free_name:
 fail:
   return false;
 }
+
+bool ladish_command_switch_studio(void * call_ptr, struct ladish_cqueue * queue_ptr, const char * studio_name)
+{
+  struct ladish_command_load_studio * cmd_ptr;
+  char * studio_name_dup;
+
+  studio_name_dup = strdup(studio_name);
+  if (studio_name_dup == NULL)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "strdup('%s') failed.", studio_name);
+    goto fail;
+  }
+
+  if (!ladish_command_detach_studio_apps(call_ptr, queue_ptr))
+  {
+    goto fail_free_name;
+  }
+
+  /* stop and unload commands */
+  if (!ladish_command_unload_studio(call_ptr, queue_ptr, true))
+  {
+    goto fail_drop_detach_command;
+  }
+
+  cmd_ptr = ladish_command_new(sizeof(struct ladish_command_load_studio));
+  if (cmd_ptr == NULL)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "ladish_command_new() failed.");
+    goto fail_drop_unload_commands;
+  }
+
+  cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "load studio";
+  cmd_ptr->command.destructor = destructor;
+  cmd_ptr->studio_name = studio_name_dup;
+
+  if (!ladish_cqueue_add_command(queue_ptr, &cmd_ptr->command))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "ladish_cqueue_add_command() failed.");
+    free(cmd_ptr);
+    goto fail_drop_unload_commands;
+  }
+
+  if (!ladish_command_adopt_studio_apps(call_ptr, queue_ptr))
+  {
+    goto fail_drop_load_command;
+  }
+
+  if (!ladish_command_start_studio(call_ptr, queue_ptr))
+  {
+    goto fail_drop_adopt_command;
+  }
+
+  return true;
+
+fail_drop_adopt_command:
+  ladish_cqueue_drop_command(queue_ptr);
+fail_drop_load_command:
+  ladish_cqueue_drop_command(queue_ptr); /* the destructor frees the name */
+  studio_name_dup = NULL;
+fail_drop_unload_commands:
+  ladish_cqueue_drop_command(queue_ptr);
+  ladish_cqueue_drop_command(queue_ptr);
+fail_drop_detach_command:
+  ladish_cqueue_drop_command(queue_ptr);
+fail_free_name:
+  free(studio_name_dup);
+fail:
+  return false;
+}
@@ -169,6 +169,7 @@ ladish_command_new_app(
   const char * level)
 {
   struct ladish_command_new_app * cmd_ptr;
+  ladish_room_handle room;
   char * opath_dup;
   char * commandline_dup;
   char * name_dup;
@@ -210,6 +211,7 @@ ladish_command_new_app(
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "new app";
   cmd_ptr->command.destructor = destructor;
   cmd_ptr->opath = opath_dup;
   cmd_ptr->commandline = commandline_dup;
@@ -217,6 +219,13 @@ ladish_command_new_app(
   cmd_ptr->terminal = terminal;
   cmd_ptr->level = level_dup;
 
+  /* commands for apps of different rooms can run in parallel */
+  room = ladish_studio_find_room_by_opath(opath);
+  if (room != NULL)
+  {
+    ladish_room_get_uuid(room, cmd_ptr->command.scope);
+  }
+
   if (!ladish_cqueue_add_command(queue_ptr, &cmd_ptr->command))
   {
     cdbus_error(call_ptr, DBUS_ERROR_FAILED, "ladish_cqueue_add_command() failed.");
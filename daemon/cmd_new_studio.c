@@ -79,7 +79,7 @@ bool ladish_command_new_studio(void * call_ptr, struct ladish_cqueue * queue_ptr
   struct ladish_command_new_studio * cmd_ptr;
   char * studio_name_dup;
 
-  if (!ladish_command_unload_studio(call_ptr, queue_ptr))
+  if (!ladish_command_unload_studio(call_ptr, queue_ptr, false))
   {
     goto fail;
   }
@@ -99,6 +99,7 @@ bool ladish_command_new_studio(void * call_ptr, struct ladish_cqueue * queue_ptr
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "new studio";
   cmd_ptr->command.destructor = destructor;
   cmd_ptr->studio_name = studio_name_dup;
 
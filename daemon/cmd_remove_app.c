@@ -99,6 +99,7 @@ static void destructor(void * context)
 bool ladish_command_remove_app(void * call_ptr, struct ladish_cqueue * queue_ptr, const char * opath, uint64_t id)
 {
   struct ladish_command_remove_app * cmd_ptr;
+  ladish_room_handle room;
   char * opath_dup;
 
   if (!ladish_command_change_app_state(call_ptr, queue_ptr, opath, id, LADISH_APP_STATE_STOPPED))
@@ -121,10 +122,18 @@ bool ladish_command_remove_app(void * call_ptr, struct ladish_cqueue * queue_ptr
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "remove app";
   cmd_ptr->command.destructor = destructor;
   cmd_ptr->opath = opath_dup;
   cmd_ptr->id = id;
 
+  /* commands for apps of different rooms can run in parallel */
+  room = ladish_studio_find_room_by_opath(opath);
+  if (room != NULL)
+  {
+    ladish_room_get_uuid(room, cmd_ptr->command.scope);
+  }
+
   if (!ladish_cqueue_add_command(queue_ptr, &cmd_ptr->command))
   {
     cdbus_error(call_ptr, DBUS_ERROR_FAILED, "ladish_cqueue_add_command() failed.");
@@ -84,6 +84,7 @@ bool ladish_command_rename_studio(void * call_ptr, struct ladish_cqueue * queue_
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "rename studio";
   cmd_ptr->command.destructor = destructor;
   cmd_ptr->studio_name = studio_name_dup;
 
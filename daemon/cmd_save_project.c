@@ -82,6 +82,7 @@ static bool run(void * command_context)
   }
 
   cmd_ptr->command.state = LADISH_COMMAND_STATE_WAITING;
+  ladish_command_set_wait_reason(&cmd_ptr->command, "room '%s' apps save", ladish_room_get_name(room));
 
   ladish_room_save_project(room, cmd_ptr->project_dir, cmd_ptr->project_name, cmd_ptr, ladish_room_project_save_complete);
 
@@ -131,8 +132,10 @@ ladish_command_save_project(
   }
 
   uuid_copy(cmd_ptr->room_uuid, room_uuid_ptr);
+  uuid_copy(cmd_ptr->command.scope, room_uuid_ptr);
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "save project";
   cmd_ptr->command.destructor = destructor;
   cmd_ptr->project_dir = project_dir_dup;
   cmd_ptr->project_name = project_name_dup;
@@ -39,6 +39,7 @@
 #include "cmd.h"
 #include "../proxies/notify_proxy.h"
 #include "save.h"
+#include "metadata_index.h"
 
 #define STUDIO_HEADER_TEXT BASE_NAME " Studio configuration.\n"
 
@@ -180,151 +181,206 @@ static bool save_studio_room(void * context, ladish_room_handle room)
 #undef indent
 #undef fd
 
-struct ladish_command_save_studio
+static bool count_studio_room(void * context, ladish_room_handle UNUSED(room))
 {
-  struct ladish_command command;
-  char * studio_name;
-  bool done;
-  bool success;
-};
+  (*(unsigned int *)context)++;
+  return true;
+}
 
-static bool ladish_save_studio_xml(struct ladish_command_save_studio * cmd_ptr)
+/* compose short summary of the jack settings, like "driver=alsa rate=48000 period=256 nperiods=2" */
+static char * compose_jack_settings_summary(void)
 {
+  static const struct
+  {
+    const char * address;
+    size_t address_size;
+    const char * key;
+  } summary_params[] =
+  {
+#define SUMMARY_PARAM(address, key) {address, sizeof(address), key}
+    SUMMARY_PARAM("engine\0driver\0", "driver"),
+    SUMMARY_PARAM("driver\0rate\0", "rate"),
+    SUMMARY_PARAM("driver\0period\0", "period"),
+    SUMMARY_PARAM("driver\0nperiods\0", "nperiods"),
+#undef SUMMARY_PARAM
+  };
   struct list_head * node_ptr;
   struct jack_conf_parameter * parameter_ptr;
-  int fd;
-  time_t timestamp;
-  char timestamp_str[26];
-  bool ret;
-  char * filename;              /* filename */
-  char * bak_filename;          /* filename of the backup file */
-  char * old_filename;          /* filename where studio was persisted before save */
-  struct stat st;
-  struct ladish_write_context save_context;
-  bool renaming;
+  char summary[1024];
+  size_t len;
+  size_t i;
+  int ret;
 
-  ret = false;
+  summary[0] = 0;
+  len = 0;
 
-  time(&timestamp);
-  ctime_r(&timestamp, timestamp_str);
-  timestamp_str[24] = 0;
-
-  if (!ladish_studio_compose_filename(cmd_ptr->studio_name, &filename, &bak_filename))
+  for (i = 0; i < sizeof(summary_params) / sizeof(summary_params[0]); i++)
   {
-    log_error("failed to compose studio filename");
-    goto exit;
-  }
+    list_for_each(node_ptr, &g_studio.jack_params)
+    {
+      parameter_ptr = list_entry(node_ptr, struct jack_conf_parameter, leaves);
+      if (memcmp(parameter_ptr->address, summary_params[i].address, summary_params[i].address_size) != 0)
+      {
+        continue;
+      }
 
-  /* whether save will initiate a rename */
-  renaming = strcmp(cmd_ptr->studio_name, g_studio.name) != 0;
+      switch (parameter_ptr->parameter.type)
+      {
+      case jack_string:
+        ret = snprintf(summary + len, sizeof(summary) - len, "%s%s=%s", len == 0 ? "" : " ", summary_params[i].key, parameter_ptr->parameter.value.string);
+        break;
+      case jack_uint32:
+        ret = snprintf(summary + len, sizeof(summary) - len, "%s%s=%" PRIu32, len == 0 ? "" : " ", summary_params[i].key, parameter_ptr->parameter.value.uint32);
+        break;
+      case jack_int32:
+        ret = snprintf(summary + len, sizeof(summary) - len, "%s%s=%" PRIi32, len == 0 ? "" : " ", summary_params[i].key, parameter_ptr->parameter.value.int32);
+        break;
+      default:
+        ret = 0;
+      }
 
-  if (g_studio.filename == NULL)
-  {
-    /* saving studio for first time */
-    g_studio.filename = filename;
-    free(bak_filename);
-    bak_filename = NULL;
-    old_filename = NULL;
-  }
-  else if (strcmp(g_studio.filename, filename) == 0)
-  {
-    /* saving already persisted studio that was not renamed */
-    old_filename = filename;
+      if (ret > 0 && (size_t)ret < sizeof(summary) - len)
+      {
+        len += ret;
+      }
+      else
+      {
+        summary[len] = 0;       /* truncated, drop the partial item */
+      }
+
+      break;
+    }
   }
-  else if (!renaming)
+
+  return len == 0 ? NULL : strdup(summary);
+}
+
+static void ladish_studio_update_metadata_index(void)
+{
+  unsigned int rooms;
+  unsigned int apps;
+  char * jack_settings;
+
+  rooms = 0;
+  ladish_studio_iterate_rooms(&rooms, count_studio_room);
+
+  apps = ladish_app_supervisor_get_app_count(g_studio.app_supervisor);
+
+  jack_settings = compose_jack_settings_summary();
+
+  ladish_metadata_index_update(g_studio.filename, g_studio.name, rooms, apps, jack_settings);
+  ladish_metadata_index_flush();
+
+  free(jack_settings);          /* safe if NULL */
+}
+
+static bool write_studio_jgraph(void * UNUSED(context), int fd)
+{
+  if (!ladish_write_jgraph(fd, 2, ladish_studio_get_studio_graph(), ladish_studio_get_studio_app_supervisor()))
   {
-    /* saving already renamed studio */
-    old_filename = g_studio.filename;
-    g_studio.filename = filename;
+    log_error("ladish_write_jgraph() failed for studio graph");
+    return false;
   }
-  else
+
+  return true;
+}
+
+static bool write_studio_vgraph(void * UNUSED(context), int fd)
+{
+  if (!ladish_write_vgraph(fd, 1, g_studio.studio_graph, g_studio.app_supervisor))
   {
-    /* saving studio copy (save as) */
-    old_filename = filename;
-    g_studio.filename = filename;
+    log_error("ladish_write_vgraph() failed for studio");
+    return false;
   }
 
-  filename = NULL;
-  ASSERT(g_studio.filename != NULL);
-  ASSERT(g_studio.filename != bak_filename);
+  return ladish_write_dict(fd, 1, ladish_graph_get_dict(g_studio.studio_graph));
+}
 
-  if (bak_filename != NULL)
-  {
-    ASSERT(old_filename != NULL);
+static uint64_t max_generation(uint64_t generation1, uint64_t generation2)
+{
+  return generation1 > generation2 ? generation1 : generation2;
+}
 
-    if (stat(old_filename, &st) == 0) /* if old filename does not exist, rename with fail */
-    {
-      if (rename(old_filename, bak_filename) != 0)
-      {
-        log_error("rename(%s, %s) failed: %d (%s)", old_filename, bak_filename, errno, strerror(errno));
-        goto free_filenames;
-      }
-    }
-    else
-    {
-      /* mark that there is no backup file */
-      free(bak_filename);
-      bak_filename = NULL;
-    }
-  }
+/* whether studio xml on disk matches the studio state, so saving it again would not change anything */
+static bool ladish_studio_is_unchanged(void)
+{
+  struct stat st;
 
-  log_info("saving studio... (%s)", g_studio.filename);
+  if (!g_studio.persisted || g_studio.saved_generation == 0)
+  {
+    return false;
+  }
 
-  fd = open(g_studio.filename, O_WRONLY | O_TRUNC | O_CREAT, 0666);
-  if (fd == -1)
+  if (g_studio.saved_jack_conf_generation != g_studio.jack_conf_generation ||
+      g_studio.saved_generation != ladish_studio_get_generation())
   {
-    log_error("open(%s) failed: %d (%s)", g_studio.filename, errno, strerror(errno));
-    goto rename_back;
+    return false;
   }
 
+  return stat(g_studio.filename, &st) == 0;
+}
+
+/* write studio xml from the current state, also used for autosave snapshots */
+bool ladish_studio_write_xml(int fd)
+{
+  struct list_head * node_ptr;
+  struct jack_conf_parameter * parameter_ptr;
+  time_t timestamp;
+  char timestamp_str[26];
+  struct ladish_write_context save_context;
+
+  time(&timestamp);
+  ctime_r(&timestamp, timestamp_str);
+  timestamp_str[24] = 0;
+
   if (!ladish_write_string(fd, "<?xml version=\"1.0\"?>\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, "<!--\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, STUDIO_HEADER_TEXT))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, "-->\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, "<!-- "))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, timestamp_str))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, " -->\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, "<studio>\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_indented_string(fd, 1, "<jack>\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_indented_string(fd, 2, "<conf>\n"))
   {
-    goto close;
+    return false;
   }
 
   list_for_each(node_ptr, &g_studio.jack_params)
@@ -333,31 +389,35 @@ static bool ladish_save_studio_xml(struct ladish_command_save_studio * cmd_ptr)
 
     if (!write_jack_parameter(fd, 3, parameter_ptr))
     {
-      goto close;
+      return false;
     }
   }
 
   if (!ladish_write_indented_string(fd, 2, "</conf>\n"))
   {
-    goto close;
+    return false;
   }
 
-  if (!ladish_write_jgraph(fd, 2, ladish_studio_get_studio_graph(), ladish_studio_get_studio_app_supervisor()))
+  if (!ladish_write_fragment(
+        fd,
+        &g_studio.jgraph_fragment,
+        max_generation(ladish_graph_get_generation(g_studio.jack_graph), ladish_app_supervisor_get_generation(g_studio.app_supervisor)),
+        NULL,
+        write_studio_jgraph))
   {
-    log_error("ladish_write_jgraph() failed for studio graph");
-    goto close;
+    return false;
   }
 
   if (!ladish_write_indented_string(fd, 1, "</jack>\n"))
   {
-    goto close;
+    return false;
   }
 
   if (ladish_studio_has_rooms())
   {
     if (!ladish_write_indented_string(fd, 1, "<rooms>\n"))
     {
-      goto close;
+      return false;
     }
 
     save_context.indent = 2;
@@ -366,27 +426,140 @@ static bool ladish_save_studio_xml(struct ladish_command_save_studio * cmd_ptr)
     if (!ladish_studio_iterate_rooms(&save_context, save_studio_room))
     {
       log_error("ladish_studio_iterate_rooms() failed");
-      goto close;
+      return false;
     }
 
     if (!ladish_write_indented_string(fd, 1, "</rooms>\n"))
     {
-      goto close;
+      return false;
     }
   }
 
-  if (!ladish_write_vgraph(fd, 1, g_studio.studio_graph, g_studio.app_supervisor))
+  if (!ladish_write_fragment(
+        fd,
+        &g_studio.vgraph_fragment,
+        max_generation(ladish_graph_get_generation(g_studio.studio_graph), ladish_app_supervisor_get_generation(g_studio.app_supervisor)),
+        NULL,
+        write_studio_vgraph))
   {
-    log_error("ladish_write_vgraph() failed for studio");
-    goto close;
+    return false;
   }
 
-  if (!ladish_write_dict(fd, 1, ladish_graph_get_dict(g_studio.studio_graph)))
+  if (!ladish_write_string(fd, "</studio>\n"))
   {
-    goto close;
+    return false;
   }
 
-  if (!ladish_write_string(fd, "</studio>\n"))
+  return true;
+}
+
+struct ladish_command_save_studio
+{
+  struct ladish_command command;
+  char * studio_name;
+  bool done;
+  bool success;
+};
+
+static bool ladish_save_studio_xml(struct ladish_command_save_studio * cmd_ptr)
+{
+  int fd;
+  bool ret;
+  char * filename;              /* filename */
+  char * bak_filename;          /* filename of the backup file */
+  char * old_filename;          /* filename where studio was persisted before save */
+  struct stat st;
+  bool renaming;
+
+  ret = false;
+
+  if (!ladish_studio_refresh_jack_settings())
+  {
+    log_error("no valid JACK settings to save");
+    goto exit;
+  }
+
+  if (!ladish_studio_compose_filename(cmd_ptr->studio_name, &filename, &bak_filename))
+  {
+    log_error("failed to compose studio filename");
+    goto exit;
+  }
+
+  /* whether save will initiate a rename */
+  renaming = strcmp(cmd_ptr->studio_name, g_studio.name) != 0;
+
+  if (!renaming &&
+      g_studio.filename != NULL &&
+      strcmp(g_studio.filename, filename) == 0 &&
+      ladish_studio_is_unchanged())
+  {
+    log_info("studio is not modified, nothing to save (%s)", g_studio.filename);
+    free(filename);
+    free(bak_filename);
+    ret = true;
+    goto exit;
+  }
+
+  if (g_studio.filename == NULL)
+  {
+    /* saving studio for first time */
+    g_studio.filename = filename;
+    free(bak_filename);
+    bak_filename = NULL;
+    old_filename = NULL;
+  }
+  else if (strcmp(g_studio.filename, filename) == 0)
+  {
+    /* saving already persisted studio that was not renamed */
+    old_filename = filename;
+  }
+  else if (!renaming)
+  {
+    /* saving already renamed studio */
+    old_filename = g_studio.filename;
+    g_studio.filename = filename;
+  }
+  else
+  {
+    /* saving studio copy (save as) */
+    old_filename = filename;
+    g_studio.filename = filename;
+  }
+
+  filename = NULL;
+  ASSERT(g_studio.filename != NULL);
+  ASSERT(g_studio.filename != bak_filename);
+
+  if (bak_filename != NULL)
+  {
+    ASSERT(old_filename != NULL);
+
+    if (stat(old_filename, &st) == 0) /* if old filename does not exist, rename with fail */
+    {
+      if (rename(old_filename, bak_filename) != 0)
+      {
+        log_error("rename(%s, %s) failed: %d (%s)", old_filename, bak_filename, errno, strerror(errno));
+        goto free_filenames;
+      }
+    }
+    else
+    {
+      /* mark that there is no backup file */
+      free(bak_filename);
+      bak_filename = NULL;
+    }
+  }
+
+  log_info("saving studio... (%s)", g_studio.filename);
+
+  fd = open(g_studio.filename, O_WRONLY | O_TRUNC | O_CREAT, 0666);
+  if (fd == -1)
+  {
+    log_error("open(%s) failed: %d (%s)", g_studio.filename, errno, strerror(errno));
+    goto rename_back;
+  }
+
+  if (!ladish_studio_write_xml(fd))
   {
     goto close;
   }
@@ -394,6 +567,8 @@ static bool ladish_save_studio_xml(struct ladish_command_save_studio * cmd_ptr)
   log_info("studio saved. (%s)", g_studio.filename);
   g_studio.persisted = true;
   g_studio.automatic = false;   /* even if it was automatic, it is not anymore because it is saved */
+  g_studio.saved_generation = ladish_studio_get_generation();
+  g_studio.saved_jack_conf_generation = g_studio.jack_conf_generation;
 
   ret = true;
 
@@ -408,6 +583,11 @@ static bool ladish_save_studio_xml(struct ladish_command_save_studio * cmd_ptr)
 close:
   close(fd);
 
+  if (ret)
+  {
+    ladish_studio_update_metadata_index();
+  }
+
 rename_back:
   if (!ret && bak_filename != NULL)
   {
@@ -497,7 +677,11 @@ static bool run(void * command_context)
   ladish_check_integrity();
 
   cmd_ptr->command.state = LADISH_COMMAND_STATE_WAITING;
+  ladish_command_set_wait_reason(&cmd_ptr->command, "studio apps save");
 
+  /* Room apps are part of the room projects and are saved with them, not here.
+     Saving them from studio save would rotate their JS dirs without
+     writing the project file that references the new commandlines. */
   ladish_app_supervisor_save(g_studio.app_supervisor, cmd_ptr, ladish_studio_apps_save_complete);
 
   return true;
@@ -534,6 +718,7 @@ bool ladish_command_save_studio(void * call_ptr, struct ladish_cqueue * queue_pt
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "save studio";
   cmd_ptr->command.destructor = destructor;
   cmd_ptr->studio_name = studio_name_dup;
   cmd_ptr->done = false;
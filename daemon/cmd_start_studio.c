@@ -61,7 +61,8 @@ static bool run(void * context)
       return true;
     }
 
-    app_count = loader_get_app_count();
+    /* apps that were reused by studio switch are already running */
+    app_count = loader_get_app_count() - ladish_app_supervisor_get_running_app_count(g_studio.app_supervisor);
     if (app_count != 0)
     {
       log_error("Ignoring start request because there are apps running.");
@@ -70,6 +71,18 @@ static bool run(void * context)
       return false;
     }
 
+    if (g_studio.jack_kept)
+    {
+      if (jack_proxy_is_started(&jack_server_started) && jack_server_started)
+      {
+        log_info("Reusing JACK server that was kept running, its settings did not change.");
+        ladish_environment_set_stealth(&g_studio.env_store, ladish_environment_jack_server_started);
+        goto started;
+      }
+
+      g_studio.jack_kept = false;
+    }
+
     log_info("Starting JACK server.");
 
     ladish_graph_dump(g_studio.studio_graph);
@@ -95,6 +108,7 @@ static bool run(void * context)
     }
 
     cmd_ptr->command.state = LADISH_COMMAND_STATE_WAITING;
+    ladish_command_set_wait_reason(&cmd_ptr->command, "JACK server start");
     /* fall through */
   case LADISH_COMMAND_STATE_WAITING:
     if (!ladish_environment_consume_change(&g_studio.env_store, ladish_environment_jack_server_started, &jack_server_started))
@@ -116,7 +130,9 @@ static bool run(void * context)
 
     ASSERT(jack_server_started);
 
+  started:
     ladish_studio_on_event_jack_started(); /* fetch configuration and announce start */
+    g_studio.jack_kept = false; /* connections of the kept JACK server are pruned when jack_kept is set */
 
     ladish_studio_iterate_rooms(ladish_studio_get_virtualizer(), start_room);
 
@@ -142,6 +158,7 @@ bool ladish_command_start_studio(void * call_ptr, struct ladish_cqueue * queue_p
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "start studio";
   cmd_ptr->deadline = 0;
 
   if (!ladish_cqueue_add_command(queue_ptr, &cmd_ptr->command))
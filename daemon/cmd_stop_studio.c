@@ -42,6 +42,7 @@ struct ladish_command_stop_studio
   struct ladish_command command;
   uint64_t deadline;
   unsigned int stop_state;
+  bool keep_jack;               /* leave JACK server running for the studio that is loaded next */
 };
 
 static bool stop_room(void * UNUSED(context), ladish_room_handle room)
@@ -80,6 +81,7 @@ static bool run(void * context)
 
     cmd_ptr->command.state = LADISH_COMMAND_STATE_WAITING;
     cmd_ptr->stop_state = STOP_STATE_WAITING_FOR_ROOM_STOP;
+    ladish_command_set_wait_reason(&cmd_ptr->command, "rooms stop");
 
     if (!ladish_studio_iterate_rooms(NULL, stop_room))
     {
@@ -97,34 +99,47 @@ static bool run(void * context)
       }
 
       cmd_ptr->stop_state = STOP_STATE_WAITING_FOR_JACK_CLIENTS_DISAPPEAR;
+      ladish_command_set_wait_reason(&cmd_ptr->command, "JACK clients of studio apps disappear");
     }
 
     if (cmd_ptr->stop_state == STOP_STATE_WAITING_FOR_JACK_CLIENTS_DISAPPEAR)
     {
       clients_count = ladish_virtualizer_get_our_clients_count(g_studio.virtualizer);
       log_info("%u JACK clients started by ladish are visible", clients_count);
-      if (clients_count != 0)
+      /* clients of apps detached for a studio switch will not disappear */
+      if (clients_count != 0 && ladish_app_supervisor_get_detached_app_count(NULL) == 0)
       {
         return true;
       }
 
       cmd_ptr->stop_state = STOP_STATE_WAITING_FOR_CHILDS_TERMINATION;
+      ladish_command_set_wait_reason(&cmd_ptr->command, "child processes termination");
     }
 
     if (cmd_ptr->stop_state == STOP_STATE_WAITING_FOR_CHILDS_TERMINATION)
     {
       clients_count = loader_get_app_count();
       log_info("%u child processes are running", clients_count);
-      if (clients_count != 0)
+      if (clients_count > ladish_app_supervisor_get_detached_app_count(NULL))
       {
         return true;
       }
 
+      if (cmd_ptr->keep_jack)
+      {
+        log_info("Keeping JACK server running for the next studio.");
+        ladish_environment_reset_stealth(&g_studio.env_store, ladish_environment_jack_server_started);
+        g_studio.jack_kept = true;
+        jack_server_started = false;
+        goto done;
+      }
+
       log_info("Stopping JACK server...");
 
       ladish_graph_dump(g_studio.studio_graph);
 
       cmd_ptr->stop_state = STOP_STATE_WAITING_FOR_JACK_SERVER_STOP;
+      ladish_command_set_wait_reason(&cmd_ptr->command, "JACK server stop");
 
       if (!jack_proxy_stop_server())
       {
@@ -191,7 +206,7 @@ static bool run(void * context)
 
 #undef cmd_ptr
 
-bool ladish_command_stop_studio(void * call_ptr, struct ladish_cqueue * queue_ptr)
+bool ladish_command_stop_studio(void * call_ptr, struct ladish_cqueue * queue_ptr, bool keep_jack)
 {
   struct ladish_command_stop_studio * cmd_ptr;
 
@@ -203,7 +218,9 @@ bool ladish_command_stop_studio(void * call_ptr, struct ladish_cqueue * queue_pt
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "stop studio";
   cmd_ptr->deadline = 0;
+  cmd_ptr->keep_jack = keep_jack;
 
   if (!ladish_cqueue_add_command(queue_ptr, &cmd_ptr->command))
   {
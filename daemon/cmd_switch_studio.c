@@ -0,0 +1,206 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the app handover parts of the "switch studio" command
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Studio switch is a studio load where the JACK server and the running studio apps
+ * of the old studio are kept. The command sequence is:
+ *
+ *  1. detach running studio apps from the old studio
+ *  2. stop and unload the old studio, keeping JACK server running (apps in rooms are stopped)
+ *  3. load the new studio, JACK settings that differ are applied
+ *  4. adopt detached apps that match apps of the new studio, stop the others.
+ *     If JACK settings changed, all detached apps are stopped and JACK server is stopped.
+ *  5. start the new studio, apps that were not adopted are started,
+ *     connections that are not in the new studio are disconnected
+ */
+
+#include "cmd.h"
+#include "studio_internal.h"
+#include "../common/time.h"
+
+/* same as the JACK server stop wait of the stop studio command */
+#define DETACHED_APPS_STOP_TIMEOUT 5000000 /* microseconds */
+
+struct ladish_command_adopt_studio_apps
+{
+  struct ladish_command command;
+  uint64_t deadline;            /* 0 if time is not known */
+  bool killed;                  /* whether SIGKILL was sent to the detached apps */
+};
+
+#define cmd_ptr ((struct ladish_command *)context)
+
+static bool run_detach(void * context)
+{
+  unsigned int count;
+
+  ASSERT(cmd_ptr->state == LADISH_COMMAND_STATE_PENDING);
+
+  if (ladish_studio_is_started())
+  {
+    count = ladish_app_supervisor_detach_running_apps(g_studio.app_supervisor, NULL, NULL);
+    log_info("%u running studio apps detached", count);
+  }
+
+  cmd_ptr->state = LADISH_COMMAND_STATE_DONE;
+  return true;
+}
+
+#undef cmd_ptr
+#define cmd_ptr ((struct ladish_command_adopt_studio_apps *)context)
+
+static void set_stop_deadline(struct ladish_command_adopt_studio_apps * command_ptr)
+{
+  command_ptr->deadline = ladish_get_current_microseconds();
+  if (command_ptr->deadline != 0)
+  {
+    command_ptr->deadline += DETACHED_APPS_STOP_TIMEOUT;
+  }
+}
+
+static bool run_adopt(void * context)
+{
+  unsigned int count;
+
+  switch (cmd_ptr->command.state)
+  {
+  case LADISH_COMMAND_STATE_PENDING:
+    if (g_studio.jack_kept_outdated)
+    {
+      log_info("JACK settings differ, stopping all detached apps");
+    }
+    else
+    {
+      count = ladish_app_supervisor_adopt_detached_apps(g_studio.app_supervisor);
+      log_info("%u running apps reused", count);
+    }
+
+    ladish_app_supervisor_stop_detached_apps(g_studio.app_supervisor);
+    set_stop_deadline(cmd_ptr);
+
+    cmd_ptr->command.state = LADISH_COMMAND_STATE_WAITING;
+    /* fall through */
+  case LADISH_COMMAND_STATE_WAITING:
+    count = ladish_app_supervisor_get_detached_app_count(g_studio.app_supervisor);
+    if (count != 0)
+    {
+      log_info("%u detached apps are still running", count);
+      ladish_command_set_wait_reason(&cmd_ptr->command, "detached apps termination");
+
+      if (cmd_ptr->deadline == 0 || ladish_get_current_microseconds() < cmd_ptr->deadline)
+      {
+        return true;
+      }
+
+      if (cmd_ptr->killed)
+      {
+        log_error("%u detached apps did not terminate after SIGKILL", count);
+        cmd_ptr->command.state = LADISH_COMMAND_STATE_DONE;
+        return false;
+      }
+
+      log_error("%u detached apps did not terminate in %u seconds, killing them", count, DETACHED_APPS_STOP_TIMEOUT / 1000000);
+      ladish_app_supervisor_kill_detached_apps(g_studio.app_supervisor);
+      cmd_ptr->killed = true;
+      set_stop_deadline(cmd_ptr);
+      return true;
+    }
+
+    if (g_studio.jack_kept_outdated)
+    {
+      ladish_studio_release_kept_jack();
+    }
+
+    cmd_ptr->command.state = LADISH_COMMAND_STATE_DONE;
+    return true;
+  }
+
+  ASSERT_NO_PASS;
+  return false;
+}
+
+#undef cmd_ptr
+
+static
+bool
+ladish_command_add_simple(
+  void * call_ptr,
+  struct ladish_cqueue * queue_ptr,
+  const char * name,
+  bool (* run)(void * context))
+{
+  struct ladish_command * cmd_ptr;
+
+  cmd_ptr = ladish_command_new(sizeof(struct ladish_command));
+  if (cmd_ptr == NULL)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "ladish_command_new() failed.");
+    return false;
+  }
+
+  cmd_ptr->run = run;
+  cmd_ptr->name = name;
+
+  if (!ladish_cqueue_add_command(queue_ptr, cmd_ptr))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "ladish_cqueue_add_command() failed.");
+    free(cmd_ptr);
+    return false;
+  }
+
+  return true;
+}
+
+bool ladish_command_detach_studio_apps(void * call_ptr, struct ladish_cqueue * queue_ptr)
+{
+  return ladish_command_add_simple(call_ptr, queue_ptr, "detach studio apps", run_detach);
+}
+
+bool ladish_command_adopt_studio_apps(void * call_ptr, struct ladish_cqueue * queue_ptr)
+{
+  struct ladish_command_adopt_studio_apps * cmd_ptr;
+
+  cmd_ptr = ladish_command_new(sizeof(struct ladish_command_adopt_studio_apps));
+  if (cmd_ptr == NULL)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "ladish_command_new() failed.");
+    return false;
+  }
+
+  cmd_ptr->command.run = run_adopt;
+  cmd_ptr->command.name = "adopt studio apps";
+  cmd_ptr->deadline = 0;
+  cmd_ptr->killed = false;
+
+  if (!ladish_cqueue_add_command(queue_ptr, &cmd_ptr->command))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "ladish_cqueue_add_command() failed.");
+    free(cmd_ptr);
+    return false;
+  }
+
+  return true;
+}
@@ -38,6 +38,26 @@ struct ladish_command_unload_project
 
 #define cmd_ptr ((struct ladish_command_unload_project *)command_context)
 
+static void unload(void * command_context)
+{
+  const char * stage;
+
+  if (ladish_room_unload_project(cmd_ptr->room))
+  {
+    cmd_ptr->command.state = LADISH_COMMAND_STATE_DONE;
+    return;
+  }
+
+  /* the room moves from waiting for connections to waiting for apps, keep the reason in sync */
+  stage = ladish_room_get_unload_stage(cmd_ptr->room);
+  ladish_command_set_wait_reason(
+    &cmd_ptr->command,
+    "room '%s' %s",
+    ladish_room_get_name(cmd_ptr->room),
+    stage != NULL ? stage : "project unload");
+  cmd_ptr->command.state = LADISH_COMMAND_STATE_WAITING;
+}
+
 static bool run(void * command_context)
 {
   if (cmd_ptr->command.state == LADISH_COMMAND_STATE_PENDING)
@@ -51,25 +71,13 @@ static bool run(void * command_context)
       return false;
     }
 
-    if (ladish_room_unload_project(cmd_ptr->room))
-    {
-      cmd_ptr->command.state = LADISH_COMMAND_STATE_DONE;
-    }
-    else
-    {
-      cmd_ptr->command.state = LADISH_COMMAND_STATE_WAITING;
-    }
-
+    unload(command_context);
     return true;
   }
 
   ASSERT(cmd_ptr->command.state == LADISH_COMMAND_STATE_WAITING);
 
-  if (ladish_room_unload_project(cmd_ptr->room))
-  {
-    cmd_ptr->command.state = LADISH_COMMAND_STATE_DONE;
-  }
-
+  unload(command_context);
   return true;
 }
 
@@ -91,7 +99,9 @@ ladish_command_unload_project(
   }
 
   cmd_ptr->command.run = run;
+  cmd_ptr->command.name = "unload project";
   uuid_copy(cmd_ptr->room_uuid, room_uuid_ptr);
+  uuid_copy(cmd_ptr->command.scope, room_uuid_ptr);
   cmd_ptr->room = NULL;
 
   if (!ladish_cqueue_add_command(queue_ptr, &cmd_ptr->command))
@@ -43,11 +43,11 @@ static bool run(void * context)
 
 #undef cmd_ptr
 
-bool ladish_command_unload_studio(void * call_ptr, struct ladish_cqueue * queue_ptr)
+bool ladish_command_unload_studio(void * call_ptr, struct ladish_cqueue * queue_ptr, bool keep_jack)
 {
   struct ladish_command * cmd_ptr;
 
-  if (!ladish_command_stop_studio(call_ptr, queue_ptr))
+  if (!ladish_command_stop_studio(call_ptr, queue_ptr, keep_jack))
   {
     goto fail;
   }
@@ -60,6 +60,7 @@ bool ladish_command_unload_studio(void * call_ptr, struct ladish_cqueue * queue_
   }
 
   cmd_ptr->run = run;
+  cmd_ptr->name = "unload studio";
 
   if (!ladish_cqueue_add_command(queue_ptr, cmd_ptr))
   {
@@ -59,6 +59,16 @@ struct connection
 
 extern bool g_quit;
 
+/* Generation counter for objects that are persisted in studio and project files.
+   Each modification stamps the object with a generation that is greater than all previous ones,
+   so the maximum of the stamps of an object tree changes whenever anything in the tree changes. */
+extern uint64_t g_generation;
+
+static inline uint64_t ladish_generation_next(void)
+{
+  return ++g_generation;
+}
+
 void ladish_check_integrity(void);
 
 #endif /* #ifndef COMMON_H__CFDC869A_31AE_4FA3_B2D3_DACA8488CA55__INCLUDED */
@@ -32,11 +32,25 @@
 #define LADISH_CONF_KEY_DAEMON_TERMINAL           "/org/ladish/daemon/terminal"
 #define LADISH_CONF_KEY_DAEMON_STUDIO_AUTOSTART   "/org/ladish/daemon/studio_autostart"
 #define LADISH_CONF_KEY_DAEMON_JS_SAVE_DELAY      "/org/ladish/daemon/js_save_delay"
+#define LADISH_CONF_KEY_DAEMON_JS_SAVE_TIMEOUT    "/org/ladish/daemon/js_save_timeout"
+#define LADISH_CONF_KEY_DAEMON_AUTOSAVE_INTERVAL  "/org/ladish/daemon/autosave_interval"
+#define LADISH_CONF_KEY_DAEMON_AUTOSAVE_CHANGES   "/org/ladish/daemon/autosave_changes"
+#define LADISH_CONF_KEY_DAEMON_AUTOSAVE_BACKUPS   "/org/ladish/daemon/autosave_backups"
+#define LADISH_CONF_KEY_DAEMON_JACK_STATS_INTERVAL "/org/ladish/daemon/jack_stats_interval"
+#define LADISH_CONF_KEY_DAEMON_CQUEUE_TRACE_FILE  "/org/ladish/daemon/cqueue_trace_file"
+#define LADISH_CONF_KEY_DAEMON_GRAPH_RECORD_FILE  "/org/ladish/daemon/graph_record_file"
 
 #define LADISH_CONF_KEY_DAEMON_NOTIFY_DEFAULT             true
 #define LADISH_CONF_KEY_DAEMON_SHELL_DEFAULT              "sh"
 #define LADISH_CONF_KEY_DAEMON_TERMINAL_DEFAULT           "xterm"
 #define LADISH_CONF_KEY_DAEMON_STUDIO_AUTOSTART_DEFAULT   true
 #define LADISH_CONF_KEY_DAEMON_JS_SAVE_DELAY_DEFAULT      0
+#define LADISH_CONF_KEY_DAEMON_JS_SAVE_TIMEOUT_DEFAULT    30 /* seconds */
+#define LADISH_CONF_KEY_DAEMON_AUTOSAVE_INTERVAL_DEFAULT  300 /* seconds, 0 disables autosave */
+#define LADISH_CONF_KEY_DAEMON_AUTOSAVE_CHANGES_DEFAULT   0 /* autosave earlier after this many modifications, 0 disables */
+#define LADISH_CONF_KEY_DAEMON_AUTOSAVE_BACKUPS_DEFAULT   5
+#define LADISH_CONF_KEY_DAEMON_JACK_STATS_INTERVAL_DEFAULT 200 /* milliseconds, 0 disables the JackStats signal */
+#define LADISH_CONF_KEY_DAEMON_CQUEUE_TRACE_FILE_DEFAULT  "" /* Chrome trace event file, empty disables the file trace */
+#define LADISH_CONF_KEY_DAEMON_GRAPH_RECORD_FILE_DEFAULT  "" /* JACK graph event record file, empty disables recording */
 
 #endif /* #ifndef CONF_H__795797BE_4EB8_44F8_BD9C_B8A9CB975228__INCLUDED */
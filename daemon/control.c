@@ -34,6 +34,9 @@
 #include "../lib/wkports.h"
 #include "../proxies/conf_proxy.h"
 #include "conf.h"
+#include "appdb.h"
+#include "perf_history.h"
+#include "../common/time.h"
 
 #define INTERFACE_NAME IFACE_CONTROL
 
@@ -544,7 +547,7 @@ fail:
 
 #define array_iter_ptr ((DBusMessageIter *)context)
 
-static bool get_studio_list_callback(void * UNUSED(call_ptr), void * context, const char * studio, uint32_t modtime)
+static bool get_studio_list_callback(void * UNUSED(call_ptr), void * context, const char * studio, const struct ladish_metadata * meta_ptr)
 {
   DBusMessageIter struct_iter;
   DBusMessageIter dict_iter;
@@ -564,7 +567,18 @@ static bool get_studio_list_callback(void * UNUSED(call_ptr), void * context, co
 /*   if (!maybe_add_dict_entry_string(&dict_iter, "Description", xxx)) */
 /*     goto close_dict; */
 
-  if (!cdbus_add_dict_entry_uint32(&dict_iter, "Modification Time", modtime))
+  if (!cdbus_add_dict_entry_uint32(&dict_iter, "Modification Time", (uint32_t)meta_ptr->mtime))
+    goto close_dict;
+
+  if (meta_ptr->rooms != LADISH_METADATA_COUNT_UNKNOWN &&
+      !cdbus_add_dict_entry_uint32(&dict_iter, "Rooms", meta_ptr->rooms))
+    goto close_dict;
+
+  if (meta_ptr->apps != LADISH_METADATA_COUNT_UNKNOWN &&
+      !cdbus_add_dict_entry_uint32(&dict_iter, "Applications", meta_ptr->apps))
+    goto close_dict;
+
+  if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "JACK Settings", meta_ptr->jack_settings))
     goto close_dict;
 
   ret = true;
@@ -655,6 +669,27 @@ static void ladish_load_studio(struct cdbus_method_call * call_ptr)
   }
 }
 
+static void ladish_switch_studio(struct cdbus_method_call * call_ptr)
+{
+  const char * name;
+
+  dbus_error_init(&cdbus_g_dbus_error);
+
+  if (!dbus_message_get_args(call_ptr->message, &cdbus_g_dbus_error, DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": %s",  call_ptr->method_name, cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  log_info("Switch studio request (%s)", name);
+
+  if (ladish_command_switch_studio(call_ptr, ladish_studio_get_cmd_queue(), name))
+  {
+    cdbus_method_return_new_void(call_ptr);
+  }
+}
+
 static void ladish_delete_studio(struct cdbus_method_call * call_ptr)
 {
   const char * name;
@@ -695,18 +730,57 @@ static void ladish_new_studio(struct cdbus_method_call * call_ptr)
   }
 }
 
-static void ladish_get_application_list(struct cdbus_method_call * call_ptr)
+#define array_iter_ptr ((DBusMessageIter *)context)
+
+static bool application_list_filler(void * context, const struct lash_appdb_entry * entry_ptr)
 {
-  DBusMessageIter iter;
-  DBusMessageIter array_iter;
-#if 0
   DBusMessageIter struct_iter;
   DBusMessageIter dict_iter;
-  struct list_head * node_ptr;
-  struct lash_appdb_entry * entry_ptr;
-#endif
 
-  log_info("Getting applications list");
+  if (!dbus_message_iter_open_container(array_iter_ptr, DBUS_TYPE_STRUCT, NULL, &struct_iter))
+    return false;
+
+  if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &entry_ptr->name))
+    return false;
+
+  if (!dbus_message_iter_open_container(&struct_iter, DBUS_TYPE_ARRAY, "{sv}", &dict_iter))
+    return false;
+
+  if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "GenericName", entry_ptr->generic_name))
+    return false;
+
+  if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "Comment", entry_ptr->comment))
+    return false;
+
+  if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "Icon", entry_ptr->icon))
+    return false;
+
+  if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "Exec", entry_ptr->exec))
+    return false;
+
+  if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "Path", entry_ptr->path))
+    return false;
+
+  if (!cdbus_add_dict_entry_bool(&dict_iter, "Terminal", entry_ptr->terminal))
+    return false;
+
+  if (!dbus_message_iter_close_container(&struct_iter, &dict_iter))
+    return false;
+
+  if (!dbus_message_iter_close_container(array_iter_ptr, &struct_iter))
+    return false;
+
+  return true;
+}
+
+#undef array_iter_ptr
+
+static void ladish_reply_application_list(struct cdbus_method_call * call_ptr, const char * filter)
+{
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+
+  log_info("Getting applications list (filter '%s')", filter != NULL ? filter : "");
 
   call_ptr->reply = dbus_message_new_method_return(call_ptr->message);
   if (call_ptr->reply == NULL)
@@ -721,39 +795,10 @@ static void ladish_get_application_list(struct cdbus_method_call * call_ptr)
     goto fail_unref;
   }
 
-#if 0
-  list_for_each(node_ptr, &g_server->appdb)
+  if (!lash_appdb_iterate(filter, &array_iter, application_list_filler))
   {
-    entry_ptr = list_entry(node_ptr, struct lash_appdb_entry, siblings);
-
-    if (!dbus_message_iter_open_container(&array_iter, DBUS_TYPE_STRUCT, NULL, &struct_iter))
-      goto fail_unref;
-
-    if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, (const void *) &entry_ptr->name))
-    {
-      dbus_message_iter_close_container(&iter, &array_iter);
-      goto fail_unref;
-    }
-
-    if (!dbus_message_iter_open_container(&struct_iter, DBUS_TYPE_ARRAY, "{sv}", &dict_iter))
-      goto fail_unref;
-
-    if (!maybe_add_dict_entry_string(&dict_iter, "GenericName", entry_ptr->generic_name))
-      goto fail_unref;
-
-    if (!maybe_add_dict_entry_string(&dict_iter, "Comment", entry_ptr->comment))
-      goto fail_unref;
-
-    if (!maybe_add_dict_entry_string(&dict_iter, "Icon", entry_ptr->icon))
-      goto fail_unref;
-
-    if (!dbus_message_iter_close_container(&struct_iter, &dict_iter))
-      goto fail_unref;
-
-    if (!dbus_message_iter_close_container(&array_iter, &struct_iter))
-      goto fail_unref;
+    goto fail_unref;
   }
-#endif
 
   if (!dbus_message_iter_close_container(&iter, &array_iter))
   {
@@ -769,6 +814,27 @@ fail:
   return;
 }
 
+static void ladish_get_application_list(struct cdbus_method_call * call_ptr)
+{
+  ladish_reply_application_list(call_ptr, NULL);
+}
+
+static void ladish_find_applications(struct cdbus_method_call * call_ptr)
+{
+  const char * filter;
+
+  dbus_error_init(&cdbus_g_dbus_error);
+
+  if (!dbus_message_get_args(call_ptr->message, &cdbus_g_dbus_error, DBUS_TYPE_STRING, &filter, DBUS_TYPE_INVALID))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": %s",  call_ptr->method_name, cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  ladish_reply_application_list(call_ptr, filter);
+}
+
 #define array_iter_ptr ((DBusMessageIter *)context)
 
 bool room_template_list_filler(void * context, ladish_room_handle room)
@@ -876,6 +942,95 @@ static void ladish_create_room_template(struct cdbus_method_call * call_ptr)
   }
 }
 
+#define array_iter_ptr ((DBusMessageIter *)context)
+
+static bool perf_history_filler(void * context, uint64_t time, uint32_t type, double value, const char * description)
+{
+  DBusMessageIter struct_iter;
+  dbus_uint64_t dbus_time;
+  dbus_uint32_t dbus_type;
+
+  dbus_time = time;
+  dbus_type = type;
+
+  if (!dbus_message_iter_open_container(array_iter_ptr, DBUS_TYPE_STRUCT, NULL, &struct_iter))
+    return false;
+
+  if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT64, &dbus_time))
+    return false;
+
+  if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT32, &dbus_type))
+    return false;
+
+  if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_DOUBLE, &value))
+    return false;
+
+  if (!dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &description))
+    return false;
+
+  if (!dbus_message_iter_close_container(array_iter_ptr, &struct_iter))
+    return false;
+
+  return true;
+}
+
+#undef array_iter_ptr
+
+static void ladish_get_performance_history(struct cdbus_method_call * call_ptr)
+{
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+  dbus_uint64_t since;
+  dbus_uint64_t now;
+
+  dbus_error_init(&cdbus_g_dbus_error);
+
+  if (!dbus_message_get_args(call_ptr->message, &cdbus_g_dbus_error, DBUS_TYPE_UINT64, &since, DBUS_TYPE_INVALID))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": %s",  call_ptr->method_name, cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  now = ladish_get_current_microseconds();
+
+  call_ptr->reply = dbus_message_new_method_return(call_ptr->message);
+  if (call_ptr->reply == NULL)
+  {
+    goto fail;
+  }
+
+  dbus_message_iter_init_append(call_ptr->reply, &iter);
+
+  if (!dbus_message_iter_append_basic(&iter, DBUS_TYPE_UINT64, &now))
+  {
+    goto fail_unref;
+  }
+
+  if (!dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "(tuds)", &array_iter))
+  {
+    goto fail_unref;
+  }
+
+  if (!ladish_perf_history_iterate(since, &array_iter, perf_history_filler))
+  {
+    goto fail_unref;
+  }
+
+  if (!dbus_message_iter_close_container(&iter, &array_iter))
+  {
+    goto fail_unref;
+  }
+
+  return;
+
+fail_unref:
+  dbus_message_unref(call_ptr->reply);
+  call_ptr->reply = NULL;
+fail:
+  log_error("Ran out of memory trying to construct method return");
+}
+
 static void ladish_exit(struct cdbus_method_call * call_ptr)
 {
   log_info("Exit command received through D-Bus");
@@ -910,6 +1065,54 @@ void emit_clean_exit(void)
   cdbus_signal_emit(cdbus_g_dbus_connection, CONTROL_OBJECT_PATH, INTERFACE_NAME, "CleanExit", "");
 }
 
+void emit_js_save_progress(unsigned int pending, unsigned int completed, unsigned int timed_out)
+{
+  dbus_uint32_t dbus_pending = pending;
+  dbus_uint32_t dbus_completed = completed;
+  dbus_uint32_t dbus_timed_out = timed_out;
+
+  cdbus_signal_emit(cdbus_g_dbus_connection, CONTROL_OBJECT_PATH, INTERFACE_NAME, "JSSaveProgress", "uuu", &dbus_pending, &dbus_completed, &dbus_timed_out);
+}
+
+void emit_jack_stats(uint32_t xruns_delta, double dsp_load, double peak_dsp_load, uint32_t buffer_size, uint32_t sample_rate)
+{
+  dbus_uint32_t dbus_xruns_delta = xruns_delta;
+  double dbus_dsp_load = dsp_load;
+  double dbus_peak_dsp_load = peak_dsp_load;
+  dbus_uint32_t dbus_buffer_size = buffer_size;
+  dbus_uint32_t dbus_sample_rate = sample_rate;
+
+  cdbus_signal_emit(
+    cdbus_g_dbus_connection,
+    CONTROL_OBJECT_PATH,
+    INTERFACE_NAME,
+    "JackStats",
+    "udduu",
+    &dbus_xruns_delta,
+    &dbus_dsp_load,
+    &dbus_peak_dsp_load,
+    &dbus_buffer_size,
+    &dbus_sample_rate);
+}
+
+void emit_command_trace(const char * command, const char * event, uint64_t time, uint64_t duration, const char * detail)
+{
+  dbus_uint64_t dbus_time = time;
+  dbus_uint64_t dbus_duration = duration;
+
+  cdbus_signal_emit(
+    cdbus_g_dbus_connection,
+    CONTROL_OBJECT_PATH,
+    INTERFACE_NAME,
+    "CommandTrace",
+    "sstts",
+    &command,
+    &event,
+    &dbus_time,
+    &dbus_duration,
+    &detail);
+}
+
 CDBUS_METHOD_ARGS_BEGIN(IsStudioLoaded, "Check whether studio D-Bus object is present")
   CDBUS_METHOD_ARG_DESCRIBE_OUT("present", "b", "Whether studio D-Bus object is present")
 CDBUS_METHOD_ARGS_END
@@ -927,6 +1130,10 @@ CDBUS_METHOD_ARGS_BEGIN(LoadStudio, "Load studio")
   CDBUS_METHOD_ARG_DESCRIBE_IN("options", "a{sv}", "Load options")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(SwitchStudio, "Load and start studio, keeping JACK server and matching running apps of the current studio")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("studio_name", "s", "Name of studio to switch to")
+CDBUS_METHOD_ARGS_END
+
 CDBUS_METHOD_ARGS_BEGIN(DeleteStudio, "Delete studio")
   CDBUS_METHOD_ARG_DESCRIBE_IN("studio_name", "s", "Name of studio to delete")
 CDBUS_METHOD_ARGS_END
@@ -935,6 +1142,11 @@ CDBUS_METHOD_ARGS_BEGIN(GetApplicationList, "Get list of applications that can b
   CDBUS_METHOD_ARG_DESCRIBE_OUT("applications", "a(sa{sv})", "List of applications, name and properties")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(FindApplications, "Get list of applications that can be launched and match a filter")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("filter", "s", "Prefix of application name word or keyword, case insensitive. Empty string matches all applications.")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("applications", "a(sa{sv})", "List of applications, name and properties")
+CDBUS_METHOD_ARGS_END
+
 CDBUS_METHOD_ARGS_BEGIN(GetRoomTemplateList, "Get list of room templates")
   CDBUS_METHOD_ARG_DESCRIBE_OUT("room_template_list", "a(sa{sv})", "List of room templates (name and properties)")
 CDBUS_METHOD_ARGS_END
@@ -947,6 +1159,12 @@ CDBUS_METHOD_ARGS_BEGIN(DeleteRoomTemplate, "Delete room template")
   CDBUS_METHOD_ARG_DESCRIBE_IN("room_template_name", "s", "Name of room template to delete")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(GetPerformanceHistory, "Get JACK statistics, app and connection events that ladishd recorded")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("since", DBUS_TYPE_UINT64_AS_STRING, "Return only entries newer than this time, in microseconds since the epoch. 0 for all entries.")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("now", DBUS_TYPE_UINT64_AS_STRING, "Current time, to be used as since in the next call")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("entries", "a(tuds)", "List of entries, oldest first: time, type, value and description")
+CDBUS_METHOD_ARGS_END
+
 CDBUS_METHOD_ARGS_BEGIN(Exit, "Tell ladish D-Bus service to exit")
 CDBUS_METHOD_ARGS_END
 
@@ -955,11 +1173,14 @@ CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(GetStudioList, ladish_get_studio_list)
   CDBUS_METHOD_DESCRIBE(NewStudio, ladish_new_studio)
   CDBUS_METHOD_DESCRIBE(LoadStudio, ladish_load_studio)
+  CDBUS_METHOD_DESCRIBE(SwitchStudio, ladish_switch_studio)
   CDBUS_METHOD_DESCRIBE(DeleteStudio, ladish_delete_studio)
   CDBUS_METHOD_DESCRIBE(GetApplicationList, ladish_get_application_list)
+  CDBUS_METHOD_DESCRIBE(FindApplications, ladish_find_applications)
   CDBUS_METHOD_DESCRIBE(GetRoomTemplateList, ladish_get_room_template_list)
   CDBUS_METHOD_DESCRIBE(CreateRoomTemplate, ladish_create_room_template)
   CDBUS_METHOD_DESCRIBE(DeleteRoomTemplate, ladish_delete_room_template)
+  CDBUS_METHOD_DESCRIBE(GetPerformanceHistory, ladish_get_performance_history)
   CDBUS_METHOD_DESCRIBE(Exit, ladish_exit)
 CDBUS_METHODS_END
 
@@ -975,11 +1196,36 @@ CDBUS_SIGNAL_ARGS_END
 CDBUS_SIGNAL_ARGS_BEGIN(CleanExit, "Exit was requested")
 CDBUS_SIGNAL_ARGS_END
 
+CDBUS_SIGNAL_ARGS_BEGIN(JSSaveProgress, "Progress of JACK session app saves, of studio and all rooms")
+  CDBUS_SIGNAL_ARG_DESCRIBE("pending", DBUS_TYPE_UINT32_AS_STRING, "Number of apps that are still saving")
+  CDBUS_SIGNAL_ARG_DESCRIBE("completed", DBUS_TYPE_UINT32_AS_STRING, "Number of apps that completed saving, successfully or not")
+  CDBUS_SIGNAL_ARG_DESCRIBE("timed_out", DBUS_TYPE_UINT32_AS_STRING, "Number of apps that did not complete saving before deadline")
+CDBUS_SIGNAL_ARGS_END
+
+CDBUS_SIGNAL_ARGS_BEGIN(JackStats, "JACK server statistics changed")
+  CDBUS_SIGNAL_ARG_DESCRIBE("xruns_delta", DBUS_TYPE_UINT32_AS_STRING, "Number of xruns since the previous signal")
+  CDBUS_SIGNAL_ARG_DESCRIBE("dsp_load", DBUS_TYPE_DOUBLE_AS_STRING, "Current DSP load, in percents")
+  CDBUS_SIGNAL_ARG_DESCRIBE("peak_dsp_load", DBUS_TYPE_DOUBLE_AS_STRING, "Max DSP load sampled since the previous signal, in percents")
+  CDBUS_SIGNAL_ARG_DESCRIBE("buffer_size", DBUS_TYPE_UINT32_AS_STRING, "Buffer size, in samples")
+  CDBUS_SIGNAL_ARG_DESCRIBE("sample_rate", DBUS_TYPE_UINT32_AS_STRING, "Sample rate, in Hz")
+CDBUS_SIGNAL_ARGS_END
+
+CDBUS_SIGNAL_ARGS_BEGIN(CommandTrace, "Command queue execution stage")
+  CDBUS_SIGNAL_ARG_DESCRIBE("command", DBUS_TYPE_STRING_AS_STRING, "Name of the command")
+  CDBUS_SIGNAL_ARG_DESCRIBE("event", DBUS_TYPE_STRING_AS_STRING, "One of \"started\", \"run\", \"waiting\", \"waited\", \"done\" and \"failed\"")
+  CDBUS_SIGNAL_ARG_DESCRIBE("time", DBUS_TYPE_UINT64_AS_STRING, "When the event happened, in microseconds since the epoch")
+  CDBUS_SIGNAL_ARG_DESCRIBE("duration", DBUS_TYPE_UINT64_AS_STRING, "Duration of the stage, in microseconds. For \"started\" it is the time spent in the queue")
+  CDBUS_SIGNAL_ARG_DESCRIBE("detail", DBUS_TYPE_STRING_AS_STRING, "Wait reason for \"waiting\" and \"waited\", run and wait totals for \"done\" and \"failed\"")
+CDBUS_SIGNAL_ARGS_END
+
 CDBUS_SIGNALS_BEGIN
   CDBUS_SIGNAL_DESCRIBE(StudioAppeared)
   CDBUS_SIGNAL_DESCRIBE(StudioDisappeared)
   CDBUS_SIGNAL_DESCRIBE(QueueExecutionHalted)
   CDBUS_SIGNAL_DESCRIBE(CleanExit)
+  CDBUS_SIGNAL_DESCRIBE(JSSaveProgress)
+  CDBUS_SIGNAL_DESCRIBE(JackStats)
+  CDBUS_SIGNAL_DESCRIBE(CommandTrace)
 CDBUS_SIGNALS_END
 
 /*
@@ -36,6 +36,9 @@ void emit_studio_appeared(void);
 void emit_studio_disappeared(void);
 void emit_queue_execution_halted(void);
 void emit_clean_exit(void);
+void emit_js_save_progress(unsigned int pending, unsigned int completed, unsigned int timed_out);
+void emit_jack_stats(uint32_t xruns_delta, double dsp_load, double peak_dsp_load, uint32_t buffer_size, uint32_t sample_rate);
+void emit_command_trace(const char * command, const char * event, uint64_t time, uint64_t duration, const char * detail);
 
 bool room_templates_init(void);
 void room_templates_uninit(void);
@@ -24,8 +24,12 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <stdarg.h>
+
 #include "cmd.h"
 #include "control.h"
+#include "cqueue_trace.h"
+#include "../common/time.h"
 
 void ladish_cqueue_init(struct ladish_cqueue * queue_ptr)
 {
@@ -33,102 +37,194 @@ void ladish_cqueue_init(struct ladish_cqueue * queue_ptr)
   INIT_LIST_HEAD(&queue_ptr->queue);
 }
 
+/*
+ * Commands have a scope, the room they operate on or the whole studio.
+ * A command is run when no command that is before it in the queue has
+ * overlapping scope, so commands for different rooms progress in parallel
+ * while one of them is waiting. Studio-wide commands overlap with everything,
+ * they act as barriers and run only when they are first in the queue.
+ *
+ * Room commands must only touch state of their room. State that is global,
+ * like the list of apps detached for a project switch, is partitioned by
+ * owner, so a project switch adopts and stops only the apps of its room.
+ */
+
+static bool ladish_command_scopes_overlap(struct ladish_command * cmd1_ptr, struct ladish_command * cmd2_ptr)
+{
+  if (uuid_is_null(cmd1_ptr->scope) || uuid_is_null(cmd2_ptr->scope))
+  {
+    return true;
+  }
+
+  return uuid_compare(cmd1_ptr->scope, cmd2_ptr->scope) == 0;
+}
+
+static bool ladish_cqueue_is_blocked(struct ladish_cqueue * queue_ptr, struct ladish_command * cmd_ptr)
+{
+  struct list_head * node_ptr;
+
+  list_for_each(node_ptr, &queue_ptr->queue)
+  {
+    if (node_ptr == &cmd_ptr->siblings)
+    {
+      return false;
+    }
+
+    if (ladish_command_scopes_overlap(list_entry(node_ptr, struct ladish_command, siblings), cmd_ptr))
+    {
+      return true;
+    }
+  }
+
+  ASSERT_NO_PASS;               /* command is not in the queue */
+  return true;
+}
+
+static void ladish_cqueue_destroy_command(struct ladish_command * cmd_ptr)
+{
+  list_del(&cmd_ptr->siblings);
+
+  if (cmd_ptr->destructor != NULL)
+  {
+    cmd_ptr->destructor(cmd_ptr->context);
+  }
+
+  free(cmd_ptr);
+}
+
+/* Remove failed command and the commands that were queued after it and depend on it.
+ * Commands of other rooms are not affected, unless they were queued after a studio-wide command that is removed. */
+static void ladish_cqueue_halt(struct ladish_cqueue * queue_ptr, struct ladish_command * failed_cmd_ptr)
+{
+  struct list_head * node_ptr;
+  struct list_head * next_ptr;
+  struct ladish_command * cmd_ptr;
+  bool barrier_removed;
+
+  barrier_removed = uuid_is_null(failed_cmd_ptr->scope);
+
+  for (node_ptr = failed_cmd_ptr->siblings.next; node_ptr != &queue_ptr->queue; node_ptr = next_ptr)
+  {
+    next_ptr = node_ptr->next;
+    cmd_ptr = list_entry(node_ptr, struct ladish_command, siblings);
+
+    if (!barrier_removed && !ladish_command_scopes_overlap(cmd_ptr, failed_cmd_ptr))
+    {
+      continue;
+    }
+
+    /* commands that are queued after the failed one and depend on it cannot be started yet */
+    ASSERT(cmd_ptr->state == LADISH_COMMAND_STATE_PENDING);
+
+    if (uuid_is_null(cmd_ptr->scope))
+    {
+      barrier_removed = true;
+    }
+
+    ladish_cqueue_destroy_command(cmd_ptr);
+  }
+
+  ladish_cqueue_destroy_command(failed_cmd_ptr);
+
+  if (list_empty(&queue_ptr->queue))
+  {
+    queue_ptr->cancel = false;
+  }
+
+  emit_queue_execution_halted();
+}
+
 void ladish_cqueue_run(struct ladish_cqueue * queue_ptr)
 {
   struct list_head * node_ptr;
   struct ladish_command * cmd_ptr;
+  uint64_t start;
+  bool success;
+
+  node_ptr = queue_ptr->queue.next;
 
 loop:
-  if (list_empty(&queue_ptr->queue))
+  if (node_ptr == &queue_ptr->queue)
   {
+    if (queue_ptr->cancel && list_empty(&queue_ptr->queue))
+    {
+      queue_ptr->cancel = false;
+    }
+
     return;
   }
 
-  node_ptr = queue_ptr->queue.next;
   cmd_ptr = list_entry(node_ptr, struct ladish_command, siblings);
 
   ASSERT(cmd_ptr->run != NULL);
   ASSERT(cmd_ptr->state == LADISH_COMMAND_STATE_PENDING || cmd_ptr->state == LADISH_COMMAND_STATE_WAITING);
 
+  if (ladish_cqueue_is_blocked(queue_ptr, cmd_ptr))
+  {
+    node_ptr = node_ptr->next;
+    goto loop;
+  }
+
+  start = ladish_get_monotonic_microseconds();
+
   if (cmd_ptr->state == LADISH_COMMAND_STATE_PENDING)
   { /* if this is a new command, put a separator so its impact is clearly visible in the log */
     log_info("-------");
+    ladish_cqueue_trace_start(cmd_ptr, start);
   }
 
-  if (!cmd_ptr->run(cmd_ptr->context))
+  success = cmd_ptr->run(cmd_ptr->context);
+
+  ladish_cqueue_trace_run(cmd_ptr, start, ladish_get_monotonic_microseconds(), success);
+
+  if (!success)
   {
-    ladish_cqueue_clear(queue_ptr);
-    emit_queue_execution_halted();
+    ladish_cqueue_halt(queue_ptr, cmd_ptr);
     return;
   }
 
+  node_ptr = node_ptr->next;
+
   switch (cmd_ptr->state)
   {
   case LADISH_COMMAND_STATE_DONE:
+    ladish_cqueue_destroy_command(cmd_ptr);
     break;
   case LADISH_COMMAND_STATE_WAITING:
-    return;
+    break;
   default:
     log_error("unexpected cmd state %u after run()", cmd_ptr->state);
     ASSERT_NO_PASS;
-    ladish_cqueue_clear(queue_ptr);
-    emit_queue_execution_halted();
+    ladish_cqueue_halt(queue_ptr, cmd_ptr);
     return;
   }
 
-  list_del(node_ptr);
-
-  if (cmd_ptr->destructor != NULL)
-  {
-    cmd_ptr->destructor(cmd_ptr->context);
-  }
-
-  free(cmd_ptr);
-
-  if (queue_ptr->cancel && list_empty(&queue_ptr->queue))
-  {
-    queue_ptr->cancel = false;
-  }
-
   goto loop;
 }
 
 void ladish_cqueue_cancel(struct ladish_cqueue * queue_ptr)
 {
   struct list_head * node_ptr;
+  struct list_head * next_ptr;
   struct ladish_command * cmd_ptr;
 
-  if (list_empty(&queue_ptr->queue))
-  { /* nothing to cancel */
-    return;
-  }
-
-  node_ptr = queue_ptr->queue.next; /* current command */
-  cmd_ptr = list_entry(node_ptr, struct ladish_command, siblings);
-  if (cmd_ptr->state != LADISH_COMMAND_STATE_WAITING)
-  {
-    ladish_cqueue_clear(queue_ptr);
-    return;
-  }
+  queue_ptr->cancel = false;
 
-  /* clear all commands except currently waiting one */
-  while (queue_ptr->queue.next != queue_ptr->queue.prev)
+  /* clear all commands except the currently waiting ones */
+  for (node_ptr = queue_ptr->queue.next; node_ptr != &queue_ptr->queue; node_ptr = next_ptr)
   {
-    node_ptr = queue_ptr->queue.prev;
-    list_del(node_ptr);
-
+    next_ptr = node_ptr->next;
     cmd_ptr = list_entry(node_ptr, struct ladish_command, siblings);
 
-    if (cmd_ptr->destructor != NULL)
+    if (cmd_ptr->state != LADISH_COMMAND_STATE_WAITING)
     {
-      cmd_ptr->destructor(cmd_ptr->context);
+      ladish_cqueue_destroy_command(cmd_ptr);
+      continue;
     }
 
-    free(cmd_ptr);
+    queue_ptr->cancel = true;
+    cmd_ptr->cancel = true;
   }
-
-  queue_ptr->cancel = true;
-  cmd_ptr->cancel = true;
 }
 
 bool ladish_cqueue_add_command(struct ladish_cqueue * queue_ptr, struct ladish_command * cmd_ptr)
@@ -142,6 +238,7 @@ bool ladish_cqueue_add_command(struct ladish_cqueue * queue_ptr, struct ladish_c
 
   ASSERT(cmd_ptr->state == LADISH_COMMAND_STATE_PREPARE);
   cmd_ptr->state = LADISH_COMMAND_STATE_PENDING;
+  cmd_ptr->enqueue_time = ladish_get_monotonic_microseconds();
 
   list_add_tail(&cmd_ptr->siblings, &queue_ptr->queue);
   return true;
@@ -216,5 +313,26 @@ void * ladish_command_new(size_t size)
   cmd_ptr->run = NULL;
   cmd_ptr->destructor = NULL;
 
+  uuid_clear(cmd_ptr->scope);
+
+  cmd_ptr->name = NULL;
+  cmd_ptr->wait_reason[0] = 0;
+  cmd_ptr->enqueue_time = 0;
+  cmd_ptr->start_time = 0;
+  cmd_ptr->run_usecs = 0;
+  cmd_ptr->run_count = 0;
+  cmd_ptr->wait_start = 0;
+  cmd_ptr->wait_stage_reason[0] = 0;
+  cmd_ptr->wait_usecs = 0;
+
   return cmd_ptr;
 }
+
+void ladish_command_set_wait_reason(struct ladish_command * cmd_ptr, const char * format, ...)
+{
+  va_list ap;
+
+  va_start(ap, format);
+  vsnprintf(cmd_ptr->wait_reason, sizeof(cmd_ptr->wait_reason), format, ap);
+  va_end(ap);
+}
@@ -0,0 +1,456 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the command queue tracing
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Each command is traced as a sequence of stages: time spent in the queue before
+ * the first run(), the run() invocations and the wait stages between them.
+ * A wait stage is the time between run() leaving the command in waiting state
+ * and the run() that completes the command or changes the wait reason.
+ *
+ * Stages are emitted as CommandTrace signals of the control object.
+ * run() invocations are too frequent for the signal stream while a command waits,
+ * only the slow ones are signalled, all of them are accounted in the completion event.
+ *
+ * When LADISH_CONF_KEY_DAEMON_CQUEUE_TRACE_FILE is set, everything is also
+ * written to that file in the Chrome trace event format (JSON array format),
+ * so it can be loaded in chrome://tracing or compatible viewers.
+ * Each command scope gets its own thread track, the time spent in the queue
+ * is written as async events because it overlaps the commands queued before.
+ *
+ * The queue times commands with the monotonic clock, the times in the signals
+ * are converted to the wall clock when emitted.
+ */
+
+#include <unistd.h>
+
+#include "cqueue_trace.h"
+#include "control.h"
+#include "graph_record.h"
+#include "conf.h"
+#include "studio.h"
+#include "room.h"
+#include "../proxies/conf_proxy.h"
+#include "../common/time.h"
+
+#define CQUEUE_TRACE_SLOW_RUN 1000 /* microseconds, run() invocations that take longer are signalled */
+
+struct ladish_cqueue_trace_thread
+{
+  struct list_head siblings;
+  uuid_t scope;
+  unsigned int tid;
+};
+
+static struct
+{
+  FILE * file;                  /* Chrome trace event file, NULL when not enabled */
+  char * path;
+  bool first;                   /* whether no event was written to the file yet */
+  struct list_head threads;     /* scopes that got a track in the file */
+  unsigned int next_tid;
+} g_cqueue_trace;
+
+static const char * ladish_cqueue_trace_name(struct ladish_command * cmd_ptr)
+{
+  return cmd_ptr->name != NULL ? cmd_ptr->name : "command";
+}
+
+static const char * ladish_cqueue_trace_wait_reason(struct ladish_command * cmd_ptr)
+{
+  return cmd_ptr->wait_reason[0] != 0 ? cmd_ptr->wait_reason : "unspecified";
+}
+
+/* convert time of the monotonic clock to microseconds since the epoch */
+static uint64_t ladish_cqueue_trace_wall_time(uint64_t monotonic)
+{
+  return ladish_get_current_microseconds() - (ladish_get_monotonic_microseconds() - monotonic);
+}
+
+static void
+ladish_cqueue_trace_signal(
+  struct ladish_command * cmd_ptr,
+  const char * stage,
+  uint64_t time,
+  uint64_t duration,
+  const char * detail)
+{
+  emit_command_trace(ladish_cqueue_trace_name(cmd_ptr), stage, ladish_cqueue_trace_wall_time(time), duration, detail);
+}
+
+static void ladish_cqueue_trace_threads_clear(void)
+{
+  struct ladish_cqueue_trace_thread * thread_ptr;
+
+  while (!list_empty(&g_cqueue_trace.threads))
+  {
+    thread_ptr = list_entry(g_cqueue_trace.threads.next, struct ladish_cqueue_trace_thread, siblings);
+    list_del(&thread_ptr->siblings);
+    free(thread_ptr);
+  }
+}
+
+static void ladish_cqueue_trace_file_close(void)
+{
+  if (g_cqueue_trace.file == NULL)
+  {
+    return;
+  }
+
+  ladish_cqueue_trace_threads_clear();
+
+  fputs("\n]\n", g_cqueue_trace.file);
+  if (fclose(g_cqueue_trace.file) != 0)
+  {
+    log_error("fclose(%s) failed: %d (%s)", g_cqueue_trace.path, errno, strerror(errno));
+  }
+
+  g_cqueue_trace.file = NULL;
+  free(g_cqueue_trace.path);
+  g_cqueue_trace.path = NULL;
+}
+
+/* (re)open the trace file if the configured path changed */
+static void ladish_cqueue_trace_file_update(void)
+{
+  const char * path;
+
+  if (!conf_get(LADISH_CONF_KEY_DAEMON_CQUEUE_TRACE_FILE, &path))
+  {
+    path = LADISH_CONF_KEY_DAEMON_CQUEUE_TRACE_FILE_DEFAULT;
+  }
+
+  if (path[0] == 0)
+  {
+    ladish_cqueue_trace_file_close();
+    return;
+  }
+
+  if (g_cqueue_trace.path != NULL && strcmp(g_cqueue_trace.path, path) == 0)
+  {
+    return;
+  }
+
+  ladish_cqueue_trace_file_close();
+
+  g_cqueue_trace.path = strdup(path);
+  if (g_cqueue_trace.path == NULL)
+  {
+    log_error("strdup() failed for command queue trace file path");
+    return;
+  }
+
+  g_cqueue_trace.file = fopen(path, "w");
+  if (g_cqueue_trace.file == NULL)
+  {
+    log_error("fopen(%s) failed: %d (%s)", path, errno, strerror(errno));
+    free(g_cqueue_trace.path);
+    g_cqueue_trace.path = NULL;
+    return;
+  }
+
+  log_info("Writing command queue trace to '%s'", path);
+
+  fputs("[\n", g_cqueue_trace.file);
+  g_cqueue_trace.first = true;
+  INIT_LIST_HEAD(&g_cqueue_trace.threads);
+  g_cqueue_trace.next_tid = 1;
+}
+
+static void ladish_cqueue_trace_write_string(const char * str)
+{
+  unsigned char c;
+
+  fputc('"', g_cqueue_trace.file);
+
+  for (; *str != 0; str++)
+  {
+    c = (unsigned char)*str;
+    if (c == '"' || c == '\\')
+    {
+      fputc('\\', g_cqueue_trace.file);
+      fputc(c, g_cqueue_trace.file);
+    }
+    else if (c < 0x20)
+    {
+      fprintf(g_cqueue_trace.file, "\\u%04x", (unsigned int)c);
+    }
+    else
+    {
+      fputc(c, g_cqueue_trace.file);
+    }
+  }
+
+  fputc('"', g_cqueue_trace.file);
+}
+
+/* Commands of different scopes can run in parallel, each scope gets its own track in the viewer */
+static unsigned long long ladish_cqueue_trace_tid(struct ladish_command * cmd_ptr)
+{
+  struct list_head * node_ptr;
+  struct ladish_cqueue_trace_thread * thread_ptr;
+  ladish_room_handle room;
+  char uuid_str[37];
+
+  list_for_each(node_ptr, &g_cqueue_trace.threads)
+  {
+    thread_ptr = list_entry(node_ptr, struct ladish_cqueue_trace_thread, siblings);
+    if (uuid_compare(thread_ptr->scope, cmd_ptr->scope) == 0)
+    {
+      return thread_ptr->tid;
+    }
+  }
+
+  thread_ptr = malloc(sizeof(struct ladish_cqueue_trace_thread));
+  if (thread_ptr == NULL)
+  {
+    log_error("malloc() failed for command queue trace thread");
+    return 0;
+  }
+
+  uuid_copy(thread_ptr->scope, cmd_ptr->scope);
+  thread_ptr->tid = g_cqueue_trace.next_tid++;
+  list_add_tail(&thread_ptr->siblings, &g_cqueue_trace.threads);
+
+  /* name the track, the metadata event goes before the event that caused the lookup */
+  fprintf(
+    g_cqueue_trace.file,
+    "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%llu,\"tid\":%u,\"args\":{\"name\":",
+    (unsigned long long)getpid(),
+    thread_ptr->tid);
+
+  if (uuid_is_null(cmd_ptr->scope))
+  {
+    ladish_cqueue_trace_write_string("studio");
+  }
+  else
+  {
+    room = ladish_studio_find_room_by_uuid(cmd_ptr->scope);
+    if (room != NULL)
+    {
+      ladish_cqueue_trace_write_string(ladish_room_get_name(room));
+    }
+    else
+    {
+      uuid_unparse(cmd_ptr->scope, uuid_str);
+      ladish_cqueue_trace_write_string(uuid_str);
+    }
+  }
+
+  fputs("}},\n", g_cqueue_trace.file);
+
+  return thread_ptr->tid;
+}
+
+/* Write the common part of an event without the closing brace, so more fields can be appended */
+static bool
+ladish_cqueue_trace_write_event_head(
+  struct ladish_command * cmd_ptr,
+  const char * category,
+  const char * phase,
+  uint64_t time)
+{
+  unsigned long long tid;
+
+  if (g_cqueue_trace.file == NULL)
+  {
+    return false;
+  }
+
+  fputs(g_cqueue_trace.first ? "" : ",\n", g_cqueue_trace.file);
+  g_cqueue_trace.first = false;
+
+  tid = ladish_cqueue_trace_tid(cmd_ptr);
+
+  fputs("{\"name\":", g_cqueue_trace.file);
+  ladish_cqueue_trace_write_string(ladish_cqueue_trace_name(cmd_ptr));
+  fprintf(
+    g_cqueue_trace.file,
+    ",\"cat\":\"%s\",\"ph\":\"%s\",\"ts\":%llu,\"pid\":%llu,\"tid\":%llu",
+    category,
+    phase,
+    (unsigned long long)time,
+    (unsigned long long)getpid(),
+    tid);
+
+  return true;
+}
+
+/* Write complete ("X") event without the closing brace, so args can be appended */
+static bool
+ladish_cqueue_trace_write_event(
+  struct ladish_command * cmd_ptr,
+  const char * category,
+  uint64_t start,
+  uint64_t end)
+{
+  if (!ladish_cqueue_trace_write_event_head(cmd_ptr, category, "X", start))
+  {
+    return false;
+  }
+
+  fprintf(g_cqueue_trace.file, ",\"dur\":%llu", (unsigned long long)(end - start));
+  return true;
+}
+
+static void ladish_cqueue_trace_wait_begin(struct ladish_command * cmd_ptr, uint64_t now)
+{
+  cmd_ptr->wait_start = now;
+  strcpy(cmd_ptr->wait_stage_reason, ladish_cqueue_trace_wait_reason(cmd_ptr));
+
+  ladish_cqueue_trace_signal(cmd_ptr, "waiting", now, 0, cmd_ptr->wait_stage_reason);
+}
+
+static void ladish_cqueue_trace_wait_end(struct ladish_command * cmd_ptr, uint64_t now)
+{
+  uint64_t duration;
+
+  duration = now - cmd_ptr->wait_start;
+  cmd_ptr->wait_usecs += duration;
+
+  log_info(
+    "'%s' waited %llu ms for %s",
+    ladish_cqueue_trace_name(cmd_ptr),
+    (unsigned long long)(duration / 1000),
+    cmd_ptr->wait_stage_reason);
+
+  ladish_cqueue_trace_signal(cmd_ptr, "waited", now, duration, cmd_ptr->wait_stage_reason);
+
+  if (ladish_cqueue_trace_write_event(cmd_ptr, "wait", cmd_ptr->wait_start, now))
+  {
+    fputs(",\"args\":{\"reason\":", g_cqueue_trace.file);
+    ladish_cqueue_trace_write_string(cmd_ptr->wait_stage_reason);
+    fputs("}}", g_cqueue_trace.file);
+  }
+
+  cmd_ptr->wait_start = 0;
+}
+
+static void ladish_cqueue_trace_complete(struct ladish_command * cmd_ptr, uint64_t now, bool success)
+{
+  char detail[128];
+  uint64_t duration;
+
+  duration = now - cmd_ptr->start_time;
+
+  snprintf(
+    detail,
+    sizeof(detail),
+    "%u run() calls, %llu us running, %llu us waiting",
+    cmd_ptr->run_count,
+    (unsigned long long)cmd_ptr->run_usecs,
+    (unsigned long long)cmd_ptr->wait_usecs);
+
+  log_info(
+    "'%s' %s in %llu ms (%s)",
+    ladish_cqueue_trace_name(cmd_ptr),
+    success ? "completed" : "failed",
+    (unsigned long long)(duration / 1000),
+    detail);
+
+  ladish_cqueue_trace_signal(cmd_ptr, success ? "done" : "failed", now, duration, detail);
+  ladish_graph_record_command(
+    ladish_cqueue_trace_name(cmd_ptr),
+    success ? LADISH_GRAPH_RECORD_COMMAND_DONE : LADISH_GRAPH_RECORD_COMMAND_FAILED);
+
+  if (ladish_cqueue_trace_write_event(cmd_ptr, "command", cmd_ptr->start_time, now))
+  {
+    fprintf(
+      g_cqueue_trace.file,
+      ",\"args\":{\"result\":\"%s\",\"runs\":%u,\"run_usecs\":%llu,\"wait_usecs\":%llu}}",
+      success ? "done" : "failed",
+      cmd_ptr->run_count,
+      (unsigned long long)cmd_ptr->run_usecs,
+      (unsigned long long)cmd_ptr->wait_usecs);
+    fflush(g_cqueue_trace.file);
+  }
+}
+
+void ladish_cqueue_trace_start(struct ladish_command * cmd_ptr, uint64_t now)
+{
+  ASSERT(cmd_ptr->start_time == 0);
+
+  ladish_cqueue_trace_file_update();
+
+  cmd_ptr->start_time = now;
+
+  ladish_cqueue_trace_signal(cmd_ptr, "started", now, now - cmd_ptr->enqueue_time, "");
+  ladish_graph_record_command(ladish_cqueue_trace_name(cmd_ptr), LADISH_GRAPH_RECORD_COMMAND_STARTED);
+
+  /* async pair, the command shares the track with the ones queued before it */
+  if (ladish_cqueue_trace_write_event_head(cmd_ptr, "queue", "b", cmd_ptr->enqueue_time))
+  {
+    fprintf(g_cqueue_trace.file, ",\"id\":\"%p\"}", (void *)cmd_ptr);
+    ladish_cqueue_trace_write_event_head(cmd_ptr, "queue", "e", now);
+    fprintf(g_cqueue_trace.file, ",\"id\":\"%p\"}", (void *)cmd_ptr);
+  }
+}
+
+void ladish_cqueue_trace_run(struct ladish_command * cmd_ptr, uint64_t start, uint64_t end, bool success)
+{
+  bool waiting;
+  bool stage_closed;
+
+  cmd_ptr->run_usecs += end - start;
+  cmd_ptr->run_count++;
+
+  if (end - start >= CQUEUE_TRACE_SLOW_RUN)
+  {
+    ladish_cqueue_trace_signal(cmd_ptr, "run", start, end - start, "");
+  }
+
+  if (ladish_cqueue_trace_write_event(cmd_ptr, "run", start, end))
+  {
+    fputc('}', g_cqueue_trace.file);
+  }
+
+  waiting = success && cmd_ptr->state == LADISH_COMMAND_STATE_WAITING;
+
+  stage_closed = false;
+  if (cmd_ptr->wait_start != 0 &&
+      (!waiting || strcmp(cmd_ptr->wait_stage_reason, ladish_cqueue_trace_wait_reason(cmd_ptr)) != 0))
+  {
+    /* the wait stage ended when the run() that noticed it was called */
+    ladish_cqueue_trace_wait_end(cmd_ptr, start);
+    stage_closed = true;
+  }
+
+  if (waiting)
+  {
+    if (cmd_ptr->wait_start == 0)
+    {
+      ladish_cqueue_trace_wait_begin(cmd_ptr, stage_closed ? start : end);
+    }
+
+    return;
+  }
+
+  ladish_cqueue_trace_complete(cmd_ptr, end, success && cmd_ptr->state == LADISH_COMMAND_STATE_DONE);
+}
+
+void ladish_cqueue_trace_uninit(void)
+{
+  ladish_cqueue_trace_file_close();
+}
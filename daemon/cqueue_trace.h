@@ -0,0 +1,41 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains interface to the command queue tracing
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef CQUEUE_TRACE_H__5C3E0F7A_9B2D_4E61_8A47_D1F06B3C2E95__INCLUDED
+#define CQUEUE_TRACE_H__5C3E0F7A_9B2D_4E61_8A47_D1F06B3C2E95__INCLUDED
+
+#include "cmd.h"
+
+/* Called before the first run() of a command */
+void ladish_cqueue_trace_start(struct ladish_command * cmd_ptr, uint64_t now);
+
+/* Called after each run() of a command, start and end are the run() boundaries.
+ * When command did not remain in waiting state, the command trace is completed. */
+void ladish_cqueue_trace_run(struct ladish_command * cmd_ptr, uint64_t start, uint64_t end, bool success);
+
+void ladish_cqueue_trace_uninit(void);
+
+#endif /* #ifndef CQUEUE_TRACE_H__5C3E0F7A_9B2D_4E61_8A47_D1F06B3C2E95__INCLUDED */
@@ -26,46 +26,148 @@
 
 #include "escape.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 static char hex_digits[] = "0123456789ABCDEF";
 
 #define HEX_TO_INT(hexchar) ((hexchar) <= '9' ? hexchar - '0' : 10 + (hexchar - 'A'))
 
+static inline bool escape_char_needed(char c, unsigned int flags)
+{
+  switch (c)
+  {
+  case '/':               /* used as separator for address components */
+  case '\'':
+  case '>':
+  case '%':
+    if ((flags & LADISH_ESCAPE_FLAG_OTHER) == 0)
+    {
+      return false;
+    }
+    /* fall through */
+  case '<':               /* invalid attribute value char (XML spec) */
+  case '&':               /* invalid attribute value char (XML spec) */
+  case '"':               /* we store attribute values in double quotes - invalid attribute value char (XML spec) */
+    return (flags & LADISH_ESCAPE_FLAG_XML_ATTR) != 0;
+  }
+
+  return false;
+}
+
+/* find the first char that needs escaping, or the terminating nul char */
+static const char * escape_scan(const char * src, unsigned int flags)
+{
+#if defined(__SSE2__)
+  __m128i chunk;
+  __m128i hits;
+  bool other;
+  int mask;
+
+  if ((flags & LADISH_ESCAPE_FLAG_XML_ATTR) == 0)
+  {
+    return src + strlen(src);
+  }
+
+  other = (flags & LADISH_ESCAPE_FLAG_OTHER) != 0;
+
+  /* aligned loads never cross a page boundary, so reading past the nul char is safe */
+  while (((uintptr_t)src & 15) != 0)
+  {
+    if (*src == 0 || escape_char_needed(*src, flags))
+    {
+      return src;
+    }
+
+    src++;
+  }
+
+  for (;;)
+  {
+    chunk = _mm_load_si128((const __m128i *)src);
+
+    hits = _mm_cmpeq_epi8(chunk, _mm_setzero_si128());
+    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('<')));
+    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('&')));
+    hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')));
+
+    if (other)
+    {
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('/')));
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\'')));
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('>')));
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('%')));
+    }
+
+    mask = _mm_movemask_epi8(hits);
+    if (mask != 0)
+    {
+      return src + __builtin_ctz(mask);
+    }
+
+    src += 16;
+  }
+#else
+  while (*src != 0 && !escape_char_needed(*src, flags))
+  {
+    src++;
+  }
+
+  return src;
+#endif
+}
+
+size_t escaped_length(const char * src, unsigned int flags)
+{
+  size_t len;
+  const char * end;
+
+  len = 0;
+
+  for (;;)
+  {
+    end = escape_scan(src, flags);
+    len += end - src;
+    if (*end == 0)
+    {
+      return len;
+    }
+
+    len += 3;
+    src = end + 1;
+  }
+}
+
 void escape(const char ** src_ptr, char ** dst_ptr, unsigned int flags)
 {
   const char * src;
   char * dst;
+  const char * end;
+  size_t len;
 
   src = *src_ptr;
   dst = *dst_ptr;
 
-  while (*src != 0)
+  for (;;)
   {
-    switch (*src)
+    /* bulk copy of the span that does not need escaping */
+    end = escape_scan(src, flags);
+    len = end - src;
+    memcpy(dst, src, len);
+    dst += len;
+    src = end;
+
+    if (*src == 0)
     {
-    case '/':               /* used as separator for address components */
-    case '\'':
-    case '>':
-    case '%':
-      if ((flags & LADISH_ESCAPE_FLAG_OTHER) == 0)
-      {
-        break;
-      }
-    case '<':               /* invalid attribute value char (XML spec) */
-    case '&':               /* invalid attribute value char (XML spec) */
-    case '"':               /* we store attribute values in double quotes - invalid attribute value char (XML spec) */
-      if ((flags & LADISH_ESCAPE_FLAG_XML_ATTR) == 0)
-      {
-        break;
-      }
-      dst[0] = '%';
-      dst[1] = hex_digits[*src >> 4];
-      dst[2] = hex_digits[*src & 0x0F];
-      dst += 3;
-      src++;
-      continue;
+      break;
     }
 
-    *dst++ = *src++;
+    dst[0] = '%';
+    dst[1] = hex_digits[(unsigned char)*src >> 4];
+    dst[2] = hex_digits[*src & 0x0F];
+    dst += 3;
+    src++;
   }
 
   *src_ptr = src;
@@ -81,13 +183,28 @@ void escape_simple(const char * src_ptr, char * dst_ptr, unsigned int flags)
 size_t unescape(const char * src, size_t src_len, char * dst)
 {
   size_t dst_len;
+  const char * percent;
+  size_t len;
 
   dst_len = 0;
 
   while (src_len)
   {
+    /* bulk move of the span without percent chars; dst may be same as src */
+    percent = memchr(src, '%', src_len);
+    len = percent != NULL ? (size_t)(percent - src) : src_len;
+    memmove(dst, src, len);
+    src += len;
+    src_len -= len;
+    dst += len;
+    dst_len += len;
+
+    if (src_len == 0)
+    {
+      break;
+    }
+
     if (src_len >= 3 &&
-        src[0] == '%' &&
         ((src[1] >= '0' && src[1] <= '9') ||
          (src[1] >= 'A' && src[1] <= 'F')) &&
         ((src[2] >= '0' && src[2] <= '9') ||
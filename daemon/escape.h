@@ -34,13 +34,16 @@
 #define LADISH_ESCAPE_FLAG_OTHER    ((unsigned int)1 << 1)
 #define LADISH_ESCAPE_FLAG_ALL      UINT_MAX
 
+/* length of the escaped string, without the terminating nul char */
+size_t escaped_length(const char * src, unsigned int flags);
+
 void escape(const char ** src_ptr, char ** dst_ptr, unsigned int flags);
 void escape_simple(const char * src_ptr, char * dst_ptr, unsigned int flags);
 size_t unescape(const char * src, size_t src_len, char * dst);
 void unescape_simple(char * buffer);
 char * unescape_dup(const char * src);
 
-/* encode each char in three bytes (percent encoding) */
+/* encode each char in three bytes (percent encoding); use escaped_length() for exact size */
 #define max_escaped_length(unescaped_length) ((unescaped_length) * 3)
 
 #endif /* #ifndef ESCAPE_H__FABBE484_1093_41C1_9FC9_62ED0106E542__INCLUDED */
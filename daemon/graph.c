@@ -43,6 +43,7 @@ struct ladish_graph_port
   bool hidden;
   bool link;
   uuid_t link_uuid_override;
+  struct list_head connections; /* struct ladish_graph_connection_end */
 };
 
 struct ladish_graph_client
@@ -55,6 +56,15 @@ struct ladish_graph_client
   bool hidden;
 };
 
+struct ladish_graph_connection;
+
+/* connection entry in the list of the port connections */
+struct ladish_graph_connection_end
+{
+  struct list_head siblings;
+  struct ladish_graph_connection * connection_ptr;
+};
+
 struct ladish_graph_connection
 {
   struct list_head siblings;
@@ -62,6 +72,7 @@ struct ladish_graph_connection
   bool hidden;
   struct ladish_graph_port * port1_ptr;
   struct ladish_graph_port * port2_ptr;
+  struct ladish_graph_connection_end ends[2];
   ladish_dict_handle dict;
   bool changing;
 };
@@ -74,6 +85,7 @@ struct ladish_graph
   struct list_head ports;
   struct list_head connections;
   uint64_t graph_version;
+  uint64_t generation;          /* stamp of the last modification, see ladish_graph_get_generation() */
   uint64_t next_client_id;
   uint64_t next_port_id;
   uint64_t next_connection_id;
@@ -82,8 +94,13 @@ struct ladish_graph
   void * context;
   ladish_graph_connect_request_handler connect_handler;
   ladish_graph_disconnect_request_handler disconnect_handler;
+  ladish_graph_connect_request_handler async_connect_handler;
+  ladish_graph_disconnect_request_handler async_disconnect_handler;
+  ladish_graph_commit_request_handler commit_handler;
 };
 
+#define port_connection_entry(node_ptr) (list_entry(node_ptr, struct ladish_graph_connection_end, siblings)->connection_ptr)
+
 static void ladish_graph_emit_ports_disconnected(struct ladish_graph * graph_ptr, struct ladish_graph_connection * connection_ptr)
 {
   ASSERT(graph_ptr->opath != NULL);
@@ -405,16 +422,16 @@ static struct ladish_graph_connection * ladish_graph_find_connection_by_id(struc
 static
 struct ladish_graph_connection *
 ladish_graph_find_connection_by_ports(
-  struct ladish_graph * graph_ptr,
+  struct ladish_graph * UNUSED(graph_ptr),
   struct ladish_graph_port * port1_ptr,
   struct ladish_graph_port * port2_ptr)
 {
   struct list_head * node_ptr;
   struct ladish_graph_connection * connection_ptr;
 
-  list_for_each(node_ptr, &graph_ptr->connections)
+  list_for_each(node_ptr, &port1_ptr->connections)
   {
-    connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
+    connection_ptr = port_connection_entry(node_ptr);
     if ((connection_ptr->port1_ptr == port1_ptr && connection_ptr->port2_ptr == port2_ptr) ||
         (connection_ptr->port1_ptr == port2_ptr && connection_ptr->port2_ptr == port1_ptr))
     {
@@ -425,6 +442,14 @@ ladish_graph_find_connection_by_ports(
   return NULL;
 }
 
+static void ladish_graph_commit_requests(struct ladish_graph * graph_ptr, unsigned int count)
+{
+  if (count != 0 && graph_ptr->commit_handler != NULL)
+  {
+    graph_ptr->commit_handler(graph_ptr->context, (ladish_graph_handle)graph_ptr);
+  }
+}
+
 #define graph_ptr ((struct ladish_graph *)call_ptr->iface_context)
 
 static void get_all_ports(struct cdbus_method_call * call_ptr)
@@ -939,6 +964,320 @@ static void disconnect_ports_by_connection_id(struct cdbus_method_call * call_pt
   disconnect_ports(call_ptr, connection_ptr);
 }
 
+/* iterate the a(tt) argument of the batch (dis)connect methods */
+static
+bool
+ladish_graph_iterate_port_id_pairs(
+  struct cdbus_method_call * call_ptr,
+  void * context,
+  bool (* callback)(struct cdbus_method_call * call_ptr, void * context, uint64_t port1_id, uint64_t port2_id))
+{
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+  DBusMessageIter struct_iter;
+  dbus_uint64_t port1_id;
+  dbus_uint64_t port2_id;
+
+  if (strcmp(dbus_message_get_signature(call_ptr->message), "a(tt)") != 0)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": array of port id pairs expected", call_ptr->method_name);
+    return false;
+  }
+
+  dbus_message_iter_init(call_ptr->message, &iter);
+
+  for (dbus_message_iter_recurse(&iter, &array_iter);
+       dbus_message_iter_get_arg_type(&array_iter) != DBUS_TYPE_INVALID;
+       dbus_message_iter_next(&array_iter))
+  {
+    dbus_message_iter_recurse(&array_iter, &struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &port1_id);
+    dbus_message_iter_next(&struct_iter);
+
+    dbus_message_iter_get_basic(&struct_iter, &port2_id);
+
+    if (!callback(call_ptr, context, port1_id, port2_id))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+#define GRAPH_BATCH_PAIRS_MIN_BUCKETS 64
+
+struct ladish_graph_batch_pair
+{
+  struct ladish_graph_port * port1_ptr;
+  struct ladish_graph_port * port2_ptr;
+  unsigned int next;            /* index + 1 of the next pair in the same bucket, 0 for none */
+};
+
+struct ladish_graph_batch_context
+{
+  unsigned int requested;
+  unsigned int failed;
+  struct ladish_graph_batch_pair * pairs; /* connect requests made by the batch */
+  unsigned int pairs_count;
+  unsigned int * buckets;       /* index + 1 of the first pair in the bucket, 0 for empty bucket */
+  unsigned int buckets_count;   /* power of two, kept not smaller than pairs_count */
+};
+
+static
+unsigned int
+ladish_graph_batch_pair_hash(
+  struct ladish_graph_batch_context * batch_ptr,
+  struct ladish_graph_port * port1_ptr,
+  struct ladish_graph_port * port2_ptr)
+{
+  uintptr_t a;
+  uintptr_t b;
+
+  /* the pair matches regardless of the port order */
+  a = (uintptr_t)port1_ptr;
+  b = (uintptr_t)port2_ptr;
+  if (a > b)
+  {
+    a = (uintptr_t)port2_ptr;
+    b = (uintptr_t)port1_ptr;
+  }
+
+  return (unsigned int)(((a >> 4) * 31 + (b >> 4)) * 2654435761u) & (batch_ptr->buckets_count - 1);
+}
+
+/* The connection object is created when JACK reports the connection,
+ * so a connect request that is still pending is found only in the batch itself */
+static
+bool
+ladish_graph_batch_has_pair(
+  struct ladish_graph_batch_context * batch_ptr,
+  struct ladish_graph_port * port1_ptr,
+  struct ladish_graph_port * port2_ptr)
+{
+  unsigned int index;
+  struct ladish_graph_batch_pair * pair_ptr;
+
+  if (batch_ptr->buckets_count == 0)
+  {
+    return false;
+  }
+
+  for (index = batch_ptr->buckets[ladish_graph_batch_pair_hash(batch_ptr, port1_ptr, port2_ptr)];
+       index != 0;
+       index = pair_ptr->next)
+  {
+    pair_ptr = batch_ptr->pairs + index - 1;
+    if ((pair_ptr->port1_ptr == port1_ptr && pair_ptr->port2_ptr == port2_ptr) ||
+        (pair_ptr->port1_ptr == port2_ptr && pair_ptr->port2_ptr == port1_ptr))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static
+void
+ladish_graph_batch_add_pair(
+  struct ladish_graph_batch_context * batch_ptr,
+  struct ladish_graph_port * port1_ptr,
+  struct ladish_graph_port * port2_ptr)
+{
+  struct ladish_graph_batch_pair * pairs;
+  unsigned int * buckets;
+  unsigned int buckets_count;
+  unsigned int bucket;
+  unsigned int i;
+
+  if (batch_ptr->pairs_count == batch_ptr->buckets_count)
+  {
+    buckets_count = batch_ptr->buckets_count != 0 ? batch_ptr->buckets_count * 2 : GRAPH_BATCH_PAIRS_MIN_BUCKETS;
+
+    pairs = realloc(batch_ptr->pairs, buckets_count * sizeof(struct ladish_graph_batch_pair));
+    if (pairs == NULL)
+    {
+      log_error("realloc() failed for batch port pairs, duplicate connect requests will not be skipped");
+      return;
+    }
+
+    batch_ptr->pairs = pairs;
+
+    buckets = calloc(buckets_count, sizeof(unsigned int));
+    if (buckets == NULL)
+    {
+      log_error("calloc() failed for batch port pair buckets, duplicate connect requests will not be skipped");
+      return;
+    }
+
+    free(batch_ptr->buckets);   /* safe if NULL */
+    batch_ptr->buckets = buckets;
+    batch_ptr->buckets_count = buckets_count;
+
+    /* rehash */
+    for (i = 0; i < batch_ptr->pairs_count; i++)
+    {
+      bucket = ladish_graph_batch_pair_hash(batch_ptr, pairs[i].port1_ptr, pairs[i].port2_ptr);
+      pairs[i].next = buckets[bucket];
+      buckets[bucket] = i + 1;
+    }
+  }
+
+  bucket = ladish_graph_batch_pair_hash(batch_ptr, port1_ptr, port2_ptr);
+  batch_ptr->pairs[batch_ptr->pairs_count].port1_ptr = port1_ptr;
+  batch_ptr->pairs[batch_ptr->pairs_count].port2_ptr = port2_ptr;
+  batch_ptr->pairs[batch_ptr->pairs_count].next = batch_ptr->buckets[bucket];
+  batch_ptr->pairs_count++;
+  batch_ptr->buckets[bucket] = batch_ptr->pairs_count;
+}
+
+#define batch_ptr ((struct ladish_graph_batch_context *)context)
+
+static bool connect_ports_batch_item(struct cdbus_method_call * call_ptr, void * context, uint64_t port1_id, uint64_t port2_id)
+{
+  struct ladish_graph_port * port1_ptr;
+  struct ladish_graph_port * port2_ptr;
+  ladish_graph_connect_request_handler handler;
+
+  port1_ptr = ladish_graph_find_port_by_id_internal(graph_ptr, port1_id);
+  port2_ptr = ladish_graph_find_port_by_id_internal(graph_ptr, port2_id);
+  if (port1_ptr == NULL || port2_ptr == NULL)
+  {
+    log_error("Cannot connect unknown port, ids %"PRIu64" and %"PRIu64, port1_id, port2_id);
+    batch_ptr->failed++;
+    return true;
+  }
+
+  if (ladish_graph_find_connection_by_ports(graph_ptr, port1_ptr, port2_ptr) != NULL ||
+      ladish_graph_batch_has_pair(batch_ptr, port1_ptr, port2_ptr))
+  {
+    /* already connected or being connected */
+    return true;
+  }
+
+  log_info("connecting '%s':'%s' to '%s':'%s'", port1_ptr->client_ptr->name, port1_ptr->name, port2_ptr->client_ptr->name, port2_ptr->name);
+
+  handler = graph_ptr->async_connect_handler != NULL ? graph_ptr->async_connect_handler : graph_ptr->connect_handler;
+  if (!handler(graph_ptr->context, (ladish_graph_handle)graph_ptr, port1_ptr->port, port2_ptr->port))
+  {
+    batch_ptr->failed++;
+    return true;
+  }
+
+  ladish_graph_batch_add_pair(batch_ptr, port1_ptr, port2_ptr);
+  batch_ptr->requested++;
+  return true;
+}
+
+static bool disconnect_ports_batch_item(struct cdbus_method_call * call_ptr, void * context, uint64_t port1_id, uint64_t port2_id)
+{
+  struct ladish_graph_port * port1_ptr;
+  struct ladish_graph_port * port2_ptr;
+  struct ladish_graph_connection * connection_ptr;
+  ladish_graph_disconnect_request_handler handler;
+
+  port1_ptr = ladish_graph_find_port_by_id_internal(graph_ptr, port1_id);
+  port2_ptr = ladish_graph_find_port_by_id_internal(graph_ptr, port2_id);
+  connection_ptr = port1_ptr != NULL && port2_ptr != NULL ? ladish_graph_find_connection_by_ports(graph_ptr, port1_ptr, port2_ptr) : NULL;
+  if (connection_ptr == NULL || connection_ptr->hidden)
+  {
+    log_error("Cannot disconnect not connected ports %"PRIu64" and %"PRIu64, port1_id, port2_id);
+    batch_ptr->failed++;
+    return true;
+  }
+
+  if (connection_ptr->changing)
+  {
+    return true;
+  }
+
+  log_info(
+    "disconnecting '%s':'%s' from '%s':'%s'",
+    connection_ptr->port1_ptr->client_ptr->name,
+    connection_ptr->port1_ptr->name,
+    connection_ptr->port2_ptr->client_ptr->name,
+    connection_ptr->port2_ptr->name);
+
+  handler = graph_ptr->async_disconnect_handler != NULL ? graph_ptr->async_disconnect_handler : graph_ptr->disconnect_handler;
+
+  connection_ptr->changing = true;
+  if (!handler(graph_ptr->context, (ladish_graph_handle)graph_ptr, connection_ptr->id))
+  {
+    connection_ptr->changing = false;
+    batch_ptr->failed++;
+    return true;
+  }
+
+  batch_ptr->requested++;
+  return true;
+}
+
+#undef batch_ptr
+
+static
+void
+ports_batch_request(
+  struct cdbus_method_call * call_ptr,
+  bool connect,
+  bool (* item_callback)(struct cdbus_method_call * call_ptr, void * context, uint64_t port1_id, uint64_t port2_id))
+{
+  struct ladish_graph_batch_context batch;
+  bool ret;
+
+  if ((connect ? graph_ptr->connect_handler == NULL : graph_ptr->disconnect_handler == NULL))
+  {
+    cdbus_error(
+      call_ptr,
+      DBUS_ERROR_FAILED,
+      "%s requests on graph %s cannot be handlined",
+      connect ? "connect" : "disconnect",
+      graph_ptr->opath != NULL ? graph_ptr->opath : "JACK");
+    return;
+  }
+
+  batch.requested = 0;
+  batch.failed = 0;
+  batch.pairs = NULL;
+  batch.pairs_count = 0;
+  batch.buckets = NULL;
+  batch.buckets_count = 0;
+
+  ret = ladish_graph_iterate_port_id_pairs(call_ptr, &batch, item_callback);
+
+  free(batch.pairs);            /* safe if NULL */
+  free(batch.buckets);          /* safe if NULL */
+
+  /* the requests that were made before a failure are sent anyway */
+  ladish_graph_commit_requests(graph_ptr, batch.requested);
+
+  log_info("%s(): %u requests made, %u failed", call_ptr->method_name, batch.requested, batch.failed);
+
+  if (!ret)
+  {
+    return;
+  }
+
+  if (batch.failed != 0)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "%u of the requests failed", batch.failed);
+    return;
+  }
+
+  cdbus_method_return_new_void(call_ptr);
+}
+
+static void connect_ports_by_ids(struct cdbus_method_call * call_ptr)
+{
+  ports_batch_request(call_ptr, true, connect_ports_batch_item);
+}
+
+static void disconnect_ports_by_ids(struct cdbus_method_call * call_ptr)
+{
+  ports_batch_request(call_ptr, false, disconnect_ports_batch_item);
+}
+
 static void get_client_pid(struct cdbus_method_call * call_ptr)
 {
   int64_t pid = 0;
@@ -989,6 +1328,7 @@ bool ladish_graph_create(ladish_graph_handle * graph_handle_ptr, const char * op
   INIT_LIST_HEAD(&graph_ptr->connections);
 
   graph_ptr->graph_version = 1;
+  graph_ptr->generation = ladish_generation_next();
   graph_ptr->next_client_id = 1;
   graph_ptr->next_port_id = 1;
   graph_ptr->next_connection_id = 1;
@@ -996,6 +1336,9 @@ bool ladish_graph_create(ladish_graph_handle * graph_handle_ptr, const char * op
   graph_ptr->context = NULL;
   graph_ptr->connect_handler = NULL;
   graph_ptr->disconnect_handler = NULL;
+  graph_ptr->async_connect_handler = NULL;
+  graph_ptr->async_disconnect_handler = NULL;
+  graph_ptr->commit_handler = NULL;
 
   graph_ptr->persist = true;
 
@@ -1126,6 +1469,7 @@ static void ladish_graph_hide_connection_internal(struct ladish_graph * graph_pt
   ASSERT(!connection_ptr->hidden);
   connection_ptr->hidden = true;
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
 
   if (graph_ptr->opath != NULL)
   {
@@ -1133,12 +1477,77 @@ static void ladish_graph_hide_connection_internal(struct ladish_graph * graph_pt
   }
 }
 
+/* returns whether connect request was issued */
+static bool ladish_graph_autoconnect(struct ladish_graph * graph_ptr, struct ladish_graph_connection * connection_ptr)
+{
+  ladish_graph_connect_request_handler handler;
+
+  if (!connection_ptr->hidden ||
+      connection_ptr->changing ||
+      connection_ptr->port1_ptr->hidden ||
+      connection_ptr->port2_ptr->hidden)
+  {
+    return false;
+  }
+
+  log_info(
+    "auto connecting '%s':'%s' to '%s':'%s'",
+    connection_ptr->port1_ptr->client_ptr->name,
+    connection_ptr->port1_ptr->name,
+    connection_ptr->port2_ptr->client_ptr->name,
+    connection_ptr->port2_ptr->name);
+
+  /* prefer the handler that does not wait for the connect to complete */
+  handler = graph_ptr->async_connect_handler != NULL ? graph_ptr->async_connect_handler : graph_ptr->connect_handler;
+
+  connection_ptr->changing = true;
+  if (!handler(graph_ptr->context, (ladish_graph_handle)graph_ptr, connection_ptr->port1_ptr->port, connection_ptr->port2_ptr->port))
+  {
+    connection_ptr->changing = false;
+    log_error("auto connect failed.");
+    return false;
+  }
+
+  return true;
+}
+
+/* check only the connections of the port that just became visible */
+static void ladish_graph_try_connect_port_hidden_connections(struct ladish_graph * graph_ptr, struct ladish_graph_port * port_ptr)
+{
+  struct list_head * node_ptr;
+  unsigned int count;
+
+  if (list_empty(&port_ptr->connections))
+  {
+    return;
+  }
+
+  if (graph_ptr->connect_handler == NULL)
+  {
+    ASSERT_NO_PASS;
+    return;
+  }
+
+  count = 0;
+
+  list_for_each(node_ptr, &port_ptr->connections)
+  {
+    if (ladish_graph_autoconnect(graph_ptr, port_connection_entry(node_ptr)))
+    {
+      count++;
+    }
+  }
+
+  ladish_graph_commit_requests(graph_ptr, count);
+}
+
 static void ladish_graph_show_port_internal(struct ladish_graph * graph_ptr, struct ladish_graph_port * port_ptr)
 {
   if (port_ptr->client_ptr->hidden)
   {
     port_ptr->client_ptr->hidden = false;
     graph_ptr->graph_version++;
+    graph_ptr->generation = ladish_generation_next();
     if (graph_ptr->opath != NULL)
     {
       ladish_graph_emit_client_appeared(graph_ptr, port_ptr->client_ptr);
@@ -1148,10 +1557,11 @@ static void ladish_graph_show_port_internal(struct ladish_graph * graph_ptr, str
   ASSERT(port_ptr->hidden);
   port_ptr->hidden = false;
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
   if (graph_ptr->opath != NULL)
   {
     ladish_graph_emit_port_appeared(graph_ptr, port_ptr);
-    ladish_try_connect_hidden_connections((ladish_graph_handle)graph_ptr);
+    ladish_graph_try_connect_port_hidden_connections(graph_ptr, port_ptr);
   }
 }
 
@@ -1160,6 +1570,7 @@ static void ladish_graph_hide_port_internal(struct ladish_graph * graph_ptr, str
   ASSERT(!port_ptr->hidden);
   port_ptr->hidden = true;
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
 
   if (graph_ptr->opath != NULL)
   {
@@ -1172,6 +1583,7 @@ static void ladish_graph_hide_client_internal(struct ladish_graph * graph_ptr, s
   ASSERT(!client_ptr->hidden);
   client_ptr->hidden = true;
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
 
   if (graph_ptr->opath != NULL)
   {
@@ -1188,10 +1600,10 @@ static void ladish_hide_connections(struct ladish_graph * graph_ptr, struct ladi
 
   ASSERT(graph_ptr->opath != NULL);
 
-  list_for_each(node_ptr, &graph_ptr->connections)
+  list_for_each(node_ptr, &port_ptr->connections)
   {
-    connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
-    if (!connection_ptr->hidden && (connection_ptr->port1_ptr == port_ptr || connection_ptr->port2_ptr == port_ptr))
+    connection_ptr = port_connection_entry(node_ptr);
+    if (!connection_ptr->hidden)
     {
       log_info("hidding connection between ports %"PRIu64" and %"PRIu64, connection_ptr->port1_ptr->id, connection_ptr->port2_ptr->id);
       ladish_graph_hide_connection_internal(graph_ptr, connection_ptr);
@@ -1202,7 +1614,10 @@ static void ladish_hide_connections(struct ladish_graph * graph_ptr, struct ladi
 static void ladish_graph_remove_connection_internal(struct ladish_graph * graph_ptr, struct ladish_graph_connection * connection_ptr)
 {
   list_del(&connection_ptr->siblings);
+  list_del(&connection_ptr->ends[0].siblings);
+  list_del(&connection_ptr->ends[1].siblings);
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
 
   if (!connection_ptr->hidden && graph_ptr->opath != NULL)
   {
@@ -1219,14 +1634,11 @@ static void ladish_graph_remove_port_connections(struct ladish_graph * graph_ptr
   struct list_head * temp_node_ptr;
   struct ladish_graph_connection * connection_ptr;
 
-  list_for_each_safe(node_ptr, temp_node_ptr, &graph_ptr->connections)
+  list_for_each_safe(node_ptr, temp_node_ptr, &port_ptr->connections)
   {
-    connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
-    if (connection_ptr->port1_ptr == port_ptr || connection_ptr->port2_ptr == port_ptr)
-    {
-      log_info("removing connection between ports %"PRIu64" and %"PRIu64, connection_ptr->port1_ptr->id, connection_ptr->port2_ptr->id);
-      ladish_graph_remove_connection_internal(graph_ptr, connection_ptr);
-    }
+    connection_ptr = port_connection_entry(node_ptr);
+    log_info("removing connection between ports %"PRIu64" and %"PRIu64, connection_ptr->port1_ptr->id, connection_ptr->port2_ptr->id);
+    ladish_graph_remove_connection_internal(graph_ptr, connection_ptr);
   }
 }
 
@@ -1243,6 +1655,7 @@ ladish_graph_remove_port_internal(
 
   list_del(&port_ptr->siblings_client);
   list_del(&port_ptr->siblings_graph);
+  graph_ptr->generation = ladish_generation_next();
 
   log_info("removing port '%s':'%s' (%"PRIu64":%"PRIu64") from graph %s", client_ptr->name, port_ptr->name, client_ptr->id, port_ptr->id, graph_ptr->opath != NULL ? graph_ptr->opath : "JACK");
   if (graph_ptr->opath != NULL && !port_ptr->hidden)
@@ -1276,6 +1689,7 @@ ladish_graph_remove_client_internal(
   }
 
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
   list_del(&client_ptr->siblings);
   log_info("removing client '%s' (%"PRIu64") from graph %s", client_ptr->name, client_ptr->id, graph_ptr->opath != NULL ? graph_ptr->opath : "JACK");
   if (graph_ptr->opath != NULL && !client_ptr->hidden)
@@ -1352,6 +1766,42 @@ ladish_graph_set_connection_handlers(
   graph_ptr->disconnect_handler = disconnect_handler;
 }
 
+void
+ladish_graph_set_async_connection_handlers(
+  ladish_graph_handle graph_handle,
+  ladish_graph_connect_request_handler connect_handler,
+  ladish_graph_disconnect_request_handler disconnect_handler,
+  ladish_graph_commit_request_handler commit_handler)
+{
+  graph_ptr->async_connect_handler = connect_handler;
+  graph_ptr->async_disconnect_handler = disconnect_handler;
+  graph_ptr->commit_handler = commit_handler;
+}
+
+void
+ladish_graph_cancel_connection_change(
+  ladish_graph_handle graph_handle,
+  ladish_port_handle port1_handle,
+  ladish_port_handle port2_handle)
+{
+  struct ladish_graph_port * port1_ptr;
+  struct ladish_graph_port * port2_ptr;
+  struct ladish_graph_connection * connection_ptr;
+
+  port1_ptr = ladish_graph_find_port(graph_ptr, port1_handle);
+  port2_ptr = ladish_graph_find_port(graph_ptr, port2_handle);
+  if (port1_ptr == NULL || port2_ptr == NULL)
+  {
+    return;
+  }
+
+  connection_ptr = ladish_graph_find_connection_by_ports(graph_ptr, port1_ptr, port2_ptr);
+  if (connection_ptr != NULL)
+  {
+    connection_ptr->changing = false;
+  }
+}
+
 void ladish_graph_clear(ladish_graph_handle graph_handle, ladish_graph_simple_port_callback port_callback)
 {
   struct ladish_graph_client * client_ptr;
@@ -1382,6 +1832,41 @@ ladish_dict_handle ladish_graph_get_dict(ladish_graph_handle graph_handle)
   return graph_ptr->dict;
 }
 
+#define GENERATION_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+uint64_t ladish_graph_get_generation(ladish_graph_handle graph_handle)
+{
+  uint64_t generation;
+  struct list_head * node_ptr;
+  struct ladish_graph_client * client_ptr;
+  struct ladish_graph_port * port_ptr;
+  struct ladish_graph_connection * connection_ptr;
+
+  generation = GENERATION_MAX(graph_ptr->generation, ladish_dict_get_generation(graph_ptr->dict));
+
+  list_for_each(node_ptr, &graph_ptr->clients)
+  {
+    client_ptr = list_entry(node_ptr, struct ladish_graph_client, siblings);
+    generation = GENERATION_MAX(generation, ladish_client_get_generation(client_ptr->client));
+  }
+
+  list_for_each(node_ptr, &graph_ptr->ports)
+  {
+    port_ptr = list_entry(node_ptr, struct ladish_graph_port, siblings_graph);
+    generation = GENERATION_MAX(generation, ladish_port_get_generation(port_ptr->port));
+  }
+
+  list_for_each(node_ptr, &graph_ptr->connections)
+  {
+    connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
+    generation = GENERATION_MAX(generation, ladish_dict_get_generation(connection_ptr->dict));
+  }
+
+  return generation;
+}
+
+#undef GENERATION_MAX
+
 void ladish_graph_show_connection(ladish_graph_handle graph_handle, uint64_t connection_id)
 {
   struct ladish_graph_connection * connection_ptr;
@@ -1400,6 +1885,7 @@ void ladish_graph_show_connection(ladish_graph_handle graph_handle, uint64_t con
   connection_ptr->hidden = false;
   connection_ptr->changing = false;
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
 
   ladish_graph_emit_ports_connected(graph_ptr, connection_ptr);
 }
@@ -1479,6 +1965,7 @@ void ladish_graph_show_client(ladish_graph_handle graph_handle, ladish_client_ha
   ASSERT(client_ptr->hidden);
   client_ptr->hidden = false;
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
 
   if (graph_ptr->opath != NULL)
   {
@@ -1501,6 +1988,7 @@ void ladish_graph_adjust_port(ladish_graph_handle graph_handle, ladish_port_hand
 
   port_ptr->type = type;
   port_ptr->flags = flags;
+  graph_ptr->generation = ladish_generation_next();
 }
 
 bool ladish_graph_add_client(ladish_graph_handle graph_handle, ladish_client_handle client_handle, const char * name, bool hidden)
@@ -1528,6 +2016,7 @@ bool ladish_graph_add_client(ladish_graph_handle graph_handle, ladish_client_han
   client_ptr->client = client_handle;
   client_ptr->hidden = hidden;
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
 
   INIT_LIST_HEAD(&client_ptr->ports);
 
@@ -1627,6 +2116,7 @@ ladish_graph_add_port(
   port_ptr->port = port_handle;
   ladish_port_add_ref(port_ptr->port);
   port_ptr->hidden = true;
+  INIT_LIST_HEAD(&port_ptr->connections);
 
   port_ptr->link = ladish_port_is_link(port_handle);
   if (port_ptr->link)
@@ -1637,6 +2127,7 @@ ladish_graph_add_port(
   port_ptr->client_ptr = client_ptr;
   list_add_tail(&port_ptr->siblings_client, &client_ptr->ports);
   list_add_tail(&port_ptr->siblings_graph, &graph_ptr->ports);
+  graph_ptr->generation = ladish_generation_next();
 
   if (!hidden)
   {
@@ -1682,9 +2173,15 @@ ladish_graph_add_connection(
   connection_ptr->hidden = hidden;
   connection_ptr->changing = false;
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
 
   list_add_tail(&connection_ptr->siblings, &graph_ptr->connections);
 
+  connection_ptr->ends[0].connection_ptr = connection_ptr;
+  connection_ptr->ends[1].connection_ptr = connection_ptr;
+  list_add_tail(&connection_ptr->ends[0].siblings, &port1_ptr->connections);
+  list_add_tail(&connection_ptr->ends[1].siblings, &port2_ptr->connections);
+
   /* log_info( */
   /*   "new connection %"PRIu64" between '%s':'%s' and '%s':'%s'", */
   /*   connection_ptr->id, */
@@ -2118,6 +2615,7 @@ ladish_graph_move_port(
   list_del(&port_ptr->siblings_client);
   list_del(&port_ptr->siblings_graph);
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
 
   if (graph_ptr->opath != NULL && !port_ptr->hidden)
   {
@@ -2139,6 +2637,7 @@ ladish_graph_move_port(
   list_add_tail(&port_ptr->siblings_client, &client_ptr->ports);
   list_add_tail(&port_ptr->siblings_graph, &graph_ptr->ports);
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
 
   if (graph_ptr->opath != NULL && !port_ptr->hidden)
   {
@@ -2186,6 +2685,7 @@ ladish_graph_rename_client(
   client_ptr->name = name;
 
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
 
   if (!client_ptr->hidden && graph_ptr->opath != NULL)
   {
@@ -2235,6 +2735,7 @@ ladish_graph_rename_port(
   port_ptr->name = name;
 
   graph_ptr->graph_version++;
+  graph_ptr->generation = ladish_generation_next();
 
   if (!port_ptr->hidden && graph_ptr->opath != NULL)
   {
@@ -2322,7 +2823,7 @@ bool ladish_graph_client_is_hidden(ladish_graph_handle graph_handle, ladish_clie
 void ladish_try_connect_hidden_connections(ladish_graph_handle graph_handle)
 {
   struct list_head * node_ptr;
-  struct ladish_graph_connection * connection_ptr;
+  unsigned int count;
 
   if (!list_empty(&graph_ptr->connections) && graph_ptr->connect_handler == NULL)
   {
@@ -2332,45 +2833,26 @@ void ladish_try_connect_hidden_connections(ladish_graph_handle graph_handle)
 
   ASSERT(graph_ptr->opath != NULL);
 
+  count = 0;
+
   list_for_each(node_ptr, &graph_ptr->connections)
   {
-    connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
-    log_debug(
-      "checking connection (%s, %s) '%s':'%s' (%s) to '%s':'%s' (%s)",
-      connection_ptr->hidden ? "hidden" : "visible",
-      connection_ptr->changing ? "changing" : "not changing",
-      connection_ptr->port1_ptr->client_ptr->name,
-      connection_ptr->port1_ptr->name,
-      connection_ptr->port1_ptr->hidden ? "hidden" : "visible",
-      connection_ptr->port2_ptr->client_ptr->name,
-      connection_ptr->port2_ptr->name,
-      connection_ptr->port2_ptr->hidden ? "hidden" : "visible");
-    if (connection_ptr->hidden &&
-        !connection_ptr->changing &&
-        !connection_ptr->port1_ptr->hidden &&
-        !connection_ptr->port2_ptr->hidden)
+    if (ladish_graph_autoconnect(graph_ptr, list_entry(node_ptr, struct ladish_graph_connection, siblings)))
     {
-      log_info(
-        "auto connecting '%s':'%s' to '%s':'%s'",
-        connection_ptr->port1_ptr->client_ptr->name,
-        connection_ptr->port1_ptr->name,
-        connection_ptr->port2_ptr->client_ptr->name,
-        connection_ptr->port2_ptr->name);
-
-      connection_ptr->changing = true;
-      if (!graph_ptr->connect_handler(graph_ptr->context, graph_handle, connection_ptr->port1_ptr->port, connection_ptr->port2_ptr->port))
-      {
-        connection_ptr->changing = false;
-        log_error("auto connect failed.");
-      }
+      count++;
     }
   }
+
+  ladish_graph_commit_requests(graph_ptr, count);
 }
 
 bool ladish_disconnect_visible_connections(ladish_graph_handle graph_handle)
 {
   struct list_head * node_ptr;
   struct ladish_graph_connection * connection_ptr;
+  ladish_graph_disconnect_request_handler handler;
+  unsigned int count;
+  bool ret;
 
   if (graph_ptr->disconnect_handler == NULL)
   {
@@ -2380,19 +2862,13 @@ bool ladish_disconnect_visible_connections(ladish_graph_handle graph_handle)
 
   ASSERT(graph_ptr->opath != NULL);
 
+  handler = graph_ptr->async_disconnect_handler != NULL ? graph_ptr->async_disconnect_handler : graph_ptr->disconnect_handler;
+  count = 0;
+  ret = true;
+
   list_for_each(node_ptr, &graph_ptr->connections)
   {
     connection_ptr = list_entry(node_ptr, struct ladish_graph_connection, siblings);
-    log_debug(
-      "checking connection (%s, %s) '%s':'%s' (%s) to '%s':'%s' (%s)",
-      connection_ptr->hidden ? "hidden" : "visible",
-      connection_ptr->changing ? "changing" : "not changing",
-      connection_ptr->port1_ptr->client_ptr->name,
-      connection_ptr->port1_ptr->name,
-      connection_ptr->port1_ptr->hidden ? "hidden" : "visible",
-      connection_ptr->port2_ptr->client_ptr->name,
-      connection_ptr->port2_ptr->name,
-      connection_ptr->port2_ptr->hidden ? "hidden" : "visible");
     if (!connection_ptr->hidden &&
         !connection_ptr->changing &&
         !connection_ptr->port1_ptr->hidden &&
@@ -2406,16 +2882,22 @@ bool ladish_disconnect_visible_connections(ladish_graph_handle graph_handle)
         connection_ptr->port2_ptr->name);
 
       connection_ptr->changing = true;
-      if (!graph_ptr->disconnect_handler(graph_ptr->context, graph_handle, connection_ptr->id))
+      if (!handler(graph_ptr->context, graph_handle, connection_ptr->id))
       {
         connection_ptr->changing = false;
         log_error("disconnect failed.");
-        return false;
+        ret = false;
+        break;
       }
+
+      count++;
     }
   }
 
-  return true;
+  /* send the already queued requests even after a failure */
+  ladish_graph_commit_requests(graph_ptr, count);
+
+  return ret;
 }
 
 void ladish_graph_hide_non_virtual(ladish_graph_handle graph_handle)
@@ -2515,6 +2997,7 @@ ladish_graph_set_link_port_override_uuid(
   ASSERT(port_ptr != NULL && ladish_port_is_link(port_ptr->port));
 
   uuid_copy(port_ptr->link_uuid_override, override_uuid);
+  graph_ptr->generation = ladish_generation_next();
 }
 
 bool
@@ -3065,6 +3548,10 @@ CDBUS_METHOD_ARGS_BEGIN(ConnectPortsByID, "Connect ports")
   CDBUS_METHOD_ARG_DESCRIBE_IN("port2_id", DBUS_TYPE_UINT64_AS_STRING, "if of second port")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(ConnectPortsByIDs, "Connect pairs of ports, without waiting for the connects to complete")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("port_id_pairs", "a(tt)", "ids of the ports to connect")
+CDBUS_METHOD_ARGS_END
+
 CDBUS_METHOD_ARGS_BEGIN(DisconnectPortsByName, "Disconnect ports")
   CDBUS_METHOD_ARG_DESCRIBE_IN("client1_name", DBUS_TYPE_STRING_AS_STRING, "name first port client")
   CDBUS_METHOD_ARG_DESCRIBE_IN("port1_name", DBUS_TYPE_STRING_AS_STRING, "name of first port")
@@ -3077,6 +3564,10 @@ CDBUS_METHOD_ARGS_BEGIN(DisconnectPortsByID, "Disconnect ports")
   CDBUS_METHOD_ARG_DESCRIBE_IN("port2_id", DBUS_TYPE_UINT64_AS_STRING, "if of second port")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(DisconnectPortsByIDs, "Disconnect pairs of ports, without waiting for the disconnects to complete")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("port_id_pairs", "a(tt)", "ids of the ports to disconnect")
+CDBUS_METHOD_ARGS_END
+
 CDBUS_METHOD_ARGS_BEGIN(DisconnectPortsByConnectionID, "Disconnect ports")
   CDBUS_METHOD_ARG_DESCRIBE_IN("connection_id", DBUS_TYPE_UINT64_AS_STRING, "id of connection to disconnect")
 CDBUS_METHOD_ARGS_END
@@ -3091,8 +3582,10 @@ CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(GetGraph, get_graph)
   CDBUS_METHOD_DESCRIBE(ConnectPortsByName, connect_ports_by_name)
   CDBUS_METHOD_DESCRIBE(ConnectPortsByID, connect_ports_by_id)
+  CDBUS_METHOD_DESCRIBE(ConnectPortsByIDs, connect_ports_by_ids)
   CDBUS_METHOD_DESCRIBE(DisconnectPortsByName, disconnect_ports_by_name)
   CDBUS_METHOD_DESCRIBE(DisconnectPortsByID, disconnect_ports_by_id)
+  CDBUS_METHOD_DESCRIBE(DisconnectPortsByIDs, disconnect_ports_by_ids)
   CDBUS_METHOD_DESCRIBE(DisconnectPortsByConnectionID, disconnect_ports_by_connection_id)
   CDBUS_METHOD_DESCRIBE(GetClientPID, get_client_pid)
 CDBUS_METHODS_END
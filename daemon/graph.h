@@ -47,6 +47,13 @@ bool
   ladish_graph_handle graph_handle,
   uint64_t connection_id);
 
+/* called after a batch of async (dis)connect requests was issued */
+typedef
+void
+(* ladish_graph_commit_request_handler)(
+  void * context,
+  ladish_graph_handle graph_handle);
+
 typedef void (* ladish_graph_simple_port_callback)(ladish_port_handle port_handle);
 
 bool ladish_graph_create(ladish_graph_handle * graph_handle_ptr, const char * opath);
@@ -63,9 +70,40 @@ ladish_graph_set_connection_handlers(
   ladish_graph_connect_request_handler connect_handler,
   ladish_graph_disconnect_request_handler disconnect_handler);
 
+/* Handlers for requests that are made in batches: connect requests of hidden connections
+ * whose ports became visible, disconnects of ladish_disconnect_visible_connections() and
+ * the ConnectPortsByIDs/DisconnectPortsByIDs methods.
+ * The handlers may return before the request completes. On failure, the graph
+ * is to be notified with ladish_graph_cancel_connection_change().
+ * When not set, the handlers of ladish_graph_set_connection_handlers() are used. */
+void
+ladish_graph_set_async_connection_handlers(
+  ladish_graph_handle graph_handle,
+  ladish_graph_connect_request_handler connect_handler,
+  ladish_graph_disconnect_request_handler disconnect_handler,
+  ladish_graph_commit_request_handler commit_handler);
+
+void
+ladish_graph_cancel_connection_change(
+  ladish_graph_handle graph_handle,
+  ladish_port_handle port1_handle,
+  ladish_port_handle port2_handle);
+
 void ladish_graph_clear(ladish_graph_handle graph_handle, ladish_graph_simple_port_callback port_callback);
 void * ladish_graph_get_dbus_context(ladish_graph_handle graph_handle);
 ladish_dict_handle ladish_graph_get_dict(ladish_graph_handle graph_handle);
+
+/**
+ * Get the modification stamp of the graph.
+ * The stamp covers graph structure and dicts, and the persisted properties of graph clients and ports.
+ * It grows whenever any of these changes, so equal stamps mean that graph was not modified in between.
+ *
+ * @param[in] graph_handle Handle of graph
+ *
+ * @return Generation stamp
+ */
+uint64_t ladish_graph_get_generation(ladish_graph_handle graph_handle);
+
 ladish_dict_handle ladish_graph_get_connection_dict(ladish_graph_handle graph_handle, uint64_t connection_id);
 bool ladish_graph_add_client(ladish_graph_handle graph_handle, ladish_client_handle client_handle, const char * name, bool hidden);
 
@@ -29,53 +29,53 @@
 #include "graph.h"
 #include "dict.h"
 
-#define graph_handle ((ladish_graph_handle)call_ptr->iface_context)
-
-bool find_dict(struct cdbus_method_call * call_ptr, uint32_t object_type, uint64_t object_id, ladish_dict_handle * dict_handle_ptr)
+static
+ladish_dict_handle
+lookup_dict(
+  ladish_graph_handle graph_handle,
+  uint32_t object_type,
+  uint64_t object_id)
 {
   ladish_client_handle client;
   ladish_port_handle port;
-  ladish_dict_handle dict;
 
   switch (object_type)
   {
   case GRAPH_DICT_OBJECT_TYPE_GRAPH:
-    *dict_handle_ptr = ladish_graph_get_dict(graph_handle);
-    return true;
+    return ladish_graph_get_dict(graph_handle);
   case GRAPH_DICT_OBJECT_TYPE_CLIENT:
     client = ladish_graph_find_client_by_id(graph_handle, object_id);
-    if (client == NULL)
-    {
-      cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "cannot find client %"PRIu64".", object_id);
-      return false;
-    }
-    *dict_handle_ptr = ladish_client_get_dict(client);
-    return true;
+    return client != NULL ? ladish_client_get_dict(client) : NULL;
   case GRAPH_DICT_OBJECT_TYPE_PORT:
     port = ladish_graph_find_port_by_id(graph_handle, object_id);
-    if (port == NULL)
-    {
-      cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "cannot find port %"PRIu64".", object_id);
-      return false;
-    }
-    *dict_handle_ptr = ladish_port_get_dict(port);
-    return true;
+    return port != NULL ? ladish_port_get_dict(port) : NULL;
   case GRAPH_DICT_OBJECT_TYPE_CONNECTION:
-    dict = ladish_graph_get_connection_dict(graph_handle, object_id);
-    if (dict == NULL)
-    {
-      cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "cannot find connection %"PRIu64".", object_id);
-    }
+    return ladish_graph_get_connection_dict(graph_handle, object_id);
+  }
+
+  return NULL;
+}
+
+#define graph_handle ((ladish_graph_handle)call_ptr->iface_context)
+
+bool find_dict(struct cdbus_method_call * call_ptr, uint32_t object_type, uint64_t object_id, ladish_dict_handle * dict_handle_ptr)
+{
+  if (object_type > GRAPH_DICT_OBJECT_TYPE_CONNECTION)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "find_dict() not implemented for object type %"PRIu32".", object_type);
+    return false;
+  }
 
-    *dict_handle_ptr = dict;
+  *dict_handle_ptr = lookup_dict(graph_handle, object_type, object_id);
+  if (*dict_handle_ptr == NULL)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "cannot find object %"PRIu64" of type %"PRIu32".", object_id, object_type);
     return false;
   }
 
-  cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "find_dict() not implemented for object type %"PRIu32".", object_type);
-  return false;
+  return true;
 }
 
-#undef graph_handle
 
 void ladish_dict_set_dbus(struct cdbus_method_call * call_ptr)
 {
@@ -115,6 +115,107 @@ void ladish_dict_set_dbus(struct cdbus_method_call * call_ptr)
   cdbus_method_return_new_void(call_ptr);
 }
 
+/* Set several entries at once, possibly in different dicts of the graph.
+ * Entries for objects that no longer exist are skipped.
+ * Like Set, no change signal is emitted; the caller already knows the values. */
+/* Entries that cannot be set do not stop the rest, their indexes are returned */
+static void ladish_dict_set_many_dbus(struct cdbus_method_call * call_ptr)
+{
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+  DBusMessageIter struct_iter;
+  DBusMessageIter reply_iter;
+  DBusMessageIter failed_iter;
+  uint32_t object_type;
+  uint64_t object_id;
+  ladish_dict_handle dict;
+  const char * key;
+  const char * value;
+  uint32_t index;
+  unsigned int failed;
+
+  if (strcmp(dbus_message_get_signature(call_ptr->message), "a(utss)") != 0)
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": signature is \"%s\"", call_ptr->method_name, dbus_message_get_signature(call_ptr->message));
+    return;
+  }
+
+  call_ptr->reply = dbus_message_new_method_return(call_ptr->message);
+  if (call_ptr->reply == NULL)
+  {
+    goto fail;
+  }
+
+  dbus_message_iter_init_append(call_ptr->reply, &reply_iter);
+
+  if (!dbus_message_iter_open_container(&reply_iter, DBUS_TYPE_ARRAY, "u", &failed_iter))
+  {
+    goto fail_unref;
+  }
+
+  index = 0;
+  failed = 0;
+
+  dbus_message_iter_init(call_ptr->message, &iter);
+  for (dbus_message_iter_recurse(&iter, &array_iter);
+       dbus_message_iter_get_arg_type(&array_iter) == DBUS_TYPE_STRUCT;
+       dbus_message_iter_next(&array_iter), index++)
+  {
+    dbus_message_iter_recurse(&array_iter, &struct_iter);
+    dbus_message_iter_get_basic(&struct_iter, &object_type);
+    dbus_message_iter_next(&struct_iter);
+    dbus_message_iter_get_basic(&struct_iter, &object_id);
+    dbus_message_iter_next(&struct_iter);
+    dbus_message_iter_get_basic(&struct_iter, &key);
+    dbus_message_iter_next(&struct_iter);
+    dbus_message_iter_get_basic(&struct_iter, &value);
+
+    dict = lookup_dict(graph_handle, object_type, object_id);
+    if (dict == NULL)
+    {
+      log_error("cannot find object %"PRIu64" of type %"PRIu32", not setting \"%s\"", object_id, object_type, key);
+    }
+    else
+    {
+      log_info("%s <- %s", key, value);
+
+      if (ladish_dict_set(dict, key, value))
+      {
+        continue;
+      }
+
+      log_error("ladish_dict_set(\"%s\", \"%s\") failed", key, value);
+    }
+
+    if (!dbus_message_iter_append_basic(&failed_iter, DBUS_TYPE_UINT32, &index))
+    {
+      dbus_message_iter_close_container(&reply_iter, &failed_iter);
+      goto fail_unref;
+    }
+
+    failed++;
+  }
+
+  if (!dbus_message_iter_close_container(&reply_iter, &failed_iter))
+  {
+    goto fail_unref;
+  }
+
+  if (failed != 0)
+  {
+    log_error("%s(): %u of %"PRIu32" entries were not set", call_ptr->method_name, failed, index);
+  }
+
+  return;
+
+fail_unref:
+  dbus_message_unref(call_ptr->reply);
+  call_ptr->reply = NULL;
+
+fail:
+  log_error("Ran out of memory trying to construct method return");
+}
+
 void ladish_dict_get_dbus(struct cdbus_method_call * call_ptr)
 {
   uint32_t object_type;
@@ -188,6 +289,11 @@ CDBUS_METHOD_ARGS_BEGIN(Set, "Set value for specified key")
   CDBUS_METHOD_ARG_DESCRIBE_IN("value", "s", "Value to set")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(SetDicts, "Set values for several keys, possibly of different objects")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("entries", "a(utss)", "Array of (object_type, object_id, key, value) structs")
+  CDBUS_METHOD_ARG_DESCRIBE_OUT("failed", "au", "Indexes of the entries that were not set")
+CDBUS_METHOD_ARGS_END
+
 CDBUS_METHOD_ARGS_BEGIN(Get, "Get value for specified key")
   CDBUS_METHOD_ARG_DESCRIBE_IN("object_type", "u", "Type of object, 0 - graph, 1 - client, 2 - port, 3 - connection")
   CDBUS_METHOD_ARG_DESCRIBE_IN("object_id", "t", "ID of the object")
@@ -203,8 +309,11 @@ CDBUS_METHOD_ARGS_END
 
 CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(Set, ladish_dict_set_dbus)
+  CDBUS_METHOD_DESCRIBE(SetDicts, ladish_dict_set_many_dbus)
   CDBUS_METHOD_DESCRIBE(Get, ladish_dict_get_dbus)
   CDBUS_METHOD_DESCRIBE(Drop, ladish_dict_drop_dbus)
 CDBUS_METHODS_END
 
 CDBUS_INTERFACE_DEFAULT_HANDLER_METHODS_ONLY(g_iface_graph_dict, IFACE_GRAPH_DICT)
+
+#undef graph_handle
@@ -0,0 +1,452 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the JACK graph event recorder
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * When LADISH_CONF_KEY_DAEMON_GRAPH_RECORD_FILE is set, the graph proxy callbacks
+ * of the JACK graph and the command queue actions are appended to that file,
+ * so a studio start can be replayed later without JACK (see bench/graph_replay.c).
+ *
+ * The recorder is attached as a graph proxy monitor after the virtualizer,
+ * so events are recorded in the order the virtualizer gets them.
+ *
+ * Sessions are appended to an existing record file. The file is flushed
+ * every GRAPH_RECORD_FLUSH_RECORDS records and from the main loop at least
+ * every GRAPH_RECORD_FLUSH_INTERVAL, so a crash loses little.
+ */
+
+#include "graph_record.h"
+#include "virtualizer.h"
+#include "conf.h"
+#include "../proxies/conf_proxy.h"
+#include "../common/time.h"
+
+#define GRAPH_RECORD_FLUSH_RECORDS 256
+#define GRAPH_RECORD_FLUSH_INTERVAL 1000000 /* microseconds */
+
+static struct
+{
+  FILE * file;                  /* NULL when recording is not enabled */
+  char * path;
+  uint64_t last_time;           /* monotonic time of the last record */
+  unsigned int unflushed;       /* records written since the last flush */
+  uint64_t flush_time;          /* monotonic time of the last flush */
+  graph_proxy_handle graph;     /* JACK graph proxy, NULL when not attached */
+} g_graph_record;
+
+static void ladish_graph_record_write_uint(uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    fputc((int)(value & 0x7F) | 0x80, g_graph_record.file);
+    value >>= 7;
+  }
+
+  fputc((int)value, g_graph_record.file);
+}
+
+static void ladish_graph_record_write_string(const char * str)
+{
+  size_t len;
+
+  len = strlen(str);
+  ladish_graph_record_write_uint(len);
+  fwrite(str, 1, len, g_graph_record.file);
+}
+
+static void ladish_graph_record_flush(void)
+{
+  if (g_graph_record.unflushed == 0)
+  {
+    return;
+  }
+
+  if (fflush(g_graph_record.file) != 0)
+  {
+    log_error("fflush(%s) failed: %d (%s)", g_graph_record.path, errno, strerror(errno));
+  }
+
+  g_graph_record.unflushed = 0;
+  g_graph_record.flush_time = ladish_get_monotonic_microseconds();
+}
+
+static bool ladish_graph_record_begin(unsigned int type)
+{
+  uint64_t now;
+
+  if (g_graph_record.file == NULL)
+  {
+    return false;
+  }
+
+  if (g_graph_record.unflushed >= GRAPH_RECORD_FLUSH_RECORDS)
+  {
+    ladish_graph_record_flush();
+  }
+
+  now = ladish_get_monotonic_microseconds();
+
+  fputc(type, g_graph_record.file);
+  ladish_graph_record_write_uint(now - g_graph_record.last_time);
+  g_graph_record.last_time = now;
+  g_graph_record.unflushed++;
+
+  return true;
+}
+
+/* write the header to a new file or check the header of an existing one */
+static bool ladish_graph_record_file_header(void)
+{
+  long size;
+  char magic[LADISH_GRAPH_RECORD_MAGIC_SIZE];
+  int version;
+
+  if (fseek(g_graph_record.file, 0, SEEK_END) != 0 || (size = ftell(g_graph_record.file)) < 0)
+  {
+    log_error("cannot get size of '%s': %d (%s)", g_graph_record.path, errno, strerror(errno));
+    return false;
+  }
+
+  if (size == 0)
+  {
+    fwrite(LADISH_GRAPH_RECORD_MAGIC, 1, LADISH_GRAPH_RECORD_MAGIC_SIZE, g_graph_record.file);
+    ladish_graph_record_write_uint(LADISH_GRAPH_RECORD_VERSION);
+    ladish_graph_record_write_uint(ladish_get_current_microseconds());
+    return true;
+  }
+
+  rewind(g_graph_record.file);
+  if (fread(magic, 1, LADISH_GRAPH_RECORD_MAGIC_SIZE, g_graph_record.file) != LADISH_GRAPH_RECORD_MAGIC_SIZE ||
+      memcmp(magic, LADISH_GRAPH_RECORD_MAGIC, LADISH_GRAPH_RECORD_MAGIC_SIZE) != 0 ||
+      (version = fgetc(g_graph_record.file)) != LADISH_GRAPH_RECORD_VERSION)
+  {
+    log_error("'%s' is not a version %u graph record file, not appending to it", g_graph_record.path, LADISH_GRAPH_RECORD_VERSION);
+    return false;
+  }
+
+  /* a switch from reading to writing needs a seek */
+  return fseek(g_graph_record.file, 0, SEEK_END) == 0;
+}
+
+static void ladish_graph_record_file_close(void)
+{
+  if (g_graph_record.file == NULL)
+  {
+    return;
+  }
+
+  if (fclose(g_graph_record.file) != 0)
+  {
+    log_error("fclose(%s) failed: %d (%s)", g_graph_record.path, errno, strerror(errno));
+  }
+
+  g_graph_record.file = NULL;
+  free(g_graph_record.path);
+  g_graph_record.path = NULL;
+}
+
+/* (re)open the record file if the configured path changed */
+static void ladish_graph_record_file_update(void)
+{
+  const char * path;
+
+  if (!conf_get(LADISH_CONF_KEY_DAEMON_GRAPH_RECORD_FILE, &path))
+  {
+    path = LADISH_CONF_KEY_DAEMON_GRAPH_RECORD_FILE_DEFAULT;
+  }
+
+  if (path[0] == 0)
+  {
+    ladish_graph_record_file_close();
+    return;
+  }
+
+  if (g_graph_record.path != NULL && strcmp(g_graph_record.path, path) == 0)
+  {
+    return;
+  }
+
+  ladish_graph_record_file_close();
+
+  g_graph_record.path = strdup(path);
+  if (g_graph_record.path == NULL)
+  {
+    log_error("strdup() failed for graph record file path");
+    return;
+  }
+
+  /* append, so reopening the same path does not truncate the earlier sessions */
+  g_graph_record.file = fopen(path, "a+");
+  if (g_graph_record.file == NULL)
+  {
+    log_error("fopen(%s) failed: %d (%s)", path, errno, strerror(errno));
+    free(g_graph_record.path);
+    g_graph_record.path = NULL;
+    return;
+  }
+
+  if (!ladish_graph_record_file_header())
+  {
+    ladish_graph_record_file_close();
+    return;
+  }
+
+  log_info("Recording JACK graph events to '%s'", path);
+
+  g_graph_record.last_time = ladish_get_monotonic_microseconds();
+  g_graph_record.flush_time = g_graph_record.last_time;
+  g_graph_record.unflushed = 1; /* the header */
+}
+
+/********************************************************************************/
+/* graph proxy monitor */
+
+static void clear(void * UNUSED(context))
+{
+  ladish_graph_record_begin(LADISH_GRAPH_RECORD_CLEAR);
+}
+
+static void client_appeared(void * UNUSED(context), uint64_t id, const char * name)
+{
+  pid_t pid;
+  ladish_app_handle app;
+  ladish_graph_handle vgraph;
+
+  if (g_graph_record.file == NULL)
+  {
+    return;
+  }
+
+  if (!graph_proxy_get_client_pid(g_graph_record.graph, id, &pid))
+  {
+    pid = 0;
+  }
+
+  if (pid != 0)
+  {
+    app = ladish_find_app_by_pid(pid, &vgraph);
+    if (app != NULL && ladish_graph_record_begin(LADISH_GRAPH_RECORD_APP))
+    {
+      ladish_graph_record_write_uint(pid);
+      ladish_graph_record_write_string(ladish_app_get_name(app));
+      ladish_graph_record_write_string(ladish_graph_get_opath(vgraph));
+    }
+  }
+
+  if (ladish_graph_record_begin(LADISH_GRAPH_RECORD_CLIENT_APPEARED))
+  {
+    ladish_graph_record_write_uint(id);
+    ladish_graph_record_write_uint(pid);
+    ladish_graph_record_write_string(name);
+  }
+}
+
+static void client_renamed(void * UNUSED(context), uint64_t client_id, const char * old_client_name, const char * new_client_name)
+{
+  if (ladish_graph_record_begin(LADISH_GRAPH_RECORD_CLIENT_RENAMED))
+  {
+    ladish_graph_record_write_uint(client_id);
+    ladish_graph_record_write_string(old_client_name);
+    ladish_graph_record_write_string(new_client_name);
+  }
+}
+
+static void client_disappeared(void * UNUSED(context), uint64_t id)
+{
+  if (ladish_graph_record_begin(LADISH_GRAPH_RECORD_CLIENT_DISAPPEARED))
+  {
+    ladish_graph_record_write_uint(id);
+  }
+}
+
+static
+void
+port_appeared(
+  void * UNUSED(context),
+  uint64_t client_id,
+  uint64_t port_id,
+  const char * port_name,
+  bool is_input,
+  bool is_terminal,
+  bool is_midi)
+{
+  unsigned int flags;
+
+  if (ladish_graph_record_begin(LADISH_GRAPH_RECORD_PORT_APPEARED))
+  {
+    flags = 0;
+    if (is_input)
+    {
+      flags |= LADISH_GRAPH_RECORD_PORT_INPUT;
+    }
+    if (is_terminal)
+    {
+      flags |= LADISH_GRAPH_RECORD_PORT_TERMINAL;
+    }
+    if (is_midi)
+    {
+      flags |= LADISH_GRAPH_RECORD_PORT_MIDI;
+    }
+
+    ladish_graph_record_write_uint(client_id);
+    ladish_graph_record_write_uint(port_id);
+    ladish_graph_record_write_uint(flags);
+    ladish_graph_record_write_string(port_name);
+  }
+}
+
+static
+void
+port_renamed(
+  void * UNUSED(context),
+  uint64_t client_id,
+  uint64_t port_id,
+  const char * old_port_name,
+  const char * new_port_name)
+{
+  if (ladish_graph_record_begin(LADISH_GRAPH_RECORD_PORT_RENAMED))
+  {
+    ladish_graph_record_write_uint(client_id);
+    ladish_graph_record_write_uint(port_id);
+    ladish_graph_record_write_string(old_port_name);
+    ladish_graph_record_write_string(new_port_name);
+  }
+}
+
+static void port_disappeared(void * UNUSED(context), uint64_t client_id, uint64_t port_id)
+{
+  if (ladish_graph_record_begin(LADISH_GRAPH_RECORD_PORT_DISAPPEARED))
+  {
+    ladish_graph_record_write_uint(client_id);
+    ladish_graph_record_write_uint(port_id);
+  }
+}
+
+static void ladish_graph_record_connection(unsigned int type, uint64_t client1_id, uint64_t port1_id, uint64_t client2_id, uint64_t port2_id)
+{
+  if (ladish_graph_record_begin(type))
+  {
+    ladish_graph_record_write_uint(client1_id);
+    ladish_graph_record_write_uint(port1_id);
+    ladish_graph_record_write_uint(client2_id);
+    ladish_graph_record_write_uint(port2_id);
+  }
+}
+
+static void ports_connected(void * UNUSED(context), uint64_t client1_id, uint64_t port1_id, uint64_t client2_id, uint64_t port2_id)
+{
+  ladish_graph_record_connection(LADISH_GRAPH_RECORD_PORTS_CONNECTED, client1_id, port1_id, client2_id, port2_id);
+}
+
+static void ports_disconnected(void * UNUSED(context), uint64_t client1_id, uint64_t port1_id, uint64_t client2_id, uint64_t port2_id)
+{
+  ladish_graph_record_connection(LADISH_GRAPH_RECORD_PORTS_DISCONNECTED, client1_id, port1_id, client2_id, port2_id);
+}
+
+/********************************************************************************/
+
+void ladish_graph_record_attach(graph_proxy_handle graph)
+{
+  ASSERT(g_graph_record.graph == NULL);
+
+  ladish_graph_record_file_update();
+  if (g_graph_record.file == NULL)
+  {
+    return;
+  }
+
+  if (!graph_proxy_attach(
+        graph,
+        &g_graph_record,
+        clear,
+        client_appeared,
+        client_renamed,
+        client_disappeared,
+        port_appeared,
+        port_renamed,
+        port_disappeared,
+        ports_connected,
+        ports_disconnected))
+  {
+    log_error("graph_proxy_attach() failed for the graph recorder");
+    return;
+  }
+
+  g_graph_record.graph = graph;
+  ladish_graph_record_begin(LADISH_GRAPH_RECORD_SESSION_BEGIN);
+}
+
+void ladish_graph_record_detach(graph_proxy_handle graph)
+{
+  if (g_graph_record.graph == NULL)
+  {
+    return;
+  }
+
+  ASSERT(g_graph_record.graph == graph);
+
+  graph_proxy_detach(graph, &g_graph_record);
+  g_graph_record.graph = NULL;
+
+  if (ladish_graph_record_begin(LADISH_GRAPH_RECORD_SESSION_END))
+  {
+    ladish_graph_record_flush();
+  }
+}
+
+void ladish_graph_record_command(const char * name, unsigned int event)
+{
+  if (event == LADISH_GRAPH_RECORD_COMMAND_STARTED && g_graph_record.graph == NULL)
+  {
+    /* commands that start JACK server are recorded too, so the file is opened here as well */
+    ladish_graph_record_file_update();
+  }
+
+  if (ladish_graph_record_begin(LADISH_GRAPH_RECORD_COMMAND))
+  {
+    ladish_graph_record_write_uint(event);
+    ladish_graph_record_write_string(name);
+
+    if (event != LADISH_GRAPH_RECORD_COMMAND_STARTED)
+    {
+      ladish_graph_record_flush();
+    }
+  }
+}
+
+void ladish_graph_record_run(void)
+{
+  if (g_graph_record.file != NULL &&
+      g_graph_record.unflushed != 0 &&
+      ladish_get_monotonic_microseconds() - g_graph_record.flush_time >= GRAPH_RECORD_FLUSH_INTERVAL)
+  {
+    ladish_graph_record_flush();
+  }
+}
+
+void ladish_graph_record_uninit(void)
+{
+  ladish_graph_record_file_close();
+}
@@ -0,0 +1,95 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains interface to the JACK graph event recorder
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef GRAPH_RECORD_H__F3C94736_7FB8_40D2_848E_8F286B0F1D81__INCLUDED
+#define GRAPH_RECORD_H__F3C94736_7FB8_40D2_848E_8F286B0F1D81__INCLUDED
+
+#include "common.h"
+#include "../proxies/graph_proxy.h"
+
+/*
+ * Record file format. Integers are unsigned LEB128 varints, strings are
+ * a varint length followed by the bytes (without terminating zero).
+ *
+ * header: "LADISHGR", varint version, varint start time (wall clock microseconds)
+ * record: byte type, varint microseconds since the previous record (or since the file was opened), payload
+ *
+ * Record times come from the monotonic clock. Each time ladishd opens the file
+ * its records are appended after the existing ones, without another header.
+ *
+ * payloads:
+ *  SESSION_BEGIN, SESSION_END, CLEAR: none
+ *  APP: pid, app name, object path of the app vgraph
+ *       (written before CLIENT_APPEARED when the client pid belongs to a ladish app)
+ *  CLIENT_APPEARED: client id, pid (0 when unknown), client name
+ *  CLIENT_RENAMED: client id, old name, new name
+ *  CLIENT_DISAPPEARED: client id
+ *  PORT_APPEARED: client id, port id, flags, port name
+ *  PORT_RENAMED: client id, port id, old name, new name
+ *  PORT_DISAPPEARED: client id, port id
+ *  PORTS_CONNECTED, PORTS_DISCONNECTED: client1 id, port1 id, client2 id, port2 id
+ *  COMMAND: command event, command name
+ */
+
+#define LADISH_GRAPH_RECORD_MAGIC "LADISHGR"
+#define LADISH_GRAPH_RECORD_MAGIC_SIZE 8
+#define LADISH_GRAPH_RECORD_VERSION 1
+
+#define LADISH_GRAPH_RECORD_SESSION_BEGIN       1 /* JACK server started */
+#define LADISH_GRAPH_RECORD_SESSION_END         2 /* JACK server stopped */
+#define LADISH_GRAPH_RECORD_CLEAR               3
+#define LADISH_GRAPH_RECORD_APP                 4
+#define LADISH_GRAPH_RECORD_CLIENT_APPEARED     5
+#define LADISH_GRAPH_RECORD_CLIENT_RENAMED      6
+#define LADISH_GRAPH_RECORD_CLIENT_DISAPPEARED  7
+#define LADISH_GRAPH_RECORD_PORT_APPEARED       8
+#define LADISH_GRAPH_RECORD_PORT_RENAMED        9
+#define LADISH_GRAPH_RECORD_PORT_DISAPPEARED   10
+#define LADISH_GRAPH_RECORD_PORTS_CONNECTED    11
+#define LADISH_GRAPH_RECORD_PORTS_DISCONNECTED 12
+#define LADISH_GRAPH_RECORD_COMMAND            13
+
+#define LADISH_GRAPH_RECORD_PORT_INPUT    1
+#define LADISH_GRAPH_RECORD_PORT_TERMINAL 2
+#define LADISH_GRAPH_RECORD_PORT_MIDI     4
+
+#define LADISH_GRAPH_RECORD_COMMAND_STARTED 0
+#define LADISH_GRAPH_RECORD_COMMAND_DONE    1
+#define LADISH_GRAPH_RECORD_COMMAND_FAILED  2
+
+/* Start recording the events of the JACK graph, if recording is enabled.
+ * Must be called before the graph proxy is activated. */
+void ladish_graph_record_attach(graph_proxy_handle graph);
+void ladish_graph_record_detach(graph_proxy_handle graph);
+
+void ladish_graph_record_command(const char * name, unsigned int event);
+
+/* Flush recorded events periodically, called from the main loop */
+void ladish_graph_record_run(void);
+
+void ladish_graph_record_uninit(void);
+
+#endif /* #ifndef GRAPH_RECORD_H__F3C94736_7FB8_40D2_848E_8F286B0F1D81__INCLUDED */
@@ -28,6 +28,7 @@
 
 #include "jack_session.h"
 #include "../common/catdup.h"
+#include "../common/dirhelpers.h"
 #include "studio.h"
 #include "../proxies/jack_proxy.h"
 #include "../proxies/conf_proxy.h"
@@ -128,6 +129,8 @@ ladish_js_find_app_client(
   return ctx.client_name;
 }
 
+#define JS_SAVE_CALL_TIMEOUT_SLACK 10 /* seconds */
+
 struct ladish_js_save_app_context
 {
   void * context;
@@ -135,6 +138,7 @@ struct ladish_js_save_app_context
     void * context,
     const char * commandline);
 
+  bool abandoned;               /* the callback must not be called */
   char * target_dir;            /* the dir supplied as parameter to ladish_js_save_app() */
   char * temp_dir;              /* temp dir that is passed to jack session notify */
   char * client_dir;            /* client dir within the temp dir */
@@ -147,6 +151,16 @@ void ladish_js_save_app_complete(void * context, const char * commandline)
   int iret;
   unsigned int delay;
 
+  if (ctx_ptr->abandoned)
+  {
+    log_info("Abandoned JS app save completed too late, discarding '%s'", ctx_ptr->temp_dir);
+    if (!ladish_rmdir_recursive(ctx_ptr->temp_dir))
+    {
+      log_error("Cannot remove JS temp dir '%s'", ctx_ptr->temp_dir);
+    }
+    goto free;
+  }
+
   if (commandline == NULL)
   {
     goto call;
@@ -184,6 +198,7 @@ void ladish_js_save_app_complete(void * context, const char * commandline)
 call:
   ctx_ptr->callback(ctx_ptr->context, commandline);
 
+free:
   free(ctx_ptr->client_dir);
   free(ctx_ptr->temp_dir);
   free(ctx_ptr->target_dir);
@@ -199,13 +214,15 @@ ladish_js_save_app(
   void * completion_context,
   void (* completion_callback)(
     void * completion_context,
-    const char * commandline))
+    const char * commandline),
+  ladish_js_save_handle * save_handle_ptr)
 {
   struct ladish_js_save_app_context * ctx_ptr;
   char app_uuid_str[37];
   int ret;
   const char * js_client;
   size_t ofs;
+  unsigned int timeout;
 
   js_client = ladish_js_find_app_client(app_uuid);
   if (js_client == NULL)
@@ -260,8 +277,18 @@ ladish_js_save_app(
 
   ctx_ptr->callback = completion_callback;
   ctx_ptr->context = completion_context;
+  ctx_ptr->abandoned = false;
 
-  if (!jack_proxy_session_save_one(true, js_client, ctx_ptr->temp_dir, ctx_ptr, ladish_js_save_app_complete))
+  if (!conf_get_uint(LADISH_CONF_KEY_DAEMON_JS_SAVE_TIMEOUT, &timeout))
+  {
+    timeout = LADISH_CONF_KEY_DAEMON_JS_SAVE_TIMEOUT_DEFAULT;
+  }
+
+  /* The app save deadline expires first and abandons the save.
+     The call timeout makes sure that the context is freed even if jackdbus never replies. */
+  timeout = (timeout + JS_SAVE_CALL_TIMEOUT_SLACK) * 1000;
+
+  if (!jack_proxy_session_save_one(timeout, true, js_client, ctx_ptr->temp_dir, ctx_ptr, ladish_js_save_app_complete))
   {
     log_error("jack session failed to initiate save of '%s' app state to '%s'", js_client, ctx_ptr->temp_dir);
     goto fail_rm_temp_dir;
@@ -269,6 +296,7 @@ ladish_js_save_app(
 
   log_info("JS app save initiated");
 
+  *save_handle_ptr = (ladish_js_save_handle)ctx_ptr;
   return true;
 
 fail_rm_temp_dir:
@@ -288,3 +316,8 @@ fail_free_struct:
 fail:
   return false;
 }
+
+void ladish_js_save_app_abandon(ladish_js_save_handle save_handle)
+{
+  ((struct ladish_js_save_app_context *)save_handle)->abandoned = true;
+}
@@ -29,6 +29,8 @@
 
 #include "common.h"
 
+typedef struct ladish_js_save_tag { int unused; } * ladish_js_save_handle;
+
 bool
 ladish_js_save_app(
   uuid_t app_uuid,
@@ -36,6 +38,11 @@ ladish_js_save_app(
   void * completion_context,
   void (* completion_callback)(
     void * completion_context,
-    const char * commandline));
+    const char * commandline),
+  ladish_js_save_handle * save_handle_ptr);
+
+/* Stop waiting for the app save to complete, the completion callback will not be called.
+ * When the app replies later, its save dir is removed. */
+void ladish_js_save_app_abandon(ladish_js_save_handle save_handle);
 
 #endif /* #ifndef JACK_SESSION_H__3C0F2ED2_7FAB_460F_A34F_4E3CAB6AC552__INCLUDED */
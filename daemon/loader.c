@@ -71,8 +71,21 @@ struct loader_child
   char * stderr_buffer_ptr;
 };
 
+/* helper process forked by ladishd itself, not an app */
+struct loader_internal_child
+{
+  pid_t pid;                    /* 0 if slot is free */
+  bool dead;
+  int exit_status;
+  void * context;
+  void (* on_exit)(void * context, int exit_status);
+};
+
+#define LOADER_MAX_INTERNAL_CHILDS 4
+
 static void (* g_on_child_exit)(pid_t pid, int exit_status);
 static struct list_head g_childs_list;
+static struct loader_internal_child g_internal_childs[LOADER_MAX_INTERNAL_CHILDS];
 
 static struct loader_child *
 loader_child_find(pid_t pid)
@@ -157,8 +170,41 @@ loader_childs_bury(void)
   }
 }
 
+static struct loader_internal_child * loader_internal_child_find(pid_t pid)
+{
+  unsigned int i;
+
+  for (i = 0; i < LOADER_MAX_INTERNAL_CHILDS; i++)
+  {
+    if (g_internal_childs[i].pid == pid)
+    {
+      return g_internal_childs + i;
+    }
+  }
+
+  return NULL;
+}
+
+static void loader_internal_childs_bury(void)
+{
+  unsigned int i;
+  struct loader_internal_child * child_ptr;
+
+  for (i = 0; i < LOADER_MAX_INTERNAL_CHILDS; i++)
+  {
+    child_ptr = g_internal_childs + i;
+    if (child_ptr->pid != 0 && child_ptr->dead)
+    {
+      log_debug("Bury internal child with PID %llu", (unsigned long long)child_ptr->pid);
+      child_ptr->pid = 0;
+      child_ptr->on_exit(child_ptr->context, child_ptr->exit_status);
+    }
+  }
+}
+
 static void loader_sigchld_handler(int signum)
 {
+  struct loader_internal_child * internal_child_ptr;
   int status;
   pid_t pid;
   struct loader_child *child_ptr;
@@ -170,7 +216,13 @@ static void loader_sigchld_handler(int signum)
   {
     child_ptr = loader_child_find(pid);
 
-    if (!child_ptr)
+    if (!child_ptr && (internal_child_ptr = loader_internal_child_find(pid)) != NULL)
+    {
+      log_info("Termination of internal child process with PID %llu detected", (unsigned long long)pid);
+      internal_child_ptr->dead = true;
+      internal_child_ptr->exit_status = status;
+    }
+    else if (!child_ptr)
     {
       log_error("Termination of unknown child process with PID %llu detected", (unsigned long long)pid);
     }
@@ -217,6 +269,48 @@ void loader_init(void (* on_child_exit)(pid_t pid, int exit_status))
 void loader_uninit(void)
 {
   loader_childs_bury();
+  loader_internal_childs_bury();
+}
+
+pid_t loader_fork_internal(void * context, void (* on_exit)(void * context, int exit_status))
+{
+  struct loader_internal_child * child_ptr;
+  sigset_t sigchld;
+  sigset_t oldmask;
+  pid_t pid;
+
+  child_ptr = loader_internal_child_find(0);
+  if (child_ptr == NULL)
+  {
+    log_error("Too many internal child processes");
+    return -1;
+  }
+
+  /* the child could exit before its pid is recorded */
+  sigemptyset(&sigchld);
+  sigaddset(&sigchld, SIGCHLD);
+  sigprocmask(SIG_BLOCK, &sigchld, &oldmask);
+
+  pid = fork();
+  if (pid == -1)
+  {
+    log_error("fork() failed: %d (%s)", errno, strerror(errno));
+  }
+  else if (pid == 0)
+  {
+    signal(SIGCHLD, SIG_DFL);
+  }
+  else
+  {
+    child_ptr->pid = pid;
+    child_ptr->dead = false;
+    child_ptr->context = context;
+    child_ptr->on_exit = on_exit;
+  }
+
+  sigprocmask(SIG_SETMASK, &oldmask, NULL);
+
+  return pid;
 }
 
 #if 0
@@ -489,6 +583,7 @@ loader_run(void)
 {
   loader_read_childs_output();
   loader_childs_bury();
+  loader_internal_childs_bury();
 }
 
 #define LD_PRELOAD_ADD "libalsapid.so libasound.so.2"
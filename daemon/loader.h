@@ -42,6 +42,17 @@ loader_execute(
 
 void loader_run(void);
 
+/**
+ * Fork a helper process of ladishd itself. Its termination is not reported
+ * through the on_child_exit callback but through the supplied one, from loader_run().
+ *
+ * @param[in] context User defined context that is supplied to the @c on_exit callback
+ * @param[in] on_exit Callback to call when the child process terminates
+ *
+ * @return -1 on failure, 0 in the child process, pid of the child in the parent process
+ */
+pid_t loader_fork_internal(void * context, void (* on_exit)(void * context, int exit_status));
+
 void loader_uninit(void);
 
 unsigned int loader_get_app_count(void);
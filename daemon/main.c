@@ -47,9 +47,16 @@
 #include "../proxies/conf_proxy.h"
 #include "conf.h"
 #include "recent_projects.h"
+#include "metadata_index.h"
+#include "appdb.h"
 #include "lash_server.h"
+#include "cqueue_trace.h"
+#include "graph_record.h"
+#include "../cdbus/stats.h"
 
 bool g_quit;
+static volatile sig_atomic_t g_dump_stats;
+uint64_t g_generation;
 const char * g_dbus_unique_name;
 cdbus_object_path g_control_object;
 char * g_base_dir;
@@ -164,7 +171,11 @@ static bool connect_dbus(void)
     goto unref_connection;
   }
 
-  g_control_object = cdbus_object_path_new(CONTROL_OBJECT_PATH, &g_lashd_interface_control, NULL, NULL);
+  g_control_object = cdbus_object_path_new(
+    CONTROL_OBJECT_PATH,
+    &g_lashd_interface_control, NULL,
+    &g_cdbus_interface_stats, NULL,
+    NULL);
   if (g_control_object == NULL)
   {
     goto unref_connection;
@@ -191,6 +202,7 @@ static void disconnect_dbus(void)
   cdbus_object_path_destroy(cdbus_g_dbus_connection, g_control_object);
   dbus_connection_unref(cdbus_g_dbus_connection);
   cdbus_call_last_error_cleanup();
+  cdbus_stats_uninit();
 }
 
 void term_signal_handler(int signum)
@@ -199,6 +211,12 @@ void term_signal_handler(int signum)
   g_quit = true;
 }
 
+/* the dump itself is done in the main loop, logging is not async-signal-safe */
+static void dump_stats_signal_handler(int UNUSED(signum))
+{
+  g_dump_stats = 1;
+}
+
 bool install_term_signal_handler(int signum, bool ignore_if_already_ignored)
 {
   sig_t sigh;
@@ -327,6 +345,10 @@ int main(int argc, char ** argv, char ** envp)
   {
     log_error("signal(SIGPIPE, SIG_IGN).");
   }
+  if (signal(SIGUSR2, dump_stats_signal_handler) == SIG_ERR)
+  {
+    log_error("signal() failed to install handler function for SIGUSR2.");
+  }
 
   /* setup our SIGSEGV magic that prints nice stack in our logfile */ 
   setup_siginfo();
@@ -361,16 +383,61 @@ int main(int argc, char ** argv, char ** envp)
     goto uninit_conf;
   }
 
-  if (!ladish_recent_projects_init())
+  if (!conf_register(LADISH_CONF_KEY_DAEMON_JS_SAVE_TIMEOUT, NULL, NULL))
   {
     goto uninit_conf;
   }
 
-  if (!a2j_proxy_init())
+  if (!conf_register(LADISH_CONF_KEY_DAEMON_AUTOSAVE_INTERVAL, NULL, NULL))
+  {
+    goto uninit_conf;
+  }
+
+  if (!conf_register(LADISH_CONF_KEY_DAEMON_AUTOSAVE_CHANGES, NULL, NULL))
+  {
+    goto uninit_conf;
+  }
+
+  if (!conf_register(LADISH_CONF_KEY_DAEMON_AUTOSAVE_BACKUPS, NULL, NULL))
+  {
+    goto uninit_conf;
+  }
+
+  if (!conf_register(LADISH_CONF_KEY_DAEMON_JACK_STATS_INTERVAL, NULL, NULL))
+  {
+    goto uninit_conf;
+  }
+
+  if (!conf_register(LADISH_CONF_KEY_DAEMON_CQUEUE_TRACE_FILE, NULL, NULL))
+  {
+    goto uninit_conf;
+  }
+
+  if (!conf_register(LADISH_CONF_KEY_DAEMON_GRAPH_RECORD_FILE, NULL, NULL))
+  {
+    goto uninit_conf;
+  }
+
+  if (!ladish_metadata_index_init())
+  {
+    goto uninit_conf;
+  }
+
+  if (!ladish_recent_projects_init())
+  {
+    goto uninit_metadata_index;
+  }
+
+  if (!lash_appdb_init())
   {
     goto uninit_recent_projects;
   }
 
+  if (!a2j_proxy_init())
+  {
+    goto uninit_appdb;
+  }
+
   if (!jmcore_proxy_init())
   {
     goto uninit_a2j;
@@ -392,8 +459,16 @@ int main(int argc, char ** argv, char ** envp)
   {
     dbus_connection_read_write_dispatch(cdbus_g_dbus_connection, 50);
     loader_run();
+    lash_appdb_run();
     ladish_studio_run();
+    ladish_graph_record_run();
     ladish_check_integrity();
+
+    if (g_dump_stats)
+    {
+      g_dump_stats = 0;
+      cdbus_stats_dump();
+    }
   }
 
   emit_clean_exit();
@@ -407,6 +482,8 @@ int main(int argc, char ** argv, char ** envp)
 
 uninit_studio:
   ladish_studio_uninit();
+  ladish_cqueue_trace_uninit();
+  ladish_graph_record_uninit();
 
 uninit_jmcore:
   jmcore_proxy_uninit();
@@ -414,9 +491,15 @@ uninit_jmcore:
 uninit_a2j:
   a2j_proxy_uninit();
 
+uninit_appdb:
+  lash_appdb_uninit();
+
 uninit_recent_projects:
   ladish_recent_projects_uninit();
 
+uninit_metadata_index:
+  ladish_metadata_index_uninit();
+
 uninit_conf:
   if (g_use_notify)
   {
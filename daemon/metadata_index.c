@@ -0,0 +1,866 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the studio and project metadata index
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * The index is kept in memory and persisted as a text file in the base dir.
+ * Each line is a record with tab separated fields:
+ *
+ * D <dir path> <mtime> <mtime nsec> <inode>
+ * F <file path> <mtime> <mtime nsec> <size> <inode> <rooms> <apps> <name> <jack settings>
+ *
+ * Tab, newline and percent chars in string fields are percent-encoded.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#include "metadata_index.h"
+#include "save.h"
+#include "escape.h"
+#include "../common/catdup.h"
+
+#define METADATA_INDEX_FILE "metadata_index"
+#define METADATA_INDEX_HEADER "# " BASE_NAME " metadata index, version 2\n"
+#define METADATA_INDEX_HASH_SIZE 256
+
+struct ladish_metadata_entry
+{
+  struct list_head siblings;
+  struct list_head hash_siblings; /* in hash bucket */
+  char * path;
+  bool seen;                    /* used during directory rescan */
+  struct ladish_metadata meta;
+};
+
+struct ladish_metadata_dir
+{
+  struct list_head siblings;
+  char * path;
+  time_t mtime;
+  long mtime_nsec;
+  uint64_t inode;
+};
+
+static char * g_metadata_index_path;
+static struct list_head g_metadata_entries;
+static struct list_head g_metadata_entries_hash[METADATA_INDEX_HASH_SIZE];
+static struct list_head g_metadata_dirs;
+static bool g_metadata_index_dirty;
+
+static void ladish_metadata_entry_destroy(struct ladish_metadata_entry * entry_ptr)
+{
+  list_del(&entry_ptr->siblings);
+  list_del(&entry_ptr->hash_siblings);
+  free(entry_ptr->meta.jack_settings); /* safe if NULL */
+  free(entry_ptr->meta.name);
+  free(entry_ptr->path);
+  free(entry_ptr);
+}
+
+static unsigned int ladish_metadata_hash(const char * path)
+{
+  unsigned int hash;
+
+  hash = 5381;
+  while (*path != 0)
+  {
+    hash = hash * 33 + (unsigned char)*path++;
+  }
+
+  return hash % METADATA_INDEX_HASH_SIZE;
+}
+
+static struct ladish_metadata_entry * ladish_metadata_find_entry(const char * path)
+{
+  struct list_head * node_ptr;
+  struct ladish_metadata_entry * entry_ptr;
+
+  list_for_each(node_ptr, g_metadata_entries_hash + ladish_metadata_hash(path))
+  {
+    entry_ptr = list_entry(node_ptr, struct ladish_metadata_entry, hash_siblings);
+    if (strcmp(entry_ptr->path, path) == 0)
+    {
+      return entry_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+static struct ladish_metadata_dir * ladish_metadata_find_dir(const char * path)
+{
+  struct list_head * node_ptr;
+  struct ladish_metadata_dir * dir_ptr;
+
+  list_for_each(node_ptr, &g_metadata_dirs)
+  {
+    dir_ptr = list_entry(node_ptr, struct ladish_metadata_dir, siblings);
+    if (strcmp(dir_ptr->path, path) == 0)
+    {
+      return dir_ptr;
+    }
+  }
+
+  return NULL;
+}
+
+static struct ladish_metadata_dir * ladish_metadata_add_dir(const char * path, time_t mtime, long mtime_nsec, uint64_t inode)
+{
+  struct ladish_metadata_dir * dir_ptr;
+
+  dir_ptr = malloc(sizeof(struct ladish_metadata_dir));
+  if (dir_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct ladish_metadata_dir");
+    return NULL;
+  }
+
+  dir_ptr->path = strdup(path);
+  if (dir_ptr->path == NULL)
+  {
+    log_error("strdup() failed for metadata index dir path '%s'", path);
+    free(dir_ptr);
+    return NULL;
+  }
+
+  dir_ptr->mtime = mtime;
+  dir_ptr->mtime_nsec = mtime_nsec;
+  dir_ptr->inode = inode;
+  list_add_tail(&dir_ptr->siblings, &g_metadata_dirs);
+
+  return dir_ptr;
+}
+
+/* path is in the dir and not in a subdir of it */
+static bool ladish_metadata_path_in_dir(const char * path, const char * dir, size_t dir_len)
+{
+  return strncmp(path, dir, dir_len) == 0 && strchr(path + dir_len, '/') == NULL;
+}
+
+/* mtime has nanosecond resolution, so rewrites within the same second are detected too */
+static bool ladish_metadata_matches_stat(const struct ladish_metadata * meta_ptr, const struct stat * st_ptr)
+{
+  return
+    meta_ptr->mtime == st_ptr->st_mtim.tv_sec &&
+    meta_ptr->mtime_nsec == st_ptr->st_mtim.tv_nsec &&
+    meta_ptr->size == (uint64_t)st_ptr->st_size &&
+    meta_ptr->inode == (uint64_t)st_ptr->st_ino;
+}
+
+static void ladish_metadata_set_stat(struct ladish_metadata * meta_ptr, const struct stat * st_ptr)
+{
+  meta_ptr->mtime = st_ptr->st_mtim.tv_sec;
+  meta_ptr->mtime_nsec = st_ptr->st_mtim.tv_nsec;
+  meta_ptr->size = (uint64_t)st_ptr->st_size;
+  meta_ptr->inode = (uint64_t)st_ptr->st_ino;
+}
+
+static
+bool
+ladish_metadata_set(
+  struct ladish_metadata * meta_ptr,
+  const char * name,
+  unsigned int rooms,
+  unsigned int apps,
+  const char * jack_settings)
+{
+  char * name_dup;
+  char * jack_settings_dup;
+
+  name_dup = strdup(name);
+  if (name_dup == NULL)
+  {
+    log_error("strdup() failed for metadata name '%s'", name);
+    return false;
+  }
+
+  if (jack_settings != NULL && *jack_settings != 0)
+  {
+    jack_settings_dup = strdup(jack_settings);
+    if (jack_settings_dup == NULL)
+    {
+      log_error("strdup() failed for metadata jack settings '%s'", jack_settings);
+      free(name_dup);
+      return false;
+    }
+  }
+  else
+  {
+    jack_settings_dup = NULL;
+  }
+
+  free(meta_ptr->name);
+  free(meta_ptr->jack_settings);
+
+  meta_ptr->name = name_dup;
+  meta_ptr->jack_settings = jack_settings_dup;
+  meta_ptr->rooms = rooms;
+  meta_ptr->apps = apps;
+
+  return true;
+}
+
+static struct ladish_metadata_entry * ladish_metadata_add_entry(const char * path)
+{
+  struct ladish_metadata_entry * entry_ptr;
+
+  entry_ptr = malloc(sizeof(struct ladish_metadata_entry));
+  if (entry_ptr == NULL)
+  {
+    log_error("malloc() failed to allocate struct ladish_metadata_entry");
+    return NULL;
+  }
+
+  entry_ptr->path = strdup(path);
+  if (entry_ptr->path == NULL)
+  {
+    log_error("strdup() failed for metadata index path '%s'", path);
+    free(entry_ptr);
+    return NULL;
+  }
+
+  entry_ptr->seen = false;
+  entry_ptr->meta.name = NULL;
+  entry_ptr->meta.jack_settings = NULL;
+  entry_ptr->meta.mtime = 0;
+  entry_ptr->meta.mtime_nsec = 0;
+  entry_ptr->meta.size = 0;
+  entry_ptr->meta.inode = 0;
+  entry_ptr->meta.rooms = LADISH_METADATA_COUNT_UNKNOWN;
+  entry_ptr->meta.apps = LADISH_METADATA_COUNT_UNKNOWN;
+
+  list_add_tail(&entry_ptr->siblings, &g_metadata_entries);
+  list_add_tail(&entry_ptr->hash_siblings, g_metadata_entries_hash + ladish_metadata_hash(path));
+
+  return entry_ptr;
+}
+
+/**********************************************************************************/
+/*                                 persistence                                    */
+/**********************************************************************************/
+
+static bool ladish_metadata_write_field(int fd, const char * string)
+{
+  char buffer[4];
+  const char * chunk;
+
+  if (string == NULL)
+  {
+    string = "";
+  }
+
+  if (!ladish_write_string(fd, "\t"))
+  {
+    return false;
+  }
+
+  /* write runs of chars that dont need encoding in one go */
+  while (*string != 0)
+  {
+    chunk = string;
+    while (*string != 0 && *string != '%' && *string != '\t' && *string != '\n')
+    {
+      string++;
+    }
+
+    if (string != chunk && write(fd, chunk, string - chunk) != string - chunk)
+    {
+      log_error("write() failed: %d (%s)", errno, strerror(errno));
+      return false;
+    }
+
+    if (*string != 0)
+    {
+      sprintf(buffer, "%%%02X", (unsigned int)(unsigned char)*string);
+      if (!ladish_write_string(fd, buffer))
+      {
+        return false;
+      }
+
+      string++;
+    }
+  }
+
+  return true;
+}
+
+static bool ladish_metadata_write_number(int fd, uint64_t value)
+{
+  char buffer[100];
+
+  sprintf(buffer, "\t%" PRIu64, value);
+  return ladish_write_string(fd, buffer);
+}
+
+static void ladish_metadata_index_save(void)
+{
+  struct list_head * node_ptr;
+  struct ladish_metadata_entry * entry_ptr;
+  struct ladish_metadata_dir * dir_ptr;
+  char * temp_path;
+  int fd;
+
+  temp_path = catdup(g_metadata_index_path, ".tmp");
+  if (temp_path == NULL)
+  {
+    log_error("catdup() failed to compose metadata index temp file path");
+    return;
+  }
+
+  fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd == -1)
+  {
+    log_error("open(%s) failed: %d (%s)", temp_path, errno, strerror(errno));
+    goto free;
+  }
+
+  if (!ladish_write_string(fd, METADATA_INDEX_HEADER))
+  {
+    goto fail;
+  }
+
+  list_for_each(node_ptr, &g_metadata_dirs)
+  {
+    dir_ptr = list_entry(node_ptr, struct ladish_metadata_dir, siblings);
+
+    if (!ladish_write_string(fd, "D") ||
+        !ladish_metadata_write_field(fd, dir_ptr->path) ||
+        !ladish_metadata_write_number(fd, (uint64_t)dir_ptr->mtime) ||
+        !ladish_metadata_write_number(fd, (uint64_t)dir_ptr->mtime_nsec) ||
+        !ladish_metadata_write_number(fd, dir_ptr->inode) ||
+        !ladish_write_string(fd, "\n"))
+    {
+      goto fail;
+    }
+  }
+
+  list_for_each(node_ptr, &g_metadata_entries)
+  {
+    entry_ptr = list_entry(node_ptr, struct ladish_metadata_entry, siblings);
+
+    if (!ladish_write_string(fd, "F") ||
+        !ladish_metadata_write_field(fd, entry_ptr->path) ||
+        !ladish_metadata_write_number(fd, (uint64_t)entry_ptr->meta.mtime) ||
+        !ladish_metadata_write_number(fd, (uint64_t)entry_ptr->meta.mtime_nsec) ||
+        !ladish_metadata_write_number(fd, entry_ptr->meta.size) ||
+        !ladish_metadata_write_number(fd, entry_ptr->meta.inode) ||
+        !ladish_metadata_write_number(fd, entry_ptr->meta.rooms) ||
+        !ladish_metadata_write_number(fd, entry_ptr->meta.apps) ||
+        !ladish_metadata_write_field(fd, entry_ptr->meta.name) ||
+        !ladish_metadata_write_field(fd, entry_ptr->meta.jack_settings) ||
+        !ladish_write_string(fd, "\n"))
+    {
+      goto fail;
+    }
+  }
+
+  close(fd);
+
+  if (rename(temp_path, g_metadata_index_path) != 0)
+  {
+    log_error("rename(%s, %s) failed: %d (%s)", temp_path, g_metadata_index_path, errno, strerror(errno));
+    goto unlink;
+  }
+
+  g_metadata_index_dirty = false;
+  goto free;
+
+fail:
+  log_error("write to file '%s' failed", temp_path);
+  close(fd);
+unlink:
+  unlink(temp_path);
+free:
+  free(temp_path);
+}
+
+/* split line at tabs, decoding the fields in place */
+static unsigned int ladish_metadata_split_line(char * line, char ** fields, unsigned int max_fields)
+{
+  unsigned int count;
+  char * tab;
+
+  count = 0;
+
+  while (count < max_fields)
+  {
+    fields[count++] = line;
+
+    tab = strchr(line, '\t');
+    if (tab != NULL)
+    {
+      *tab = 0;
+    }
+
+    unescape_simple(line);
+
+    if (tab == NULL)
+    {
+      break;
+    }
+
+    line = tab + 1;
+  }
+
+  return count;
+}
+
+static void ladish_metadata_index_load_line(char * line)
+{
+  char * fields[10];
+  unsigned int count;
+  struct ladish_metadata_entry * entry_ptr;
+
+  if (*line == '#')
+  {
+    return;
+  }
+
+  count = ladish_metadata_split_line(line, fields, 10);
+
+  if (count == 5 && strcmp(fields[0], "D") == 0)
+  {
+    ladish_metadata_add_dir(fields[1], (time_t)strtoull(fields[2], NULL, 10), strtol(fields[3], NULL, 10), strtoull(fields[4], NULL, 10));
+    return;
+  }
+
+  if (count != 10 || strcmp(fields[0], "F") != 0)
+  {
+    log_error("ignoring malformed metadata index record");
+    return;
+  }
+
+  entry_ptr = ladish_metadata_add_entry(fields[1]);
+  if (entry_ptr == NULL)
+  {
+    return;
+  }
+
+  entry_ptr->meta.mtime = (time_t)strtoull(fields[2], NULL, 10);
+  entry_ptr->meta.mtime_nsec = strtol(fields[3], NULL, 10);
+  entry_ptr->meta.size = strtoull(fields[4], NULL, 10);
+  entry_ptr->meta.inode = strtoull(fields[5], NULL, 10);
+
+  if (!ladish_metadata_set(
+        &entry_ptr->meta,
+        fields[8],
+        (unsigned int)strtoul(fields[6], NULL, 10),
+        (unsigned int)strtoul(fields[7], NULL, 10),
+        fields[9]))
+  {
+    ladish_metadata_entry_destroy(entry_ptr);
+  }
+}
+
+static void ladish_metadata_index_load(void)
+{
+  int fd;
+  struct stat st;
+  char * buffer;
+  size_t buffer_size;
+  ssize_t ret;
+  char * line;
+  char * saveptr;
+
+  fd = open(g_metadata_index_path, O_RDONLY);
+  if (fd == -1)
+  {
+    if (errno != ENOENT)
+    {
+      log_error("open(%s) failed: %d (%s)", g_metadata_index_path, errno, strerror(errno));
+    }
+
+    goto exit;
+  }
+
+  if (fstat(fd, &st) != 0)
+  {
+    log_error("fstat(%s) failed: %d (%s)", g_metadata_index_path, errno, strerror(errno));
+    goto close;
+  }
+
+  buffer_size = (size_t)st.st_size;
+  buffer = malloc(buffer_size + 1);
+  if (buffer == NULL)
+  {
+    log_error("malloc() failed to allocate %zu byte buffer for reading the contents of the metadata index file '%s'", buffer_size + 1, g_metadata_index_path);
+    goto close;
+  }
+
+  ret = read(fd, buffer, buffer_size);
+  if (ret == -1)
+  {
+    log_error("read(%s) failed: %d (%s)", g_metadata_index_path, errno, strerror(errno));
+    goto free;
+  }
+
+  if ((size_t)ret < buffer_size)
+  {
+    log_error("read(%s) returned less bytes than requested", g_metadata_index_path);
+    goto free;
+  }
+
+  buffer[buffer_size] = 0;
+
+  if (strncmp(buffer, METADATA_INDEX_HEADER, sizeof(METADATA_INDEX_HEADER) - 1) != 0)
+  {
+    log_info("discarding metadata index '%s' of other version", g_metadata_index_path);
+    g_metadata_index_dirty = true;
+    goto free;
+  }
+
+  for (line = strtok_r(buffer, "\n", &saveptr); line != NULL; line = strtok_r(NULL, "\n", &saveptr))
+  {
+    ladish_metadata_index_load_line(line);
+  }
+
+free:
+  free(buffer);
+close:
+  close(fd);
+exit:
+  return;
+}
+
+/**********************************************************************************/
+/*                                 public API                                     */
+/**********************************************************************************/
+
+bool ladish_metadata_index_init(void)
+{
+  unsigned int i;
+
+  g_metadata_index_path = catdup(g_base_dir, "/" METADATA_INDEX_FILE);
+  if (g_metadata_index_path == NULL)
+  {
+    log_error("catdup() failed to compose metadata index file path");
+    return false;
+  }
+
+  INIT_LIST_HEAD(&g_metadata_entries);
+  for (i = 0; i < METADATA_INDEX_HASH_SIZE; i++)
+  {
+    INIT_LIST_HEAD(g_metadata_entries_hash + i);
+  }
+  INIT_LIST_HEAD(&g_metadata_dirs);
+  g_metadata_index_dirty = false;
+
+  ladish_metadata_index_load();
+
+  return true;
+}
+
+void ladish_metadata_index_uninit(void)
+{
+  struct ladish_metadata_dir * dir_ptr;
+
+  ladish_metadata_index_flush();
+
+  while (!list_empty(&g_metadata_entries))
+  {
+    ladish_metadata_entry_destroy(list_entry(g_metadata_entries.next, struct ladish_metadata_entry, siblings));
+  }
+
+  while (!list_empty(&g_metadata_dirs))
+  {
+    dir_ptr = list_entry(g_metadata_dirs.next, struct ladish_metadata_dir, siblings);
+    list_del(&dir_ptr->siblings);
+    free(dir_ptr->path);
+    free(dir_ptr);
+  }
+
+  free(g_metadata_index_path);
+}
+
+const struct ladish_metadata * ladish_metadata_index_lookup(const char * path)
+{
+  struct ladish_metadata_entry * entry_ptr;
+  struct stat st;
+
+  entry_ptr = ladish_metadata_find_entry(path);
+  if (entry_ptr == NULL)
+  {
+    return NULL;
+  }
+
+  if (stat(path, &st) == 0 && ladish_metadata_matches_stat(&entry_ptr->meta, &st))
+  {
+    return &entry_ptr->meta;
+  }
+
+  log_info("dropping stale metadata index entry for '%s'", path);
+  ladish_metadata_entry_destroy(entry_ptr);
+  g_metadata_index_dirty = true;
+
+  return NULL;
+}
+
+const struct ladish_metadata *
+ladish_metadata_index_update(
+  const char * path,
+  const char * name,
+  unsigned int rooms,
+  unsigned int apps,
+  const char * jack_settings)
+{
+  struct ladish_metadata_entry * entry_ptr;
+  struct stat st;
+
+  if (stat(path, &st) != 0)
+  {
+    log_error("failed to stat '%s': %d (%s)", path, errno, strerror(errno));
+    return NULL;
+  }
+
+  entry_ptr = ladish_metadata_find_entry(path);
+  if (entry_ptr == NULL)
+  {
+    entry_ptr = ladish_metadata_add_entry(path);
+    if (entry_ptr == NULL)
+    {
+      return NULL;
+    }
+  }
+
+  if (!ladish_metadata_set(&entry_ptr->meta, name, rooms, apps, jack_settings))
+  {
+    ladish_metadata_entry_destroy(entry_ptr);
+    g_metadata_index_dirty = true;
+    return NULL;
+  }
+
+  ladish_metadata_set_stat(&entry_ptr->meta, &st);
+  g_metadata_index_dirty = true;
+
+  return &entry_ptr->meta;
+}
+
+void ladish_metadata_index_flush(void)
+{
+  if (g_metadata_index_dirty)
+  {
+    ladish_metadata_index_save();
+  }
+}
+
+static
+bool
+ladish_metadata_index_rescan_dir(
+  struct ladish_metadata_dir * dir_ptr,
+  const char * suffix,
+  char * (* get_name)(const char * filename, size_t len))
+{
+  struct list_head * node_ptr;
+  struct list_head * temp_node_ptr;
+  struct ladish_metadata_entry * entry_ptr;
+  size_t dir_len;
+  size_t suffix_len;
+  size_t len;
+  DIR * dir;
+  struct dirent * dentry;
+  struct stat st;
+  char * path;
+  char * name;
+
+  log_info("rescanning '%s'", dir_ptr->path);
+
+  dir_len = strlen(dir_ptr->path);
+  suffix_len = strlen(suffix);
+
+  list_for_each(node_ptr, &g_metadata_entries)
+  {
+    entry_ptr = list_entry(node_ptr, struct ladish_metadata_entry, siblings);
+    entry_ptr->seen = false;
+  }
+
+  dir = opendir(dir_ptr->path);
+  if (dir == NULL)
+  {
+    log_error("Cannot open directory '%s': %d (%s)", dir_ptr->path, errno, strerror(errno));
+    return false;
+  }
+
+  while ((dentry = readdir(dir)) != NULL)
+  {
+    len = strlen(dentry->d_name);
+    if (len <= suffix_len || strcmp(dentry->d_name + (len - suffix_len), suffix) != 0)
+      continue;
+
+    path = catdup(dir_ptr->path, dentry->d_name);
+    if (path == NULL)
+    {
+      log_error("catdup() failed");
+      closedir(dir);
+      return false;
+    }
+
+    if (stat(path, &st) != 0)
+    {
+      log_error("failed to stat '%s': %d (%s)", path, errno, strerror(errno));
+      goto next;
+    }
+
+    if (!S_ISREG(st.st_mode))
+    {
+      goto next;
+    }
+
+    entry_ptr = ladish_metadata_find_entry(path);
+    if (entry_ptr != NULL && ladish_metadata_matches_stat(&entry_ptr->meta, &st))
+    {
+      entry_ptr->seen = true;
+      goto next;
+    }
+
+    name = get_name(dentry->d_name, len - suffix_len);
+    if (name == NULL)
+    {
+      goto next;
+    }
+
+    if (entry_ptr == NULL)
+    {
+      entry_ptr = ladish_metadata_add_entry(path);
+    }
+
+    if (entry_ptr != NULL)
+    {
+      if (ladish_metadata_set(&entry_ptr->meta, name, LADISH_METADATA_COUNT_UNKNOWN, LADISH_METADATA_COUNT_UNKNOWN, NULL))
+      {
+        ladish_metadata_set_stat(&entry_ptr->meta, &st);
+        entry_ptr->seen = true;
+      }
+      else
+      {
+        ladish_metadata_entry_destroy(entry_ptr);
+      }
+    }
+
+    free(name);
+  next:
+    free(path);
+  }
+
+  closedir(dir);
+
+  /* drop entries for files that are gone */
+  list_for_each_safe(node_ptr, temp_node_ptr, &g_metadata_entries)
+  {
+    entry_ptr = list_entry(node_ptr, struct ladish_metadata_entry, siblings);
+    if (!entry_ptr->seen && ladish_metadata_path_in_dir(entry_ptr->path, dir_ptr->path, dir_len))
+    {
+      ladish_metadata_entry_destroy(entry_ptr);
+    }
+  }
+
+  return true;
+}
+
+bool
+ladish_metadata_index_iterate_dir(
+  const char * dir,
+  const char * suffix,
+  char * (* get_name)(const char * filename, size_t len),
+  void * context,
+  bool (* callback)(void * context, const char * path, const struct ladish_metadata * meta_ptr))
+{
+  struct ladish_metadata_dir * dir_ptr;
+  struct ladish_metadata_entry * entry_ptr;
+  struct list_head * node_ptr;
+  struct stat st;
+  struct stat file_st;
+  size_t dir_len;
+  bool rescan;
+
+  if (stat(dir, &st) != 0)
+  {
+    log_error("failed to stat '%s': %d (%s)", dir, errno, strerror(errno));
+    return false;
+  }
+
+  dir_ptr = ladish_metadata_find_dir(dir);
+  if (dir_ptr == NULL)
+  {
+    dir_ptr = ladish_metadata_add_dir(dir, 0, 0, 0);
+    if (dir_ptr == NULL)
+    {
+      return false;
+    }
+  }
+
+  dir_len = strlen(dir);
+
+  rescan =
+    dir_ptr->mtime != st.st_mtim.tv_sec ||
+    dir_ptr->mtime_nsec != st.st_mtim.tv_nsec ||
+    dir_ptr->inode != (uint64_t)st.st_ino;
+
+  /* files rewritten in place do not change the dir, check them like lookups do */
+  if (!rescan)
+  {
+    list_for_each(node_ptr, &g_metadata_entries)
+    {
+      entry_ptr = list_entry(node_ptr, struct ladish_metadata_entry, siblings);
+      if (ladish_metadata_path_in_dir(entry_ptr->path, dir, dir_len) &&
+          (stat(entry_ptr->path, &file_st) != 0 || !ladish_metadata_matches_stat(&entry_ptr->meta, &file_st)))
+      {
+        log_info("metadata index entry for '%s' is stale", entry_ptr->path);
+        rescan = true;
+        break;
+      }
+    }
+  }
+
+  if (rescan)
+  {
+    if (!ladish_metadata_index_rescan_dir(dir_ptr, suffix, get_name))
+    {
+      return false;
+    }
+
+    dir_ptr->mtime = st.st_mtim.tv_sec;
+    dir_ptr->mtime_nsec = st.st_mtim.tv_nsec;
+    dir_ptr->inode = (uint64_t)st.st_ino;
+    g_metadata_index_dirty = true;
+  }
+
+  list_for_each(node_ptr, &g_metadata_entries)
+  {
+    entry_ptr = list_entry(node_ptr, struct ladish_metadata_entry, siblings);
+    if (ladish_metadata_path_in_dir(entry_ptr->path, dir, dir_len))
+    {
+      if (!callback(context, entry_ptr->path, &entry_ptr->meta))
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,115 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains interface to the studio and project metadata index
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef METADATA_INDEX_H__CB241D5A_DEA8_4987_9AED_22810AB5C9CA__INCLUDED
+#define METADATA_INDEX_H__CB241D5A_DEA8_4987_9AED_22810AB5C9CA__INCLUDED
+
+#include "common.h"
+#include <limits.h>             /* UINT_MAX */
+
+/* room or app count of file that was not saved by this ladishd instance */
+#define LADISH_METADATA_COUNT_UNKNOWN UINT_MAX
+
+/**
+ * Metadata of a studio or project file, as seen when the file was last saved or scanned.
+ * Entries are validated against the file mtime, size and inode before being returned.
+ */
+struct ladish_metadata
+{
+  char * name;                  /* studio or project name */
+  time_t mtime;
+  long mtime_nsec;              /* nanoseconds part of mtime */
+  uint64_t size;
+  uint64_t inode;
+  unsigned int rooms;
+  unsigned int apps;
+  char * jack_settings;         /* summary of the JACK settings; NULL if not applicable or not known */
+};
+
+bool ladish_metadata_index_init(void);
+void ladish_metadata_index_uninit(void);
+
+/**
+ * Lookup metadata of a file. The entry is checked against the file state with stat().
+ * Stale entries are dropped.
+ *
+ * @param[in] path Path of the studio or project xml file
+ *
+ * @return metadata pointer or NULL if file is not indexed or index entry is stale.
+ *         The pointer is valid until next call to any of ladish_metadata_index_* functions.
+ */
+const struct ladish_metadata * ladish_metadata_index_lookup(const char * path);
+
+/**
+ * Create or refresh index entry for a file. Call this after the file is written and closed.
+ * The index file is not written, call ladish_metadata_index_flush() for that.
+ *
+ * @param[in] path Path of the studio or project xml file
+ * @param[in] name Studio or project name
+ * @param[in] rooms Room count or LADISH_METADATA_COUNT_UNKNOWN
+ * @param[in] apps App count or LADISH_METADATA_COUNT_UNKNOWN
+ * @param[in] jack_settings Summary of JACK settings, can be NULL
+ *
+ * @return metadata pointer or NULL on failure.
+ *         The pointer is valid until next call to any of ladish_metadata_index_* functions.
+ */
+const struct ladish_metadata *
+ladish_metadata_index_update(
+  const char * path,
+  const char * name,
+  unsigned int rooms,
+  unsigned int apps,
+  const char * jack_settings);
+
+/**
+ * Write the index file if it was changed since it was last written.
+ * Call this once after a batch of lookups and updates, for example after a listing.
+ */
+void ladish_metadata_index_flush(void);
+
+/**
+ * Iterate indexed files in a directory. The directory is rescanned only when its mtime or inode changed since last scan,
+ * or when one of its indexed files does not match its entry anymore.
+ * Files that are found during rescan but are not indexed get entries with name supplied by the @c get_name callback.
+ *
+ * @param[in] dir Directory path, with trailing slash
+ * @param[in] suffix Suffix of files to be indexed, for example ".xml"
+ * @param[in] get_name Callback that supplies malloc()ed name for not indexed files
+ * @param[in] context User defined context that is supplied to the @c callback
+ * @param[in] callback Callback to call for each indexed file. Return false to stop iteration.
+ *
+ * @retval true All files iterated
+ * @retval false Directory scan failed or iteration stopped because callback returned false
+ */
+bool
+ladish_metadata_index_iterate_dir(
+  const char * dir,
+  const char * suffix,
+  char * (* get_name)(const char * filename, size_t len),
+  void * context,
+  bool (* callback)(void * context, const char * path, const struct ladish_metadata * meta_ptr));
+
+#endif /* #ifndef METADATA_INDEX_H__CB241D5A_DEA8_4987_9AED_22810AB5C9CA__INCLUDED */
@@ -0,0 +1,192 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the performance history
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * The history is a fixed size ring of timestamped entries, the oldest entry
+ * is overwritten when the ring is full. Nothing is allocated when entries are added.
+ * JACK statistics entries come from the JackStats sampler, app entries
+ * from the app supervisor and connection entries from the virtualizer,
+ * so xruns can be correlated with the app start or reconnection that caused them.
+ */
+
+#include <stdarg.h>
+
+#include "perf_history.h"
+#include "../common/time.h"
+
+struct ladish_perf_entry
+{
+  uint64_t time;                /* microseconds since the epoch */
+  uint32_t type;
+  double value;
+  char description[LADISH_PERF_DESCRIPTION_MAX];
+};
+
+static struct
+{
+  struct ladish_perf_entry entries[LADISH_PERF_HISTORY_SIZE];
+  unsigned int next;            /* index of the entry that will be written next */
+  unsigned int count;           /* number of valid entries */
+} g_perf_history;
+
+static struct ladish_perf_entry * ladish_perf_history_next_entry(uint32_t type, double value)
+{
+  struct ladish_perf_entry * entry_ptr;
+
+  entry_ptr = g_perf_history.entries + g_perf_history.next;
+
+  entry_ptr->time = ladish_get_current_microseconds();
+  entry_ptr->type = type;
+  entry_ptr->value = value;
+
+  g_perf_history.next = (g_perf_history.next + 1) % LADISH_PERF_HISTORY_SIZE;
+  if (g_perf_history.count < LADISH_PERF_HISTORY_SIZE)
+  {
+    g_perf_history.count++;
+  }
+
+  return entry_ptr;
+}
+
+void ladish_perf_history_add_sample(uint32_t type, double value)
+{
+  ladish_perf_history_next_entry(type, value)->description[0] = 0;
+}
+
+/* Descriptions are sent as D-Bus strings that must be valid UTF-8.
+ * Drop a multibyte sequence split by the truncation to the description size
+ * and replace invalid bytes coming from the formatted strings with '?'. */
+static void ladish_perf_history_sanitize_description(char * description)
+{
+  unsigned char * ptr;
+  unsigned int len;
+  unsigned int i;
+
+  ptr = (unsigned char *)description;
+  while (*ptr != 0)
+  {
+    if (*ptr < 0x80)
+    {
+      ptr++;
+      continue;
+    }
+
+    if (*ptr >= 0xC2 && *ptr <= 0xDF)
+    {
+      len = 2;
+    }
+    else if (*ptr >= 0xE0 && *ptr <= 0xEF)
+    {
+      len = 3;
+    }
+    else if (*ptr >= 0xF0 && *ptr <= 0xF4)
+    {
+      len = 4;
+    }
+    else
+    {
+      *ptr++ = '?';
+      continue;
+    }
+
+    for (i = 1; i < len; i++)
+    {
+      if ((ptr[i] & 0xC0) != 0x80)
+      {
+        break;
+      }
+    }
+
+    if (i < len && ptr[i] == 0)
+    {
+      /* the sequence was cut by the truncation */
+      *ptr = 0;
+      return;
+    }
+
+    if (i < len ||
+        (ptr[0] == 0xE0 && ptr[1] < 0xA0) || /* overlong */
+        (ptr[0] == 0xED && ptr[1] >= 0xA0) || /* surrogate */
+        (ptr[0] == 0xF0 && ptr[1] < 0x90) || /* overlong */
+        (ptr[0] == 0xF4 && ptr[1] >= 0x90))   /* above U+10FFFF */
+    {
+      *ptr++ = '?';
+      continue;
+    }
+
+    ptr += len;
+  }
+}
+
+void
+ladish_perf_history_add(
+  uint32_t type,
+  double value,
+  const char * format,
+  ...)
+{
+  struct ladish_perf_entry * entry_ptr;
+  va_list ap;
+
+  entry_ptr = ladish_perf_history_next_entry(type, value);
+
+  va_start(ap, format);
+  vsnprintf(entry_ptr->description, sizeof(entry_ptr->description), format, ap);
+  va_end(ap);
+
+  ladish_perf_history_sanitize_description(entry_ptr->description);
+}
+
+bool
+ladish_perf_history_iterate(
+  uint64_t since,
+  void * context,
+  bool (* callback)(void * context, uint64_t time, uint32_t type, double value, const char * description))
+{
+  unsigned int index;
+  unsigned int i;
+  struct ladish_perf_entry * entry_ptr;
+
+  index = (g_perf_history.next + LADISH_PERF_HISTORY_SIZE - g_perf_history.count) % LADISH_PERF_HISTORY_SIZE;
+
+  for (i = 0; i < g_perf_history.count; i++)
+  {
+    entry_ptr = g_perf_history.entries + index;
+    index = (index + 1) % LADISH_PERF_HISTORY_SIZE;
+
+    if (entry_ptr->time <= since)
+    {
+      continue;
+    }
+
+    if (!callback(context, entry_ptr->time, entry_ptr->type, entry_ptr->value, entry_ptr->description))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,64 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains interface to the performance history
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef PERF_HISTORY_H__0022D945_1F72_4387_8A5F_262CC2DC2D9C__INCLUDED
+#define PERF_HISTORY_H__0022D945_1F72_4387_8A5F_262CC2DC2D9C__INCLUDED
+
+#include "common.h"
+
+/* Event types, they are part of the D-Bus API, don't renumber */
+#define LADISH_PERF_EVENT_DSP_LOAD            1 /* value is peak DSP load since the previous sample, in percents */
+#define LADISH_PERF_EVENT_XRUNS               2 /* value is number of xruns since the previous sample */
+#define LADISH_PERF_EVENT_BUFFER_SIZE         3 /* value is the new buffer size */
+#define LADISH_PERF_EVENT_APP_STARTED         4 /* description is "supervisor/app" */
+#define LADISH_PERF_EVENT_APP_STOPPED         5 /* description is "supervisor/app", value is 0 for clean exit, 1 for dirty exit */
+#define LADISH_PERF_EVENT_PORTS_CONNECTED     6 /* description is "client:port -> client:port" */
+#define LADISH_PERF_EVENT_PORTS_DISCONNECTED  7 /* description is "client:port -> client:port" */
+
+#define LADISH_PERF_HISTORY_SIZE 4096 /* entries */
+#define LADISH_PERF_DESCRIPTION_MAX 128 /* including the terminating nul char, longer descriptions are truncated */
+
+void ladish_perf_history_add_sample(uint32_t type, double value);
+
+void
+ladish_perf_history_add(
+  uint32_t type,
+  double value,
+  const char * format,
+  ...)
+#if defined (__GNUC__)
+  __attribute__((format(printf, 3, 4)))
+#endif
+  ;
+
+/* Iterate entries that are newer than since, oldest first. since is in microseconds since the epoch */
+bool
+ladish_perf_history_iterate(
+  uint64_t since,
+  void * context,
+  bool (* callback)(void * context, uint64_t time, uint32_t type, double value, const char * description));
+
+#endif /* #ifndef PERF_HISTORY_H__0022D945_1F72_4387_8A5F_262CC2DC2D9C__INCLUDED */
@@ -41,6 +41,7 @@ struct ladish_port
   void * vgraph;                /* virtual graph */
 
   ladish_dict_handle dict;
+  uint64_t generation;          /* stamp of the last modification of the persisted properties */
 };
 
 bool
@@ -82,6 +83,7 @@ ladish_port_create(
   port_ptr->refcount = 0;
 
   port_ptr->vgraph = NULL;
+  port_ptr->generation = ladish_generation_next();
 
   log_info("port %p created", port_ptr);
   *port_handle_ptr = (ladish_port_handle)port_ptr;
@@ -108,6 +110,14 @@ ladish_dict_handle ladish_port_get_dict(ladish_port_handle port_handle)
   return port_ptr->dict;
 }
 
+uint64_t ladish_port_get_generation(ladish_port_handle port_handle)
+{
+  uint64_t dict_generation;
+
+  dict_generation = ladish_dict_get_generation(port_ptr->dict);
+  return dict_generation > port_ptr->generation ? dict_generation : port_ptr->generation;
+}
+
 void ladish_port_get_uuid(ladish_port_handle port_handle, uuid_t uuid)
 {
   uuid_copy(uuid, port_ptr->uuid);
@@ -167,6 +177,7 @@ bool ladish_port_is_link(ladish_port_handle port_handle)
 void ladish_port_set_vgraph(ladish_port_handle port_handle, void * vgraph)
 {
   port_ptr->vgraph = vgraph;
+  port_ptr->generation = ladish_generation_next();
 }
 
 void * ladish_port_get_vgraph(ladish_port_handle port_handle)
@@ -177,6 +188,7 @@ void * ladish_port_get_vgraph(ladish_port_handle port_handle)
 void ladish_port_set_app(ladish_port_handle port_handle, const uuid_t app_uuid)
 {
   uuid_copy(port_ptr->app_uuid, app_uuid);
+  port_ptr->generation = ladish_generation_next();
 }
 
 bool ladish_port_get_app(ladish_port_handle port_handle, uuid_t app_uuid)
@@ -35,6 +35,7 @@ bool ladish_port_create(const uuid_t uuid_ptr, bool link, ladish_port_handle * p
 bool ladish_port_create_copy(ladish_port_handle port_handle, ladish_port_handle * port_handle_ptr);
 void ladish_port_destroy(ladish_port_handle port_handle);
 ladish_dict_handle ladish_port_get_dict(ladish_port_handle port_handle);
+uint64_t ladish_port_get_generation(ladish_port_handle port_handle);
 void ladish_port_get_uuid(ladish_port_handle port_handle, uuid_t uuid);
 
 void ladish_port_set_jack_id(ladish_port_handle port_handle, uint64_t jack_id);
@@ -29,6 +29,8 @@
 #include "../common/catdup.h"
 #include "../dbus_constants.h"
 #include "room.h"
+#include "room_internal.h"
+#include "metadata_index.h"
 
 #define RECENT_PROJECTS_STORE_FILE "recent_projects"
 #define RECENT_PROJECTS_STORE_MAX_ITEMS 50
@@ -85,11 +87,35 @@ bool recent_projects_callback(void * callback_context, const char * project_path
 {
   DBusMessageIter struct_iter;
   DBusMessageIter dict_iter;
+  char * filename;
+  const struct ladish_metadata * meta_ptr;
   char * name;
 
   ASSERT(ctx_ptr->max_items > 0);
 
-  name = ladish_get_project_name(project_path);
+  name = NULL;
+
+  filename = catdup(project_path, LADISH_PROJECT_FILENAME);
+  if (filename == NULL)
+  {
+    log_error("catdup() failed to compose project xml filename");
+    meta_ptr = NULL;
+  }
+  else
+  {
+    meta_ptr = ladish_metadata_index_lookup(filename);
+    if (meta_ptr == NULL)
+    {
+      /* index miss, parse the project xml and remember the result */
+      name = ladish_get_project_name(project_path);
+      if (name != NULL)
+      {
+        meta_ptr = ladish_metadata_index_update(filename, name, LADISH_METADATA_COUNT_UNKNOWN, LADISH_METADATA_COUNT_UNKNOWN, NULL);
+      }
+    }
+
+    free(filename);
+  }
 
   if (!dbus_message_iter_open_container(&ctx_ptr->array_iter, DBUS_TYPE_STRUCT, NULL, &struct_iter))
   {
@@ -109,7 +135,15 @@ bool recent_projects_callback(void * callback_context, const char * project_path
     goto close_struct;
   }
 
-  if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "name", name))
+  if (!cdbus_maybe_add_dict_entry_string(&dict_iter, "name", meta_ptr != NULL ? meta_ptr->name : name))
+  {
+    ctx_ptr->error = true;
+    goto close_dict;
+  }
+
+  if (meta_ptr != NULL &&
+      meta_ptr->apps != LADISH_METADATA_COUNT_UNKNOWN &&
+      !cdbus_add_dict_entry_uint32(&dict_iter, "apps", meta_ptr->apps))
   {
     ctx_ptr->error = true;
     goto close_dict;
@@ -179,6 +213,7 @@ static void get(struct cdbus_method_call * call_ptr)
 
   ctx.error = false;
   ladish_recent_store_iterate_items(g_recent_projects_store, &ctx,  recent_projects_callback);
+  ladish_metadata_index_flush(); /* index misses are written once per listing */
   if (ctx.error)
   {
     goto fail_unref;
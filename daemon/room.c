@@ -283,6 +283,7 @@ ladish_room_create(
   room_ptr->index = index;
   room_ptr->owner = owner;
   room_ptr->started = false;
+  room_ptr->reuse_detached_apps = false;
   room_ptr->version = 1;
 
   room_ptr->project_name = NULL;
@@ -291,6 +292,10 @@ ladish_room_create(
   room_ptr->project_notes = NULL;
   room_ptr->project_state = ROOM_PROJECT_STATE_UNLOADED;
 
+  room_ptr->generation = ladish_generation_next();
+  room_ptr->saved_generation = 0;
+  ladish_write_fragment_init(&room_ptr->vgraph_fragment);
+
   if (template != NULL)
   {
     ladish_room_get_uuid(template, room_ptr->template_uuid);
@@ -387,6 +392,7 @@ void ladish_room_destroy(ladish_room_handle room_handle)
     free(room_ptr->project_name);
     free(room_ptr->project_description);
     free(room_ptr->project_notes);
+    ladish_write_fragment_uninit(&room_ptr->vgraph_fragment);
 
     ASSERT(!room_ptr->started); /* attempt to destroy not stopped room */
 
@@ -455,6 +461,36 @@ ladish_app_supervisor_handle ladish_room_get_app_supervisor(ladish_room_handle r
   return room_ptr->app_supervisor;
 }
 
+uint64_t ladish_room_get_generation(ladish_room_handle room_handle)
+{
+  uint64_t generation;
+  uint64_t subgeneration;
+
+  generation = ladish_graph_get_generation(room_ptr->graph);
+
+  if (!room_ptr->template)
+  {
+    if (room_ptr->generation > generation)
+    {
+      generation = room_ptr->generation;
+    }
+
+    subgeneration = ladish_app_supervisor_get_generation(room_ptr->app_supervisor);
+    if (subgeneration > generation)
+    {
+      generation = subgeneration;
+    }
+  }
+
+  return generation;
+}
+
+/* NULL if room has no project */
+const char * ladish_room_get_project_name(ladish_room_handle room_handle)
+{
+  return room_ptr->project_name;
+}
+
 struct ladish_room_iterate_link_ports_context
 {
   void * context;
@@ -570,6 +606,7 @@ void ladish_room_initiate_stop(ladish_room_handle room_handle, bool clear_persis
   }
 
   ladish_graph_set_connection_handlers(room_ptr->graph, NULL, NULL, NULL);
+  ladish_graph_set_async_connection_handlers(room_ptr->graph, NULL, NULL, NULL);
 
   if (clear_persist)
   {
@@ -655,6 +692,29 @@ ladish_remove_room_app(
   return true;
 }
 
+static void ladish_room_forget_app(void * UNUSED(context), const uuid_t uuid, const char * name)
+{
+  ladish_virtualizer_forget_app(ladish_studio_get_virtualizer(), uuid, name);
+}
+
+unsigned int ladish_room_detach_running_apps(ladish_room_handle room_handle)
+{
+  unsigned int count;
+
+  if (!room_ptr->started ||
+      (room_ptr->project_state != ROOM_PROJECT_STATE_LOADED &&
+       room_ptr->project_state != ROOM_PROJECT_STATE_UNLOADED))
+  {
+    return 0;
+  }
+
+  /* the JACK clients of the detached apps are replayed to the virtualizer when the apps are adopted */
+  count = ladish_app_supervisor_detach_running_apps(room_ptr->app_supervisor, NULL, ladish_room_forget_app);
+  room_ptr->reuse_detached_apps = count != 0;
+
+  return count;
+}
+
 bool ladish_room_unload_project(ladish_room_handle room_handle)
 {
   unsigned int old_project_state;
@@ -731,6 +791,19 @@ bool ladish_room_unload_project(ladish_room_handle room_handle)
   return true;
 }
 
+const char * ladish_room_get_unload_stage(ladish_room_handle room_handle)
+{
+  switch (room_ptr->project_state)
+  {
+  case ROOM_PROJECT_STATE_UNLOADING_CONNECTIONS:
+    return "connections disappear";
+  case ROOM_PROJECT_STATE_UNLOADING_APPS:
+    return "apps stop";
+  }
+
+  return NULL;
+}
+
 ladish_port_handle
 ladish_room_add_port(
   ladish_room_handle room_handle,
@@ -869,6 +942,7 @@ void ladish_room_emit_project_properties_changed(struct ladish_room * room_ptr)
   DBusMessageIter iter;
 
   room_ptr->version++;
+  room_ptr->generation = ladish_generation_next();
 
   message_ptr = dbus_message_new_signal(room_ptr->object_path, IFACE_ROOM, "ProjectPropertiesChanged");
   if (message_ptr == NULL)
@@ -911,6 +985,8 @@ void ladish_room_clear_project(struct ladish_room * room_ptr)
   room_ptr->project_notes = NULL;
 
   room_ptr->project_state = ROOM_PROJECT_STATE_UNLOADED;
+  room_ptr->saved_generation = 0;
+  ladish_write_fragment_uninit(&room_ptr->vgraph_fragment);
   ladish_graph_dump(room_ptr->graph);
 }
 
@@ -974,6 +1050,25 @@ static void ladish_room_dbus_load_project(struct cdbus_method_call * call_ptr)
   }
 }
 
+static void ladish_room_dbus_switch_project(struct cdbus_method_call * call_ptr)
+{
+  const char * dir;
+
+  log_info("Switch project request");
+
+  if (!dbus_message_get_args(call_ptr->message, &cdbus_g_dbus_error, DBUS_TYPE_STRING, &dir, DBUS_TYPE_INVALID))
+  {
+    cdbus_error(call_ptr, DBUS_ERROR_INVALID_ARGS, "Invalid arguments to method \"%s\": %s",  call_ptr->method_name, cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  if (ladish_command_switch_project(call_ptr, ladish_studio_get_cmd_queue(), room_ptr->uuid, dir))
+  {
+    cdbus_method_return_new_void(call_ptr);
+  }
+}
+
 static void ladish_room_dbus_get_project_properties(struct cdbus_method_call * call_ptr)
 {
   DBusMessageIter iter;
@@ -1085,6 +1180,10 @@ CDBUS_METHOD_ARGS_BEGIN(LoadProject, "Load project")
   CDBUS_METHOD_ARG_DESCRIBE_IN("project_dir", "s", "Project directory")
 CDBUS_METHOD_ARGS_END
 
+CDBUS_METHOD_ARGS_BEGIN(SwitchProject, "Load project, reusing running apps that are same in both projects")
+  CDBUS_METHOD_ARG_DESCRIBE_IN("project_dir", "s", "Project directory")
+CDBUS_METHOD_ARGS_END
+
 CDBUS_METHOD_ARGS_BEGIN(GetProjectProperties, "Get project properties")
   CDBUS_METHOD_ARG_DESCRIBE_OUT("new_version", DBUS_TYPE_UINT64_AS_STRING, "New version of the project properties")
   CDBUS_METHOD_ARG_DESCRIBE_OUT("properties", "a{sv}", "project properties")
@@ -1105,6 +1204,7 @@ CDBUS_METHODS_BEGIN
   CDBUS_METHOD_DESCRIBE(SaveProject, ladish_room_dbus_save_project) /* async */
   CDBUS_METHOD_DESCRIBE(UnloadProject, ladish_room_dbus_unload_project) /* async */
   CDBUS_METHOD_DESCRIBE(LoadProject, ladish_room_dbus_load_project) /* async */
+  CDBUS_METHOD_DESCRIBE(SwitchProject, ladish_room_dbus_switch_project) /* async */
   CDBUS_METHOD_DESCRIBE(GetProjectProperties, ladish_room_dbus_get_project_properties) /* sync */
   CDBUS_METHOD_DESCRIBE(SetProjectDescription, ladish_room_dbus_set_project_description) /* sync */
   CDBUS_METHOD_DESCRIBE(SetProjectNotes, ladish_room_dbus_set_project_notes) /* sync */
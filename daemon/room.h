@@ -61,6 +61,7 @@ bool ladish_room_get_template_uuid(ladish_room_handle room_handle, uuid_t uuid_p
 void ladish_room_get_uuid(ladish_room_handle room_handle, uuid_t uuid_ptr);
 ladish_graph_handle ladish_room_get_graph(ladish_room_handle room_handle);
 ladish_app_supervisor_handle ladish_room_get_app_supervisor(ladish_room_handle room_handle);
+uint64_t ladish_room_get_generation(ladish_room_handle room_handle); /* graph, apps and project properties */
 
 bool
 ladish_room_iterate_link_ports(
@@ -96,7 +97,18 @@ ladish_room_save_project(
   void * context,
   ladish_room_save_complete_callback callback);
 
+bool ladish_room_write_project_xml(ladish_room_handle room_handle, int fd);
+const char * ladish_room_get_project_name(ladish_room_handle room_handle);
+
 bool ladish_room_unload_project(ladish_room_handle room_handle);
+
+/* What an unfinished ladish_room_unload_project() waits for, NULL when the project is not being unloaded */
+const char * ladish_room_get_unload_stage(ladish_room_handle room_handle);
+
+/* Detach running apps of the room so they are kept running while the project is unloaded.
+ * The next ladish_room_load_project() reuses the ones that match apps of the loaded project
+ * and stops the others. Returns number of detached apps. */
+unsigned int ladish_room_detach_running_apps(ladish_room_handle room_handle);
 bool ladish_room_load_project(ladish_room_handle room_handle, const char * project_dir);
 
 char * ladish_get_project_name(const char * project_dir);
@@ -28,6 +28,7 @@
 #define ROOM_INTERNAL_H__FAF5B68F_E419_442A_8F9B_C729BAC00422__INCLUDED
 
 #include "room.h"
+#include "save.h"
 
 #define LADISH_PROJECT_FILENAME "/ladish-project.xml"
 
@@ -54,6 +55,7 @@ struct ladish_room
   ladish_app_supervisor_handle app_supervisor;
   ladish_client_handle client;
   bool started;
+  bool reuse_detached_apps;     /* project switch in progress, detached apps are to be adopted on project load */
 
   unsigned int project_state;
   uuid_t project_uuid;
@@ -61,6 +63,10 @@ struct ladish_room
   char * project_name;
   char * project_description;
   char * project_notes;
+
+  uint64_t generation;          /* stamp of the last project properties change */
+  uint64_t saved_generation;    /* ladish_room_get_generation() when project was last saved, 0 if not saved */
+  struct ladish_write_fragment vgraph_fragment; /* room graph and apps, as written in the project xml */
 };
 
 void ladish_room_emit_project_properties_changed(struct ladish_room * room_ptr);
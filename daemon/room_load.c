@@ -793,9 +793,13 @@ bool ladish_room_load_project(ladish_room_handle room_handle, const char * proje
   enum XML_Status xmls;
   struct ladish_parse_context parse_context;
   bool ret;
+  bool reuse_detached_apps;
 
   log_info("Loading project '%s' into room '%s'", project_dir, room_ptr->name);
 
+  reuse_detached_apps = room_ptr->reuse_detached_apps;
+  room_ptr->reuse_detached_apps = false;
+
   ASSERT(room_ptr->project_state == ROOM_PROJECT_STATE_UNLOADED);
   ASSERT(room_ptr->project_dir == NULL);
   ASSERT(room_ptr->project_name == NULL);
@@ -894,6 +898,17 @@ bool ladish_room_load_project(ladish_room_handle room_handle, const char * proje
 
   ladish_graph_trick_dicts(room_ptr->graph);
   ladish_try_connect_hidden_connections(room_ptr->graph);
+
+  if (reuse_detached_apps)
+  {
+    if (ladish_app_supervisor_adopt_detached_apps(room_ptr->app_supervisor) != 0)
+    {
+      ladish_virtualizer_replay_app_clients(ladish_studio_get_virtualizer(), room_ptr->graph);
+    }
+
+    ladish_app_supervisor_stop_detached_apps(room_ptr->app_supervisor);
+  }
+
   ladish_app_supervisor_autorun(room_ptr->app_supervisor);
 
   ladish_recent_project_use(room_ptr->project_dir);
@@ -36,6 +36,8 @@
 #include "save.h"
 #include "../common/dirhelpers.h"
 #include "escape.h"
+#include "metadata_index.h"
+#include "studio.h"
 
 #define PROJECT_HEADER_TEXT BASE_NAME " Project.\n"
 #define DEFAULT_PROJECT_BASE_DIR "/ladish-projects/"
@@ -92,84 +94,130 @@ static void ladish_room_save_complete(struct ladish_room_save_context * ctx_ptr,
   ladish_room_save_context_destroy(ctx_ptr);
 }
 
-static bool ladish_room_save_project_xml(struct ladish_room * room_ptr)
+/* generation of everything that is written to the project xml */
+static uint64_t ladish_room_get_project_generation(struct ladish_room * room_ptr)
 {
-  bool ret;
-  time_t timestamp;
-  char timestamp_str[26];
-  char uuid_str[37];
+  uint64_t generation;
+  uint64_t jack_generation;
+
+  generation = ladish_room_get_generation((ladish_room_handle)room_ptr);
+
+  /* room clients are stored in the jack graph that is shared with the studio */
+  jack_generation = ladish_graph_get_generation(ladish_studio_get_jack_graph());
+
+  return jack_generation > generation ? jack_generation : generation;
+}
+
+/* whether project xml on disk matches the room state, so saving it again would not change anything */
+static bool ladish_room_project_is_unchanged(struct ladish_room_save_context * ctx_ptr)
+{
+  struct ladish_room * room_ptr;
   char * filename;
-  char * bak_filename;
-  int fd;
+  struct stat st;
+  bool exists;
 
-  time(&timestamp);
-  ctime_r(&timestamp, timestamp_str);
-  timestamp_str[24] = 0;
+  room_ptr = ctx_ptr->room;
 
-  ret = false;
+  if (room_ptr->saved_generation == 0 || room_ptr->project_state != ROOM_PROJECT_STATE_LOADED)
+  {
+    return false;
+  }
 
-  uuid_generate(room_ptr->project_uuid); /* TODO: the uuid should be changed on "save as" but not on "rename" */
-  uuid_unparse(room_ptr->project_uuid, uuid_str);
+  if (ctx_ptr->old_project_dir == NULL ||
+      strcmp(ctx_ptr->project_dir, ctx_ptr->old_project_dir) != 0 ||
+      strcmp(ctx_ptr->project_name, ctx_ptr->old_project_name) != 0)
+  {
+    return false;
+  }
+
+  if (ladish_room_get_project_generation(room_ptr) != room_ptr->saved_generation)
+  {
+    return false;
+  }
 
   filename = catdup(room_ptr->project_dir, LADISH_PROJECT_FILENAME);
   if (filename == NULL)
   {
     log_error("catdup() failed to compose project xml filename");
-    goto exit;
+    return false;
   }
 
-  bak_filename = catdup(filename, ".bak");
-  if (bak_filename == NULL)
-  {
-    log_error("catdup() failed to compose project xml backup filename");
-    goto free_filename;
-  }
+  exists = stat(filename, &st) == 0;
+  free(filename);
 
-  fd = open(filename, O_WRONLY | O_TRUNC | O_CREAT, 0666);
-  if (fd == -1)
+  return exists;
+}
+
+#define room_ptr ((struct ladish_room *)context)
+
+static bool ladish_room_write_vgraph(void * context, int fd)
+{
+  if (!ladish_write_vgraph(fd, 1, room_ptr->graph, room_ptr->app_supervisor))
   {
-    log_error("open(%s) failed: %d (%s)", filename, errno, strerror(errno));
-    goto free_bak_filename;
+    log_error("ladish_write_vgraph() failed for room");
+    return false;
   }
 
+  return ladish_write_dict(fd, 1, ladish_graph_get_dict(room_ptr->graph));
+}
+
+#undef room_ptr
+
+/* write project xml from the current room state, also used for autosave snapshots */
+bool ladish_room_write_project_xml(ladish_room_handle room_handle, int fd)
+{
+  struct ladish_room * room_ptr;
+  uint64_t vgraph_generation;
+  time_t timestamp;
+  char timestamp_str[26];
+  char uuid_str[37];
+
+  room_ptr = (struct ladish_room *)room_handle;
+
+  time(&timestamp);
+  ctime_r(&timestamp, timestamp_str);
+  timestamp_str[24] = 0;
+
+  uuid_unparse(room_ptr->project_uuid, uuid_str);
+
   if (!ladish_write_string(fd, "<?xml version=\"1.0\"?>\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, "<!--\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, PROJECT_HEADER_TEXT))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, "-->\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, "<!-- "))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, timestamp_str))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, " -->\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, "<project name=\""))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string_escape(fd, room_ptr->project_name))
@@ -189,24 +237,24 @@ static bool ladish_room_save_project_xml(struct ladish_room * room_ptr)
 
   if (!ladish_write_string(fd, "\">\n"))
   {
-    goto close;
+    return false;
   }
 
   if (room_ptr->project_description != NULL)
   {
     if (!ladish_write_indented_string(fd, 1, "<description>"))
     {
-      goto close;
+      return false;
     }
 
     if (!ladish_write_string_escape(fd, room_ptr->project_description))
     {
-      goto close;
+      return false;
     }
 
     if (!ladish_write_string(fd, "</description>\n"))
     {
-      goto close;
+      return false;
     }
   }
 
@@ -214,23 +262,23 @@ static bool ladish_room_save_project_xml(struct ladish_room * room_ptr)
   {
     if (!ladish_write_indented_string(fd, 1, "<notes>"))
     {
-      goto close;
+      return false;
     }
 
     if (!ladish_write_string_escape(fd, room_ptr->project_notes))
     {
-      goto close;
+      return false;
     }
 
     if (!ladish_write_string(fd, "</notes>\n"))
     {
-      goto close;
+      return false;
     }
   }
 
   if (!ladish_write_indented_string(fd, 1, "<room>\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_room_link_ports(fd, 2, (ladish_room_handle)room_ptr))
@@ -241,37 +289,69 @@ static bool ladish_room_save_project_xml(struct ladish_room * room_ptr)
 
   if (!ladish_write_indented_string(fd, 1, "</room>\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_indented_string(fd, 1, "<jack>\n"))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_jgraph(fd, 2, room_ptr->graph, room_ptr->app_supervisor))
   {
     log_error("ladish_write_jgraph() failed for room graph");
-    goto close;
+    return false;
   }
 
   if (!ladish_write_indented_string(fd, 1, "</jack>\n"))
   {
-    goto close;
+    return false;
   }
 
-  if (!ladish_write_vgraph(fd, 1, room_ptr->graph, room_ptr->app_supervisor))
+  vgraph_generation = ladish_graph_get_generation(room_ptr->graph);
+  if (ladish_app_supervisor_get_generation(room_ptr->app_supervisor) > vgraph_generation)
   {
-    log_error("ladish_write_vgraph() failed for studio");
-    goto close;
+    vgraph_generation = ladish_app_supervisor_get_generation(room_ptr->app_supervisor);
   }
 
-  if (!ladish_write_dict(fd, 1, ladish_graph_get_dict(room_ptr->graph)))
+  if (!ladish_write_fragment(fd, &room_ptr->vgraph_fragment, vgraph_generation, room_ptr, ladish_room_write_vgraph))
   {
-    goto close;
+    return false;
   }
 
   if (!ladish_write_string(fd, "</project>\n"))
+  {
+    return false;
+  }
+
+  return true;
+}
+
+static bool ladish_room_save_project_xml(struct ladish_room * room_ptr)
+{
+  bool ret;
+  char * filename;
+  int fd;
+
+  ret = false;
+
+  uuid_generate(room_ptr->project_uuid); /* TODO: the uuid should be changed on "save as" but not on "rename" */
+
+  filename = catdup(room_ptr->project_dir, LADISH_PROJECT_FILENAME);
+  if (filename == NULL)
+  {
+    log_error("catdup() failed to compose project xml filename");
+    goto exit;
+  }
+
+  fd = open(filename, O_WRONLY | O_TRUNC | O_CREAT, 0666);
+  if (fd == -1)
+  {
+    log_error("open(%s) failed: %d (%s)", filename, errno, strerror(errno));
+    goto free_filename;
+  }
+
+  if (!ladish_room_write_project_xml((ladish_room_handle)room_ptr, fd))
   {
     goto close;
   }
@@ -280,8 +360,13 @@ static bool ladish_room_save_project_xml(struct ladish_room * room_ptr)
 
 close:
   close(fd);
-free_bak_filename:
-  free(bak_filename);
+
+  if (ret)
+  {
+    ladish_metadata_index_update(filename, room_ptr->project_name, 0, ladish_app_supervisor_get_app_count(room_ptr->app_supervisor), NULL);
+    ladish_metadata_index_flush();
+  }
+
 free_filename:
   free(filename);
 exit:
@@ -300,6 +385,13 @@ static void ladish_room_apps_save_complete(void * context, bool success)
     return;
   }
 
+  if (ladish_room_project_is_unchanged(ctx_ptr))
+  {
+    log_info("Project '%s' in room '%s' is not modified, nothing to save", ctx_ptr->room->project_name, ctx_ptr->room->name);
+    ladish_room_save_complete(ctx_ptr, true);
+    return;
+  }
+
   if (!ladish_room_save_project_xml(ctx_ptr->room))
   {
     ladish_room_save_complete(ctx_ptr, false);
@@ -310,6 +402,7 @@ static void ladish_room_apps_save_complete(void * context, bool success)
   ladish_room_emit_project_properties_changed(ctx_ptr->room);
 
   ctx_ptr->room->project_state = ROOM_PROJECT_STATE_LOADED;
+  ctx_ptr->room->saved_generation = ladish_room_get_project_generation(ctx_ptr->room);
 
   ladish_room_save_complete(ctx_ptr, true);
 }
@@ -341,7 +434,7 @@ char * compose_project_dir_from_name(const char * project_name)
   home_dir = getenv("HOME");
   home_dir_len = strlen(home_dir);
 
-  project_dir = malloc(home_dir_len + DEFAULT_PROJECT_BASE_DIR_LEN + max_escaped_length(strlen(project_name)) + 1);
+  project_dir = malloc(home_dir_len + DEFAULT_PROJECT_BASE_DIR_LEN + escaped_length(project_name, LADISH_ESCAPE_FLAG_ALL) + 1);
   if (project_dir == NULL)
   {
     log_error("malloc() failed to allocate buffer for project dir");
@@ -68,17 +68,54 @@ is_hidden_port_interesting(
   return !ladish_app_is_running(app);
 }
 
-bool ladish_write_string(int fd, const char * string)
+/* fragment that captures output written to LADISH_WRITE_FD_FRAGMENT */
+static struct ladish_write_fragment * g_capture_fragment_ptr;
+
+static bool ladish_write_capture(const char * data, size_t len)
+{
+  size_t size;
+  char * buffer;
+
+  ASSERT(g_capture_fragment_ptr != NULL);
+
+  if (g_capture_fragment_ptr->size + len > g_capture_fragment_ptr->allocated)
+  {
+    size = g_capture_fragment_ptr->allocated != 0 ? g_capture_fragment_ptr->allocated : 4096;
+    while (size < g_capture_fragment_ptr->size + len)
+    {
+      size *= 2;
+    }
+
+    buffer = realloc(g_capture_fragment_ptr->buffer, size);
+    if (buffer == NULL)
+    {
+      log_error("realloc() failed to grow fragment buffer to %zu bytes", size);
+      return false;
+    }
+
+    g_capture_fragment_ptr->buffer = buffer;
+    g_capture_fragment_ptr->allocated = size;
+  }
+
+  memcpy(g_capture_fragment_ptr->buffer + g_capture_fragment_ptr->size, data, len);
+  g_capture_fragment_ptr->size += len;
+
+  return true;
+}
+
+static bool ladish_write_buffer(int fd, const char * data, size_t len)
 {
-  size_t len;
   ssize_t ret;
 
-  len = strlen(string);
+  if (fd == LADISH_WRITE_FD_FRAGMENT)
+  {
+    return ladish_write_capture(data, len);
+  }
 
-  ret = write(fd, string, len);
+  ret = write(fd, data, len);
   if (ret == -1)
   {
-    log_error("write(%d, \"%s\", %zu) failed to write file: %d (%s)", fd, string, len, errno, strerror(errno));
+    log_error("write(%d, \"%.*s\", %zu) failed to write file: %d (%s)", fd, (int)(len > 100 ? 100 : len), data, len, errno, strerror(errno));
     return false;
   }
   if ((size_t)ret != len)
@@ -90,6 +127,11 @@ bool ladish_write_string(int fd, const char * string)
   return true;
 }
 
+bool ladish_write_string(int fd, const char * string)
+{
+  return ladish_write_buffer(fd, string, strlen(string));
+}
+
 bool ladish_write_indented_string(int fd, int indent, const char * string)
 {
   ASSERT(indent >= 0);
@@ -112,20 +154,39 @@ bool ladish_write_indented_string(int fd, int indent, const char * string)
 bool ladish_write_string_escape_ex(int fd, const char * string, unsigned int flags)
 {
   bool ret;
+  size_t len;
+  char buffer[1024];
   char * escaped_buffer;
 
-  escaped_buffer = malloc(max_escaped_length(strlen(string)));
-  if (escaped_buffer == NULL)
+  len = escaped_length(string, flags);
+  if (len == strlen(string))
   {
-    log_error("malloc() failed to allocate buffer for escaped string");
-    return false;
+    /* nothing to escape */
+    return ladish_write_string(fd, string);
+  }
+
+  if (len < sizeof(buffer))
+  {
+    escaped_buffer = buffer;
+  }
+  else
+  {
+    escaped_buffer = malloc(len + 1);
+    if (escaped_buffer == NULL)
+    {
+      log_error("malloc() failed to allocate buffer for escaped string");
+      return false;
+    }
   }
 
   escape_simple(string, escaped_buffer, flags);
 
   ret = ladish_write_string(fd, escaped_buffer);
 
-  free(escaped_buffer);
+  if (escaped_buffer != buffer)
+  {
+    free(escaped_buffer);
+  }
 
   return ret;
 }
@@ -135,6 +196,58 @@ bool ladish_write_string_escape(int fd, const char * string)
   return ladish_write_string_escape_ex(fd, string, LADISH_ESCAPE_FLAG_ALL);
 }
 
+void ladish_write_fragment_init(struct ladish_write_fragment * fragment_ptr)
+{
+  fragment_ptr->generation = 0;
+  fragment_ptr->buffer = NULL;
+  fragment_ptr->size = 0;
+  fragment_ptr->allocated = 0;
+}
+
+void ladish_write_fragment_uninit(struct ladish_write_fragment * fragment_ptr)
+{
+  free(fragment_ptr->buffer);
+  ladish_write_fragment_init(fragment_ptr);
+}
+
+bool
+ladish_write_fragment(
+  int fd,
+  struct ladish_write_fragment * fragment_ptr,
+  uint64_t generation,
+  void * context,
+  bool (* serialize)(void * context, int fd))
+{
+  bool ret;
+
+  ASSERT(generation != 0);
+  ASSERT(fd != LADISH_WRITE_FD_FRAGMENT); /* fragments cannot be nested */
+
+  if (fragment_ptr->generation == generation)
+  {
+    log_debug("reusing serialized fragment of %zu bytes", fragment_ptr->size);
+    return ladish_write_buffer(fd, fragment_ptr->buffer, fragment_ptr->size);
+  }
+
+  ASSERT(g_capture_fragment_ptr == NULL);
+  g_capture_fragment_ptr = fragment_ptr;
+  fragment_ptr->generation = 0;
+  fragment_ptr->size = 0;
+
+  ret = serialize(context, LADISH_WRITE_FD_FRAGMENT);
+
+  g_capture_fragment_ptr = NULL;
+
+  if (!ret)
+  {
+    return false;
+  }
+
+  fragment_ptr->generation = generation;
+
+  return ladish_write_buffer(fd, fragment_ptr->buffer, fragment_ptr->size);
+}
+
 static
 bool
 ladish_port_dict_ignored_keys_check(
@@ -759,9 +872,6 @@ ladish_save_app(
   pid_t UNUSED(pid),
   const uuid_t uuid)
 {
-  const char * unescaped_string;
-  char * escaped_string;
-  char * escaped_buffer;
   bool ret;
   char str[37];
 
@@ -771,91 +881,73 @@ ladish_save_app(
 
   ret = false;
 
-  escaped_buffer = malloc(max_escaped_length(ladish_max(strlen(name), strlen(command))) + 1);
-  if (escaped_buffer == NULL)
-  {
-    log_error("malloc() failed.");
-    goto exit;
-  }
-
   if (!ladish_write_indented_string(fd, indent, "<application name=\""))
   {
-    goto free_buffer;
+    goto exit;
   }
 
-  unescaped_string = name;
-  escaped_string = escaped_buffer;
-  escape(&unescaped_string, &escaped_string, LADISH_ESCAPE_FLAG_ALL);
-  *escaped_string = 0;
-  if (!ladish_write_string(fd, escaped_buffer))
+  if (!ladish_write_string_escape(fd, name))
   {
-    goto free_buffer;
+    goto exit;
   }
 
   if (!ladish_write_string(fd, "\" uuid=\""))
   {
-    return false;
+    goto exit;
   }
 
   if (!ladish_write_string(fd, str))
   {
-    return false;
+    goto exit;
   }
 
   if (!ladish_write_string(fd, "\" terminal=\""))
   {
-    goto free_buffer;
+    goto exit;
   }
 
   if (!ladish_write_string(fd, terminal ? "true" : "false"))
   {
-    goto free_buffer;
+    goto exit;
   }
 
   if (!ladish_write_string(fd, "\" level=\""))
   {
-    goto free_buffer;
+    goto exit;
   }
 
   if (!ladish_write_string(fd, level))
   {
-    goto free_buffer;
+    goto exit;
   }
 
   if (!ladish_write_string(fd, "\" autorun=\""))
   {
-    goto free_buffer;
+    goto exit;
   }
 
   if (!ladish_write_string(fd, running ? "true" : "false"))
   {
-    goto free_buffer;
+    goto exit;
   }
 
   if (!ladish_write_string(fd, "\">"))
   {
-    goto free_buffer;
+    goto exit;
   }
 
-  unescaped_string = command;
-  escaped_string = escaped_buffer;
-  escape(&unescaped_string, &escaped_string, LADISH_ESCAPE_FLAG_ALL);
-  *escaped_string = 0;
-  if (!ladish_write_string(fd, escaped_buffer))
+  if (!ladish_write_string_escape(fd, command))
   {
-    goto free_buffer;
+    goto exit;
   }
 
   if (!ladish_write_string(fd, "</application>\n"))
   {
-    goto free_buffer;
+    goto exit;
   }
 
   ret = true;
 
-free_buffer:
-  free(escaped_buffer);
-
 exit:
   return ret;
 }
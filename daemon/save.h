@@ -41,6 +41,18 @@ struct ladish_write_context
   int indent;
 };
 
+/* pseudo fd that is passed to ladish_write_fragment() serialize callbacks */
+#define LADISH_WRITE_FD_FRAGMENT (-2)
+
+/* Serialized xml fragment, reused as long as the generation of the serialized objects does not change */
+struct ladish_write_fragment
+{
+  uint64_t generation;          /* 0 when fragment is not valid */
+  char * buffer;
+  size_t size;
+  size_t allocated;
+};
+
 bool ladish_write_string(int fd, const char * string);
 bool ladish_write_indented_string(int fd, int indent, const char * string);
 bool ladish_write_string_escape(int fd, const char * string);
@@ -50,4 +62,15 @@ bool ladish_write_vgraph(int fd, int indent, ladish_graph_handle vgraph, ladish_
 bool ladish_write_room_link_ports(int fd, int indent, ladish_room_handle room);
 bool ladish_write_jgraph(int fd, int indent, ladish_graph_handle vgraph, ladish_app_supervisor_handle app_supervisor);
 
+void ladish_write_fragment_init(struct ladish_write_fragment * fragment_ptr);
+void ladish_write_fragment_uninit(struct ladish_write_fragment * fragment_ptr);
+
+bool
+ladish_write_fragment(
+  int fd,
+  struct ladish_write_fragment * fragment_ptr,
+  uint64_t generation,
+  void * context,
+  bool (* serialize)(void * context, int fd));
+
 #endif /* #ifndef SAVE_H__120D6D3D_90A9_4998_8F00_23FCB8BA8DE9__INCLUDED */
@@ -40,6 +40,7 @@
 #include "graph_manager.h"
 #include "escape.h"
 #include "studio.h"
+#include "graph_record.h"
 #include "../proxies/notify_proxy.h"
 
 #define STUDIOS_DIR "/studios/"
@@ -151,6 +152,10 @@ void ladish_studio_clear(void)
   g_studio.modified = false;
   g_studio.persisted = false;
 
+  g_studio.saved_generation = 0;
+  ladish_write_fragment_uninit(&g_studio.jgraph_fragment);
+  ladish_write_fragment_uninit(&g_studio.vgraph_fragment);
+
   ladish_app_supervisor_clear(g_studio.app_supervisor);
 
   if (g_studio.dbus_object != NULL)
@@ -350,12 +355,22 @@ void ladish_studio_on_event_jack_started(void)
     else
     {
       ladish_studio_iterate_virtual_graphs(g_studio.virtualizer, ladish_studio_set_graph_connection_handlers);
+
+      /* connections made for the previous studio are still there */
+      ladish_virtualizer_set_prune_connections(g_studio.virtualizer, g_studio.jack_kept);
     }
 
+    ladish_graph_record_attach(g_studio.jack_graph_proxy);
+
     if (!graph_proxy_activate(g_studio.jack_graph_proxy))
     {
       log_error("graph_proxy_activate() failed.");
     }
+
+    if (g_studio.virtualizer != NULL)
+    {
+      ladish_virtualizer_set_prune_connections(g_studio.virtualizer, false);
+    }
   }
 
   ladish_app_supervisor_autorun(g_studio.app_supervisor);
@@ -379,6 +394,7 @@ static void ladish_studio_on_jack_stopped_internal(void)
 
   if (g_studio.jack_graph_proxy)
   {
+    ladish_graph_record_detach(g_studio.jack_graph_proxy);
     graph_proxy_destroy(g_studio.jack_graph_proxy);
     g_studio.jack_graph_proxy = NULL;
   }
@@ -391,6 +407,20 @@ void ladish_studio_on_event_jack_stopped(void)
   ladish_notify_simple(LADISH_NOTIFY_URGENCY_NORMAL, "Studio stopped", NULL);
 }
 
+void ladish_studio_release_kept_jack(void)
+{
+  ASSERT(g_studio.jack_kept);
+  g_studio.jack_kept = false;
+  g_studio.jack_kept_outdated = false;
+
+  log_info("Stopping JACK server that was kept running...");
+
+  if (!jack_proxy_stop_server())
+  {
+    log_error("Stopping JACK server failed.");
+  }
+}
+
 void ladish_studio_handle_unexpected_jack_server_stop(void)
 {
   ladish_studio_emit_crashed();
@@ -414,12 +444,27 @@ void ladish_studio_run(void)
 {
   bool state;
 
+  ladish_app_supervisor_check_js_save_deadlines();
   ladish_cqueue_run(&g_studio.cmd_queue);
   if (g_quit)
   { /* if quit is requested, don't bother to process external events */
     return;
   }
 
+  if (list_empty(&g_studio.cmd_queue.queue) &&
+      (g_studio.jack_kept || ladish_app_supervisor_get_detached_app_count(NULL) != 0))
+  {
+    /* studio that was loaded after the stop was not started or the switch failed */
+    ladish_app_supervisor_stop_detached_apps(NULL);
+    if (g_studio.jack_kept)
+    {
+      ladish_studio_release_kept_jack();
+    }
+  }
+
+  ladish_studio_autosave_run();
+  ladish_studio_jack_stats_run();
+
   if (ladish_environment_consume_change(&g_studio.env_store, ladish_environment_jack_server_started, &state))
   {
     ladish_cqueue_clear(&g_studio.cmd_queue);
@@ -473,7 +518,7 @@ void ladish_studio_run(void)
       if (g_studio.automatic)
       {
         log_info("Unloading automatic studio.");
-        ladish_command_unload_studio(NULL, &g_studio.cmd_queue);
+        ladish_command_unload_studio(NULL, &g_studio.cmd_queue, false);
 
         ladish_studio_on_event_jack_stopped();
         return;
@@ -524,6 +569,8 @@ static void ladish_studio_on_jack_server_started(void)
 static void ladish_studio_on_jack_server_stopped(void)
 {
   log_info("JACK server stop detected.");
+  g_studio.jack_kept = false;
+  g_studio.jack_kept_outdated = false;
   ladish_environment_reset(&g_studio.env_store, ladish_environment_jack_server_started);
 }
 
@@ -592,6 +639,11 @@ bool ladish_studio_init(void)
 
   g_studio.room_count = 0;
 
+  g_studio.saved_generation = 0;
+  g_studio.saved_jack_conf_generation = 0;
+  ladish_write_fragment_init(&g_studio.jgraph_fragment);
+  ladish_write_fragment_init(&g_studio.vgraph_fragment);
+
   if (!ladish_graph_create(&g_studio.jack_graph, NULL))
   {
     log_error("ladish_graph_create() failed to create jack graph object.");
@@ -650,6 +702,11 @@ void ladish_studio_uninit(void)
   ladish_graph_destroy(g_studio.studio_graph);
   ladish_graph_destroy(g_studio.jack_graph);
 
+  ladish_write_fragment_uninit(&g_studio.jgraph_fragment);
+  ladish_write_fragment_uninit(&g_studio.vgraph_fragment);
+
+  ladish_studio_autosave_uninit();
+
   ladish_recent_store_destroy(g_studios_recent_store);
 
   free(g_studios_dir);
@@ -691,7 +748,7 @@ void ladish_studio_on_child_exit(pid_t pid, int exit_status)
 
   ladish_studio_iterate_virtual_graphs(&context, ladish_studio_on_child_exit_callback);
 
-  if (!context.found)
+  if (!context.found && !ladish_app_supervisor_detached_child_exit(pid))
   {
     log_error("unknown child exit detected. pid is %llu", (unsigned long long)pid);
   }
@@ -710,14 +767,16 @@ bool ladish_studio_is_started(void)
 bool ladish_studio_compose_filename(const char * name, char ** filename_ptr_ptr, char ** backup_filename_ptr_ptr)
 {
   size_t len_dir;
+  size_t len_name;
   char * p;
   const char * src;
   char * filename_ptr;
   char * backup_filename_ptr = NULL;
 
   len_dir = strlen(g_studios_dir);
+  len_name = escaped_length(name, LADISH_ESCAPE_FLAG_ALL);
 
-  filename_ptr = malloc(len_dir + 1 + strlen(name) * 3 + 4 + 1);
+  filename_ptr = malloc(len_dir + 1 + len_name + 4 + 1);
   if (filename_ptr == NULL)
   {
     log_error("malloc failed to allocate memory for studio file path");
@@ -726,7 +785,7 @@ bool ladish_studio_compose_filename(const char * name, char ** filename_ptr_ptr,
 
   if (backup_filename_ptr_ptr != NULL)
   {
-    backup_filename_ptr = malloc(len_dir + 1 + strlen(name) * 3 + 4 + 4 + 1);
+    backup_filename_ptr = malloc(len_dir + 1 + len_name + 4 + 4 + 1);
     if (backup_filename_ptr == NULL)
     {
       log_error("malloc failed to allocate memory for studio backup file path");
@@ -952,6 +1011,39 @@ bool ladish_studio_has_rooms(void)
   return !list_empty(&g_studio.rooms);
 }
 
+/* generation of everything that is written to the studio xml, except the JACK settings */
+uint64_t ladish_studio_get_generation(void)
+{
+  uint64_t generation;
+  uint64_t subgeneration;
+  struct list_head * node_ptr;
+
+  generation = ladish_graph_get_generation(g_studio.jack_graph);
+
+  subgeneration = ladish_graph_get_generation(g_studio.studio_graph);
+  if (subgeneration > generation)
+  {
+    generation = subgeneration;
+  }
+
+  subgeneration = ladish_app_supervisor_get_generation(g_studio.app_supervisor);
+  if (subgeneration > generation)
+  {
+    generation = subgeneration;
+  }
+
+  list_for_each(node_ptr, &g_studio.rooms)
+  {
+    subgeneration = ladish_room_get_generation(ladish_room_from_list_node(node_ptr));
+    if (subgeneration > generation)
+    {
+      generation = subgeneration;
+    }
+  }
+
+  return generation;
+}
+
 static
 bool
 ladish_studio_stop_app_supervisor(
@@ -1013,6 +1105,23 @@ ladish_room_handle ladish_studio_find_room_by_uuid(const uuid_t room_uuid_ptr)
   return NULL;
 }
 
+ladish_room_handle ladish_studio_find_room_by_opath(const char * opath)
+{
+  struct list_head * node_ptr;
+  ladish_room_handle room;
+
+  list_for_each(node_ptr, &g_studio.rooms)
+  {
+    room = ladish_room_from_list_node(node_ptr);
+    if (strcmp(ladish_room_get_opath(room), opath) == 0)
+    {
+      return room;
+    }
+  }
+
+  return NULL;
+}
+
 bool ladish_studio_check_room_name(const char * room_name)
 {
   struct list_head * node_ptr;
@@ -1100,7 +1209,7 @@ static void ladish_studio_dbus_unload(struct cdbus_method_call * call_ptr)
 {
   log_info("Unload studio request");
 
-  if (ladish_command_unload_studio(call_ptr, &g_studio.cmd_queue))
+  if (ladish_command_unload_studio(call_ptr, &g_studio.cmd_queue, false))
   {
     cdbus_method_return_new_void(call_ptr);
   }
@@ -1112,7 +1221,7 @@ static void ladish_studio_dbus_stop(struct cdbus_method_call * call_ptr)
 
   g_studio.automatic = false;   /* even if it was automatic, it is not anymore because user knows about it */
 
-  if (ladish_command_stop_studio(call_ptr, &g_studio.cmd_queue))
+  if (ladish_command_stop_studio(call_ptr, &g_studio.cmd_queue, false))
   {
     cdbus_method_return_new_void(call_ptr);
   }
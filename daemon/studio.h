@@ -31,6 +31,7 @@
 #include "graph.h"
 #include "room.h"
 #include "virtualizer.h"
+#include "metadata_index.h"
 
 bool ladish_studio_init(void);
 void ladish_studio_uninit(void);
@@ -38,7 +39,7 @@ void ladish_studio_run(void);
 bool ladish_studio_is_loaded(void);
 bool ladish_studio_is_started(void);
 
-bool ladish_studios_iterate(void * call_ptr, void * context, bool (* callback)(void * call_ptr, void * context, const char * studio, uint32_t modtime));
+bool ladish_studios_iterate(void * call_ptr, void * context, bool (* callback)(void * call_ptr, void * context, const char * studio, const struct ladish_metadata * meta_ptr));
 bool ladish_studio_delete(void * call_ptr, const char * studio_name);
 
 void ladish_studio_on_child_exit(pid_t pid, int exit_status);
@@ -75,6 +76,7 @@ void ladish_studio_room_appeared(ladish_room_handle room);
 void ladish_studio_room_disappeared(ladish_room_handle room);
 
 ladish_room_handle ladish_studio_find_room_by_uuid(const uuid_t room_uuid_ptr);
+ladish_room_handle ladish_studio_find_room_by_opath(const char * opath);
 bool ladish_studio_check_room_name(const char * room_name);
 
 #endif /* #ifndef STUDIO_H__0BEDE85E_4FB3_4D74_BC08_C373A22409C0__INCLUDED */
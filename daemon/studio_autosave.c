@@ -0,0 +1,353 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the periodic studio autosave
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Autosave snapshots are written by a forked child process.
+ * The child gets a copy-on-write image of the daemon memory,
+ * so it serializes the studio as it was at fork time while
+ * the main loop continues to run and to modify the live objects.
+ * The command queue is not used, autosave does not block or delay commands.
+ *
+ * Snapshots are stored in ~/.ladish/autosave/<studio>/ and
+ * the previous ones are kept as <studio>.1 ... <studio>.N by ladish_rotate()
+ */
+
+#include "common.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "studio_internal.h"
+#include "loader.h"
+#include "escape.h"
+#include "conf.h"
+#include "../proxies/conf_proxy.h"
+#include "../common/catdup.h"
+#include "../common/dirhelpers.h"
+#include "../common/time.h"
+
+#define AUTOSAVE_DIR "/autosave/"
+#define AUTOSAVE_STUDIO_FILENAME "/studio.xml"
+#define AUTOSAVE_CHECK_INTERVAL 1000000 /* microseconds */
+
+static struct
+{
+  pid_t pid;                      /* autosave process, 0 when autosave is not in progress */
+  uint64_t next_check;            /* when to check again whether autosave is needed */
+  uint64_t last_time;             /* when last snapshot was taken */
+  uint64_t last_generation;       /* ladish_studio_get_generation() of the last snapshot */
+  uint64_t last_global_generation; /* g_generation of the last snapshot */
+  unsigned int last_jack_conf_generation;
+  char * studio_name;             /* name of the studio the last* values are for */
+} g_autosave;
+
+static bool write_file(const char * dir, const char * name, bool (* write_xml)(void * context, int fd), void * context)
+{
+  char * filename;
+  int fd;
+  bool ret;
+
+  ret = false;
+
+  filename = catdup(dir, name);
+  if (filename == NULL)
+  {
+    log_error("catdup() failed to compose autosave filename");
+    goto exit;
+  }
+
+  fd = open(filename, O_WRONLY | O_TRUNC | O_CREAT, 0600);
+  if (fd == -1)
+  {
+    log_error("open(%s) failed: %d (%s)", filename, errno, strerror(errno));
+    goto free;
+  }
+
+  if (!write_xml(context, fd))
+  {
+    goto close;
+  }
+
+  if (fsync(fd) != 0)
+  {
+    log_error("fsync(%s) failed: %d (%s)", filename, errno, strerror(errno));
+    goto close;
+  }
+
+  ret = true;
+
+close:
+  close(fd);
+free:
+  free(filename);
+exit:
+  return ret;
+}
+
+static bool write_studio_xml(void * UNUSED(context), int fd)
+{
+  return ladish_studio_write_xml(fd);
+}
+
+static bool write_room_xml(void * context, int fd)
+{
+  return ladish_room_write_project_xml((ladish_room_handle)context, fd);
+}
+
+static bool write_room(void * context, ladish_room_handle room)
+{
+  const char * name;
+  char * escaped_name;
+  char * dst;
+  bool ret;
+
+  if (ladish_room_get_project_name(room) == NULL)
+  {
+    /* rooms without project have nothing to restore except what is in the studio xml */
+    return true;
+  }
+
+  name = ladish_room_get_name(room);
+
+  escaped_name = malloc(1 + escaped_length(name, LADISH_ESCAPE_FLAG_ALL) + 4 + 1);
+  if (escaped_name == NULL)
+  {
+    log_error("malloc() failed for escaped room name");
+    return false;
+  }
+
+  dst = escaped_name;
+  *dst++ = '/';
+  escape(&name, &dst, LADISH_ESCAPE_FLAG_ALL);
+  strcpy(dst, ".xml");
+
+  ret = write_file((const char *)context, escaped_name, write_room_xml, room);
+
+  free(escaped_name);
+  return ret;
+}
+
+/* runs in the autosave child process */
+static bool autosave_snapshot(const char * dir, unsigned int backups)
+{
+  char * temp_dir;
+  bool ret;
+
+  ret = false;
+
+  temp_dir = catdup(dir, ".tmp");
+  if (temp_dir == NULL)
+  {
+    log_error("catdup() failed to compose autosave temp dir");
+    goto exit;
+  }
+
+  /* remains of interrupted autosave */
+  if (check_dir_exists(temp_dir) && !ladish_rmdir_recursive(temp_dir))
+  {
+    goto free;
+  }
+
+  if (!ensure_dir_exist(temp_dir, 0700))
+  {
+    goto free;
+  }
+
+  if (!write_file(temp_dir, AUTOSAVE_STUDIO_FILENAME, write_studio_xml, NULL))
+  {
+    goto free;
+  }
+
+  if (!ladish_studio_iterate_rooms(temp_dir, write_room))
+  {
+    goto free;
+  }
+
+  ret = ladish_rotate(temp_dir, dir, backups);
+
+free:
+  free(temp_dir);
+exit:
+  return ret;
+}
+
+static char * compose_autosave_dir(const char * studio_name)
+{
+  char * dir;
+  char * dst;
+
+  dir = malloc(strlen(g_base_dir) + strlen(AUTOSAVE_DIR) + escaped_length(studio_name, LADISH_ESCAPE_FLAG_ALL) + 1);
+  if (dir == NULL)
+  {
+    log_error("malloc() failed for autosave dir path");
+    return NULL;
+  }
+
+  strcpy(dir, g_base_dir);
+  strcat(dir, AUTOSAVE_DIR);
+  dst = dir + strlen(dir);
+  escape(&studio_name, &dst, LADISH_ESCAPE_FLAG_ALL);
+  *dst = 0;
+
+  return dir;
+}
+
+static void on_autosave_exit(void * UNUSED(context), int exit_status)
+{
+  ASSERT(g_autosave.pid != 0);
+  g_autosave.pid = 0;
+
+  if (WIFEXITED(exit_status) && WEXITSTATUS(exit_status) == 0)
+  {
+    log_info("Studio autosave complete");
+    return;
+  }
+
+  log_error("Studio autosave failed");
+
+  /* retry after the interval even if nothing changes meanwhile */
+  g_autosave.last_generation = 0;
+}
+
+static void autosave_start(unsigned int backups)
+{
+  char * dir;
+  pid_t pid;
+
+  dir = compose_autosave_dir(g_studio.name);
+  if (dir == NULL)
+  {
+    return;
+  }
+
+  log_info("Autosaving studio '%s' to '%s'", g_studio.name, dir);
+
+  pid = loader_fork_internal(NULL, on_autosave_exit);
+  if (pid == 0)
+  {
+    /* child, note that it must not touch the D-Bus connection */
+    _exit(autosave_snapshot(dir, backups) ? 0 : 1);
+  }
+
+  free(dir);
+
+  if (pid != -1)
+  {
+    g_autosave.pid = pid;
+  }
+}
+
+void ladish_studio_autosave_run(void)
+{
+  uint64_t now;
+  uint64_t generation;
+  unsigned int interval;
+  unsigned int changes;
+  unsigned int backups;
+
+  now = ladish_get_current_microseconds();
+  if (now < g_autosave.next_check)
+  {
+    return;
+  }
+
+  g_autosave.next_check = now + AUTOSAVE_CHECK_INTERVAL;
+
+  if (g_autosave.pid != 0)
+  {
+    /* previous snapshot is still being written */
+    return;
+  }
+
+  if (!ladish_studio_is_loaded() || g_studio.name == NULL || !list_empty(&g_studio.cmd_queue.queue))
+  {
+    /* nothing to autosave or studio is in the middle of a command */
+    return;
+  }
+
+  if (!conf_get_uint(LADISH_CONF_KEY_DAEMON_AUTOSAVE_INTERVAL, &interval))
+  {
+    interval = LADISH_CONF_KEY_DAEMON_AUTOSAVE_INTERVAL_DEFAULT;
+  }
+
+  if (interval == 0)
+  {
+    return;
+  }
+
+  if (!conf_get_uint(LADISH_CONF_KEY_DAEMON_AUTOSAVE_CHANGES, &changes))
+  {
+    changes = LADISH_CONF_KEY_DAEMON_AUTOSAVE_CHANGES_DEFAULT;
+  }
+
+  if (!conf_get_uint(LADISH_CONF_KEY_DAEMON_AUTOSAVE_BACKUPS, &backups) || backups == 0)
+  {
+    backups = LADISH_CONF_KEY_DAEMON_AUTOSAVE_BACKUPS_DEFAULT;
+  }
+
+  generation = ladish_studio_get_generation();
+
+  if (g_autosave.studio_name == NULL || strcmp(g_autosave.studio_name, g_studio.name) != 0)
+  {
+    /* studio loaded or renamed, start counting from its current state */
+    free(g_autosave.studio_name);
+    g_autosave.studio_name = strdup(g_studio.name);
+    g_autosave.last_time = now;
+    g_autosave.last_generation = generation;
+    g_autosave.last_global_generation = g_generation;
+    g_autosave.last_jack_conf_generation = g_studio.jack_conf_generation;
+    return;
+  }
+
+  if (generation == g_autosave.last_generation &&
+      g_studio.jack_conf_generation == g_autosave.last_jack_conf_generation)
+  {
+    /* not modified since last snapshot */
+    return;
+  }
+
+  if (now - g_autosave.last_time < (uint64_t)interval * 1000000 &&
+      (changes == 0 || g_generation - g_autosave.last_global_generation < changes))
+  {
+    return;
+  }
+
+  g_autosave.last_time = now;
+  g_autosave.last_generation = generation;
+  g_autosave.last_global_generation = g_generation;
+  g_autosave.last_jack_conf_generation = g_studio.jack_conf_generation;
+
+  autosave_start(backups);
+}
+
+void ladish_studio_autosave_uninit(void)
+{
+  free(g_autosave.studio_name);
+  g_autosave.studio_name = NULL;
+}
@@ -34,6 +34,7 @@
 #include "cmd.h"
 #include "studio.h"
 #include "recent_store.h"
+#include "save.h"
 
 #define JACK_CONF_MAX_ADDRESS_SIZE 1024
 
@@ -135,9 +136,17 @@ struct studio
   bool persisted:1;             /* Studio has on-disk representation, i.e. can be reloaded from disk */
   bool modified:1;              /* Studio needs saving */
   bool jack_conf_valid:1;       /* JACK server configuration obtained successfully */
+  bool jack_kept:1;             /* JACK server was left running by stop of the previous studio */
+  bool jack_kept_outdated:1;    /* the kept JACK server has to be restarted because settings changed */
 
   struct list_head jack_conf;   /* root of the conf tree */
   struct list_head jack_params; /* list of conf tree leaves */
+  unsigned int jack_conf_generation; /* jack_proxy_conf_generation() when the conf tree was fetched */
+
+  uint64_t saved_generation;    /* ladish_studio_get_generation() when studio was last saved, 0 if not saved */
+  unsigned int saved_jack_conf_generation; /* jack_conf_generation when studio was last saved */
+  struct ladish_write_fragment jgraph_fragment; /* studio clients of the jack graph, as written in the studio xml */
+  struct ladish_write_fragment vgraph_fragment; /* studio graph and apps, as written in the studio xml */
 
   cdbus_object_path dbus_object;
   bool announced;
@@ -191,7 +200,14 @@ extern const struct cdbus_interface_descriptor g_interface_studio;
 
 void ladish_studio_jack_conf_clear(void);
 bool ladish_studio_fetch_jack_settings(void);
+bool ladish_studio_refresh_jack_settings(void);
+void ladish_studio_release_kept_jack(void);
 bool ladish_studio_compose_filename(const char * name, char ** filename_ptr_ptr, char ** backup_filename_ptr_ptr);
+uint64_t ladish_studio_get_generation(void);
+bool ladish_studio_write_xml(int fd);
+void ladish_studio_autosave_run(void);
+void ladish_studio_autosave_uninit(void);
+void ladish_studio_jack_stats_run(void);
 bool ladish_studio_show(void);
 void ladish_studio_announce(void);
 bool ladish_studio_publish(void);
@@ -338,17 +338,22 @@ ladish_studio_jack_conf_callback(
 
 #undef context_ptr
 
-void ladish_studio_jack_conf_clear(void)
+static void ladish_studio_jack_conf_destroy(struct list_head * conf_ptr)
 {
   struct list_head * node_ptr;
 
-  INIT_LIST_HEAD(&g_studio.jack_params); /* we will destroy the leaves as part of tree destroy traversal */
-  while (!list_empty(&g_studio.jack_conf))
+  while (!list_empty(conf_ptr))
   {
-    node_ptr = g_studio.jack_conf.next;
+    node_ptr = conf_ptr->next;
     list_del(node_ptr);
     ladish_studio_jack_conf_container_destroy(list_entry(node_ptr, struct jack_conf_container, siblings));
   }
+}
+
+void ladish_studio_jack_conf_clear(void)
+{
+  INIT_LIST_HEAD(&g_studio.jack_params); /* we will destroy the leaves as part of tree destroy traversal */
+  ladish_studio_jack_conf_destroy(&g_studio.jack_conf);
 
   g_studio.jack_conf_valid = false;
 }
@@ -359,6 +364,12 @@ bool ladish_studio_fetch_jack_settings(void)
 
   ladish_studio_jack_conf_clear();
 
+  /* bulk fetch of the whole configuration; the tree walk below is then served from memory */
+  if (!jack_proxy_conf_snapshot_fetch())
+  {
+    log_error("jack_proxy_conf_snapshot_fetch() failed, reading JACK settings one by one.");
+  }
+
   context.address[0] = 0;
   context.container_ptr = &g_studio.jack_conf;
   context.parent_ptr = NULL;
@@ -369,5 +380,50 @@ bool ladish_studio_fetch_jack_settings(void)
     return false;
   }
 
+  g_studio.jack_conf_generation = jack_proxy_conf_generation();
+
+  return true;
+}
+
+/* Refetch JACK settings only if they were changed since last fetch
+ * and, unless there are none yet, only while the studio JACK server is running.
+ * When the refetch fails, the stored settings are kept.
+ * Returns false only when there are no valid settings to use. */
+bool ladish_studio_refresh_jack_settings(void)
+{
+  struct list_head old_conf;
+  struct list_head old_params;
+  bool old_valid;
+
+  if (g_studio.jack_conf_valid && g_studio.jack_conf_generation == jack_proxy_conf_generation())
+  {
+    return true;
+  }
+
+  if (g_studio.jack_conf_valid && !ladish_studio_is_started())
+  {
+    return true;
+  }
+
+  log_info("JACK settings changed since last fetch");
+
+  INIT_LIST_HEAD(&old_conf);
+  INIT_LIST_HEAD(&old_params);
+  list_splice_init(&g_studio.jack_conf, &old_conf);
+  list_splice_init(&g_studio.jack_params, &old_params);
+  old_valid = g_studio.jack_conf_valid;
+
+  if (!ladish_studio_fetch_jack_settings())
+  {
+    log_error("failed to refetch JACK settings, keeping the stored ones");
+    ladish_studio_jack_conf_clear();
+    list_splice_init(&old_conf, &g_studio.jack_conf);
+    list_splice_init(&old_params, &g_studio.jack_params);
+    g_studio.jack_conf_valid = old_valid;
+    return old_valid;
+  }
+
+  ladish_studio_jack_conf_destroy(&old_conf);
+  g_studio.jack_conf_valid = true;
   return true;
 }
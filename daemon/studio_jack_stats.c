@@ -0,0 +1,185 @@
+/* -*- Mode: C ; c-basic-offset: 2 -*- */
+/*
+ * LADI Session Handler (ladish)
+ *
+ * Copyright (C) 2011 Nedko Arnaudov <nedko@arnaudov.name>
+ *
+ **************************************************************************
+ * This file contains implementation of the JACK statistics sampler
+ **************************************************************************
+ *
+ * LADI Session Handler is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * LADI Session Handler is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with LADI Session Handler. If not, see <http://www.gnu.org/licenses/>
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * JACK statistics are sampled here once for all clients of ladishd
+ * and are broadcasted through the JackStats signal of the control object.
+ * The signal is emitted only when something changed since the previous one:
+ * new xruns, buffer size or sample rate change, or DSP load that
+ * moved more than JACK_STATS_DSP_LOAD_RESOLUTION percents.
+ *
+ * The xrun count is sent as delta. The first sample after JACK server start
+ * only sets the baseline, clients are expected to query the absolute count
+ * when they see the server started. When the xrun count of the server
+ * decreases, it was reset and the new count is sent as delta.
+ */
+
+#include "common.h"
+
+#include "studio_internal.h"
+#include "control.h"
+#include "conf.h"
+#include "perf_history.h"
+#include "../proxies/jack_proxy.h"
+#include "../proxies/conf_proxy.h"
+#include "../common/time.h"
+
+#define JACK_STATS_DSP_LOAD_RESOLUTION 0.5 /* percents */
+
+static struct
+{
+  bool valid;                   /* whether the values below are for the current JACK server session */
+  uint64_t next_sample;         /* when to sample again */
+  uint32_t xruns;               /* xrun count of the last sample */
+  uint32_t xruns_delta;         /* xruns since the last signal */
+  double dsp_load;              /* DSP load sent in the last signal */
+  double peak_dsp_load;         /* max DSP load sampled since the last signal */
+  uint32_t buffer_size;         /* buffer size sent in the last signal */
+  uint32_t sample_rate;         /* sample rate of the JACK server session */
+} g_jack_stats;
+
+static bool sample(uint32_t * xruns_ptr, double * dsp_load_ptr, uint32_t * buffer_size_ptr)
+{
+  if (!jack_proxy_get_xruns(xruns_ptr))
+  {
+    log_error("Cannot get JACK xrun count");
+    return false;
+  }
+
+  if (!jack_proxy_get_dsp_load(dsp_load_ptr))
+  {
+    log_error("Cannot get JACK DSP load");
+    return false;
+  }
+
+  if (!jack_proxy_get_buffer_size(buffer_size_ptr))
+  {
+    log_error("Cannot get JACK buffer size");
+    return false;
+  }
+
+  return true;
+}
+
+void ladish_studio_jack_stats_run(void)
+{
+  uint64_t now;
+  unsigned int interval;
+  uint32_t xruns;
+  double dsp_load;
+  uint32_t buffer_size;
+
+  now = ladish_get_current_microseconds();
+  if (now < g_jack_stats.next_sample)
+  {
+    return;
+  }
+
+  if (!conf_get_uint(LADISH_CONF_KEY_DAEMON_JACK_STATS_INTERVAL, &interval))
+  {
+    interval = LADISH_CONF_KEY_DAEMON_JACK_STATS_INTERVAL_DEFAULT;
+  }
+
+  if (interval == 0)
+  {
+    g_jack_stats.valid = false;
+    g_jack_stats.next_sample = now + 1000000; /* check again whether sampling was enabled after a second */
+    return;
+  }
+
+  g_jack_stats.next_sample = now + (uint64_t)interval * 1000;
+
+  if (!ladish_environment_get(&g_studio.env_store, ladish_environment_jack_server_started))
+  {
+    g_jack_stats.valid = false;
+    return;
+  }
+
+  if (!sample(&xruns, &dsp_load, &buffer_size))
+  {
+    g_jack_stats.valid = false;
+    return;
+  }
+
+  if (!g_jack_stats.valid)
+  {
+    if (!jack_proxy_sample_rate(&g_jack_stats.sample_rate))
+    {
+      log_error("Cannot get JACK sample rate");
+      return;
+    }
+
+    g_jack_stats.valid = true;
+    g_jack_stats.xruns = xruns;
+    g_jack_stats.xruns_delta = 0;
+    g_jack_stats.dsp_load = dsp_load;
+    g_jack_stats.peak_dsp_load = dsp_load;
+    g_jack_stats.buffer_size = buffer_size;
+    ladish_perf_history_add_sample(LADISH_PERF_EVENT_BUFFER_SIZE, buffer_size);
+    emit_jack_stats(0, dsp_load, dsp_load, buffer_size, g_jack_stats.sample_rate);
+    return;
+  }
+
+  if (xruns < g_jack_stats.xruns)
+  {
+    /* xrun count was reset */
+    g_jack_stats.xruns = 0;
+  }
+
+  if (xruns != g_jack_stats.xruns)
+  {
+    ladish_perf_history_add_sample(LADISH_PERF_EVENT_XRUNS, xruns - g_jack_stats.xruns);
+    g_jack_stats.xruns_delta += xruns - g_jack_stats.xruns;
+    g_jack_stats.xruns = xruns;
+  }
+
+  if (buffer_size != g_jack_stats.buffer_size)
+  {
+    ladish_perf_history_add_sample(LADISH_PERF_EVENT_BUFFER_SIZE, buffer_size);
+  }
+
+  if (dsp_load > g_jack_stats.peak_dsp_load)
+  {
+    g_jack_stats.peak_dsp_load = dsp_load;
+  }
+
+  if (g_jack_stats.xruns_delta == 0 &&
+      buffer_size == g_jack_stats.buffer_size &&
+      dsp_load - g_jack_stats.dsp_load < JACK_STATS_DSP_LOAD_RESOLUTION &&
+      g_jack_stats.dsp_load - dsp_load < JACK_STATS_DSP_LOAD_RESOLUTION)
+  {
+    /* nothing changed enough to be worth the signal */
+    return;
+  }
+
+  ladish_perf_history_add_sample(LADISH_PERF_EVENT_DSP_LOAD, g_jack_stats.peak_dsp_load);
+  emit_jack_stats(g_jack_stats.xruns_delta, dsp_load, g_jack_stats.peak_dsp_load, buffer_size, g_jack_stats.sample_rate);
+
+  g_jack_stats.xruns_delta = 0;
+  g_jack_stats.dsp_load = dsp_load;
+  g_jack_stats.peak_dsp_load = dsp_load;
+  g_jack_stats.buffer_size = buffer_size;
+}
@@ -29,18 +29,18 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
-#include <dirent.h>
 
 #include "studio_internal.h"
-#include "../common/catdup.h"
 #include "escape.h"
+#include "metadata_index.h"
 
 struct ladish_studios_iterate_context
 {
   void * call_ptr;
   void * context;
-  bool (* callback)(void * call_ptr, void * context, const char * studio, uint32_t modtime);
+  bool (* callback)(void * call_ptr, void * context, const char * studio, const struct ladish_metadata * meta_ptr);
   unsigned int counter;
+  bool stopped;
 };
 
 #define ctx_ptr ((struct ladish_studios_iterate_context *)callback_context)
@@ -49,6 +49,7 @@ bool recent_studio_callback(void * callback_context, const char * item)
 {
   char * path;
   struct stat st;
+  const struct ladish_metadata * meta_ptr;
 
   if (!ladish_studio_compose_filename(item, &path, NULL))
   {
@@ -56,23 +57,34 @@ bool recent_studio_callback(void * callback_context, const char * item)
     goto exit;
   }
 
-  if (stat(path, &st) != 0)
+  meta_ptr = ladish_metadata_index_lookup(path);
+  if (meta_ptr == NULL)
   {
-    if (errno != ENOENT)
+    if (stat(path, &st) != 0)
     {
-      log_error("failed to stat '%s': %d (%s)", path, errno, strerror(errno));
+      if (errno != ENOENT)
+      {
+        log_error("failed to stat '%s': %d (%s)", path, errno, strerror(errno));
+      }
+
+      goto free;
     }
 
-    goto free;
-  }
+    if (!S_ISREG(st.st_mode))
+    {
+      log_info("Ignoring recent studio that is not regular file. Mode is %07o", st.st_mode);
+      goto free;
+    }
 
-  if (!S_ISREG(st.st_mode))
-  {
-    log_info("Ignoring recent studio that is not regular file. Mode is %07o", st.st_mode);
-    goto free;
+    /* studio that was not saved by this ladishd instance */
+    meta_ptr = ladish_metadata_index_update(path, item, LADISH_METADATA_COUNT_UNKNOWN, LADISH_METADATA_COUNT_UNKNOWN, NULL);
+    if (meta_ptr == NULL)
+    {
+      goto free;
+    }
   }
 
-  ctx_ptr->callback(ctx_ptr->call_ptr, ctx_ptr->context, item, st.st_mtime);
+  ctx_ptr->callback(ctx_ptr->call_ptr, ctx_ptr->context, item, meta_ptr);
   ctx_ptr->counter++;
 
 free:
@@ -81,86 +93,69 @@ exit:
   return true;
 }
 
+static bool studio_dir_callback(void * callback_context, const char * UNUSED(path), const struct ladish_metadata * meta_ptr)
+{
+  if (ladish_recent_store_check_known(g_studios_recent_store, meta_ptr->name))
+  {
+    return true;
+  }
+
+  if (!ctx_ptr->callback(ctx_ptr->call_ptr, ctx_ptr->context, meta_ptr->name, meta_ptr))
+  {
+    ctx_ptr->stopped = true;
+    return false;
+  }
+
+  return true;
+}
+
 #undef ctx_ptr
 
-bool ladish_studios_iterate(void * call_ptr, void * context, bool (* callback)(void * call_ptr, void * context, const char * studio, uint32_t modtime))
+static char * studio_name_from_filename(const char * filename, size_t len)
 {
-  DIR * dir;
-  struct dirent * dentry;
-  size_t len;
-  struct stat st;
-  char * path;
   char * name;
+
+  name = malloc(len + 1);
+  if (name == NULL)
+  {
+    log_error("malloc() failed.");
+    return NULL;
+  }
+
+  name[unescape(filename, len, name)] = 0;
+  return name;
+}
+
+bool ladish_studios_iterate(void * call_ptr, void * context, bool (* callback)(void * call_ptr, void * context, const char * studio, const struct ladish_metadata * meta_ptr))
+{
   struct ladish_studios_iterate_context ctx;
 
   ctx.call_ptr = call_ptr;
   ctx.context = context;
   ctx.callback = callback;
   ctx.counter = 0;
+  ctx.stopped = false;
 
   ladish_recent_store_iterate_items(g_studios_recent_store, &ctx, recent_studio_callback);
 
   /* TODO: smarter error handling based on ctx.counter (dbus error vs just logged error) */
 
-  dir = opendir(g_studios_dir);
-  if (dir == NULL)
-  {
-    cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Cannot open directory '%s': %d (%s)", g_studios_dir, errno, strerror(errno));
-    return false;
-  }
-
-  while ((dentry = readdir(dir)) != NULL)
+  /* the studios dir listing is served from the metadata index and
+     is rescanned only when the directory itself has changed */
+  if (!ladish_metadata_index_iterate_dir(g_studios_dir, ".xml", studio_name_from_filename, &ctx, studio_dir_callback))
   {
-    len = strlen(dentry->d_name);
-    if (len <= 4 || strcmp(dentry->d_name + (len - 4), ".xml") != 0)
-      continue;
+    ladish_metadata_index_flush();
 
-    path = catdup(g_studios_dir, dentry->d_name);
-    if (path == NULL)
+    if (!ctx.stopped)
     {
-      cdbus_error(call_ptr, DBUS_ERROR_FAILED, "catdup() failed");
-      return false;
+      cdbus_error(call_ptr, DBUS_ERROR_FAILED, "Cannot list directory '%s'", g_studios_dir);
     }
 
-    if (stat(path, &st) != 0)
-    {
-      cdbus_error(call_ptr, DBUS_ERROR_FAILED, "failed to stat '%s': %d (%s)", path, errno, strerror(errno));
-      free(path);
-      return false;
-    }
-
-    free(path);
-
-    if (!S_ISREG(st.st_mode))
-    {
-      //log_info("Ignoring direntry that is not regular file. Mode is %07o", st.st_mode);
-      continue;
-    }
-
-    name = malloc(len - 4 + 1);
-    if (name == NULL)
-    {
-      log_error("malloc() failed.");
-      closedir(dir);
-      return false;
-    }
-
-    name[unescape(dentry->d_name, len - 4, name)] = 0;
-    //log_info("name = '%s'", name);
-
-    if (!ladish_recent_store_check_known(g_studios_recent_store, name))
-    {
-      if (!callback(call_ptr, context, name, st.st_mtime))
-      {
-        free(name);
-        closedir(dir);
-        return false;
-      }
-    }
-
-    free(name);
+    return false;
   }
 
-  closedir(dir);
+  /* index entries created for studios not saved by this ladishd instance */
+  ladish_metadata_index_flush();
+
   return true;
 }
@@ -34,6 +34,7 @@
 #include "../common/catdup.h"
 #include "room.h"
 #include "studio.h"
+#include "perf_history.h"
 #include "../alsapid/alsapid.h"
 
 struct virtualizer
@@ -42,6 +43,7 @@ struct virtualizer
   ladish_graph_handle jack_graph;
   uint64_t system_client_id;
   unsigned int our_clients_count;
+  bool prune_connections;       /* disconnect appearing connections that are not in the vgraph */
 };
 
 /* 47c1cd18-7b21-4389-bec4-6e0658e1d6b1 */
@@ -266,6 +268,34 @@ lookup_port(
   return true;
 }
 
+static
+void
+add_connection_perf_event(
+  ladish_graph_handle jack_graph,
+  uint32_t type,
+  ladish_port_handle port1,
+  ladish_port_handle port2)
+{
+  ladish_client_handle client1;
+  ladish_client_handle client2;
+
+  client1 = ladish_graph_get_port_client(jack_graph, port1);
+  client2 = ladish_graph_get_port_client(jack_graph, port2);
+  if (client1 == NULL || client2 == NULL)
+  {
+    return;
+  }
+
+  ladish_perf_history_add(
+    type,
+    0,
+    "%s:%s -> %s:%s",
+    ladish_graph_get_client_name(jack_graph, client1),
+    ladish_graph_get_port_name(jack_graph, port1),
+    ladish_graph_get_client_name(jack_graph, client2),
+    ladish_graph_get_port_name(jack_graph, port2));
+}
+
 #define virtualizer_ptr ((struct virtualizer *)context)
 
 static void clear(void * UNUSED(context))
@@ -1051,37 +1081,80 @@ port_renamed(
   }
 }
 
-static bool ports_connect_request(void * context, ladish_graph_handle graph_handle, ladish_port_handle port1, ladish_port_handle port2)
+static
+void
+get_connect_port_ids(
+  ladish_graph_handle graph_handle,
+  ladish_port_handle port1,
+  ladish_port_handle port2,
+  uint64_t * port1_id_ptr,
+  uint64_t * port2_id_ptr)
 {
-  uint64_t port1_id;
-  uint64_t port2_id;
-
   ASSERT(ladish_graph_get_opath(graph_handle)); /* studio or room virtual graph */
-  log_info("virtualizer: ports connect request");
 
   if (graph_handle == g_studio.studio_graph)
   {
-    port1_id = ladish_port_get_jack_id(port1);
-    port2_id = ladish_port_get_jack_id(port2);
+    *port1_id_ptr = ladish_port_get_jack_id(port1);
+    *port2_id_ptr = ladish_port_get_jack_id(port2);
   }
   else
   {
-    port1_id = ladish_port_get_jack_id_room(port1);
-    port2_id = ladish_port_get_jack_id_room(port2);
+    *port1_id_ptr = ladish_port_get_jack_id_room(port1);
+    *port2_id_ptr = ladish_port_get_jack_id_room(port2);
   }
+}
+
+static bool ports_connect_request(void * context, ladish_graph_handle graph_handle, ladish_port_handle port1, ladish_port_handle port2)
+{
+  uint64_t port1_id;
+  uint64_t port2_id;
+
+  log_info("virtualizer: ports connect request");
+
+  get_connect_port_ids(graph_handle, port1, port2, &port1_id, &port2_id);
 
   return graph_proxy_connect_ports(virtualizer_ptr->jack_graph_proxy, port1_id, port2_id);
 }
 
-static bool ports_disconnect_request(void * context, ladish_graph_handle graph_handle, uint64_t connection_id)
+static void async_request_complete(void * context, uint64_t port1_id, uint64_t port2_id, bool success)
 {
   ladish_port_handle port1;
   ladish_port_handle port2;
+  ladish_graph_handle vgraph1;
+  ladish_graph_handle vgraph2;
+
+  if (success)
+  {
+    /* the connection is shown or hidden when jackdbus reports the change */
+    return;
+  }
+
+  /* ports could disappear meanwhile */
+  if (!lookup_port(virtualizer_ptr, port1_id, &port1, &vgraph1) ||
+      !lookup_port(virtualizer_ptr, port2_id, &port2, &vgraph2) ||
+      vgraph1 != vgraph2)
+  {
+    return;
+  }
+
+  /* allow the request to be retried */
+  ladish_graph_cancel_connection_change(vgraph1, port1, port2);
+}
+
+static bool ports_connect_request_async(void * context, ladish_graph_handle graph_handle, ladish_port_handle port1, ladish_port_handle port2)
+{
   uint64_t port1_id;
   uint64_t port2_id;
 
-  ASSERT(ladish_graph_get_opath(graph_handle)); /* studio or room virtual graph */
-  log_info("virtualizer: ports disconnect request");
+  get_connect_port_ids(graph_handle, port1, port2, &port1_id, &port2_id);
+
+  return graph_proxy_connect_ports_async(virtualizer_ptr->jack_graph_proxy, port1_id, port2_id, virtualizer_ptr, async_request_complete);
+}
+
+static bool get_disconnect_port_ids(ladish_graph_handle graph_handle, uint64_t connection_id, uint64_t * port1_id_ptr, uint64_t * port2_id_ptr)
+{
+  ladish_port_handle port1;
+  ladish_port_handle port2;
 
   if (!ladish_graph_get_connection_ports(graph_handle, connection_id, &port1, &port2))
   {
@@ -1090,18 +1163,41 @@ static bool ports_disconnect_request(void * context, ladish_graph_handle graph_h
     return false;
   }
 
-  if (graph_handle == g_studio.studio_graph)
+  get_connect_port_ids(graph_handle, port1, port2, port1_id_ptr, port2_id_ptr);
+  return true;
+}
+
+static bool ports_disconnect_request(void * context, ladish_graph_handle graph_handle, uint64_t connection_id)
+{
+  uint64_t port1_id;
+  uint64_t port2_id;
+
+  log_info("virtualizer: ports disconnect request");
+
+  if (!get_disconnect_port_ids(graph_handle, connection_id, &port1_id, &port2_id))
   {
-    port1_id = ladish_port_get_jack_id(port1);
-    port2_id = ladish_port_get_jack_id(port2);
+    return false;
   }
-  else
+
+  return graph_proxy_disconnect_ports(virtualizer_ptr->jack_graph_proxy, port1_id, port2_id);
+}
+
+static bool ports_disconnect_request_async(void * context, ladish_graph_handle graph_handle, uint64_t connection_id)
+{
+  uint64_t port1_id;
+  uint64_t port2_id;
+
+  if (!get_disconnect_port_ids(graph_handle, connection_id, &port1_id, &port2_id))
   {
-    port1_id = ladish_port_get_jack_id_room(port1);
-    port2_id = ladish_port_get_jack_id_room(port2);
+    return false;
   }
 
-  return graph_proxy_disconnect_ports(virtualizer_ptr->jack_graph_proxy, port1_id, port2_id);
+  return graph_proxy_disconnect_ports_async(virtualizer_ptr->jack_graph_proxy, port1_id, port2_id, virtualizer_ptr, async_request_complete);
+}
+
+static void ports_requests_commit(void * context, ladish_graph_handle UNUSED(graph_handle))
+{
+  graph_proxy_commit_requests(virtualizer_ptr->jack_graph_proxy);
 }
 
 static void ports_connected(void * context, uint64_t client1_id, uint64_t port1_id, uint64_t client2_id, uint64_t port2_id)
@@ -1132,6 +1228,7 @@ static void ports_connected(void * context, uint64_t client1_id, uint64_t port1_
   }
 
   ladish_graph_add_connection(virtualizer_ptr->jack_graph, port1, port2, false);
+  add_connection_perf_event(virtualizer_ptr->jack_graph, LADISH_PERF_EVENT_PORTS_CONNECTED, port1, port2);
 
   if (ladish_graph_find_connection(vgraph1, port1, port2, &connection_id))
   {
@@ -1142,6 +1239,13 @@ static void ports_connected(void * context, uint64_t client1_id, uint64_t port1_
   {
     log_info("creating new virtual connection");
     ladish_graph_add_connection(vgraph1, port1, port2, false);
+
+    if (virtualizer_ptr->prune_connections)
+    {
+      /* the connection is removed from the graphs when the disconnect is reported */
+      log_info("disconnecting ports that are not connected in %s", ladish_graph_get_description(vgraph1));
+      graph_proxy_disconnect_ports(virtualizer_ptr->jack_graph_proxy, port1_id, port2_id);
+    }
   }
 }
 
@@ -1172,6 +1276,8 @@ static void ports_disconnected(void * context, uint64_t client1_id, uint64_t por
     return;
   }
 
+  add_connection_perf_event(virtualizer_ptr->jack_graph, LADISH_PERF_EVENT_PORTS_DISCONNECTED, port1, port2);
+
   if (ladish_graph_find_connection(virtualizer_ptr->jack_graph, port1, port2, &connection_id))
   {
     ladish_graph_remove_connection(virtualizer_ptr->jack_graph, connection_id, true);
@@ -1212,6 +1318,7 @@ ladish_virtualizer_create(
   virtualizer_ptr->jack_graph = jack_graph;
   virtualizer_ptr->system_client_id = 0;
   virtualizer_ptr->our_clients_count = 0;
+  virtualizer_ptr->prune_connections = false;
 
   if (!graph_proxy_attach(
         jack_graph_proxy,
@@ -1242,6 +1349,7 @@ ladish_virtualizer_set_graph_connection_handlers(
   ladish_graph_handle graph)
 {
   ladish_graph_set_connection_handlers(graph, virtualizer_ptr, ports_connect_request, ports_disconnect_request);
+  ladish_graph_set_async_connection_handlers(graph, ports_connect_request_async, ports_disconnect_request_async, ports_requests_commit);
 }
 
 unsigned int
@@ -1251,6 +1359,123 @@ ladish_virtualizer_get_our_clients_count(
   return virtualizer_ptr->our_clients_count;
 }
 
+void
+ladish_virtualizer_set_prune_connections(
+  ladish_virtualizer_handle handle,
+  bool prune)
+{
+  virtualizer_ptr->prune_connections = prune;
+}
+
+struct app_client_find_context
+{
+  uuid_t app_uuid;
+  uint64_t jack_id;
+};
+
+#define find_context_ptr ((struct app_client_find_context *)context)
+
+static
+bool
+find_app_client(
+  void * context,
+  ladish_graph_handle UNUSED(graph_handle),
+  bool UNUSED(hidden),
+  ladish_client_handle client_handle,
+  const char * UNUSED(client_name),
+  void ** UNUSED(client_iteration_context_ptr_ptr))
+{
+  uuid_t app_uuid;
+
+  if (!ladish_client_get_app(client_handle, app_uuid) ||
+      uuid_compare(app_uuid, find_context_ptr->app_uuid) != 0)
+  {
+    return true;
+  }
+
+  find_context_ptr->jack_id = ladish_client_get_jack_id(client_handle);
+  return find_context_ptr->jack_id == 0; /* stop iteration when a client that exists in JACK is found */
+}
+
+#undef find_context_ptr
+
+void
+ladish_virtualizer_forget_app(
+  ladish_virtualizer_handle handle,
+  const uuid_t app_uuid,
+  const char * app_name)
+{
+  struct app_client_find_context ctx;
+
+  log_info("forgetting JACK clients of app '%s'", app_name);
+
+  uuid_copy(ctx.app_uuid, app_uuid);
+
+  /* clients are removed or hidden, so iteration is restarted after each one */
+  for (;;)
+  {
+    ctx.jack_id = 0;
+    ladish_graph_iterate_nodes(virtualizer_ptr->jack_graph, &ctx, find_app_client, NULL, NULL);
+    if (ctx.jack_id == 0)
+    {
+      break;
+    }
+
+    client_disappeared(virtualizer_ptr, ctx.jack_id);
+  }
+
+  ladish_virtualizer_remove_app(virtualizer_ptr->jack_graph, app_uuid, app_name);
+}
+
+struct replay_context
+{
+  struct virtualizer * virtualizer;
+  ladish_graph_handle vgraph;
+};
+
+#define replay_context_ptr ((struct replay_context *)context)
+
+static bool replay_filter(void * context, uint64_t client_id)
+{
+  pid_t pid;
+  ladish_graph_handle vgraph;
+
+  if (ladish_graph_find_client_by_jack_id(replay_context_ptr->virtualizer->jack_graph, client_id) != NULL)
+  {
+    /* already known */
+    return false;
+  }
+
+  if (!graph_proxy_get_client_pid(replay_context_ptr->virtualizer->jack_graph_proxy, client_id, &pid) || pid == 0)
+  {
+    return false;
+  }
+
+  return ladish_find_app_by_pid(pid, &vgraph) != NULL && vgraph == replay_context_ptr->vgraph;
+}
+
+#undef replay_context_ptr
+
+void
+ladish_virtualizer_replay_app_clients(
+  ladish_virtualizer_handle handle,
+  ladish_graph_handle vgraph)
+{
+  struct replay_context ctx;
+  bool prune;
+
+  ctx.virtualizer = virtualizer_ptr;
+  ctx.vgraph = vgraph;
+
+  /* connections of the reused apps that are not in the vgraph are disconnected */
+  prune = virtualizer_ptr->prune_connections;
+  virtualizer_ptr->prune_connections = true;
+
+  graph_proxy_replay_clients(virtualizer_ptr->jack_graph_proxy, &ctx, replay_filter);
+
+  virtualizer_ptr->prune_connections = prune;
+}
+
 static bool app_has_a2j_ports(ladish_graph_handle jack_graph, const uuid_t app_uuid)
 {
   ladish_client_handle a2jclient;
@@ -49,6 +49,28 @@ unsigned int
 ladish_virtualizer_get_our_clients_count(
   ladish_virtualizer_handle handle);
 
+/* When enabled, JACK connections that appear and have no match in the vgraph are disconnected.
+ * Used while JACK server that was kept running from previous studio is attached. */
+void
+ladish_virtualizer_set_prune_connections(
+  ladish_virtualizer_handle handle,
+  bool prune);
+
+/* Make the virtualizer act as if the JACK clients of a running app disappeared
+ * and remove the app from the graphs. Used before the app is detached from its supervisor. */
+void
+ladish_virtualizer_forget_app(
+  ladish_virtualizer_handle handle,
+  const uuid_t app_uuid,
+  const char * app_name);
+
+/* Replay JACK clients of the running apps of a vgraph that are not known to the virtualizer.
+ * JACK connections of these clients that are not in the vgraph are disconnected. */
+void
+ladish_virtualizer_replay_app_clients(
+  ladish_virtualizer_handle handle,
+  ladish_graph_handle vgraph);
+
 bool
 ladish_virtualizer_is_hidden_app(
   ladish_graph_handle jack_graph,
@@ -46,6 +46,7 @@
 #define IFACE_GRAPH_DICT         DBUS_NAME_BASE ".GraphDict"
 #define IFACE_GRAPH_MANAGER      DBUS_NAME_BASE ".GraphManager"
 #define IFACE_RECENT_ITEMS       DBUS_NAME_BASE ".RecentItems"
+#define IFACE_STATS              DBUS_NAME_BASE ".Stats"
 #define LASH_SERVER_OBJECT_PATH  DBUS_BASE_PATH "/LashServer"
 #define IFACE_LASH_SERVER        DBUS_NAME_BASE ".LashServer"
 #define IFACE_LASH_CLIENT        DBUS_NAME_BASE ".LashClient"
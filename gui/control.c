@@ -30,6 +30,7 @@
 #include "../proxies/studio_proxy.h"
 #include "world_tree.h"
 #include "ask_dialog.h"
+#include "jack.h"
 
 static guint g_ladishd_poll_source_tag;
 
@@ -55,6 +56,8 @@ void control_proxy_on_daemon_disappeared(bool clean_exit)
 {
   log_info("ladishd disappeared");
 
+  set_jack_stats_pushed(false);
+
   if (!clean_exit)
   {
     error_message_box("ladish daemon crashed");
@@ -127,6 +130,20 @@ void control_proxy_on_studio_disappeared(void)
   destroy_studio_view();
 }
 
+void
+control_proxy_on_jack_stats(
+  uint32_t xruns_delta,
+  double dsp_load,
+  double peak_dsp_load,
+  uint32_t buffer_size,
+  uint32_t sample_rate)
+{
+  /* ladishd does not sample when jack_stats_interval is 0,
+     so stop polling only once the statistics actually arrive */
+  set_jack_stats_pushed(true);
+  jack_stats_changed(xruns_delta, dsp_load, peak_dsp_load, buffer_size, sample_rate);
+}
+
 void menu_request_ladishd_exit(void)
 {
   log_info("ladishd exit request");
@@ -44,6 +44,12 @@ using std::vector;
 
 namespace FlowCanvas {
 
+/** Zoom level below which text is not drawn and modules are simplified */
+static const double LOD_ZOOM_THRESHOLD = 0.5;
+
+/** Extra border (in pixels) around the window that is treated as visible */
+static const double VIEW_MARGIN = 64.0;
+
 sigc::signal<void, Gnome::Canvas::Item*> Canvas::signal_item_entered;
 sigc::signal<void, Gnome::Canvas::Item*> Canvas::signal_item_left;
 
@@ -54,10 +60,18 @@ Canvas::Canvas(double width, double height)
 	, _zoom(1.0)
 	, _width(width)
 	, _height(height)
+	, _view_x1(0.0)
+	, _view_y1(0.0)
+	, _view_x2(0.0)
+	, _view_y2(0.0)
+	, _view_generation(1)
 	, _drag_state(NOT_DRAGGING)
 	, _direction(HORIZONTAL)
 	, _remove_objects(true)
 	, _locked(false)
+	, _detailed(true)
+	, _view_valid(false)
+	, _visible_update_queued(false)
 {
 	set_scroll_region(0.0, 0.0, width, height);
 	set_center_scroll_region(true);
@@ -80,6 +94,13 @@ Canvas::Canvas(double width, double height)
 
 	Glib::signal_timeout().connect(
 		sigc::mem_fun(this, &Canvas::animate_selected), 300);
+
+	// Track the visible region so offscreen items can be updated lazily
+	signal_size_allocate().connect(
+		sigc::hide(sigc::mem_fun(this, &Canvas::queue_visible_update)));
+	signal_set_scroll_adjustments().connect(
+		sigc::mem_fun(this, &Canvas::on_scroll_adjustments_set));
+	on_scroll_adjustments_set(get_hadjustment(), get_vadjustment());
 }
 
 
@@ -110,13 +131,188 @@ Canvas::set_zoom(double pix_per_unit)
 		return;
 
 	_zoom = pix_per_unit;
+	_detailed = (_zoom >= LOD_ZOOM_THRESHOLD);
+	_view_generation++;
 	set_pixels_per_unit(_zoom);
 
-	for (ItemList::iterator m = _items.begin(); m != _items.end(); ++m)
-		(*m)->zoom(_zoom);
+	// Only items in view are updated now, the rest when scrolled into view
+	update_visible_items();
+}
+
+
+void
+Canvas::on_scroll_adjustments_set(Gtk::Adjustment* hadjustment, Gtk::Adjustment* vadjustment)
+{
+	_hadjustment_connection.disconnect();
+	_vadjustment_connection.disconnect();
+
+	if (hadjustment)
+		_hadjustment_connection = hadjustment->signal_value_changed().connect(
+			sigc::mem_fun(this, &Canvas::queue_visible_update));
+
+	if (vadjustment)
+		_vadjustment_connection = vadjustment->signal_value_changed().connect(
+			sigc::mem_fun(this, &Canvas::queue_visible_update));
+
+	queue_visible_update();
+}
+
+
+void
+Canvas::queue_visible_update()
+{
+	if (_visible_update_queued)
+		return;
+
+	_visible_update_queued = true;
+	Glib::signal_idle().connect(sigc::mem_fun(this, &Canvas::visible_update_idle));
+}
+
+
+bool
+Canvas::visible_update_idle()
+{
+	update_visible_items();
+	return false;
+}
+
+
+/** Recalculate the visible region (in world units) from the scroll offsets
+ * and window size.  Until the canvas is realized everything is visible.
+ */
+void
+Canvas::update_visible_region()
+{
+	Glib::RefPtr<Gdk::Window> win = get_window();
+	if (!win) {
+		_view_valid = false;
+		return;
+	}
+
+	int win_width, win_height;
+	int scroll_x, scroll_y;
+	win->get_size(win_width, win_height);
+	get_scroll_offsets(scroll_x, scroll_y);
+
+	c2w(scroll_x, scroll_y, _view_x1, _view_y1);
+	c2w(scroll_x + win_width, scroll_y + win_height, _view_x2, _view_y2);
+
+	const double margin = VIEW_MARGIN / _zoom;
+	_view_x1 -= margin;
+	_view_y1 -= margin;
+	_view_x2 += margin;
+	_view_y2 += margin;
+
+	_view_valid = true;
+}
+
+
+/** Return true if the box @a x1, @a y1, @a x2, @a y2 (world units) intersects
+ * the visible region of the canvas.
+ */
+bool
+Canvas::region_is_visible(double x1, double y1, double x2, double y2) const
+{
+	if (!_view_valid)
+		return true;
+
+	return (x1 < _view_x2 && x2 > _view_x1 && y1 < _view_y2 && y2 > _view_y1);
+}
+
+
+/** Bring connections of @a connectable up to date with the zoom level
+ * and rebuild paths of those that were moved while offscreen.
+ */
+void
+Canvas::update_visible_connections(Connectable& connectable)
+{
+	Connectable::Connections& connections = connectable.connections();
+	for (Connectable::Connections::iterator c = connections.begin(); c != connections.end(); ++c) {
+		const boost::shared_ptr<Connection> connection = c->lock();
+		if (!connection)
+			continue;
+
+		if (connection->_location_dirty) {
+			connection->update_location();
+			if (connection->_location_dirty)
+				continue;
+		}
+
+		if (connection->_view_generation == _view_generation)
+			continue;
+
+		connection->zoom(_zoom);
+		connection->_view_generation = _view_generation;
+	}
+}
+
+
+/** Bring items in the visible region up to date with the zoom level
+ * and level of detail.  Connections are updated when at least one of
+ * their endpoints is in a visible item.  Hidden connections are kept in
+ * a list of their own and rechecked on each update, so a connection
+ * between two offscreen items is shown when its path crosses the view.
+ */
+void
+Canvas::update_visible_items()
+{
+	_visible_update_queued = false;
+	update_visible_region();
+
+	for (ItemList::iterator i = _items.begin(); i != _items.end(); ++i) {
+		const boost::shared_ptr<Item> item = *i;
+
+		if (_view_valid && !item->intersects(_view_x1, _view_y1, _view_x2, _view_y2))
+			continue;
+
+		const boost::shared_ptr<Module> module = boost::dynamic_pointer_cast<Module>(item);
+		if (module) {
+			for (PortVector::iterator p = module->ports().begin(); p != module->ports().end(); ++p)
+				update_visible_connections(**p);
+		} else {
+			const boost::shared_ptr<Connectable> connectable = boost::dynamic_pointer_cast<Connectable>(item);
+			if (connectable)
+				update_visible_connections(*connectable);
+		}
 
-	for (list<boost::shared_ptr<Connection> >::iterator c = _connections.begin(); c != _connections.end(); ++c)
-		(*c)->zoom(_zoom);
+		if (!_detailed) {
+			// Text is hidden, so there is no point in resizing fonts yet
+			if (item->detailed())
+				item->set_detailed(false);
+			continue;
+		}
+
+		if (item->_view_generation == _view_generation)
+			continue;
+
+		if (!item->detailed())
+			item->set_detailed(true);
+		item->zoom(_zoom);
+		item->_view_generation = _view_generation;
+	}
+
+	std::list<Connection*> offscreen;
+	offscreen.swap(_offscreen_connections);
+	for (std::list<Connection*>::iterator c = offscreen.begin(); c != offscreen.end(); ++c) {
+		Connection* const connection = *c;
+
+		if (connection->_location_dirty)
+			connection->update_location();
+
+		if (connection->_location_dirty) {
+			_offscreen_connections.push_back(connection);
+			continue;
+		}
+
+		// Shown, either now or when one of its items was moved
+		connection->_offscreen_listed = false;
+
+		if (connection->_view_generation == _view_generation)
+			continue;
+
+		connection->zoom(_zoom);
+		connection->_view_generation = _view_generation;
+	}
 }
 
 
@@ -419,8 +615,11 @@ Canvas::set_default_placement(boost::shared_ptr<Module> m)
 void
 Canvas::add_item(boost::shared_ptr<Item> m)
 {
-	if (m)
+	if (m) {
+		// Items are constructed at the current zoom level
+		m->_view_generation = _view_generation;
 		_items.push_back(m);
+	}
 }
 
 
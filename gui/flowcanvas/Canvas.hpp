@@ -101,6 +101,12 @@ public:
 	void   set_zoom(double pix_per_unit);
 	void   zoom_full();
 
+	/** Whether items should be drawn with full detail at the current zoom */
+	bool detailed() const { return _detailed; }
+
+	bool region_is_visible(double x1, double y1, double x2, double y2) const;
+	void update_visible_items();
+
 	void render_to_dot(const std::string& filename);
 	virtual void arrange(bool use_length_hints=false, bool center=true);
 
@@ -148,6 +154,7 @@ protected:
 
 private:
 	friend class Module;
+	friend class Connection;
 	bool port_event(GdkEvent* event, boost::weak_ptr<Port> port);
 
 	GVNodes layout_dot(bool use_length_hints, const std::string& filename);
@@ -176,6 +183,14 @@ private:
 	void on_parent_changed(Gtk::Widget* old_parent);
 	sigc::connection _parent_event_connection;
 
+	void update_visible_region();
+	void update_visible_connections(Connectable& connectable);
+	void queue_visible_update();
+	bool visible_update_idle();
+	void on_scroll_adjustments_set(Gtk::Adjustment* hadjustment, Gtk::Adjustment* vadjustment);
+	sigc::connection _hadjustment_connection;
+	sigc::connection _vadjustment_connection;
+
 	typedef std::list< boost::shared_ptr<Port> > SelectedPorts;
 
 	SelectedPorts           _selected_ports; ///< Selected ports (hilited red)
@@ -190,6 +205,14 @@ private:
 	double _width;
 	double _height;
 
+	double   _view_x1; ///< Visible region (world units), valid if _view_valid
+	double   _view_y1;
+	double   _view_x2;
+	double   _view_y2;
+	unsigned _view_generation; ///< Incremented on every zoom change
+
+	std::list<Connection*> _offscreen_connections; ///< Hidden connections, unlisted when destroyed
+
 	enum DragState { NOT_DRAGGING, CONNECTION, SCROLL, SELECT };
 	DragState      _drag_state;
 
@@ -197,6 +220,9 @@ private:
 
 	bool _remove_objects :1; // flag to avoid removing objects from destructors when unnecessary
 	bool _locked         :1;
+	bool _detailed       :1; // zoom is above the level of detail threshold
+	bool _view_valid     :1; // visible region is known (canvas is realized)
+	bool _visible_update_queued :1;
 };
 
 
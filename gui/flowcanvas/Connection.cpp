@@ -44,8 +44,11 @@ Connection::Connection(boost::shared_ptr<Canvas>      canvas,
 	, _handle(NULL)
 	, _color(color)
 	, _handle_style(HANDLE_NONE)
+	, _view_generation(0)
 	, _selected(false)
 	, _show_arrowhead(show_arrowhead)
+	, _location_dirty(false)
+	, _offscreen_listed(false)
 {
 	_bpath.property_width_units() = 2.0;
 	set_color(color);
@@ -57,6 +60,12 @@ Connection::Connection(boost::shared_ptr<Canvas>      canvas,
 
 Connection::~Connection()
 {
+	if (_offscreen_listed) {
+		boost::shared_ptr<Canvas> canvas = _canvas.lock();
+		if (canvas)
+			canvas->_offscreen_connections.remove(this);
+	}
+
 	gnome_canvas_path_def_unref(_path);
 }
 
@@ -79,6 +88,9 @@ Connection::set_color(uint32_t color)
 
 
 /** Updates the path of the connection to match it's ports if they've moved.
+ *
+ * Connections that are entirely outside of the visible canvas region are
+ * hidden and their path is rebuilt later, when they are scrolled into view.
  */
 void
 Connection::update_location()
@@ -100,6 +112,32 @@ Connection::update_location()
 	const double dst_x = dst_point.get_x();
 	const double dst_y = dst_point.get_y();
 
+	boost::shared_ptr<Canvas> canvas = _canvas.lock();
+	if (canvas) {
+		// Bezier control points stick out by a third of the span at most
+		const double pad_x = fabs(dst_x - src_x) / 3.0 + 12.0;
+		const double pad_y = fabs(dst_y - src_y) / 3.0 + 12.0;
+
+		if (!canvas->region_is_visible(
+				std::min(src_x, dst_x) - pad_x, std::min(src_y, dst_y) - pad_y,
+				std::max(src_x, dst_x) + pad_x, std::max(src_y, dst_y) + pad_y)) {
+			if (!_location_dirty) {
+				_location_dirty = true;
+				hide();
+				if (!_offscreen_listed) {
+					_offscreen_listed = true;
+					canvas->_offscreen_connections.push_back(this);
+				}
+			}
+			return;
+		}
+
+		if (_location_dirty) {
+			_location_dirty = false;
+			show();
+		}
+	}
+
 	if (straight) {
 
 		gnome_canvas_path_def_reset(_path);
@@ -103,9 +103,12 @@ protected:
 
 	uint32_t    _color;
 	HandleStyle _handle_style;
+	unsigned    _view_generation; ///< Canvas view generation zoom was last applied for
 
 	bool _selected       :1;
 	bool _show_arrowhead :1;
+	bool _location_dirty :1; ///< Path is stale because the connection is off screen
+	bool _offscreen_listed :1; ///< In the offscreen connection list of the canvas
 };
 
 typedef std::list<boost::shared_ptr<Connection> > ConnectionList;
@@ -43,7 +43,9 @@ Item::Item(boost::shared_ptr<Canvas> canvas,
 	, _height(1.0)
 	, _border_color(color)
 	, _color(color)
+	, _view_generation(0)
 	, _selected(false)
+	, _detailed(true)
 {
 }
 
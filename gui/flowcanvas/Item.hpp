@@ -63,6 +63,11 @@ public:
 	virtual void zoom(double z) {}
 	boost::weak_ptr<Canvas> canvas() const { return _canvas; }
 
+	/** Level of detail.  Items that are not detailed are drawn as simplified
+	 * glyphs (no text) and are not required to track the zoom level. */
+	bool         detailed() const         { return _detailed; }
+	virtual void set_detailed(bool b)     { _detailed = b; }
+
 	bool popup_menu(guint button, guint32 activate_time) {
 		if ( ! _menu)
 			create_menu();
@@ -89,6 +94,7 @@ public:
 
 	bool        is_within(const Gnome::Canvas::Rect& rect) const;
 	inline bool point_is_within(double x, double y) const;
+	inline bool intersects(double x1, double y1, double x2, double y2) const;
 
 	const std::string& name() const                   { return _name; }
 	virtual void       set_name(const std::string& n) { _name = n; }
@@ -131,6 +137,8 @@ protected:
 	
 	bool on_event(GdkEvent* event);
 
+	friend class Canvas;
+
 	const boost::weak_ptr<Canvas> _canvas;
 
 	boost::weak_ptr<Item> _partner;
@@ -142,7 +150,9 @@ protected:
 	double      _height;
 	uint32_t    _border_color;
 	uint32_t    _color;
+	unsigned    _view_generation; ///< Canvas view generation zoom was last applied for
 	bool        _selected :1;
+	bool        _detailed :1;
 };
 
 
@@ -159,6 +169,17 @@ Item::point_is_within(double x, double y) const
 }
 
 
+/** Returns whether or not the item overlaps the box @a x1, @a y1, @a x2, @a y2
+ * (world units, x1 <= x2 and y1 <= y2).
+ */
+inline bool
+Item::intersects(double x1, double y1, double x2, double y2) const
+{
+	return (property_x() < x2 && property_x() + _width > x1
+			&& property_y() < y2 && property_y() + _height > y1);
+}
+
+
 inline bool
 Item::is_within(const Gnome::Canvas::Rect& rect) const
 {
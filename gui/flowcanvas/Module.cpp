@@ -97,6 +97,9 @@ Module::Module(
 
 	set_width(10.0);
 	set_height(10.0);
+
+	if (!canvas->detailed())
+		set_detailed(false);
 }
 
 
@@ -195,7 +198,10 @@ Module::set_icon(const Glib::RefPtr<Gdk::Pixbuf>& icon)
 		double scale = _icon_size / (icon->get_width() > icon->get_height() ?
 				icon->get_width() : icon->get_height());
 		_icon_box->affine_relative(Gnome::Art::AffineTrans::scaling(scale));
-		_icon_box->show();
+		if (_detailed)
+			_icon_box->show();
+		else
+			_icon_box->hide();
 	}
 	resize();
 }
@@ -210,6 +216,35 @@ Module::zoom(double z)
 }
 
 
+/** Switch between full rendering and a simplified glyph (box only).
+ *
+ * Text items are hidden rather than removed so that module geometry (and
+ * thus connection end points) does not change with the level of detail.
+ */
+void
+Module::set_detailed(bool b)
+{
+	Item::set_detailed(b);
+
+	if (_title_visible) {
+		if (b)
+			_canvas_title.show();
+		else
+			_canvas_title.hide();
+	}
+
+	if (_icon_box) {
+		if (b)
+			_icon_box->show();
+		else
+			_icon_box->hide();
+	}
+
+	for (PortVector::iterator p = _ports.begin(); p != _ports.end(); ++p)
+		(*p)->set_detailed(b);
+}
+
+
 void
 Module::set_highlighted(bool b)
 {
@@ -58,6 +58,8 @@ public:
 	void zoom(double z);
 	void resize();
 
+	void set_detailed(bool b);
+
 	bool show_port_labels(bool b) { return _show_port_labels; }
 	void set_show_port_labels(bool b);
 
@@ -57,7 +57,7 @@ Port::Port(boost::shared_ptr<Module> module, const string& name, bool is_input,
 	, _is_input(is_input)
 	, _selected(false)
 	, _toggled(false)
-
+	, _detailed(module->detailed())
 {
 	boost::shared_ptr<Canvas> canvas = module->canvas().lock();
 
@@ -333,6 +333,8 @@ Port::show_label(bool b)
 		_label->property_fill_color_rgba() = 0xFFFFFFFF;
 
 		_label->raise_to_top();
+		if (!_detailed)
+			_label->hide();
 	} else {
 		delete _label;
 		_label = NULL;
@@ -354,6 +356,26 @@ Port::show_label(bool b)
 }
 
 
+/** Show or hide the label without changing the port geometry.
+ *
+ * Used for level of detail rendering, unlike show_label() this does not
+ * require the module to be resized.
+ */
+void
+Port::set_detailed(bool b)
+{
+	_detailed = b;
+
+	if (!_label)
+		return;
+
+	if (b)
+		_label->show();
+	else
+		_label->hide();
+}
+
+
 void
 Port::set_selected(bool b)
 {
@@ -68,6 +68,7 @@ public:
 	void set_fill_color(uint32_t c) { _rect->property_fill_color_rgba() = c; }
 
 	void show_label(bool b);
+	void set_detailed(bool b);
 	void set_selected(bool b);
 	bool selected() const { return _selected; }
 
@@ -167,6 +168,7 @@ protected:
 	bool _is_input :1;
 	bool _selected :1;
 	bool _toggled  :1;
+	bool _detailed :1;
 };
 
 typedef std::vector<boost::shared_ptr<Port> > PortVector;
@@ -31,12 +31,16 @@
 #include "../common/catdup.h"
 #include "internal.h"
 
+/* Module locations are buffered and stored in the graph dicts at most once per this period */
+#define LOCATION_FLUSH_INTERVAL 250 /* in milliseconds */
+
 struct graph_canvas
 {
   graph_proxy_handle graph;
   canvas_handle canvas;
   void (* fill_menu)(GtkMenu * menu);
   struct list_head clients;
+  guint location_flush_source_tag;
 };
 
 struct client
@@ -48,6 +52,9 @@ struct client
   struct graph_canvas * owner_ptr;
   unsigned int inport_count;
   unsigned int outport_count;
+  bool location_dirty;          /* x and y are not stored in the graph dict yet */
+  double x;
+  double y;
 };
 
 struct port
@@ -132,46 +139,150 @@ disconnect_request(
 #undef port1_ptr
 #undef port2_ptr
 
-#define client_ptr ((struct client *)module_context)
-
-void
-module_location_changed(
-  void * module_context,
-  double x,
-  double y)
+/* Store locations of all moved modules with a single SetDicts call */
+static void flush_module_locations(struct graph_canvas * graph_canvas_ptr)
 {
-  char x_str[100];
-  char y_str[100];
+  struct list_head * node_ptr;
+  struct client * client_ptr;
+  size_t count;
+  size_t i;
+  struct graph_proxy_dict_entry * entries;
+  char (* strings)[100];
+  bool * failed;
   char * locale;
 
-  log_info("module_location_changed(id = %3llu, x = %6.1f, y = %6.1f)", (unsigned long long)client_ptr->id, x, y);
+  if (graph_canvas_ptr->graph == NULL)
+  {
+    return;
+  }
+
+  count = 0;
+  list_for_each(node_ptr, &graph_canvas_ptr->clients)
+  {
+    client_ptr = list_entry(node_ptr, struct client, siblings);
+    if (client_ptr->location_dirty)
+    {
+      count += 2;
+    }
+  }
+
+  if (count == 0)
+  {
+    return;
+  }
+
+  entries = malloc(count * (sizeof(struct graph_proxy_dict_entry) + sizeof(*strings) + sizeof(bool)));
+  if (entries == NULL)
+  {
+    log_error("malloc() failed to allocate %zu module location entries", count);
+    return;
+  }
+
+  strings = (char (*)[100])(entries + count);
+  failed = (bool *)(strings + count);
 
   locale = strdup(setlocale(LC_NUMERIC, NULL));
   if (locale == NULL)
   {
     log_error("strdup() failed for locale string");
+    free(entries);
     return;
   }
 
   setlocale(LC_NUMERIC, "POSIX");
-  sprintf(x_str, "%f", x);
-  sprintf(y_str, "%f", y);
+
+  i = 0;
+  list_for_each(node_ptr, &graph_canvas_ptr->clients)
+  {
+    client_ptr = list_entry(node_ptr, struct client, siblings);
+    if (!client_ptr->location_dirty)
+    {
+      continue;
+    }
+
+    sprintf(strings[i], "%f", client_ptr->x);
+    entries[i].object_type = GRAPH_DICT_OBJECT_TYPE_CLIENT;
+    entries[i].object_id = client_ptr->id;
+    entries[i].key = URI_CANVAS_X;
+    entries[i].value = strings[i];
+    i++;
+
+    sprintf(strings[i], "%f", client_ptr->y);
+    entries[i].object_type = GRAPH_DICT_OBJECT_TYPE_CLIENT;
+    entries[i].object_id = client_ptr->id;
+    entries[i].key = URI_CANVAS_Y;
+    entries[i].value = strings[i];
+    i++;
+
+    client_ptr->location_dirty = false;
+  }
+
   setlocale(LC_NUMERIC, locale);
   free(locale);
 
-  graph_proxy_dict_entry_set(
-    client_ptr->owner_ptr->graph,
-    GRAPH_DICT_OBJECT_TYPE_CLIENT,
-    client_ptr->id,
-    URI_CANVAS_X,
-    x_str);
+  ASSERT(i == count);
 
-  graph_proxy_dict_entry_set(
-    client_ptr->owner_ptr->graph,
-    GRAPH_DICT_OBJECT_TYPE_CLIENT,
-    client_ptr->id,
-    URI_CANVAS_Y,
-    y_str);
+  log_info("storing locations of %zu modules", count / 2);
+
+  if (!graph_proxy_dict_entries_set(graph_canvas_ptr->graph, entries, count, failed))
+  {
+    /* ladishd without SetDicts support or the call failed as a whole */
+    for (i = 0; i < count; i++)
+    {
+      failed[i] = true;
+    }
+  }
+
+  /* set one by one only the entries that SetDicts did not set */
+  for (i = 0; i < count; i++)
+  {
+    if (failed[i])
+    {
+      graph_proxy_dict_entry_set(
+        graph_canvas_ptr->graph,
+        entries[i].object_type,
+        entries[i].object_id,
+        entries[i].key,
+        entries[i].value);
+    }
+  }
+
+  free(entries);
+}
+
+static gboolean flush_module_locations_timeout(gpointer data)
+{
+  struct graph_canvas * graph_canvas_ptr;
+
+  graph_canvas_ptr = data;
+  graph_canvas_ptr->location_flush_source_tag = 0;
+  flush_module_locations(graph_canvas_ptr);
+
+  return FALSE;
+}
+
+#define client_ptr ((struct client *)module_context)
+
+void
+module_location_changed(
+  void * module_context,
+  double x,
+  double y)
+{
+  log_info("module_location_changed(id = %3llu, x = %6.1f, y = %6.1f)", (unsigned long long)client_ptr->id, x, y);
+
+  /* Coalesce moves, only the last location is stored on flush */
+  client_ptr->x = x;
+  client_ptr->y = y;
+  client_ptr->location_dirty = true;
+
+  if (client_ptr->owner_ptr->location_flush_source_tag == 0)
+  {
+    client_ptr->owner_ptr->location_flush_source_tag = g_timeout_add(
+      LOCATION_FLUSH_INTERVAL,
+      flush_module_locations_timeout,
+      client_ptr->owner_ptr);
+  }
 }
 
 static void on_popup_menu_action_client_rename(GtkWidget * UNUSED(menuitem), gpointer module_context)
@@ -382,6 +493,7 @@ graph_canvas_create(
 
   graph_canvas_ptr->graph = NULL;
   INIT_LIST_HEAD(&graph_canvas_ptr->clients);
+  graph_canvas_ptr->location_flush_source_tag = 0;
 
   *graph_canvas_handle_ptr = (graph_canvas_handle)graph_canvas_ptr;
 
@@ -409,6 +521,8 @@ client_appeared(
   struct client * client_ptr;
   char * x_str;
   char * y_str;
+  static const char * const location_keys[2] = {URI_CANVAS_X, URI_CANVAS_Y};
+  char * location_values[2];
   double x;
   double y;
   char * locale;
@@ -430,31 +544,31 @@ client_appeared(
   client_ptr->id = id;
   client_ptr->inport_count = 0;
   client_ptr->outport_count = 0;
+  client_ptr->location_dirty = false;
   INIT_LIST_HEAD(&client_ptr->ports);
   client_ptr->owner_ptr = graph_canvas_ptr;
 
   x = 0;
   y = 0;
 
-  if (!graph_proxy_dict_entry_get(
-        client_ptr->owner_ptr->graph,
-        GRAPH_DICT_OBJECT_TYPE_CLIENT,
-        id,
-        URI_CANVAS_X,
-        &x_str))
+  /* both coordinates are fetched in one round trip */
+  graph_proxy_dict_entries_get(
+    client_ptr->owner_ptr->graph,
+    GRAPH_DICT_OBJECT_TYPE_CLIENT,
+    id,
+    location_keys,
+    2,
+    location_values);
+  x_str = location_values[0];
+  y_str = location_values[1];
+
+  if (x_str == NULL)
   {
-    x_str = NULL;
     x = width / 2 - 200 + rand() % 300;
   }
 
-  if (!graph_proxy_dict_entry_get(
-        client_ptr->owner_ptr->graph,
-        GRAPH_DICT_OBJECT_TYPE_CLIENT,
-        id,
-        URI_CANVAS_Y,
-        &y_str))
+  if (y_str == NULL)
   {
-    y_str = NULL;
     y = height / 2 - 200 + rand() % 300;
   }
 
@@ -860,6 +974,14 @@ graph_canvas_detach(
   graph_canvas_handle graph_canvas)
 {
   ASSERT(graph_canvas_ptr->graph != NULL);
+
+  if (graph_canvas_ptr->location_flush_source_tag != 0)
+  {
+    g_source_remove(graph_canvas_ptr->location_flush_source_tag);
+    graph_canvas_ptr->location_flush_source_tag = 0;
+    flush_module_locations(graph_canvas_ptr);
+  }
+
   graph_proxy_detach(graph_canvas_ptr->graph, graph_canvas);
   graph_canvas_ptr->graph = NULL;
 }
@@ -26,6 +26,7 @@
  */
 
 #include <math.h>
+#include <stdlib.h>
 
 #include "graph_view.h"
 #include "studio.h"
@@ -35,6 +36,7 @@
 #include "../proxies/jack_proxy.h"
 #include "../proxies/a2j_proxy.h"
 #include "../proxies/conf_proxy.h"
+#include "../daemon/conf.h"
 #include "gtk_builder.h"
 #include "ask_dialog.h"
 
@@ -51,6 +53,10 @@ static uint32_t g_sample_rate;
 static bool g_jack_view_enabled = false;
 static graph_view_handle g_jack_view = NULL;
 static guint g_jack_poll_source_tag;
+static guint g_jack_poll_source_interval; /* milliseconds, period of the current source */
+static bool g_jack_stats_pushed = false; /* whether ladishd sends JackStats signals */
+static bool g_jack_stats_received;      /* whether a JackStats signal arrived since the last watchdog check */
+static unsigned int g_jack_stats_interval = LADISH_CONF_KEY_DAEMON_JACK_STATS_INTERVAL_DEFAULT;
 
 static void update_raw_jack_visibility(void)
 {
@@ -113,21 +119,51 @@ static void update_buffer_size(bool force)
   }
 }
 
+static void set_xruns(uint32_t xruns)
+{
+  char tmp_buf[100];
+
+  snprintf(tmp_buf, sizeof(tmp_buf),
+           ngettext("%"PRIu32" dropout",
+                    "%"PRIu32" dropouts",
+                    xruns), xruns);
+
+  set_xruns_text(tmp_buf);
+  gtk_progress_bar_set_text(GTK_PROGRESS_BAR(g_xrun_progress_bar), tmp_buf);
+
+  if ((g_xruns == 0 && xruns != 0) || (g_xruns != 0 && xruns == 0))
+  {
+    g_xruns = xruns;
+    studio_state_changed(NULL);
+  }
+  else
+  {
+    g_xruns = xruns;
+  }
+}
+
+static void set_dsp_load(double load, double peak_load)
+{
+  char tmp_buf[100];
+
+  if (peak_load > g_jack_max_dsp_load)
+  {
+    g_jack_max_dsp_load = peak_load;
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(g_xrun_progress_bar), peak_load / 100.0);
+  }
+
+  snprintf(tmp_buf, sizeof(tmp_buf), _("DSP: %5.1f%% (%5.1f%%)"), (float)load, (float)g_jack_max_dsp_load);
+  set_dsp_load_text(tmp_buf);
+}
+
 static void update_load(void)
 {
   double load;
-  char tmp_buf[100];
   uint32_t xruns;
 
   if (jack_proxy_get_xruns(&xruns))
   {
-    snprintf(tmp_buf, sizeof(tmp_buf),
-             ngettext("%"PRIu32" dropout",
-                      "%"PRIu32" dropouts",
-                      xruns), xruns);
-
-    set_xruns_text(tmp_buf);
-    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(g_xrun_progress_bar), tmp_buf);
+    set_xruns(xruns);
   }
   else
   {
@@ -138,37 +174,113 @@ static void update_load(void)
 
   if (jack_proxy_get_dsp_load(&load))
   {
-    if (load > g_jack_max_dsp_load)
-    {
-      g_jack_max_dsp_load = load;
-      gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(g_xrun_progress_bar), load / 100.0);
-    }
-
-    snprintf(tmp_buf, sizeof(tmp_buf), _("DSP: %5.1f%% (%5.1f%%)"), (float)load, (float)g_jack_max_dsp_load);
-    set_dsp_load_text(tmp_buf);
+    set_dsp_load(load, load);
   }
   else
   {
     set_xruns_text("?");
   }
+}
 
-  if ((g_xruns == 0 && xruns != 0) || (g_xruns != 0 && xruns == 0))
+static gboolean poll_jack(gpointer UNUSED(data))
+{
+  update_load();
+  update_buffer_size(false);
+
+  return TRUE;
+}
+
+static void update_jack_poll(void);
+
+/* ladishd stopped sampling or is stuck, go back to polling */
+static gboolean check_jack_stats(gpointer UNUSED(data))
+{
+  if (g_jack_stats_received)
   {
-    g_xruns = xruns;
-    studio_state_changed(NULL);
+    g_jack_stats_received = false;
+    return TRUE;
+  }
+
+  log_info("No JackStats signal for %u ms, polling JACK", g_jack_poll_source_interval);
+  g_jack_stats_pushed = false;
+  update_jack_poll();
+
+  return TRUE;                  /* update_jack_poll() already removed the source */
+}
+
+/* JACK is polled only when ladishd is not available to push the statistics,
+ * otherwise the signals are watched for with a period of twice the sampling interval */
+static void update_jack_poll(void)
+{
+  guint interval;
+
+  if (g_jack_state != JACK_STATE_STARTED)
+  {
+    interval = 0;
+  }
+  else if (g_jack_stats_pushed)
+  {
+    interval = 2 * g_jack_stats_interval;
   }
   else
   {
-    g_xruns = xruns;
+    interval = 100;
+  }
+
+  if (g_jack_poll_source_tag != 0 && g_jack_poll_source_interval == interval)
+  {
+    return;
+  }
+
+  if (g_jack_poll_source_tag != 0)
+  {
+    g_source_remove(g_jack_poll_source_tag);
+    g_jack_poll_source_tag = 0;
+  }
+
+  g_jack_poll_source_interval = interval;
+
+  if (interval == 0)
+  {
+    return;
+  }
+
+  if (g_jack_stats_pushed)
+  {
+    g_jack_stats_received = false;
+    g_jack_poll_source_tag = g_timeout_add(interval, check_jack_stats, NULL);
+  }
+  else
+  {
+    g_jack_poll_source_tag = g_timeout_add(interval, poll_jack, NULL);
   }
 }
 
-static gboolean poll_jack(gpointer UNUSED(data))
+void set_jack_stats_pushed(bool pushed)
 {
-  update_load();
-  update_buffer_size(false);
+  /* ladishd does not sample when jack_stats_interval is 0 */
+  g_jack_stats_pushed = pushed && g_jack_stats_interval != 0;
+  update_jack_poll();
+  g_jack_stats_received = pushed;
+}
 
-  return TRUE;
+static void on_jack_stats_interval_changed(void * UNUSED(context), const char * UNUSED(key), const char * value)
+{
+  if (value == NULL)
+  {
+    g_jack_stats_interval = LADISH_CONF_KEY_DAEMON_JACK_STATS_INTERVAL_DEFAULT;
+  }
+  else
+  {
+    g_jack_stats_interval = strtoul(value, NULL, 10);
+  }
+
+  if (g_jack_stats_interval == 0)
+  {
+    g_jack_stats_pushed = false;
+  }
+
+  update_jack_poll();
 }
 
 static void jack_appeared(void)
@@ -189,9 +301,10 @@ static void jack_started(void)
 
   menu_set_jack_latency_items_sensivity(true);
   update_buffer_size(true);
+  update_load();              /* JackStats signal has xrun deltas, start from the absolute count */
   enable_action(g_clear_xruns_and_max_dsp_action);
 
-  g_jack_poll_source_tag = g_timeout_add(100, poll_jack, NULL);
+  update_jack_poll();
 }
 
 static void jack_stopped(void)
@@ -199,11 +312,11 @@ static void jack_stopped(void)
   if (g_jack_state == JACK_STATE_STARTED)
   {
     log_info("JACK stopped");
-
-    g_source_remove(g_jack_poll_source_tag);
   }
 
   g_jack_state = JACK_STATE_STOPPED;
+  g_jack_stats_pushed = false;  /* the sampling config may change before next start */
+  update_jack_poll();
   studio_state_changed(NULL);
 
   menu_set_jack_latency_items_sensivity(false);
@@ -226,8 +339,13 @@ static void jack_disappeared(void)
 void clear_xruns_and_max_dsp(void)
 {
   log_info("clearing xruns and max dsp load");
-  jack_proxy_reset_xruns();
   g_jack_max_dsp_load = 0.0;
+
+  if (jack_proxy_reset_xruns())
+  {
+    /* ladishd sends deltas only for the xruns that happen after the reset */
+    set_xruns(0);
+  }
 }
 
 void menu_request_jack_latency_change(uint32_t buffer_size)
@@ -331,6 +449,11 @@ void init_jack_widgets(void)
 
 bool init_jack(void)
 {
+  if (!conf_register(LADISH_CONF_KEY_DAEMON_JACK_STATS_INTERVAL, on_jack_stats_interval_changed, NULL))
+  {
+    return false;
+  }
+
   return jack_proxy_init(jack_started, jack_stopped, jack_appeared, jack_disappeared);
 }
 
@@ -378,6 +501,34 @@ void update_jack_sample_rate(void)
   }
 }
 
+void
+jack_stats_changed(
+  uint32_t xruns_delta,
+  double dsp_load,
+  double peak_dsp_load,
+  uint32_t buffer_size,
+  uint32_t sample_rate)
+{
+  if (g_jack_state != JACK_STATE_STARTED)
+  {
+    return;
+  }
+
+  if (xruns_delta != 0)
+  {
+    set_xruns(g_xruns + xruns_delta);
+  }
+
+  set_dsp_load(dsp_load, peak_dsp_load);
+
+  if (sample_rate != g_sample_rate)
+  {
+    update_jack_sample_rate();
+  }
+
+  buffer_size_set(buffer_size, false);
+}
+
 unsigned int get_jack_state(void)
 {
   return g_jack_state;
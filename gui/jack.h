@@ -41,5 +41,7 @@ bool jack_xruns(void);
 void set_xrun_progress_bar_text(const char * text);
 void update_jack_sample_rate(void);
 void clear_xruns_and_max_dsp(void);
+void set_jack_stats_pushed(bool pushed);
+void jack_stats_changed(uint32_t xruns_delta, double dsp_load, double peak_dsp_load, uint32_t buffer_size, uint32_t sample_rate);
 
 #endif /* #ifndef JACK_H__AA9BB099_1EAA_43A8_B84D_3DA221F1A1CF__INCLUDED */
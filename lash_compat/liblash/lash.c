@@ -31,6 +31,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <dirent.h>
+#include <sys/mman.h>
 
 #include "lash/lash.h"
 
@@ -42,7 +43,29 @@
 #include "../../cdbus/helpers.h"
 #include "../../dbus_constants.h"
 
-#define LASH_CONFIG_SUBDIR "/.ladish_lash_dict/"
+#define LASH_CONFIG_SUBDIR "/.ladish_lash_dict/" /* legacy layout, file per key */
+#define LASH_CONFIG_PACK "/.ladish_lash_dict.pack"
+
+/* The packed config container:
+ * header, index of key/value locations and then the keys and values.
+ * All integers are in network byte order. Keys are nul terminated. */
+
+#define LASH_CONFIG_PACK_MAGIC "LADISHLC"
+#define LASH_CONFIG_PACK_VERSION 1
+
+struct lash_config_pack_header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t count;
+};
+
+struct lash_config_pack_index_entry
+{
+  uint32_t key_offset;          /* from start of file */
+  uint32_t value_offset;        /* from start of file */
+  uint32_t value_size;
+};
 
 static cdbus_object_path g_object;
 extern const struct cdbus_interface_descriptor g_interface __attribute__((visibility("hidden")));
@@ -86,69 +109,258 @@ static void clean_pending_configs(void)
   }
 }
 
-static void save_config(const char * dir,  struct _lash_config * config_ptr)
+static bool write_all(int fd, const void * buffer, size_t size, const char * path)
+{
+  ssize_t written;
+
+  written = write(fd, buffer, size);
+  if (written == -1)
+  {
+    log_error("error writing config file '%s' (%s)", path, strerror(errno));
+    return false;
+  }
+
+  if ((size_t)written < size)
+  {
+    log_error("error writing config file '%s' (%zd instead of %zu)", path, written, size);
+    return false;
+  }
+
+  return true;
+}
+
+static void save_pending_configs(const char * dir)
 {
+  struct _lash_config * config_ptr;
+  struct list_head * node_ptr;
+  struct lash_config_pack_header header;
+  struct lash_config_pack_index_entry * index;
+  uint32_t count;
+  uint32_t offset;
+  uint32_t i;
   char * path;
+  char * tmp_path;
   int fd;
-	ssize_t written;
+  bool ok;
 
-  log_debug("saving dict key '%s'", config_ptr->key);
+  count = 0;
+  list_for_each(node_ptr, &g_pending_configs)
+  {
+    count++;
+  }
 
-  path = catdup3(dir, LASH_CONFIG_SUBDIR, config_ptr->key);
-  if (path == NULL)
+  log_debug("saving %u dict keys", (unsigned int)count);
+
+  if (!ensure_dir_exist(dir, S_IRWXU | S_IRWXG | S_IRWXO))
   {
-    goto exit;
+    log_error("ensure_dir_exist() failed for %s", dir);
+    goto clean;
   }
 
-  fd = creat(path, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+  index = malloc(count * sizeof(struct lash_config_pack_index_entry) + 1);
+  if (index == NULL)
+  {
+    log_error("malloc() failed to allocate config pack index");
+    goto clean;
+  }
 
-	if (fd == -1)
+  /* keys and values follow the index, in list order */
+  offset = sizeof(struct lash_config_pack_header) + count * sizeof(struct lash_config_pack_index_entry);
+  i = 0;
+  list_for_each(node_ptr, &g_pending_configs)
   {
-    log_error("error creating config file '%s' (%s)", path, strerror(errno));
-    goto free;
-	}
+    config_ptr = list_entry(node_ptr, struct _lash_config, siblings);
+    index[i].key_offset = htonl(offset);
+    offset += strlen(config_ptr->key) + 1;
+    index[i].value_offset = htonl(offset);
+    index[i].value_size = htonl(config_ptr->size);
+    offset += config_ptr->size;
+    i++;
+  }
+
+  memcpy(header.magic, LASH_CONFIG_PACK_MAGIC, sizeof(header.magic));
+  header.version = htonl(LASH_CONFIG_PACK_VERSION);
+  header.count = htonl(count);
 
-	written = write(fd, config_ptr->value, config_ptr->size);
-	if (written == -1)
+  path = catdup(dir, LASH_CONFIG_PACK);
+  if (path == NULL)
   {
-    log_error("error writing config file '%s' (%s)", path, strerror(errno));
-    goto close;
-	}
+    goto free_index;
+  }
 
-  if ((size_t)written < config_ptr->size)
+  tmp_path = catdup(path, ".tmp");
+  if (tmp_path == NULL)
   {
-    log_error("error writing config file '%s' (%zd instead of %zu)", path, written, config_ptr->size);
-    goto close;
+    goto free_path;
   }
 
-  log_debug("saved dict key '%s'", config_ptr->key);
+  fd = creat(tmp_path, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
+  if (fd == -1)
+  {
+    log_error("error creating config file '%s' (%s)", tmp_path, strerror(errno));
+    goto free_tmp_path;
+  }
+
+  ok = write_all(fd, &header, sizeof(header), tmp_path) &&
+    write_all(fd, index, count * sizeof(struct lash_config_pack_index_entry), tmp_path);
+
+  list_for_each(node_ptr, &g_pending_configs)
+  {
+    config_ptr = list_entry(node_ptr, struct _lash_config, siblings);
+    ok = ok &&
+      write_all(fd, config_ptr->key, strlen(config_ptr->key) + 1, tmp_path) &&
+      write_all(fd, config_ptr->value, config_ptr->size, tmp_path);
+  }
+
+  if (ok && fsync(fd) != 0)
+  {
+    log_error("fsync() failed for config file '%s' (%s)", tmp_path, strerror(errno));
+    ok = false;
+  }
 
-close:
   close(fd);
-free:
+
+  /* the old container is replaced atomically */
+  if (ok && rename(tmp_path, path) != 0)
+  {
+    log_error("rename('%s', '%s') failed (%s)", tmp_path, path, strerror(errno));
+    ok = false;
+  }
+
+  if (ok)
+  {
+    log_debug("saved %u dict keys to '%s'", (unsigned int)count, path);
+  }
+  else
+  {
+    unlink(tmp_path);
+  }
+
+free_tmp_path:
+  free(tmp_path);
+free_path:
   free(path);
-exit:
-  return;
+free_index:
+  free(index);
+clean:
+  clean_pending_configs();
 }
 
-static void save_pending_configs(const char * dir)
+/* returns false if there is no valid config container in the app dir */
+static bool load_packed_configs(const char * appdir)
 {
-  struct _lash_config * config_ptr;
+  char * path;
+  int fd;
+  struct stat st;
+  const char * data;
+  struct lash_config_pack_header header;
+  struct lash_config_pack_index_entry entry;
+  uint32_t count;
+  uint32_t i;
+  uint32_t key_offset;
+  uint32_t value_offset;
+  uint32_t value_size;
+  size_t index_size;
+  lash_config_t * config_ptr;
+  bool ret;
 
-  if (!ensure_dir_exist_varg(S_IRWXU | S_IRWXG | S_IRWXO, dir, LASH_CONFIG_SUBDIR, NULL))
+  ret = false;
+
+  path = catdup(appdir, LASH_CONFIG_PACK);
+  if (path == NULL)
   {
-    log_error("ensure_dir_exist_varg() failed for %s%s", dir, LASH_CONFIG_SUBDIR);
-    clean_pending_configs();
-    return;
+    goto exit;
   }
 
-  while (!list_empty(&g_pending_configs))
+  fd = open(path, O_RDONLY);
+  if (fd == -1)
   {
-    config_ptr = list_entry(g_pending_configs.next, struct _lash_config, siblings);
-    list_del(g_pending_configs.next);
-    save_config(dir, config_ptr);
-    lash_config_destroy(config_ptr);
+    if (errno != ENOENT)
+    {
+      log_error("Cannot open '%s': %d (%s)", path, errno, strerror(errno));
+    }
+    goto free;
+  }
+
+  if (fstat(fd, &st) != 0)
+  {
+    log_error("failed to stat '%s': %d (%s)", path, errno, strerror(errno));
+    goto close;
+  }
+
+  if ((size_t)st.st_size < sizeof(struct lash_config_pack_header))
+  {
+    log_error("config container '%s' is truncated", path);
+    goto close;
+  }
+
+  data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED)
+  {
+    log_error("mmap() failed for '%s': %d (%s)", path, errno, strerror(errno));
+    goto close;
+  }
+
+  memcpy(&header, data, sizeof(header));
+  count = ntohl(header.count);
+  index_size = (size_t)count * sizeof(struct lash_config_pack_index_entry);
+
+  if (memcmp(header.magic, LASH_CONFIG_PACK_MAGIC, sizeof(header.magic)) != 0 ||
+      ntohl(header.version) != LASH_CONFIG_PACK_VERSION ||
+      index_size > (size_t)st.st_size - sizeof(struct lash_config_pack_header))
+  {
+    log_error("'%s' is not a valid config container", path);
+    goto unmap;
+  }
+
+  ret = true;
+
+  for (i = 0; i < count; i++)
+  {
+    memcpy(&entry, data + sizeof(struct lash_config_pack_header) + i * sizeof(struct lash_config_pack_index_entry), sizeof(entry));
+    key_offset = ntohl(entry.key_offset);
+    value_offset = ntohl(entry.value_offset);
+    value_size = ntohl(entry.value_size);
+
+    if (key_offset >= value_offset ||
+        value_offset > (size_t)st.st_size ||
+        value_size > (size_t)st.st_size - value_offset ||
+        data[value_offset - 1] != 0)
+    {
+      log_error("invalid index entry #%u in '%s'", (unsigned int)i, path);
+      continue;
+    }
+
+    config_ptr = lash_config_new_with_key(data + key_offset);
+    if (config_ptr == NULL)
+    {
+      continue;
+    }
+
+    /* the value is owned by the app that gets the config, so it cannot point to the mapping */
+    config_ptr->value = malloc(value_size + 1);
+    if (config_ptr->value == NULL)
+    {
+      log_error("malloc() failed for value of config key '%s'", config_ptr->key);
+      lash_config_destroy(config_ptr);
+      continue;
+    }
+
+    memcpy(config_ptr->value, data + value_offset, value_size);
+    config_ptr->size = value_size;
+    list_add_tail(&config_ptr->siblings, &g_pending_configs);
   }
+
+  log_debug("loaded %u dict keys from '%s'", (unsigned int)count, path);
+
+unmap:
+  munmap((void *)data, st.st_size);
+close:
+  close(fd);
+free:
+  free(path);
+exit:
+  return ret;
 }
 
 static void load_configs(const char * appdir)
@@ -165,6 +377,13 @@ static void load_configs(const char * appdir)
 
   log_debug("Loading configs from '%s'", appdir);
 
+  if (load_packed_configs(appdir))
+  {
+    return;
+  }
+
+  /* app dir saved by older liblash version */
+
   dirpath = catdup(appdir, LASH_CONFIG_SUBDIR);
   if (dirpath == NULL)
   {
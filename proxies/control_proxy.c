@@ -46,6 +46,32 @@ static void on_clean_exit(void * UNUSED(context), DBusMessage * UNUSED(message_p
   g_clean_exit = true;
 }
 
+static void on_jack_stats(void * UNUSED(context), DBusMessage * message_ptr)
+{
+  dbus_uint32_t xruns_delta;
+  double dsp_load;
+  double peak_dsp_load;
+  dbus_uint32_t buffer_size;
+  dbus_uint32_t sample_rate;
+
+  if (!dbus_message_get_args(
+        message_ptr,
+        &cdbus_g_dbus_error,
+        DBUS_TYPE_UINT32, &xruns_delta,
+        DBUS_TYPE_DOUBLE, &dsp_load,
+        DBUS_TYPE_DOUBLE, &peak_dsp_load,
+        DBUS_TYPE_UINT32, &buffer_size,
+        DBUS_TYPE_UINT32, &sample_rate,
+        DBUS_TYPE_INVALID))
+  {
+    log_error("Invalid parameters of JackStats signal: %s",  cdbus_g_dbus_error.message);
+    dbus_error_free(&cdbus_g_dbus_error);
+    return;
+  }
+
+  control_proxy_on_jack_stats(xruns_delta, dsp_load, peak_dsp_load, buffer_size, sample_rate);
+}
+
 /* this must be static because it is referenced by the
  * dbus helper layer when hooks are active */
 static struct cdbus_signal_hook g_signal_hooks[] =
@@ -53,6 +79,7 @@ static struct cdbus_signal_hook g_signal_hooks[] =
   {"StudioAppeared", on_studio_appeared},
   {"StudioDisappeared", on_studio_disappeared},
   {"CleanExit", on_clean_exit},
+  {"JackStats", on_jack_stats},
   {NULL, NULL}
 };
 
@@ -203,6 +230,17 @@ bool control_proxy_load_studio(const char * studio_name)
   return true;
 }
 
+bool control_proxy_switch_studio(const char * studio_name)
+{
+  if (!cdbus_call(0, SERVICE_NAME, CONTROL_OBJECT_PATH, IFACE_CONTROL, "SwitchStudio", "s", &studio_name, ""))
+  {
+    log_error("SwitchStudio() failed.");
+    return false;
+  }
+
+  return true;
+}
+
 bool control_proxy_delete_studio(const char * studio_name)
 {
   if (!cdbus_call(0, SERVICE_NAME, CONTROL_OBJECT_PATH, IFACE_CONTROL, "DeleteStudio", "s", &studio_name, ""))
@@ -36,9 +36,21 @@ void control_proxy_on_daemon_appeared(void);
 void control_proxy_on_daemon_disappeared(bool clean_exit);
 void control_proxy_on_studio_appeared(bool initial);
 void control_proxy_on_studio_disappeared(void);
+
+/* Called when JACK statistics that ladishd samples change.
+ * xruns_delta is the number of xruns since the previous call. */
+void
+control_proxy_on_jack_stats(
+  uint32_t xruns_delta,
+  double dsp_load,
+  double peak_dsp_load,
+  uint32_t buffer_size,
+  uint32_t sample_rate);
+
 bool control_proxy_get_studio_list(void (* callback)(void * context, const char * studio_name), void * context);
 bool control_proxy_new_studio(const char * studio_name);
 bool control_proxy_load_studio(const char * studio_name);
+bool control_proxy_switch_studio(const char * studio_name);
 bool control_proxy_delete_studio(const char * studio_name);
 bool control_proxy_exit(void);
 void control_proxy_ping(void);
@@ -50,6 +50,24 @@ struct graph
   bool active;
   bool graph_dict_supported;
   bool graph_manager_supported;
+  struct list_head connect_batches; /* async (dis)connect requests that are not complete yet */
+  struct connect_batch * open_connect_batch_ptr; /* batch that is not committed yet, if any */
+};
+
+struct connect_batch
+{
+  struct list_head siblings;
+  struct graph * owner_ptr;     /* NULL when graph was destroyed before the batch completed */
+  cdbus_call_group_handle group;
+};
+
+struct connect_request
+{
+  bool connect;                 /* false for disconnect */
+  uint64_t port1_id;
+  uint64_t port2_id;
+  void * context;
+  void (* callback)(void * context, uint64_t port1_id, uint64_t port2_id, bool success);
 };
 
 static struct cdbus_signal_hook g_signal_hooks[];
@@ -218,7 +236,30 @@ ports_disconnected(
   }
 }
 
-static void refresh_internal(struct graph * graph_ptr, bool force)
+static bool is_client_replayed(const uint64_t * ids, size_t count, uint64_t client_id)
+{
+  size_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    if (ids[i] == client_id)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/* When filter is not NULL, the graph is not cleared and only clients for which
+ * filter returns true are replayed, together with their ports and connections */
+static
+void
+refresh_internal(
+  struct graph * graph_ptr,
+  bool force,
+  void * filter_context,
+  bool (* filter)(void * context, uint64_t client_id))
 {
   DBusMessage* reply_ptr;
   DBusMessageIter iter;
@@ -241,9 +282,17 @@ static void refresh_internal(struct graph * graph_ptr, bool force)
   dbus_uint64_t port2_id;
   const char *port2_name;
   dbus_uint64_t connection_id;
+  uint64_t * replayed_ids;
+  size_t replayed_count;
+  size_t replayed_size;
+  uint64_t * new_ids;
 
   log_info("refresh_internal() called");
 
+  replayed_ids = NULL;
+  replayed_count = 0;
+  replayed_size = 0;
+
   if (force)
   {
     version = 0; // workaround module split/join stupidity
@@ -273,15 +322,18 @@ static void refresh_internal(struct graph * graph_ptr, bool force)
   dbus_message_iter_get_basic(&iter, &version);
   dbus_message_iter_next(&iter);
 
-  if (!force && version <= graph_ptr->version)
+  if (filter == NULL)
   {
-    goto unref;
-  }
+    if (!force && version <= graph_ptr->version)
+    {
+      goto unref;
+    }
 
-  clear(graph_ptr);
+    clear(graph_ptr);
 
-  //log_info("got new graph version %llu", (unsigned long long)version);
-  graph_ptr->version = version;
+    //log_info("got new graph version %llu", (unsigned long long)version);
+    graph_ptr->version = version;
+  }
 
   //info_msg((std::string)"clients " + (char)dbus_message_iter_get_arg_type(&iter));
 
@@ -300,6 +352,29 @@ static void refresh_internal(struct graph * graph_ptr, bool force)
 
     //info_msg((std::string)"client '" + client_name + "'");
 
+    if (filter != NULL)
+    {
+      if (!filter(filter_context, client_id))
+      {
+        continue;
+      }
+
+      if (replayed_count == replayed_size)
+      {
+        replayed_size = replayed_size == 0 ? 16 : replayed_size * 2;
+        new_ids = realloc(replayed_ids, replayed_size * sizeof(uint64_t));
+        if (new_ids == NULL)
+        {
+          log_error("realloc() failed for replayed client ids");
+          goto unref;
+        }
+
+        replayed_ids = new_ids;
+      }
+
+      replayed_ids[replayed_count++] = client_id;
+    }
+
     client_appeared(graph_ptr, client_id, client_name);
 
     for (dbus_message_iter_recurse(&client_struct_iter, &ports_array_iter);
@@ -376,10 +451,18 @@ static void refresh_internal(struct graph * graph_ptr, bool force)
     //    port2_name %
     //    port2_id));
 
+    if (filter != NULL &&
+        !is_client_replayed(replayed_ids, replayed_count, client_id) &&
+        !is_client_replayed(replayed_ids, replayed_count, client2_id))
+    {
+      continue;
+    }
+
     ports_connected(graph_ptr, client_id, port_id, client2_id, port2_id);
   }
 
 unref:
+  free(replayed_ids);
   dbus_message_unref(reply_ptr);
 }
 
@@ -421,6 +504,8 @@ graph_proxy_create(
 
   graph_ptr->graph_dict_supported = graph_dict_supported;
   graph_ptr->graph_manager_supported = graph_manager_supported;
+  INIT_LIST_HEAD(&graph_ptr->connect_batches);
+  graph_ptr->open_connect_batch_ptr = NULL;
 
   *graph_proxy_handle_ptr = (graph_proxy_handle)graph_ptr;
 
@@ -452,8 +537,27 @@ void
 graph_proxy_destroy(
   graph_proxy_handle graph)
 {
+  struct connect_batch * batch_ptr;
+
   ASSERT(list_empty(&graph_ptr->monitors));
 
+  batch_ptr = graph_ptr->open_connect_batch_ptr;
+  if (batch_ptr != NULL)
+  {
+    /* cancel requests that were not committed */
+    list_del(&batch_ptr->siblings);
+    cdbus_call_group_destroy(batch_ptr->group);
+    free(batch_ptr);
+  }
+
+  /* committed batches free themselves on completion */
+  while (!list_empty(&graph_ptr->connect_batches))
+  {
+    batch_ptr = list_entry(graph_ptr->connect_batches.next, struct connect_batch, siblings);
+    list_del_init(&batch_ptr->siblings);
+    batch_ptr->owner_ptr = NULL;
+  }
+
   if (graph_ptr->active)
   {
     cdbus_unregister_object_signal_hooks(
@@ -497,8 +601,24 @@ graph_proxy_activate(
 
   graph_ptr->active = true;
 
-  refresh_internal(graph_ptr, true);
+  refresh_internal(graph_ptr, true, NULL, NULL);
+
+  return true;
+}
+
+bool
+graph_proxy_replay_clients(
+  graph_proxy_handle graph,
+  void * context,
+  bool (* filter)(void * context, uint64_t client_id))
+{
+  if (!graph_ptr->active)
+  {
+    log_error("cannot replay clients of inactive graph");
+    return false;
+  }
 
+  refresh_internal(graph_ptr, true, context, filter);
   return true;
 }
 
@@ -583,6 +703,160 @@ graph_proxy_connect_ports(
   return true;
 }
 
+static bool is_monitor_attached(graph_proxy_handle graph, void * context)
+{
+  struct list_head * node_ptr;
+
+  list_for_each(node_ptr, &graph_ptr->monitors)
+  {
+    if (list_entry(node_ptr, struct monitor, siblings)->context == context)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+#define batch_ptr ((struct connect_batch *)context)
+
+static void connect_reply(void * context, void * cookie, DBusMessage * reply_ptr)
+{
+  struct connect_request * request_ptr;
+
+  request_ptr = cookie;
+
+  if (reply_ptr == NULL)
+  {
+    log_error(
+      "%s(%"PRIu64", %"PRIu64") failed.",
+      request_ptr->connect ? "ConnectPortsByID" : "DisconnectPortsByID",
+      request_ptr->port1_id,
+      request_ptr->port2_id);
+  }
+
+  /* the requester could detach meanwhile */
+  if (request_ptr->callback != NULL &&
+      batch_ptr->owner_ptr != NULL &&
+      is_monitor_attached((graph_proxy_handle)batch_ptr->owner_ptr, request_ptr->context))
+  {
+    request_ptr->callback(request_ptr->context, request_ptr->port1_id, request_ptr->port2_id, reply_ptr != NULL);
+  }
+}
+
+static void connect_batch_complete(void * context, unsigned int failed)
+{
+  if (failed != 0)
+  {
+    log_error("%u of the batched (dis)connect requests failed", failed);
+  }
+
+  list_del(&batch_ptr->siblings);
+  free(batch_ptr);
+}
+
+#undef batch_ptr
+
+static
+bool
+graph_proxy_queue_ports_request(
+  graph_proxy_handle graph,
+  bool connect,
+  uint64_t port1_id,
+  uint64_t port2_id,
+  void * context,
+  void (* callback)(void * context, uint64_t port1_id, uint64_t port2_id, bool success))
+{
+  struct connect_batch * batch_ptr;
+  DBusMessage * message_ptr;
+  struct connect_request request;
+  bool ret;
+
+  batch_ptr = graph_ptr->open_connect_batch_ptr;
+  if (batch_ptr == NULL)
+  {
+    batch_ptr = malloc(sizeof(struct connect_batch));
+    if (batch_ptr == NULL)
+    {
+      log_error("malloc() failed for struct connect_batch");
+      return false;
+    }
+
+    if (!cdbus_call_group_create(0, &batch_ptr->group))
+    {
+      free(batch_ptr);
+      return false;
+    }
+
+    batch_ptr->owner_ptr = graph_ptr;
+    list_add_tail(&batch_ptr->siblings, &graph_ptr->connect_batches);
+    graph_ptr->open_connect_batch_ptr = batch_ptr;
+  }
+
+  message_ptr = cdbus_new_method_call_message(
+    graph_ptr->service,
+    graph_ptr->object,
+    JACKDBUS_IFACE_PATCHBAY,
+    connect ? "ConnectPortsByID" : "DisconnectPortsByID",
+    "tt",
+    &port1_id,
+    &port2_id,
+    NULL);
+  if (message_ptr == NULL)
+  {
+    return false;
+  }
+
+  request.connect = connect;
+  request.port1_id = port1_id;
+  request.port2_id = port2_id;
+  request.context = context;
+  request.callback = callback;
+
+  ret = cdbus_call_group_add(batch_ptr->group, message_ptr, "", batch_ptr, &request, sizeof(request), connect_reply);
+  dbus_message_unref(message_ptr);
+
+  return ret;
+}
+
+bool
+graph_proxy_connect_ports_async(
+  graph_proxy_handle graph,
+  uint64_t port1_id,
+  uint64_t port2_id,
+  void * context,
+  void (* callback)(void * context, uint64_t port1_id, uint64_t port2_id, bool success))
+{
+  return graph_proxy_queue_ports_request(graph, true, port1_id, port2_id, context, callback);
+}
+
+bool
+graph_proxy_disconnect_ports_async(
+  graph_proxy_handle graph,
+  uint64_t port1_id,
+  uint64_t port2_id,
+  void * context,
+  void (* callback)(void * context, uint64_t port1_id, uint64_t port2_id, bool success))
+{
+  return graph_proxy_queue_ports_request(graph, false, port1_id, port2_id, context, callback);
+}
+
+void graph_proxy_commit_requests(graph_proxy_handle graph)
+{
+  struct connect_batch * batch_ptr;
+
+  batch_ptr = graph_ptr->open_connect_batch_ptr;
+  if (batch_ptr == NULL)
+  {
+    return;
+  }
+
+  graph_ptr->open_connect_batch_ptr = NULL;
+
+  /* may complete (and free the batch) before returning */
+  cdbus_call_group_complete_async(batch_ptr->group, batch_ptr, connect_batch_complete);
+}
+
 bool
 graph_proxy_disconnect_ports(
   graph_proxy_handle graph,
@@ -892,6 +1166,113 @@ graph_proxy_dict_entry_set(
   return true;
 }
 
+bool
+graph_proxy_dict_entries_set(
+  graph_proxy_handle graph,
+  const struct graph_proxy_dict_entry * entries,
+  size_t count,
+  bool * failed)
+{
+  DBusMessage * request_ptr;
+  DBusMessage * reply_ptr;
+  DBusMessageIter iter;
+  DBusMessageIter array_iter;
+  DBusMessageIter struct_iter;
+  const char * reply_signature;
+  dbus_uint32_t index;
+  size_t i;
+  bool ret;
+
+  if (!graph_ptr->graph_dict_supported)
+  {
+    return false;
+  }
+
+  if (count == 0)
+  {
+    return true;
+  }
+
+  request_ptr = dbus_message_new_method_call(graph_ptr->service, graph_ptr->object, IFACE_GRAPH_DICT, "SetDicts");
+  if (request_ptr == NULL)
+  {
+    log_error("dbus_message_new_method_call() failed.");
+    return false;
+  }
+
+  ret = false;
+
+  dbus_message_iter_init_append(request_ptr, &iter);
+
+  if (!dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "(utss)", &array_iter))
+  {
+    log_error("dbus_message_iter_open_container() failed.");
+    goto unref;
+  }
+
+  for (i = 0; i < count; i++)
+  {
+    if (!dbus_message_iter_open_container(&array_iter, DBUS_TYPE_STRUCT, NULL, &struct_iter) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT32, &entries[i].object_type) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT64, &entries[i].object_id) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &entries[i].key) ||
+        !dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &entries[i].value) ||
+        !dbus_message_iter_close_container(&array_iter, &struct_iter))
+    {
+      log_error("Ran out of memory while composing SetDicts message");
+      dbus_message_iter_close_container(&iter, &array_iter);
+      goto unref;
+    }
+  }
+
+  if (!dbus_message_iter_close_container(&iter, &array_iter))
+  {
+    log_error("dbus_message_iter_close_container() failed.");
+    goto unref;
+  }
+
+  if (!cdbus_call(0, graph_ptr->service, graph_ptr->object, IFACE_GRAPH_DICT, "SetDicts", NULL, request_ptr, NULL, &reply_ptr))
+  {
+    log_error(IFACE_GRAPH_DICT ".SetDicts() failed.");
+    goto unref;
+  }
+
+  reply_signature = dbus_message_get_signature(reply_ptr);
+  if (strcmp(reply_signature, "au") != 0)
+  {
+    log_error(IFACE_GRAPH_DICT ".SetDicts() reply signature mismatch. '%s'", reply_signature);
+    goto unref_reply;
+  }
+
+  for (i = 0; i < count; i++)
+  {
+    failed[i] = false;
+  }
+
+  dbus_message_iter_init(reply_ptr, &iter);
+  for (dbus_message_iter_recurse(&iter, &array_iter);
+       dbus_message_iter_get_arg_type(&array_iter) == DBUS_TYPE_UINT32;
+       dbus_message_iter_next(&array_iter))
+  {
+    dbus_message_iter_get_basic(&array_iter, &index);
+    if (index >= count)
+    {
+      log_error(IFACE_GRAPH_DICT ".SetDicts() returned index %"PRIu32" of %zu entries", index, count);
+      continue;
+    }
+
+    failed[index] = true;
+  }
+
+  ret = true;
+
+unref_reply:
+  dbus_message_unref(reply_ptr);
+unref:
+  dbus_message_unref(request_ptr);
+  return ret;
+}
+
 bool
 graph_proxy_dict_entry_get(
   graph_proxy_handle graph,
@@ -939,6 +1320,116 @@ graph_proxy_dict_entry_get(
   return true;
 }
 
+struct graph_proxy_dict_get_context
+{
+  char ** values;
+  bool oom;
+};
+
+static void graph_proxy_dict_get_reply(void * context, void * cookie, DBusMessage * reply_ptr)
+{
+  struct graph_proxy_dict_get_context * ctx_ptr;
+  DBusMessageIter iter;
+  const char * cvalue_ptr;
+  size_t index;
+
+  if (reply_ptr == NULL)
+  {
+    /* missing key */
+    return;
+  }
+
+  ctx_ptr = context;
+  index = *(size_t *)cookie;
+
+  dbus_message_iter_init(reply_ptr, &iter);
+  dbus_message_iter_get_basic(&iter, &cvalue_ptr);
+  ctx_ptr->values[index] = strdup(cvalue_ptr);
+  if (ctx_ptr->values[index] == NULL)
+  {
+    log_error("strdup() failed for dict value");
+    ctx_ptr->oom = true;
+  }
+}
+
+bool
+graph_proxy_dict_entries_get(
+  graph_proxy_handle graph,
+  uint32_t object_type,
+  uint64_t object_id,
+  const char * const * keys,
+  size_t count,
+  char ** values)
+{
+  struct graph_proxy_dict_get_context ctx;
+  cdbus_call_group_handle group;
+  DBusMessage * request_ptr;
+  size_t i;
+  bool ret;
+
+  for (i = 0; i < count; i++)
+  {
+    values[i] = NULL;
+  }
+
+  if (!graph_ptr->graph_dict_supported)
+  {
+    return false;
+  }
+
+  if (!cdbus_call_group_create(0, &group))
+  {
+    return false;
+  }
+
+  ctx.values = values;
+  ctx.oom = false;
+  ret = true;
+
+  for (i = 0; i < count; i++)
+  {
+    request_ptr = cdbus_new_method_call_message(
+      graph_ptr->service,
+      graph_ptr->object,
+      IFACE_GRAPH_DICT,
+      "Get",
+      "uts",
+      &object_type,
+      &object_id,
+      keys + i);
+    if (request_ptr == NULL)
+    {
+      ret = false;
+      break;
+    }
+
+    ret = cdbus_call_group_add(group, request_ptr, "s", &ctx, &i, sizeof(i), graph_proxy_dict_get_reply);
+    dbus_message_unref(request_ptr);
+    if (!ret)
+    {
+      break;
+    }
+  }
+
+  /* failed calls are for missing keys, the values for them are left NULL */
+  cdbus_call_group_wait(group);
+  cdbus_call_group_destroy(group);
+
+  if (!ret || ctx.oom)
+  {
+    log_error(IFACE_GRAPH_DICT ".Get() pipelining failed.");
+    for (i = 0; i < count; i++)
+    {
+      free(values[i]);
+      values[i] = NULL;
+    }
+
+    return false;
+  }
+
+  return true;
+}
+
 bool
 graph_proxy_dict_entry_drop(
   graph_proxy_handle graph,
@@ -31,6 +31,14 @@
 
 typedef struct graph_proxy_tag { int unused; } * graph_proxy_handle;
 
+struct graph_proxy_dict_entry
+{
+  uint32_t object_type;
+  uint64_t object_id;
+  const char * key;
+  const char * value;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -57,6 +65,15 @@ bool
 graph_proxy_activate(
   graph_proxy_handle graph);
 
+/* Replay client_appeared, port_appeared and ports_connected to the monitors for clients
+ * that the filter accepts. Connections are replayed when at least one of the endpoints is accepted.
+ * Used to make monitors see clients again after they were forgotten. */
+bool
+graph_proxy_replay_clients(
+  graph_proxy_handle graph,
+  void * context,
+  bool (* filter)(void * context, uint64_t client_id));
+
 bool
 graph_proxy_attach(
   graph_proxy_handle graph,
@@ -82,6 +99,27 @@ graph_proxy_connect_ports(
   uint64_t port1_id,
   uint64_t port2_id);
 
+/* Send (dis)connect request without waiting for the reply. Requests are pipelined
+ * in a batch and their replies are collected after graph_proxy_commit_requests() is called.
+ * The callback is called when the request completes, it can be NULL. */
+bool
+graph_proxy_connect_ports_async(
+  graph_proxy_handle graph,
+  uint64_t port1_id,
+  uint64_t port2_id,
+  void * context,
+  void (* callback)(void * context, uint64_t port1_id, uint64_t port2_id, bool success));
+
+bool
+graph_proxy_disconnect_ports_async(
+  graph_proxy_handle graph,
+  uint64_t port1_id,
+  uint64_t port2_id,
+  void * context,
+  void (* callback)(void * context, uint64_t port1_id, uint64_t port2_id, bool success));
+
+void graph_proxy_commit_requests(graph_proxy_handle graph);
+
 bool
 graph_proxy_disconnect_ports(
   graph_proxy_handle graph,
@@ -96,6 +134,16 @@ graph_proxy_dict_entry_set(
   const char * key,
   const char * value);
 
+/* Set several dict entries with one SetDicts call.
+ * Returns false when the call itself failed, none of the entries can be assumed set then.
+ * Otherwise failed[i] tells whether entries[i] was not set. */
+bool
+graph_proxy_dict_entries_set(
+  graph_proxy_handle graph,
+  const struct graph_proxy_dict_entry * entries,
+  size_t count,
+  bool * failed);
+
 bool
 graph_proxy_dict_entry_get(
   graph_proxy_handle graph,
@@ -104,6 +152,17 @@ graph_proxy_dict_entry_get(
   const char * key,
   char ** value);
 
+/* Get values of several keys of one object in a single round trip.
+ * values[i] is set to NULL when keys[i] is not set; the rest are malloc()ed. */
+bool
+graph_proxy_dict_entries_get(
+  graph_proxy_handle graph,
+  uint32_t object_type,
+  uint64_t object_id,
+  const char * const * keys,
+  size_t count,
+  char ** values);
+
 bool
 graph_proxy_dict_entry_drop(
   graph_proxy_handle graph,
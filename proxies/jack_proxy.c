@@ -26,6 +26,8 @@
 
 #include "jack_proxy.h"
 
+#define JACK_PROXY_MAX_ADDRESS_SIZE 1024
+
 jack_proxy_callback_server_started g_on_server_started;
 jack_proxy_callback_server_stopped g_on_server_stopped;
 jack_proxy_callback_server_appeared g_on_server_appeared;
@@ -57,8 +59,13 @@ on_jack_server_stopped(
   }
 }
 
+static void on_jack_parameter_value_changed(void * context, DBusMessage * message_ptr);
+
 static void on_jack_life_status_changed(bool appeared)
 {
+  /* jackdbus restarted or gone, the cached configuration is not trusted anymore */
+  jack_proxy_conf_snapshot_invalidate();
+
   if (appeared)
   {
     log_debug("JACK serivce appeared");
@@ -86,6 +93,12 @@ static struct cdbus_signal_hook g_control_signal_hooks[] =
   {NULL, NULL}
 };
 
+static struct cdbus_signal_hook g_configure_signal_hooks[] =
+{
+  {"ParameterValueChanged", on_jack_parameter_value_changed},
+  {NULL, NULL}
+};
+
 bool
 jack_proxy_init(
   jack_proxy_callback_server_started server_started,
@@ -117,6 +130,20 @@ jack_proxy_init(
     return false;
   }
 
+  if (!cdbus_register_object_signal_hooks(
+        cdbus_g_dbus_connection,
+        JACKDBUS_SERVICE_NAME,
+        JACKDBUS_OBJECT_PATH,
+        JACKDBUS_IFACE_CONFIGURE,
+        NULL,
+        g_configure_signal_hooks))
+  {
+    cdbus_unregister_object_signal_hooks(cdbus_g_dbus_connection, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL);
+    cdbus_unregister_service_lifetime_hook(cdbus_g_dbus_connection, JACKDBUS_SERVICE_NAME);
+    log_error("dbus_register_object_signal_hooks() failed for jackdbus configure interface");
+    return false;
+  }
+
   {
     bool started;
 
@@ -141,8 +168,10 @@ void
 jack_proxy_uninit(
   void)
 {
+  cdbus_unregister_object_signal_hooks(cdbus_g_dbus_connection, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONFIGURE);
   cdbus_unregister_object_signal_hooks(cdbus_g_dbus_connection, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL);
   cdbus_unregister_service_lifetime_hook(cdbus_g_dbus_connection, JACKDBUS_SERVICE_NAME);
+  jack_proxy_conf_snapshot_invalidate();
 }
 
 bool
@@ -204,8 +233,9 @@ add_address(
   return true;
 }
 
+static
 bool
-jack_proxy_read_conf_container(
+jack_proxy_read_conf_container_dbus(
   const char * address,
   void * callback_context,
   bool (* callback)(void * context, bool leaf, const char * address, char * child))
@@ -273,6 +303,7 @@ jack_proxy_read_conf_container(
   return true;
 }
 
+static
 bool
 get_variant(
   DBusMessageIter * iter_ptr,
@@ -328,8 +359,9 @@ get_variant(
   return false;
 }
 
+static
 bool
-jack_proxy_get_parameter_value(
+jack_proxy_get_parameter_value_dbus(
   const char * address,
   bool * is_set_ptr,
   struct jack_parameter_variant * parameter_ptr)
@@ -403,270 +435,1291 @@ jack_proxy_get_parameter_value(
   return true;
 }
 
-bool
-jack_proxy_set_parameter_value(
-  const char * address,
-  const struct jack_parameter_variant * parameter_ptr)
+/**********************************************************************************/
+/*                       JACK configuration snapshot                              */
+/**********************************************************************************/
+
+/* The whole jackdbus configuration tree is fetched at once, with the requests
+ * for each tree level sent as one call group. Reads are then served
+ * from memory until jackdbus reports a change that we dont know of. */
+
+struct jack_conf_node
 {
-  DBusMessage * request_ptr;
-  DBusMessage * reply_ptr;
-  DBusMessageIter top_iter;
-  const char * reply_signature;
-  int type;
-  const void * value_ptr;
-  dbus_bool_t boolean;
+  struct list_head siblings;
+  struct list_head children;
+  struct list_head fetch_siblings;  /* used while the snapshot is fetched */
+  struct jack_conf_node * parent_ptr;
+  char * name;
+  bool leaf;                        /* whether the node is a parameter */
+  bool children_leafs;              /* whether the children are parameters */
+  bool is_set;
+  bool value_valid;                 /* whether value is known */
+  bool staged;                      /* whether staged_value is the value to apply */
+  struct jack_parameter_variant default_value;
+  struct jack_parameter_variant value;
+  struct jack_parameter_variant staged_value;
+};
 
-  switch (parameter_ptr->type)
-  {
-  case jack_int32:
-    type = DBUS_TYPE_INT32;
-    value_ptr = &parameter_ptr->value.int32;
-    break;
-  case jack_uint32:
-    type = DBUS_TYPE_UINT32;
-    value_ptr = &parameter_ptr->value.uint32;
-    break;
-  case jack_byte:
-    type = DBUS_TYPE_BYTE;
-    value_ptr = &parameter_ptr->value.byte;
-    break;
-  case jack_string:
-    type = DBUS_TYPE_STRING;
-    value_ptr = &parameter_ptr->value.string;
-    break;
-  case jack_boolean:
-    type = DBUS_TYPE_BOOLEAN;
-    boolean = parameter_ptr->value.boolean;
-    value_ptr = &boolean;
-    break;
-  default:
-    log_error("Unknown jack parameter type %i", (int)parameter_ptr->type);
-    return false;
-  }
+static struct jack_conf_node * g_conf_snapshot;
+static unsigned int g_conf_generation;
 
-  request_ptr = dbus_message_new_method_call(JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONFIGURE, "SetParameterValue");
-  if (request_ptr == NULL)
+static void jack_parameter_variant_free(struct jack_parameter_variant * parameter_ptr)
+{
+  if (parameter_ptr->type == jack_string)
   {
-    log_error("dbus_message_new_method_call() failed.");
-    return false;
+    free(parameter_ptr->value.string);
+    parameter_ptr->value.string = NULL;
   }
+}
 
-  dbus_message_iter_init_append(request_ptr, &top_iter);
+static
+bool
+jack_parameter_variant_copy(
+  struct jack_parameter_variant * dst_ptr,
+  const struct jack_parameter_variant * src_ptr)
+{
+  char * string;
 
-  if (!add_address(&top_iter, address))
+  if (src_ptr->type == jack_string)
   {
-    dbus_message_unref(request_ptr);
-    return false;
-  }
+    string = strdup(src_ptr->value.string);
+    if (string == NULL)
+    {
+      log_error("strdup failed.");
+      return false;
+    }
 
-  if (!cdbus_iter_append_variant(&top_iter, type, value_ptr))
-  {
-    dbus_message_unref(request_ptr);
-    return false;
+    jack_parameter_variant_free(dst_ptr);
+    dst_ptr->type = jack_string;
+    dst_ptr->value.string = string;
+    return true;
   }
 
-  reply_ptr = cdbus_call_raw(0, request_ptr);
-  dbus_message_unref(request_ptr);
-  if (reply_ptr == NULL)
+  jack_parameter_variant_free(dst_ptr);
+  *dst_ptr = *src_ptr;
+  return true;
+}
+
+static
+bool
+jack_parameter_variant_equal(
+  const struct jack_parameter_variant * a_ptr,
+  const struct jack_parameter_variant * b_ptr)
+{
+  if (a_ptr->type != b_ptr->type)
   {
     return false;
   }
 
-  reply_signature = dbus_message_get_signature(reply_ptr);
-
-  dbus_message_unref(reply_ptr);
-
-  if (strcmp(reply_signature, "") != 0)
+  switch (a_ptr->type)
   {
-    log_error("SetParameterValue() reply signature mismatch. '%s'", reply_signature);
+  case jack_byte:
+    return a_ptr->value.byte == b_ptr->value.byte;
+  case jack_boolean:
+    return a_ptr->value.boolean == b_ptr->value.boolean;
+  case jack_int32:
+    return a_ptr->value.int32 == b_ptr->value.int32;
+  case jack_uint32:
+    return a_ptr->value.uint32 == b_ptr->value.uint32;
+  case jack_string:
+    return strcmp(a_ptr->value.string, b_ptr->value.string) == 0;
+  default:
     return false;
   }
-
-  return true;
 }
 
-bool
-jack_proxy_reset_parameter_value(
-  const char * address)
+static struct jack_conf_node * jack_conf_node_create(struct jack_conf_node * parent_ptr, const char * name, bool leaf)
 {
-  DBusMessage * request_ptr;
-  DBusMessage * reply_ptr;
-  DBusMessageIter top_iter;
-  const char * reply_signature;
+  struct jack_conf_node * node_ptr;
 
-  request_ptr = dbus_message_new_method_call(JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONFIGURE, "ResetParameterValue");
-  if (request_ptr == NULL)
+  node_ptr = malloc(sizeof(struct jack_conf_node));
+  if (node_ptr == NULL)
   {
-    log_error("dbus_message_new_method_call() failed.");
-    return false;
+    log_error("malloc() failed to allocate struct jack_conf_node");
+    return NULL;
   }
 
-  dbus_message_iter_init_append(request_ptr, &top_iter);
-
-  if (!add_address(&top_iter, address))
+  node_ptr->name = strdup(name);
+  if (node_ptr->name == NULL)
   {
-    dbus_message_unref(request_ptr);
-    return false;
+    log_error("strdup() failed for jack conf node name '%s'", name);
+    free(node_ptr);
+    return NULL;
   }
 
-  reply_ptr = cdbus_call_raw(0, request_ptr);
-  dbus_message_unref(request_ptr);
-  if (reply_ptr == NULL)
+  INIT_LIST_HEAD(&node_ptr->children);
+  INIT_LIST_HEAD(&node_ptr->fetch_siblings);
+  node_ptr->parent_ptr = parent_ptr;
+  node_ptr->leaf = leaf;
+  node_ptr->children_leafs = false;
+  node_ptr->is_set = false;
+  node_ptr->value_valid = false;
+  node_ptr->staged = false;
+  node_ptr->default_value.type = jack_boolean;
+  node_ptr->value.type = jack_boolean;
+  node_ptr->staged_value.type = jack_boolean;
+
+  if (parent_ptr != NULL)
   {
-    return false;
+    list_add_tail(&node_ptr->siblings, &parent_ptr->children);
   }
-
-  reply_signature = dbus_message_get_signature(reply_ptr);
-
-  dbus_message_unref(reply_ptr);
-
-  if (strcmp(reply_signature, "") != 0)
+  else
   {
-    log_error("ResetParameterValue() reply signature mismatch. '%s'", reply_signature);
-    return false;
+    INIT_LIST_HEAD(&node_ptr->siblings);
   }
 
-  return true;
-}
-
-bool jack_proxy_start_server(void)
-{
-  return cdbus_call(7000, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "StartServer", "", "");
-}
-
-bool jack_proxy_stop_server(void)
-{
-  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "StopServer", "", "");
+  return node_ptr;
 }
 
-bool jack_proxy_is_realtime(bool * realtime_ptr)
+static void jack_conf_node_destroy(struct jack_conf_node * node_ptr)
 {
-  dbus_bool_t realtime;
-
-  if (!cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "IsStarted", "", "b", &realtime))
+  while (!list_empty(&node_ptr->children))
   {
-    return false;
+    jack_conf_node_destroy(list_entry(node_ptr->children.next, struct jack_conf_node, siblings));
   }
 
-  *realtime_ptr = realtime;
-  return true;
-}
-
-bool jack_proxy_sample_rate(uint32_t * sample_rate_ptr)
-{
-  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "GetSampleRate", "", "u", sample_rate_ptr);
-}
-
-bool jack_proxy_get_xruns(uint32_t * xruns_ptr)
-{
-  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "GetXruns", "", "u", xruns_ptr);
+  list_del(&node_ptr->siblings);
+  jack_parameter_variant_free(&node_ptr->default_value);
+  jack_parameter_variant_free(&node_ptr->value);
+  jack_parameter_variant_free(&node_ptr->staged_value);
+  free(node_ptr->name);
+  free(node_ptr);
 }
 
-bool jack_proxy_get_dsp_load(double * dsp_load_ptr)
+/* Used when the snapshot cannot be updated with the new value.
+ * The tree itself is not destroyed because this can happen while it is being iterated.
+ * Parameter with unknown value is never skipped when set or reset. */
+static void jack_conf_node_forget_value(struct jack_conf_node * node_ptr)
 {
-  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "GetLoad", "", "d", dsp_load_ptr);
+  jack_parameter_variant_free(&node_ptr->value);
+  node_ptr->value.type = jack_boolean;
+  node_ptr->value_valid = false;
 }
 
-bool jack_proxy_get_buffer_size(uint32_t * size_ptr)
+/* engine/driver selects the driver, its value determines the contents of the driver container */
+static bool jack_conf_node_is_driver_selector(struct jack_conf_node * node_ptr)
 {
-  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "GetBufferSize", "", "u", size_ptr);
+  return
+    node_ptr->leaf &&
+    strcmp(node_ptr->name, "driver") == 0 &&
+    node_ptr->parent_ptr != NULL &&
+    strcmp(node_ptr->parent_ptr->name, "engine") == 0 &&
+    node_ptr->parent_ptr->parent_ptr == g_conf_snapshot;
 }
 
-bool jack_proxy_set_buffer_size(uint32_t size)
+void jack_proxy_conf_snapshot_invalidate(void)
 {
-  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "SetBufferSize", "u", &size, "");
+  if (g_conf_snapshot != NULL)
+  {
+    log_debug("JACK configuration snapshot invalidated");
+    jack_conf_node_destroy(g_conf_snapshot);
+    g_conf_snapshot = NULL;
+    g_conf_generation++;
+  }
 }
 
-bool jack_proxy_reset_xruns(void)
+unsigned int jack_proxy_conf_generation(void)
 {
-  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "ResetXruns", "", "");
+  return g_conf_generation;
 }
 
-static
-bool
-reset_callback(
-  void * context,
-  bool leaf,
-  const char * address,
-  char * child)
+/* compose the zero separated, double zero terminated address of a node */
+static char * jack_conf_node_compose_address(struct jack_conf_node * node_ptr, char * dst, char * end)
 {
-  const char * component;
-  char * dst;
   size_t len;
 
-  component = address;
-  while (*component != 0)
-  {
-    component += strlen(component) + 1;
-  }
-
-  /* address always is same buffer as the one in the jack_reset_all_params() stack */
-  dst = (char *)component;
-
-  len = strlen(child) + 1;
-  memcpy(dst, child, len);
-  dst[len] = 0;
-
-  if (leaf)
+  if (node_ptr->parent_ptr != NULL) /* the root node has no address component */
   {
-    if (!jack_proxy_reset_parameter_value(address))
+    dst = jack_conf_node_compose_address(node_ptr->parent_ptr, dst, end);
+    if (dst == NULL)
     {
-      log_error("cannot reset value of parameter");
-      return false;
+      return NULL;
     }
-  }
-  else
-  {
-    if (!jack_proxy_read_conf_container(address, context, reset_callback))
+
+    len = strlen(node_ptr->name) + 1;
+    if ((size_t)(end - dst) < len + 1)
     {
-      log_error("cannot read container");
-      return false;
+      log_error("jack conf address too long");
+      return NULL;
     }
+
+    memcpy(dst, node_ptr->name, len);
+    dst += len;
   }
 
   *dst = 0;
-
-  return true;
+  return dst;
 }
 
-bool jack_reset_all_params(void)
+static struct jack_conf_node * jack_conf_snapshot_lookup(const char * address)
 {
-  char address[1024] = "";
+  struct jack_conf_node * node_ptr;
+  struct jack_conf_node * child_ptr;
+  struct list_head * list_node_ptr;
 
-  return jack_proxy_read_conf_container(address, NULL, reset_callback);
-}
+  node_ptr = g_conf_snapshot;
 
-struct jack_proxy_session_save_one_reply_cookie
-{
-  void * context;
-  void (* callback)(void * context, const char * commandline);
-};
+  if (address == NULL)
+  {
+    return node_ptr;
+  }
 
-#define cookie_ptr ((struct jack_proxy_session_save_one_reply_cookie *)void_cookie)
+  while (node_ptr != NULL && *address != 0)
+  {
+    child_ptr = NULL;
+    list_for_each(list_node_ptr, &node_ptr->children)
+    {
+      child_ptr = list_entry(list_node_ptr, struct jack_conf_node, siblings);
+      if (strcmp(child_ptr->name, address) == 0)
+      {
+        break;
+      }
 
-static void jack_proxy_session_save_one_handle_reply(void * UNUSED(context), void * void_cookie, DBusMessage * reply_ptr)
+      child_ptr = NULL;
+    }
+
+    node_ptr = child_ptr;
+    address += strlen(address) + 1;
+  }
+
+  return node_ptr;
+}
+
+static DBusMessage * jack_conf_node_new_request(struct jack_conf_node * node_ptr, const char * method)
 {
-  const char * reply_signature;
+  char address[JACK_PROXY_MAX_ADDRESS_SIZE];
+  DBusMessage * request_ptr;
   DBusMessageIter top_iter;
-  DBusMessageIter array_iter;
-  DBusMessageIter struct_iter;
-  const char * uuid;
-  const char * client_name;
-  const char * commandline;
-  uint32_t flags;
 
-  if (reply_ptr == NULL)
+  if (jack_conf_node_compose_address(node_ptr, address, address + sizeof(address)) == NULL)
   {
-    cookie_ptr->callback(cookie_ptr->context, NULL);
-    return;
+    return NULL;
   }
 
-  reply_signature = dbus_message_get_signature(reply_ptr);
-
-  if (strcmp(reply_signature, "a(sssu)") != 0)
+  request_ptr = dbus_message_new_method_call(JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONFIGURE, method);
+  if (request_ptr == NULL)
   {
-    log_error(JACKDBUS_IFACE_SESSMGR ".Notify() reply signature mismatch. '%s'", reply_signature);
-    return;
+    log_error("dbus_message_new_method_call() failed.");
+    return NULL;
+  }
+
+  dbus_message_iter_init_append(request_ptr, &top_iter);
+
+  if (!add_address(&top_iter, address))
+  {
+    dbus_message_unref(request_ptr);
+    return NULL;
+  }
+
+  return request_ptr;
+}
+
+struct jack_conf_fetch_context
+{
+  struct list_head containers;      /* containers of the current tree level */
+  struct list_head next_containers; /* containers of the next tree level */
+  struct list_head parameters;
+  bool ok;
+};
+
+/* send request for each node in the list, as one call group, and wait for all replies */
+static
+bool
+jack_conf_fetch_level(
+  struct jack_conf_fetch_context * ctx_ptr,
+  struct list_head * nodes_ptr,
+  const char * method,
+  const char * output_signature,
+  void (* callback)(void * context, void * cookie, DBusMessage * reply_ptr))
+{
+  cdbus_call_group_handle group;
+  struct list_head * list_node_ptr;
+  struct jack_conf_node * node_ptr;
+  DBusMessage * request_ptr;
+  bool ret;
+
+  if (!cdbus_call_group_create(0, &group))
+  {
+    return false;
+  }
+
+  ret = true;
+
+  list_for_each(list_node_ptr, nodes_ptr)
+  {
+    node_ptr = list_entry(list_node_ptr, struct jack_conf_node, fetch_siblings);
+
+    request_ptr = jack_conf_node_new_request(node_ptr, method);
+    if (request_ptr == NULL)
+    {
+      ret = false;
+      break;
+    }
+
+    ret = cdbus_call_group_add(group, request_ptr, output_signature, ctx_ptr, &node_ptr, sizeof(node_ptr), callback);
+    dbus_message_unref(request_ptr);
+    if (!ret)
+    {
+      break;
+    }
+  }
+
+  /* wait even after a failure, for the already sent calls */
+  if (!cdbus_call_group_wait(group))
+  {
+    log_error("%u of JACK configuration %s() calls failed: %s", cdbus_call_group_get_failed_count(group), method, cdbus_call_last_error_get_message());
+    ret = false;
+  }
+
+  cdbus_call_group_destroy(group);
+
+  while (!list_empty(nodes_ptr))
+  {
+    list_del_init(nodes_ptr->next);
+  }
+
+  return ret;
+}
+
+#define ctx_ptr ((struct jack_conf_fetch_context *)context)
+#define node_ptr (*(struct jack_conf_node **)cookie)
+
+static void jack_conf_read_container_reply(void * context, void * cookie, DBusMessage * reply_ptr)
+{
+  DBusMessageIter top_iter;
+  DBusMessageIter array_iter;
+  dbus_bool_t leaf;
+  const char * child;
+  struct jack_conf_node * child_ptr;
+
+  if (reply_ptr == NULL)
+  {
+    ctx_ptr->ok = false;
+    return;
+  }
+
+  dbus_message_iter_init(reply_ptr, &top_iter);
+
+  dbus_message_iter_get_basic(&top_iter, &leaf);
+  dbus_message_iter_next(&top_iter);
+
+  node_ptr->children_leafs = leaf;
+
+  for (dbus_message_iter_recurse(&top_iter, &array_iter);
+       dbus_message_iter_get_arg_type(&array_iter) != DBUS_TYPE_INVALID;
+       dbus_message_iter_next(&array_iter))
+  {
+    dbus_message_iter_get_basic(&array_iter, &child);
+
+    child_ptr = jack_conf_node_create(node_ptr, child, leaf);
+    if (child_ptr == NULL)
+    {
+      ctx_ptr->ok = false;
+      return;
+    }
+
+    list_add_tail(&child_ptr->fetch_siblings, leaf ? &ctx_ptr->parameters : &ctx_ptr->next_containers);
+  }
+}
+
+static void jack_conf_get_parameter_reply(void * context, void * cookie, DBusMessage * reply_ptr)
+{
+  DBusMessageIter top_iter;
+  dbus_bool_t is_set;
+
+  if (reply_ptr == NULL)
+  {
+    ctx_ptr->ok = false;
+    return;
+  }
+
+  dbus_message_iter_init(reply_ptr, &top_iter);
+
+  dbus_message_iter_get_basic(&top_iter, &is_set);
+  dbus_message_iter_next(&top_iter);
+
+  if (!get_variant(&top_iter, &node_ptr->default_value))
+  {
+    ctx_ptr->ok = false;
+    return;
+  }
+
+  dbus_message_iter_next(&top_iter);
+
+  if (!get_variant(&top_iter, &node_ptr->value))
+  {
+    ctx_ptr->ok = false;
+    return;
+  }
+
+  node_ptr->is_set = is_set;
+  node_ptr->value_valid = true;
+}
+
+#undef node_ptr
+#undef ctx_ptr
+
+/* fetch the subtree of a container node that has no children yet */
+static bool jack_conf_fetch_tree(struct jack_conf_node * root_ptr)
+{
+  struct jack_conf_fetch_context ctx;
+  struct list_head * list_node_ptr;
+  unsigned int round_trips;
+  unsigned int count;
+
+  INIT_LIST_HEAD(&ctx.containers);
+  INIT_LIST_HEAD(&ctx.next_containers);
+  INIT_LIST_HEAD(&ctx.parameters);
+  list_add_tail(&root_ptr->fetch_siblings, &ctx.containers);
+  ctx.ok = true;
+
+  round_trips = 0;
+
+  while (!list_empty(&ctx.containers))
+  {
+    round_trips++;
+
+    if (!jack_conf_fetch_level(&ctx, &ctx.containers, "ReadContainer", "bas", jack_conf_read_container_reply))
+    {
+      ctx.ok = false;
+    }
+
+    if (!ctx.ok)
+    {
+      while (!list_empty(&ctx.next_containers))
+      {
+        list_del_init(ctx.next_containers.next);
+      }
+
+      break;
+    }
+
+    list_splice_init(&ctx.next_containers, &ctx.containers);
+  }
+
+  count = 0;
+  list_for_each(list_node_ptr, &ctx.parameters)
+  {
+    count++;
+  }
+
+  if (ctx.ok)
+  {
+    round_trips++;
+
+    if (!jack_conf_fetch_level(&ctx, &ctx.parameters, "GetParameterValue", "bvv", jack_conf_get_parameter_reply))
+    {
+      ctx.ok = false;
+    }
+  }
+
+  while (!list_empty(&ctx.parameters))
+  {
+    list_del_init(ctx.parameters.next);
+  }
+
+  if (!ctx.ok)
+  {
+    return false;
+  }
+
+  log_info("JACK configuration fetched, %u parameters in %u round trips", count, round_trips);
+  return true;
+}
+
+bool jack_proxy_conf_snapshot_fetch(void)
+{
+  struct jack_conf_node * root_ptr;
+
+  if (g_conf_snapshot != NULL)
+  {
+    return true;
+  }
+
+  root_ptr = jack_conf_node_create(NULL, "", false);
+  if (root_ptr == NULL)
+  {
+    return false;
+  }
+
+  if (!jack_conf_fetch_tree(root_ptr))
+  {
+    log_error("fetching of JACK configuration snapshot failed");
+    jack_conf_node_destroy(root_ptr);
+    return false;
+  }
+
+  g_conf_snapshot = root_ptr;
+  g_conf_generation++;
+  return true;
+}
+
+/* The parameters in the driver container belong to the selected driver.
+ * After engine/driver is changed, the container is refetched. */
+static void jack_conf_driver_refetch(void)
+{
+  struct jack_conf_node * driver_ptr;
+
+  g_conf_generation++;
+
+  driver_ptr = jack_conf_snapshot_lookup("driver\0");
+  if (driver_ptr == NULL || driver_ptr->leaf)
+  {
+    jack_proxy_conf_snapshot_invalidate();
+    return;
+  }
+
+  log_debug("JACK driver changed, refetching the driver parameters");
+
+  while (!list_empty(&driver_ptr->children))
+  {
+    jack_conf_node_destroy(list_entry(driver_ptr->children.next, struct jack_conf_node, siblings));
+  }
+
+  driver_ptr->children_leafs = false;
+
+  if (!jack_conf_fetch_tree(driver_ptr))
+  {
+    log_error("refetching of JACK driver parameters failed");
+    jack_proxy_conf_snapshot_invalidate();
+  }
+}
+
+static
+void
+on_jack_parameter_value_changed(
+  void * UNUSED(context),
+  DBusMessage * message_ptr)
+{
+  char address[JACK_PROXY_MAX_ADDRESS_SIZE];
+  char * dst;
+  const char * component;
+  size_t len;
+  DBusMessageIter top_iter;
+  DBusMessageIter array_iter;
+  struct jack_conf_node * node_ptr;
+  struct jack_parameter_variant value;
+
+  if (g_conf_snapshot == NULL)
+  {
+    return;
+  }
+
+  if (strcmp(dbus_message_get_signature(message_ptr), "asv") != 0)
+  {
+    goto invalidate;
+  }
+
+  dbus_message_iter_init(message_ptr, &top_iter);
+
+  dst = address;
+  for (dbus_message_iter_recurse(&top_iter, &array_iter);
+       dbus_message_iter_get_arg_type(&array_iter) != DBUS_TYPE_INVALID;
+       dbus_message_iter_next(&array_iter))
+  {
+    dbus_message_iter_get_basic(&array_iter, &component);
+    len = strlen(component) + 1;
+    if ((size_t)(address + sizeof(address) - dst) < len + 1)
+    {
+      goto invalidate;
+    }
+
+    memcpy(dst, component, len);
+    dst += len;
+  }
+  *dst = 0;
+
+  dbus_message_iter_next(&top_iter);
+
+  node_ptr = jack_conf_snapshot_lookup(address);
+  if (node_ptr == NULL || !node_ptr->leaf)
+  {
+    goto invalidate;
+  }
+
+  if (!get_variant(&top_iter, &value))
+  {
+    goto invalidate;
+  }
+
+  if (node_ptr->value_valid && jack_parameter_variant_equal(&node_ptr->value, &value))
+  {
+    /* most likely notification about change made through us */
+    jack_parameter_variant_free(&value);
+    return;
+  }
+
+  jack_parameter_variant_free(&value);
+
+invalidate:
+  jack_proxy_conf_snapshot_invalidate();
+}
+
+bool
+jack_proxy_read_conf_container(
+  const char * address,
+  void * callback_context,
+  bool (* callback)(void * context, bool leaf, const char * address, char * child))
+{
+  struct jack_conf_node * node_ptr;
+  struct list_head * list_node_ptr;
+
+  if (jack_proxy_conf_snapshot_fetch())
+  {
+    node_ptr = jack_conf_snapshot_lookup(address);
+    if (node_ptr != NULL && !node_ptr->leaf)
+    {
+      list_for_each(list_node_ptr, &node_ptr->children)
+      {
+        if (!callback(callback_context, node_ptr->children_leafs, address, list_entry(list_node_ptr, struct jack_conf_node, siblings)->name))
+        {
+          break;
+        }
+      }
+
+      return true;
+    }
+  }
+
+  return jack_proxy_read_conf_container_dbus(address, callback_context, callback);
+}
+
+bool
+jack_proxy_get_parameter_value(
+  const char * address,
+  bool * is_set_ptr,
+  struct jack_parameter_variant * parameter_ptr)
+{
+  struct jack_conf_node * node_ptr;
+
+  if (jack_proxy_conf_snapshot_fetch())
+  {
+    node_ptr = jack_conf_snapshot_lookup(address);
+    if (node_ptr != NULL && node_ptr->leaf && node_ptr->value_valid)
+    {
+      parameter_ptr->type = jack_boolean; /* nothing to free */
+      if (!jack_parameter_variant_copy(parameter_ptr, &node_ptr->value))
+      {
+        return false;
+      }
+
+      *is_set_ptr = node_ptr->is_set;
+      return true;
+    }
+  }
+
+  return jack_proxy_get_parameter_value_dbus(address, is_set_ptr, parameter_ptr);
+}
+
+static
+DBusMessage *
+jack_proxy_new_set_parameter_request(
+  const char * address,
+  const struct jack_parameter_variant * parameter_ptr)
+{
+  DBusMessage * request_ptr;
+  DBusMessageIter top_iter;
+  int type;
+  const void * value_ptr;
+  dbus_bool_t boolean;
+
+  switch (parameter_ptr->type)
+  {
+  case jack_int32:
+    type = DBUS_TYPE_INT32;
+    value_ptr = &parameter_ptr->value.int32;
+    break;
+  case jack_uint32:
+    type = DBUS_TYPE_UINT32;
+    value_ptr = &parameter_ptr->value.uint32;
+    break;
+  case jack_byte:
+    type = DBUS_TYPE_BYTE;
+    value_ptr = &parameter_ptr->value.byte;
+    break;
+  case jack_string:
+    type = DBUS_TYPE_STRING;
+    value_ptr = &parameter_ptr->value.string;
+    break;
+  case jack_boolean:
+    type = DBUS_TYPE_BOOLEAN;
+    boolean = parameter_ptr->value.boolean;
+    value_ptr = &boolean;
+    break;
+  default:
+    log_error("Unknown jack parameter type %i", (int)parameter_ptr->type);
+    return NULL;
+  }
+
+  request_ptr = dbus_message_new_method_call(JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONFIGURE, "SetParameterValue");
+  if (request_ptr == NULL)
+  {
+    log_error("dbus_message_new_method_call() failed.");
+    return NULL;
+  }
+
+  dbus_message_iter_init_append(request_ptr, &top_iter);
+
+  if (!add_address(&top_iter, address))
+  {
+    dbus_message_unref(request_ptr);
+    return NULL;
+  }
+
+  if (!cdbus_iter_append_variant(&top_iter, type, value_ptr))
+  {
+    dbus_message_unref(request_ptr);
+    return NULL;
+  }
+
+  return request_ptr;
+}
+
+static DBusMessage * jack_proxy_new_reset_parameter_request(const char * address)
+{
+  DBusMessage * request_ptr;
+  DBusMessageIter top_iter;
+
+  request_ptr = dbus_message_new_method_call(JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONFIGURE, "ResetParameterValue");
+  if (request_ptr == NULL)
+  {
+    log_error("dbus_message_new_method_call() failed.");
+    return NULL;
+  }
+
+  dbus_message_iter_init_append(request_ptr, &top_iter);
+
+  if (!add_address(&top_iter, address))
+  {
+    dbus_message_unref(request_ptr);
+    return NULL;
+  }
+
+  return request_ptr;
+}
+
+/* update the snapshot after successful SetParameterValue() or ResetParameterValue() */
+static void jack_conf_node_value_changed(struct jack_conf_node * node_ptr, const struct jack_parameter_variant * parameter_ptr)
+{
+  if (jack_parameter_variant_copy(&node_ptr->value, parameter_ptr != NULL ? parameter_ptr : &node_ptr->default_value))
+  {
+    node_ptr->is_set = parameter_ptr != NULL;
+    node_ptr->value_valid = true;
+  }
+  else
+  {
+    jack_conf_node_forget_value(node_ptr);
+  }
+}
+
+bool
+jack_proxy_set_parameter_value(
+  const char * address,
+  const struct jack_parameter_variant * parameter_ptr)
+{
+  DBusMessage * request_ptr;
+  DBusMessage * reply_ptr;
+  const char * reply_signature;
+  struct jack_conf_node * node_ptr;
+
+  node_ptr = jack_conf_snapshot_lookup(address);
+  if (node_ptr != NULL && node_ptr->leaf && node_ptr->value_valid && node_ptr->is_set && jack_parameter_variant_equal(&node_ptr->value, parameter_ptr))
+  {
+    log_debug("Not setting JACK parameter to the value it already has");
+    return true;
+  }
+
+  request_ptr = jack_proxy_new_set_parameter_request(address, parameter_ptr);
+  if (request_ptr == NULL)
+  {
+    return false;
+  }
+
+  reply_ptr = cdbus_call_raw(0, request_ptr);
+  dbus_message_unref(request_ptr);
+  if (reply_ptr == NULL)
+  {
+    return false;
+  }
+
+  reply_signature = dbus_message_get_signature(reply_ptr);
+
+  dbus_message_unref(reply_ptr);
+
+  if (strcmp(reply_signature, "") != 0)
+  {
+    log_error("SetParameterValue() reply signature mismatch. '%s'", reply_signature);
+    return false;
+  }
+
+  if (node_ptr != NULL && node_ptr->leaf)
+  {
+    jack_conf_node_value_changed(node_ptr, parameter_ptr);
+    g_conf_generation++;
+
+    if (jack_conf_node_is_driver_selector(node_ptr))
+    {
+      jack_conf_driver_refetch();
+    }
+  }
+
+  return true;
+}
+
+bool
+jack_proxy_reset_parameter_value(
+  const char * address)
+{
+  DBusMessage * request_ptr;
+  DBusMessage * reply_ptr;
+  const char * reply_signature;
+  struct jack_conf_node * node_ptr;
+
+  node_ptr = jack_conf_snapshot_lookup(address);
+  if (node_ptr != NULL && node_ptr->leaf && node_ptr->value_valid && !node_ptr->is_set)
+  {
+    return true;                /* already has its default value */
+  }
+
+  request_ptr = jack_proxy_new_reset_parameter_request(address);
+  if (request_ptr == NULL)
+  {
+    return false;
+  }
+
+  reply_ptr = cdbus_call_raw(0, request_ptr);
+  dbus_message_unref(request_ptr);
+  if (reply_ptr == NULL)
+  {
+    return false;
+  }
+
+  reply_signature = dbus_message_get_signature(reply_ptr);
+
+  dbus_message_unref(reply_ptr);
+
+  if (strcmp(reply_signature, "") != 0)
+  {
+    log_error("ResetParameterValue() reply signature mismatch. '%s'", reply_signature);
+    return false;
+  }
+
+  if (node_ptr != NULL && node_ptr->leaf)
+  {
+    jack_conf_node_value_changed(node_ptr, NULL);
+    g_conf_generation++;
+
+    if (jack_conf_node_is_driver_selector(node_ptr))
+    {
+      jack_conf_driver_refetch();
+    }
+  }
+
+  return true;
+}
+
+/**********************************************************************************/
+/*                       Staged JACK configuration                                */
+/**********************************************************************************/
+
+/* The complete desired configuration is staged in the snapshot and then
+ * applied at once: parameters that already have the staged value are left
+ * alone, the others are set and the parameters that are not staged are reset.
+ * All calls are sent as one call group.
+ *
+ * engine/driver is the exception, it is applied when staged. The driver
+ * container is then refetched, so the parameters of the new driver,
+ * that are staged after it, can be compared against their current values. */
+
+static unsigned int g_conf_stage_applied; /* parameters changed while staging */
+
+bool jack_proxy_conf_stage_begin(void)
+{
+  if (!jack_proxy_conf_snapshot_fetch())
+  {
+    return false;
+  }
+
+  jack_proxy_conf_stage_abort();
+  return true;
+}
+
+/* set the parameter now, instead of when the stage is committed */
+static
+bool
+jack_conf_stage_apply(
+  struct jack_conf_node * node_ptr,
+  const char * address,
+  const struct jack_parameter_variant * parameter_ptr)
+{
+  unsigned int generation;
+
+  generation = g_conf_generation;
+
+  if (!jack_proxy_set_parameter_value(address, parameter_ptr))
+  {
+    return false;
+  }
+
+  /* the snapshot is not updated for unknown parameters */
+  if (node_ptr == NULL || generation != g_conf_generation)
+  {
+    g_conf_stage_applied++;
+  }
+
+  if (node_ptr != NULL && g_conf_snapshot != NULL)
+  {
+    /* stage the value too, so that the commit does not reset it;
+       node is not destroyed by the driver container refetch */
+    if (!jack_parameter_variant_copy(&node_ptr->staged_value, parameter_ptr))
+    {
+      return false;
+    }
+
+    node_ptr->staged = true;
+  }
+
+  return true;
+}
+
+bool
+jack_proxy_conf_stage_set(
+  const char * address,
+  const struct jack_parameter_variant * parameter_ptr)
+{
+  struct jack_conf_node * node_ptr;
+
+  node_ptr = jack_conf_snapshot_lookup(address);
+  if (node_ptr == NULL || !node_ptr->leaf)
+  {
+    /* most likely parameter of a driver that is not available */
+    log_info("JACK parameter is not in the configuration snapshot, setting it directly");
+    return jack_conf_stage_apply(NULL, address, parameter_ptr);
+  }
+
+  if (jack_conf_node_is_driver_selector(node_ptr))
+  {
+    return jack_conf_stage_apply(node_ptr, address, parameter_ptr);
+  }
+
+  if (!jack_parameter_variant_copy(&node_ptr->staged_value, parameter_ptr))
+  {
+    return false;
+  }
+
+  node_ptr->staged = true;
+  return true;
+}
+
+static void jack_conf_node_unstage(struct jack_conf_node * node_ptr)
+{
+  struct list_head * list_node_ptr;
+
+  jack_parameter_variant_free(&node_ptr->staged_value);
+  node_ptr->staged_value.type = jack_boolean;
+  node_ptr->staged = false;
+
+  list_for_each(list_node_ptr, &node_ptr->children)
+  {
+    jack_conf_node_unstage(list_entry(list_node_ptr, struct jack_conf_node, siblings));
+  }
+}
+
+void jack_proxy_conf_stage_abort(void)
+{
+  g_conf_stage_applied = 0;
+
+  if (g_conf_snapshot != NULL)
+  {
+    jack_conf_node_unstage(g_conf_snapshot);
+  }
+}
+
+struct jack_conf_commit_context
+{
+  cdbus_call_group_handle group;
+  unsigned int count;
+  bool driver_changed;
+};
+
+#define ctx_ptr ((struct jack_conf_commit_context *)context)
+#define node_ptr (*(struct jack_conf_node **)cookie)
+
+static void jack_conf_commit_reply(void * context, void * cookie, DBusMessage * reply_ptr)
+{
+  if (jack_conf_node_is_driver_selector(node_ptr))
+  {
+    /* even a failed call may have changed the driver */
+    ctx_ptr->driver_changed = true;
+  }
+
+  if (reply_ptr == NULL)
+  {
+    /* the actual value is not known anymore */
+    jack_conf_node_forget_value(node_ptr);
+    return;
+  }
+
+  jack_conf_node_value_changed(node_ptr, node_ptr->staged ? &node_ptr->staged_value : NULL);
+}
+
+#undef node_ptr
+#undef ctx_ptr
+
+static bool jack_conf_commit_node(struct jack_conf_commit_context * ctx_ptr, struct jack_conf_node * node_ptr)
+{
+  char address[JACK_PROXY_MAX_ADDRESS_SIZE];
+  struct list_head * list_node_ptr;
+  DBusMessage * request_ptr;
+  bool ret;
+
+  if (!node_ptr->leaf)
+  {
+    list_for_each(list_node_ptr, &node_ptr->children)
+    {
+      if (!jack_conf_commit_node(ctx_ptr, list_entry(list_node_ptr, struct jack_conf_node, siblings)))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  if (node_ptr->value_valid &&
+      (node_ptr->staged ?
+       node_ptr->is_set && jack_parameter_variant_equal(&node_ptr->value, &node_ptr->staged_value) :
+       !node_ptr->is_set))
+  {
+    return true;                /* already has the desired value */
+  }
+
+  if (jack_conf_node_compose_address(node_ptr, address, address + sizeof(address)) == NULL)
+  {
+    return false;
+  }
+
+  if (node_ptr->staged)
+  {
+    request_ptr = jack_proxy_new_set_parameter_request(address, &node_ptr->staged_value);
+  }
+  else
+  {
+    request_ptr = jack_proxy_new_reset_parameter_request(address);
+  }
+
+  if (request_ptr == NULL)
+  {
+    return false;
+  }
+
+  ret = cdbus_call_group_add(ctx_ptr->group, request_ptr, "", ctx_ptr, &node_ptr, sizeof(node_ptr), jack_conf_commit_reply);
+  dbus_message_unref(request_ptr);
+  if (ret)
+  {
+    ctx_ptr->count++;
+  }
+
+  return ret;
+}
+
+bool jack_proxy_conf_stage_commit(unsigned int * changed_ptr)
+{
+  struct jack_conf_commit_context ctx;
+  bool ret;
+
+  if (g_conf_snapshot == NULL)
+  {
+    log_error("JACK configuration snapshot was invalidated while staging");
+    return false;
+  }
+
+  if (!cdbus_call_group_create(0, &ctx.group))
+  {
+    jack_proxy_conf_stage_abort();
+    return false;
+  }
+
+  ctx.count = 0;
+  ctx.driver_changed = false;
+
+  ret = jack_conf_commit_node(&ctx, g_conf_snapshot);
+
+  /* wait even after a failure, for the already sent calls */
+  if (!cdbus_call_group_wait(ctx.group))
+  {
+    log_error("%u of %u JACK configuration changes failed: %s", cdbus_call_group_get_failed_count(ctx.group), ctx.count, cdbus_call_last_error_get_message());
+    ret = false;
+  }
+
+  cdbus_call_group_destroy(ctx.group);
+
+  if (ctx.count != 0)
+  {
+    g_conf_generation++;
+  }
+
+  ctx.count += g_conf_stage_applied;
+
+  log_info("%u JACK parameters changed", ctx.count);
+
+  jack_proxy_conf_stage_abort();
+
+  if (ctx.driver_changed)
+  {
+    jack_conf_driver_refetch();
+  }
+
+  *changed_ptr = ctx.count;
+  return ret;
+}
+
+bool jack_proxy_start_server(void)
+{
+  return cdbus_call(7000, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "StartServer", "", "");
+}
+
+bool jack_proxy_stop_server(void)
+{
+  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "StopServer", "", "");
+}
+
+bool jack_proxy_is_realtime(bool * realtime_ptr)
+{
+  dbus_bool_t realtime;
+
+  if (!cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "IsStarted", "", "b", &realtime))
+  {
+    return false;
+  }
+
+  *realtime_ptr = realtime;
+  return true;
+}
+
+bool jack_proxy_sample_rate(uint32_t * sample_rate_ptr)
+{
+  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "GetSampleRate", "", "u", sample_rate_ptr);
+}
+
+bool jack_proxy_get_xruns(uint32_t * xruns_ptr)
+{
+  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "GetXruns", "", "u", xruns_ptr);
+}
+
+bool jack_proxy_get_dsp_load(double * dsp_load_ptr)
+{
+  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "GetLoad", "", "d", dsp_load_ptr);
+}
+
+bool jack_proxy_get_buffer_size(uint32_t * size_ptr)
+{
+  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "GetBufferSize", "", "u", size_ptr);
+}
+
+bool jack_proxy_set_buffer_size(uint32_t size)
+{
+  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "SetBufferSize", "u", &size, "");
+}
+
+bool jack_proxy_reset_xruns(void)
+{
+  return cdbus_call(0, JACKDBUS_SERVICE_NAME, JACKDBUS_OBJECT_PATH, JACKDBUS_IFACE_CONTROL, "ResetXruns", "", "");
+}
+
+static
+bool
+reset_callback(
+  void * context,
+  bool leaf,
+  const char * address,
+  char * child)
+{
+  const char * component;
+  char * dst;
+  size_t len;
+
+  component = address;
+  while (*component != 0)
+  {
+    component += strlen(component) + 1;
+  }
+
+  /* address always is same buffer as the one in the jack_reset_all_params() stack */
+  dst = (char *)component;
+
+  len = strlen(child) + 1;
+  memcpy(dst, child, len);
+  dst[len] = 0;
+
+  if (leaf)
+  {
+    if (!jack_proxy_reset_parameter_value(address))
+    {
+      log_error("cannot reset value of parameter");
+      return false;
+    }
+  }
+  else
+  {
+    if (!jack_proxy_read_conf_container(address, context, reset_callback))
+    {
+      log_error("cannot read container");
+      return false;
+    }
+  }
+
+  *dst = 0;
+
+  return true;
+}
+
+bool jack_reset_all_params(void)
+{
+  char address[1024] = "";
+
+  return jack_proxy_read_conf_container(address, NULL, reset_callback);
+}
+
+struct jack_proxy_session_save_one_reply_cookie
+{
+  void * context;
+  void (* callback)(void * context, const char * commandline);
+};
+
+#define cookie_ptr ((struct jack_proxy_session_save_one_reply_cookie *)void_cookie)
+
+static void jack_proxy_session_save_one_handle_reply(void * UNUSED(context), void * void_cookie, DBusMessage * reply_ptr)
+{
+  const char * reply_signature;
+  DBusMessageIter top_iter;
+  DBusMessageIter array_iter;
+  DBusMessageIter struct_iter;
+  const char * uuid;
+  const char * client_name;
+  const char * commandline;
+  uint32_t flags;
+
+  if (reply_ptr == NULL)
+  {
+    cookie_ptr->callback(cookie_ptr->context, NULL);
+    return;
+  }
+
+  if (dbus_message_get_type(reply_ptr) == DBUS_MESSAGE_TYPE_ERROR)
+  {
+    log_error(JACKDBUS_IFACE_SESSMGR ".Notify() failed: %s", dbus_message_get_error_name(reply_ptr));
+    cookie_ptr->callback(cookie_ptr->context, NULL);
+    return;
+  }
+
+  reply_signature = dbus_message_get_signature(reply_ptr);
+
+  if (strcmp(reply_signature, "a(sssu)") != 0)
+  {
+    log_error(JACKDBUS_IFACE_SESSMGR ".Notify() reply signature mismatch. '%s'", reply_signature);
+    cookie_ptr->callback(cookie_ptr->context, NULL);
+    return;
   }
 
   dbus_message_iter_init(reply_ptr, &top_iter);
@@ -680,6 +1733,7 @@ static void jack_proxy_session_save_one_handle_reply(void * UNUSED(context), voi
     if (commandline != NULL)
     {
       log_error(JACKDBUS_IFACE_SESSMGR ".Notify() save returned more than one command");
+      cookie_ptr->callback(cookie_ptr->context, NULL);
       return;
     }
 
@@ -705,6 +1759,7 @@ static void jack_proxy_session_save_one_handle_reply(void * UNUSED(context), voi
   if (commandline == NULL)
   {
     log_error(JACKDBUS_IFACE_SESSMGR ".Notify() save returned no commands");
+    cookie_ptr->callback(cookie_ptr->context, NULL);
     return;
   }
 
@@ -715,6 +1770,7 @@ static void jack_proxy_session_save_one_handle_reply(void * UNUSED(context), voi
 
 bool
 jack_proxy_session_save_one(
+  unsigned int timeout,
   bool queue,
   const char * target,
   const char * path,
@@ -751,7 +1807,7 @@ jack_proxy_session_save_one(
   cookie.context = callback_context;
   cookie.callback = completion_callback;
 
-  ret = cdbus_call_async(request_ptr, callback_context, &cookie, sizeof(cookie), jack_proxy_session_save_one_handle_reply);
+  ret = cdbus_call_async(timeout, request_ptr, callback_context, &cookie, sizeof(cookie), jack_proxy_session_save_one_handle_reply);
 
   dbus_message_unref(request_ptr);
 
@@ -135,8 +135,68 @@ jack_proxy_reset_parameter_value(
 
 bool jack_reset_all_params(void);
 
+/**
+ * Fetch snapshot of the jackdbus configuration, unless there is already a valid one.
+ * Container reads and parameter gets are served from the snapshot.
+ * Parameter sets and resets that would not change the configuration are not sent to jackdbus.
+ *
+ * @return whether the snapshot is valid
+ */
+bool jack_proxy_conf_snapshot_fetch(void);
+
+/**
+ * Drop the snapshot of the jackdbus configuration. Next configuration access will fetch new one.
+ */
+void jack_proxy_conf_snapshot_invalidate(void);
+
+/**
+ * Get counter that is incremented each time the (cached) jackdbus configuration changes.
+ *
+ * @return the counter value
+ */
+unsigned int jack_proxy_conf_generation(void);
+
+/**
+ * Start staging of complete JACK configuration.
+ * Parameters that are not staged until jack_proxy_conf_stage_commit() will be reset to their defaults.
+ *
+ * @return success status
+ */
+bool jack_proxy_conf_stage_begin(void);
+
+/**
+ * Stage value of a JACK parameter.
+ * engine/driver and parameters that are not in the configuration snapshot are set immediately.
+ * Stage engine/driver before the driver parameters, so they are staged for the new driver.
+ *
+ * @param[in] address Parameter address
+ * @param[in] parameter_ptr The value, copied
+ *
+ * @return success status
+ */
+bool
+jack_proxy_conf_stage_set(
+  const char * address,
+  const struct jack_parameter_variant * parameter_ptr);
+
+/**
+ * Apply the staged configuration. Only parameters whose value differs are changed,
+ * with all calls pipelined. Staging ends even if the call fails.
+ *
+ * @param[out] changed_ptr Pointer to variable that will receive the number of changed parameters
+ *
+ * @return success status
+ */
+bool jack_proxy_conf_stage_commit(unsigned int * changed_ptr);
+
+/**
+ * Discard the staged configuration
+ */
+void jack_proxy_conf_stage_abort(void);
+
 bool
 jack_proxy_session_save_one(
+  unsigned int timeout,         /* in milliseconds, zero for no timeout */
   bool queue,
   const char * target,
   const char * path,
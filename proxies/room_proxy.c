@@ -375,6 +375,17 @@ bool ladish_room_proxy_load_project(ladish_room_proxy_handle proxy, const char *
   return true;
 }
 
+bool ladish_room_proxy_switch_project(ladish_room_proxy_handle proxy, const char * project_dir)
+{
+  if (!cdbus_call(0, proxy_ptr->service, proxy_ptr->object, IFACE_ROOM, "SwitchProject", "s", &project_dir, ""))
+  {
+    log_error("SwitchProject() failed.");
+    return false;
+  }
+
+  return true;
+}
+
 bool ladish_room_proxy_save_project(ladish_room_proxy_handle proxy, const char * project_dir, const char * project_name)
 {
   if (!cdbus_call(0, proxy_ptr->service, proxy_ptr->object, IFACE_ROOM, "SaveProject", "ss", &project_dir, &project_name, ""))
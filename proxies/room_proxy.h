@@ -47,6 +47,7 @@ ladish_room_proxy_create(
 void ladish_room_proxy_destroy(ladish_room_proxy_handle proxy);
 char * ladish_room_proxy_get_name(ladish_room_proxy_handle proxy);
 bool ladish_room_proxy_load_project(ladish_room_proxy_handle proxy, const char * project_dir);
+bool ladish_room_proxy_switch_project(ladish_room_proxy_handle proxy, const char * project_dir);
 bool ladish_room_proxy_save_project(ladish_room_proxy_handle proxy, const char * project_dir, const char * project_name);
 bool ladish_room_proxy_unload_project(ladish_room_proxy_handle proxy);
 